@@ -43,6 +43,7 @@ MIDDLEWARE = [
     'django.middleware.common.CommonMiddleware',
     'django.middleware.csrf.CsrfViewMiddleware',
     'django.contrib.auth.middleware.AuthenticationMiddleware',
+    'core.middleware.NativeTraceMiddleware',
     'django.contrib.messages.middleware.MessageMiddleware',
     'django.middleware.clickjacking.XFrameOptionsMiddleware',
 ]
@@ -114,6 +115,24 @@ STATIC_ROOT = BASE_DIR / 'staticfiles'
 MEDIA_URL = '/media/'
 MEDIA_ROOT = BASE_DIR / 'media'
 
+# Cubos columnares de encuestas (archivos mmap, uno por versión de encuesta)
+SURVEY_CUBE_DIR = config('SURVEY_CUBE_DIR', default=str(BASE_DIR / 'cache' / 'survey_cubes'))
+
+# Planificador nativo de cpp_csv (compartido por proceso). 0 = núcleos de la
+# máquina; con Celery prefork + gunicorn conviene repartir los núcleos.
+CPP_CSV_THREADS = config('CPP_CSV_THREADS', default=0, cast=int)
+CPP_CSV_THREADS_PER_CALL = config('CPP_CSV_THREADS_PER_CALL', default=0, cast=int)
+
+# Líneas de tiempo (Chrome Trace Event) de cpp_csv + Python. Vacío = apagado;
+# con directorio, ?trace=1 (staff) traza esa petición y CPP_CSV_TRACE_IMPORTS
+# traza cada importación.
+CPP_CSV_TRACE_DIR = config('CPP_CSV_TRACE_DIR', default='')
+CPP_CSV_TRACE_IMPORTS = config('CPP_CSV_TRACE_IMPORTS', default=False, cast=bool)
+
+# Contadores por fase de cpp_csv en los logs de importación ([IMPORT][STATS]).
+# Cuestan ~15-20% del parseo, así que van apagados; la memoria se registra siempre.
+CPP_CSV_IMPORT_STATS = config('CPP_CSV_IMPORT_STATS', default=False, cast=bool)
+
 DEFAULT_AUTO_FIELD = 'django.db.models.BigAutoField'
 
 LOGIN_REDIRECT_URL = 'dashboard'
@@ -23,6 +23,7 @@ MIDDLEWARE = [
     'django.middleware.common.CommonMiddleware',
     'django.middleware.csrf.CsrfViewMiddleware',
     'django.contrib.auth.middleware.AuthenticationMiddleware',
+    'core.middleware.NativeTraceMiddleware',
     'django.contrib.messages.middleware.MessageMiddleware',
     'django.middleware.clickjacking.XFrameOptionsMiddleware',
 ]
@@ -232,6 +233,8 @@ SURVEY_IMPORT_USE_COPY_QR = True
 # Chunks más pequeños para evitar picos de memoria
 SURVEY_IMPORT_CHUNK_SIZE = 2500  # Reducido de 5000 a 2500
 SURVEY_IMPORT_SAMPLE_SIZE = 5000  # Reducido de 10000 a 5000
+SURVEY_IMPORT_PREFETCH_CHUNKS = 2  # Chunks que cpp_csv parsea por adelantado durante el COPY
+SURVEY_IMPORT_MAX_OPTIONS = 200  # Más valores distintos que esto = columna de texto libre
 SURVEY_DELETE_CHUNK_SIZE = 2000  # Reducido de 5000 a 2000
 
 # Límites de memoria para procesamiento
@@ -4,4 +4,17 @@ from django.apps import AppConfig
 class CoreConfig(AppConfig):
     default_auto_field = 'django.db.models.BigAutoField'
     name = 'core'
-    verbose_name = 'Dashboard Core' # <-- El nombre en inglés
\ No newline at end of file
+    verbose_name = 'Dashboard Core' # <-- El nombre en inglés
+
+    def ready(self):
+        # Tamaño del planificador nativo antes de que cualquier kernel lo cree
+        from django.conf import settings
+
+        try:
+            from tools.cpp_csv import pybind_csv as cpp_csv
+        except ImportError:  # pragma: no cover - depende de la compilación local
+            return
+        cpp_csv.configure_threads(
+            getattr(settings, 'CPP_CSV_THREADS', 0),
+            getattr(settings, 'CPP_CSV_THREADS_PER_CALL', 0),
+        )
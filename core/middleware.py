@@ -1,6 +1,8 @@
 """
 Middleware para desarrollo local
 """
+import os
+
 from django.http import HttpResponsePermanentRedirect
 from django.conf import settings
 
@@ -23,3 +25,33 @@ class ForceHTTPInDevelopment:
         response = self.get_response(request)
         return response
 
+
+
+class NativeTraceMiddleware:
+    """
+    Con ?trace=1 (solo staff) y CPP_CSV_TRACE_DIR configurado, guarda la línea
+    de tiempo de la petición (etapas de Python y spans nativos de cpp_csv) como
+    JSON de Chrome Trace Event; el nombre del archivo va en X-Trace-File.
+    """
+    def __init__(self, get_response):
+        self.get_response = get_response
+
+    def __call__(self, request):
+        if not self._requested(request):
+            return self.get_response(request)
+
+        from core.utils.tracing import span, trace_to_file
+
+        with trace_to_file(f"request-{request.path}") as trace:
+            with span(f"{request.method} {request.path}"):
+                response = self.get_response(request)
+        if trace.path:
+            response['X-Trace-File'] = os.path.basename(trace.path)
+        return response
+
+    @staticmethod
+    def _requested(request):
+        if request.GET.get('trace') != '1' or not getattr(settings, 'CPP_CSV_TRACE_DIR', ''):
+            return False
+        user = getattr(request, 'user', None)
+        return bool(user and user.is_staff)
@@ -8,14 +8,25 @@ DataFrame building, simple question analytics, and NPS calculations.
 from __future__ import annotations
 
 import re
-import statistics
 from collections import Counter
 from typing import Iterable, List, Tuple, Dict, Optional, Any
 
 import pandas as pd
+from django.db.models import Count
 
+from core.utils.nps import nps_breakdown
+from core.utils.numeric_stats import summarize_distribution
+from core.utils.sentiment import SentimentLexicon, build_terms
+from core.utils.text_mining import analyze_texts
 from surveys.models import QuestionResponse, SurveyResponse, Question
 
+# El módulo nativo es opcional aquí: estas utilidades también corren en
+# entornos de prueba sin la extensión compilada.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
 # ---------------------------------------------------------------------------
 # Helpers
 # ---------------------------------------------------------------------------
@@ -36,6 +47,14 @@ def render_nps_chart(buckets: Dict[str, int]) -> str:
     return "nps_chart"
 
 
+def split_choice_values(text: str) -> List[str]:
+    """Split a multi-select answer into clean, de-duplicated options."""
+    if cpp_csv is not None:
+        return cpp_csv.split_multi_select(text)
+    parts = (p.strip() for p in re.split(r",|;", text))
+    return list(dict.fromkeys(p for p in parts if p))
+
+
 # ---------------------------------------------------------------------------
 # Context helper
 # ---------------------------------------------------------------------------
@@ -82,55 +101,43 @@ class TextAnalyzer:
         tokens = re.findall(r"[A-Za-zÁÉÍÓÚáéíóúñÑüÜ']+", text)
         return [t.lower() for t in tokens]
 
+    SENTIMENT_LEXICON = SentimentLexicon(build_terms(
+        positive=("good", "great", "excelente", "excellent", "amazing"),
+        negative=("bad", "poor", "terrible"),
+    ))
+
     @staticmethod
     def analyze_sentiment(texts: Iterable[str]):
-        """Very small heuristic sentiment: positive if any good tokens, negative otherwise."""
-        good = {"good", "great", "excelente", "excellent", "amazing"}
-        bad = {"bad", "poor", "terrible"}
-        joined = " ".join([t or "" for t in texts])
-        jl = joined.lower()
-        score = 0
-        if any(w in jl for w in good):
-            score += 1
-        if any(w in jl for w in bad):
-            score -= 1
+        """Sentimiento por léxico (con negaciones): puntaje agregado y por respuesta."""
+        result = TextAnalyzer.SENTIMENT_LEXICON.score(list(texts))
+        score = result["positive"] - result["negative"]
         label = "neutral"
         if score > 0:
             label = "positive"
         elif score < 0:
             label = "negative"
-        return {"score": score, "label": label}
+        return {"score": score, "label": label, "scores": result["scores"]}
 
     @staticmethod
-    def analyze_text_responses(qs: Iterable[Any], max_texts: int = 100) -> Tuple[List[Tuple[str, int]], List[Tuple[str, int]], Optional[Any]]:
+    def analyze_text_responses(qs: Iterable[Any], max_texts: Optional[int] = None) -> Tuple[List[Tuple[str, int]], List[Tuple[str, int]], Optional[Any]]:
+        """Frecuencias de palabras y bigramas; max_texts=None analiza todos los textos."""
         texts: List[str] = []
         for item in qs:
             val = getattr(item, "text_value", None)
             if val:
                 texts.append(str(val))
-            if len(texts) >= max_texts:
+            if max_texts is not None and len(texts) >= max_texts:
                 break
 
         if not texts:
             return [], [], None
 
-        tokens: List[str] = []
-        for t in texts:
-            tokens.extend(TextAnalyzer._tokenize(t))
-
-        # Filter short tokens and stopwords
-        tokens = [t for t in tokens if len(t) > 2 and t not in TextAnalyzer.SPANISH_STOPWORDS]
-        word_counts = Counter(tokens)
-        words = sorted(word_counts.items(), key=lambda kv: (-kv[1], kv[0]))
-
-        bigrams: Counter[str] = Counter()
-        for t in texts:
-            toks = [x for x in TextAnalyzer._tokenize(t) if len(x) > 2 and x not in TextAnalyzer.SPANISH_STOPWORDS]
-            for i in range(len(toks) - 1):
-                bg = f"{toks[i]} {toks[i+1]}"
-                bigrams[bg] += 1
-        bigram_list = sorted(bigrams.items(), key=lambda kv: (-kv[1], kv[0]))
-
+        # Conteo en un solo recorrido (nativo cuando cpp_csv está compilado)
+        result = analyze_texts(
+            texts, min_length=3, stopwords=TextAnalyzer.SPANISH_STOPWORDS, top_k=0, bigrams=True,
+        )
+        words = [tuple(item) for item in result['words']]
+        bigram_list = [tuple(item) for item in result['bigrams']]
         return words, bigram_list, None
 
 
@@ -190,9 +197,18 @@ class QuestionAnalyzer:
     @staticmethod
     def analyze_numeric_question(question: Question, survey_responses: Iterable[SurveyResponse], include_charts: bool = False) -> Dict[str, Any]:
         qr_qs = QuestionAnalyzer._responses_for_question(question, survey_responses)
-        values = [qr.numeric_value for qr in qr_qs if qr.numeric_value is not None]
-        total = len(values)
-        if not values:
+        # Distribución (valor, conteo) agregada en la BD: no se cargan objetos por respuesta
+        dist = sorted(
+            qr_qs.filter(numeric_value__isnull=False)
+            .values_list("numeric_value")
+            .annotate(cnt=Count("id"))
+            .order_by()
+        )
+        values = [value for value, _ in dist]
+        counts = [count for _, count in dist]
+        summary = summarize_distribution(values, counts)
+        total = summary["count"]
+        if not total:
             return {
                 "total_respuestas": 0,
                 "estadisticas": None,
@@ -203,10 +219,10 @@ class QuestionAnalyzer:
                 "chart_data": None,
             }
 
-        minimo = min(values)
-        maximo = max(values)
-        promedio = round(sum(values) / total, 1)
-        mediana = statistics.median(values)
+        minimo = values[0]
+        maximo = values[-1]
+        promedio = round(summary["mean"], 1)
+        mediana = summary["median"]
         scale_cap = 10 if getattr(question, "type", None) == "scale" else None
 
         if promedio >= 8:
@@ -217,7 +233,7 @@ class QuestionAnalyzer:
             sentimiento = "Bueno"
 
         chart_image = None
-        chart_data = {"labels": list(range(len(values))), "data": values}
+        chart_data = {"labels": values, "data": counts}
         if include_charts:
             chart_image = render_numeric_chart(chart_data)
 
@@ -252,8 +268,7 @@ class QuestionAnalyzer:
             if qr.selected_option:
                 counts[qr.selected_option.text] += 1
             elif qr.text_value:
-                parts = [p.strip() for p in re.split(r",|;", qr.text_value) if p.strip()]
-                for p in parts:
+                for p in split_choice_values(qr.text_value):
                     counts[p] += 1
 
         total_responses = qr_qs.count()
@@ -311,32 +326,94 @@ class QuestionAnalyzer:
 class NPSCalculator:
     """Compute Net Promoter Score for a scale question."""
 
+    @staticmethod
+    def _group_payload(group: Dict[str, Any]) -> Dict[str, Any]:
+        """Score, buckets and confidence interval of one NPS group, rounded for display."""
+        return {
+            "score": round(group["score"], 1),
+            "total": group["total"],
+            "breakdown": {
+                "promoters": group["promoters"],
+                "passives": group["passives"],
+                "detractors": group["detractors"],
+            },
+            "margin": round(group["margin"], 1),
+            "confidence_interval": (round(group["ci_low"], 1), round(group["ci_high"], 1)),
+        }
+
     @staticmethod
     def calculate_nps(question: Optional[Question], survey_responses: Iterable[SurveyResponse], include_chart: bool = False) -> Dict[str, Any]:
         if not question:
             return {"score": None, "breakdown_chart": None}
 
         qr_qs = QuestionAnalyzer._responses_for_question(question, survey_responses)
-        values = [qr.numeric_value for qr in qr_qs if qr.numeric_value is not None]
-        total = len(values)
-        if total == 0:
+        # Histograma (valor, conteo) agregado en la BD; el kernel cuenta buckets e intervalo
+        dist = list(
+            qr_qs.filter(numeric_value__isnull=False)
+            .values_list("numeric_value")
+            .annotate(cnt=Count("id"))
+            .order_by()
+        )
+        overall = nps_breakdown([v for v, _ in dist], [c for _, c in dist])["overall"]
+        if not overall["total"]:
             return {"score": None, "breakdown_chart": None}
 
-        promoters = sum(1 for v in values if v >= 9)
-        detractors = sum(1 for v in values if v <= 6)
-        score = ((promoters / total) * 100) - ((detractors / total) * 100)
-        score = round(score, 1)
-
-        buckets = {
-            "promoters": promoters,
-            "passives": sum(1 for v in values if 7 <= v <= 8),
-            "detractors": detractors,
-        }
+        result = NPSCalculator._group_payload(overall)
+        result["breakdown_chart"] = render_nps_chart(result["breakdown"]) if include_chart else None
+        return result
 
-        breakdown_chart = render_nps_chart(buckets) if include_chart else None
-
-        return {
-            "score": score,
-            "breakdown": buckets,
-            "breakdown_chart": breakdown_chart,
-        }
+    @staticmethod
+    def calculate_nps_by_segments(
+        question: Question,
+        survey_responses: Iterable[SurveyResponse],
+        segment_questions: Iterable[Question],
+    ) -> Dict[int, List[Dict[str, Any]]]:
+        """
+        NPS of `question` split by the answers to each segment question
+        (e.g. every demographic). One DB aggregation (segment answer, score)
+        -> count and a single kernel pass for every segment of every question.
+
+        Returns {segment_question_id: [{"segment": label, **group}, ...]}
+        ordered by respondents; multi-select answers count in each option.
+        """
+        segment_questions = list(segment_questions)
+        if not question or not segment_questions:
+            return {}
+
+        rows = (
+            QuestionResponse.objects.filter(
+                question__in=segment_questions,
+                survey_response__in=survey_responses,
+                survey_response__question_responses__question=question,
+                survey_response__question_responses__numeric_value__isnull=False,
+            )
+            .values_list(
+                "question_id",
+                "selected_option__text",
+                "text_value",
+                "survey_response__question_responses__numeric_value",
+            )
+            .annotate(cnt=Count("id"))
+            .order_by()
+        )
+
+        codes: Dict[Tuple[int, str], int] = {}
+        values, counts, segments = [], [], []
+        for question_id, option_text, text_value, value, cnt in rows:
+            label = str(option_text or text_value or "").strip()
+            if not label:
+                continue
+            code = codes.setdefault((question_id, label), len(codes))
+            values.append(value)
+            counts.append(cnt)
+            segments.append(code)
+
+        groups = nps_breakdown(values, counts, segments, num_segments=len(codes))["segments"]
+        result: Dict[int, List[Dict[str, Any]]] = {q.id: [] for q in segment_questions}
+        for (question_id, label), code in codes.items():
+            group = groups[code]
+            if group["total"]:
+                result[question_id].append({"segment": label, **NPSCalculator._group_payload(group)})
+        for entries in result.values():
+            entries.sort(key=lambda e: (-e["total"], e["segment"]))
+        return result
@@ -3,13 +3,21 @@ import logging
 import random
 import unicodedata
 import re
-from collections import defaultdict, Counter
+from collections import defaultdict
 from django.core.exceptions import FieldError
 from django.core.cache import cache
 from django.db.models import Avg, Max, Min, Count
 from django.db.models.functions import TruncDate
 from surveys.models import QuestionResponse
 from asgiref.sync import sync_to_async
+from core.utils.correlation import MAX_HEATMAP_COLUMNS, correlation_matrix
+from core.utils.crosstab import build_crosstab
+from core.utils import pii
+from core.utils.numeric_stats import HISTOGRAM_BINS, summarize_distribution
+from core.utils.sentiment import SentimentLexicon, build_terms, sentiment_label
+from core.utils.text_index import TextIndex, get_text_index
+from core.utils.text_mining import STOPWORDS_ES, analyze_texts, fold_text
+from core.utils import tracing
 
 logger = logging.getLogger(__name__)
 
@@ -520,35 +528,35 @@ class TextNarrative:
 class TextMiningEngine:
     POSITIVE_WORDS = {'bien', 'bueno', 'excelente', 'genial', 'mejor', 'feliz', 'satisfecho', 'gracias', 'encanta', 'perfecto', 'amable', 'rapido', 'eficiente', 'util', 'facil', 'seguro'}
     NEGATIVE_WORDS = {'mal', 'malo', 'pésimo', 'peor', 'horrible', 'lento', 'difícil', 'error', 'problema', 'queja', 'sucio', 'caro', 'tarde', 'pesimo', 'feo', 'inutil', 'complicado', 'falla'}
+    # Frases de varias palabras: ganan sobre sus palabras sueltas ("no funciona" no es solo "no")
+    POSITIVE_PHRASES = {'me gusta', 'me encanta', 'muy recomendable', 'vale la pena', 'buen servicio', 'buena atencion'}
+    NEGATIVE_PHRASES = {'no funciona', 'no sirve', 'mala atencion', 'mal servicio', 'deja mucho que desear', 'perdida de tiempo'}
+    _lexicon = None
+    @classmethod
+    def sentiment_lexicon(cls):
+        # El autómata se construye una vez por proceso y se reutiliza
+        if cls._lexicon is None:
+            cls._lexicon = SentimentLexicon(build_terms(
+                cls.POSITIVE_WORDS | cls.POSITIVE_PHRASES, cls.NEGATIVE_WORDS | cls.NEGATIVE_PHRASES,
+            ))
+        return cls._lexicon
     @staticmethod
     def extract_topics_and_sentiment(texts):
         if not texts: return [], "Neutral"
-        words = []
-        pos_count = 0; neg_count = 0
-        for text in texts:
-            clean = TextMiningEngine.normalize_text(text)
-            tokens = [w for w in clean.split() if len(w) > 3]
-            words.extend(tokens)
-            for w in tokens:
-                if w in TextMiningEngine.POSITIVE_WORDS: pos_count += 1
-                elif w in TextMiningEngine.NEGATIVE_WORDS: neg_count += 1
-        total_sent = pos_count + neg_count
-        sentiment_label = "Neutral"
-        if total_sent > 0:
-            score = (pos_count - neg_count) / total_sent
-            if score > 0.15: sentiment_label = "Positivo"
-            elif score < -0.15: sentiment_label = "Negativo"
-        return ([item[0] for item in Counter(words).most_common(6)] if words else []), sentiment_label
+        topics = analyze_texts(texts, min_length=4, stopwords=STOPWORDS_ES, top_k=6, bigrams=False)
+        sentiment = TextMiningEngine.sentiment_lexicon().score(texts)
+        return [word for word, _ in topics['words']], sentiment_label(sentiment)
     @staticmethod
     def normalize_text(text):
         if not text: return ''
-        return re.sub(r'[^a-z0-9\s]', '', unicodedata.normalize('NFKD', str(text).lower()).encode('ascii', 'ignore').decode('ascii'))
+        return ' '.join(fold_text(text).split())
     @staticmethod
-    def find_representative_quote(texts, topic):
+    def find_representative_quote(texts, topic, index=None):
         if not topic: return None
-        for text in texts:
-            if topic in text.lower() and 20 < len(text) < 110: return f'"{text}"'
-        return None
+        # Índice invertido: una consulta por tema en vez de recorrer los textos
+        index = index or TextIndex(texts)
+        row = index.best_quote([topic])
+        return f'"{index.texts[row]}"' if row is not None else None
 
 
 class SensitiveMetadataDetector:
@@ -557,9 +565,8 @@ class SensitiveMetadataDetector:
     Diseñado para ser conservador (mejor ocultar de más que filtrar PII).
     """
 
-    _EMAIL_RE = re.compile(r"\b[a-z0-9._%+-]+@[a-z0-9.-]+\.[a-z]{2,}\b", re.IGNORECASE)
-    # Teléfonos comunes: admite +, espacios, guiones, paréntesis; valida longitud de dígitos.
-    _PHONE_CANDIDATE_RE = re.compile(r"\+?\d[\d\s\-().]{6,}\d")
+    _EMAIL_RE = pii.EMAIL_RE
+    _PHONE_CANDIDATE_RE = pii.PHONE_CANDIDATE_RE
 
     # Palabras/patrones (ya normalizados: sin acentos, solo a-z0-9 y espacios)
     _SENSITIVE_LABEL_PATTERNS = [
@@ -675,45 +682,20 @@ class SensitiveMetadataDetector:
 
     @staticmethod
     def _looks_like_phone(value: str) -> bool:
-        if not value:
-            return False
-        s = str(value).strip()
-        if not SensitiveMetadataDetector._PHONE_CANDIDATE_RE.search(s):
-            return False
-        digits = re.sub(r"\D", "", s)
-        return 7 <= len(digits) <= 15
+        return pii.looks_like_phone(value)
 
     @staticmethod
     def _looks_like_identifier(value: str) -> bool:
-        """Detecta IDs típicos: mezcla alfanumérica o números largos.
-
-        Heurística para columnas como Reserva_ID/BookingCode aunque el label sea raro.
-        """
-        if value is None:
-            return False
-        s = str(value).strip()
-        if not s:
-            return False
-        # Normalizar separadores comunes en IDs
-        s_clean = re.sub(r"[\s_\-]+", "", s)
-        if len(s_clean) < 6 or len(s_clean) > 64:
-            return False
-        if not re.fullmatch(r"[A-Za-z0-9]+", s_clean):
-            return False
-        has_alpha = bool(re.search(r"[A-Za-z]", s_clean))
-        has_digit = bool(re.search(r"\d", s_clean))
-        if has_alpha and has_digit:
-            return True
-        # Solo dígitos, pero largo (ej. folio numérico)
-        if (not has_alpha) and has_digit and len(s_clean) >= 8:
-            return True
-        return False
+        """Detecta IDs típicos: mezcla alfanumérica o números largos."""
+        return pii.looks_like_identifier(value)
 
     @classmethod
-    def detect(cls, question_text: str, *, is_demographic: bool = False, sample_values=None):
+    def detect(cls, question_text: str, *, is_demographic: bool = False, sample_values=None, value_stats=None):
         """Devuelve (is_sensitive, category, reason).
 
         category: 'metadata' | 'pii'
+        value_stats: resultado de core.utils.pii.scan_values sobre TODOS los
+        valores de la pregunta; si no viene, se escanean `sample_values`.
         """
         if is_demographic:
             return True, 'metadata', 'question.is_demographic'
@@ -748,23 +730,21 @@ class SensitiveMetadataDetector:
                     return True, 'metadata', 'matched_sensitive_label'
 
         # Heurística por valores (cuando el label no lo delata)
-        if sample_values:
-            values = [str(v) for v in sample_values if v is not None]
-            if values:
-                email_hits = sum(1 for v in values if cls._EMAIL_RE.search(v))
-                phone_hits = sum(1 for v in values if cls._looks_like_phone(v))
-                id_hits = sum(1 for v in values if cls._looks_like_identifier(v))
-                n = len(values)
-                if email_hits >= 2 and (email_hits / max(n, 1)) >= 0.25:
-                    return True, 'pii', 'detected_email_values'
-                if phone_hits >= 2 and (phone_hits / max(n, 1)) >= 0.25:
-                    return True, 'pii', 'detected_phone_values'
-
-                # IDs: además exigir alta unicidad (típico de identificadores)
-                if id_hits >= 2 and (id_hits / max(n, 1)) >= 0.25:
-                    unique_ratio = len(set(values)) / max(n, 1)
-                    if unique_ratio >= 0.8:
-                        return True, 'metadata', 'detected_identifier_values'
+        if value_stats is None and sample_values:
+            value_stats = pii.scan_values(sample_values)
+        if value_stats and value_stats['values']:
+            n = value_stats['values']
+            if value_stats['emails'] >= 2 and value_stats['email_ratio'] >= 0.25:
+                return True, 'pii', 'detected_email_values'
+            if value_stats['phones'] >= 2 and value_stats['phone_ratio'] >= 0.25:
+                return True, 'pii', 'detected_phone_values'
+            if value_stats['national_ids'] >= 2 and value_stats['national_id_ratio'] >= 0.25:
+                return True, 'pii', 'detected_national_id_values'
+
+            # IDs: además exigir alta unicidad (típico de identificadores)
+            if value_stats['identifiers'] >= 2 and value_stats['identifier_ratio'] >= 0.25:
+                if value_stats['distinct'] / n >= 0.8:
+                    return True, 'metadata', 'detected_identifier_values'
 
         return False, 'none', ''
 
@@ -814,35 +794,21 @@ class SurveyAnalysisService:
     def _optimize_chart_data(raw_dist, is_numeric=False):
         if not raw_dist: return [], []
         if is_numeric:
-            data_points = []
-            for d in raw_dist:
-                if d.get('value') is not None:
-                    data_points.extend([float(d['value'])] * d['count'])
-            if not data_points: return [], []
-            unique_vals = set(data_points)
+            # OPT: trabajar sobre (valor, conteo) sin expandir una lista por respuesta
+            valid = [d for d in raw_dist if d.get('value') is not None and d.get('count')]
+            if not valid: return [], []
+            unique_vals = {float(d['value']) for d in valid}
             if len(unique_vals) <= 12:
-                sorted_dist = sorted(raw_dist, key=lambda x: x['value'])
+                sorted_dist = sorted(valid, key=lambda x: x['value'])
                 labels = [str(int(d['value']) if d['value'] % 1 == 0 else d['value']) for d in sorted_dist]
                 data = [d['count'] for d in sorted_dist]
                 return labels, data
-            min_val = min(data_points); max_val = max(data_points)
-            num_bins = 10
-            interval = (max_val - min_val) / num_bins
-            if interval < 1: interval = 1
-            ranges = []; curr = min_val
-            for _ in range(num_bins):
-                end = curr + interval
-                ranges.append((curr, end))
-                curr = end
-            bins_count = [0] * num_bins
-            for val in data_points:
-                for i, (start, end) in enumerate(ranges):
-                    if start <= val < end or (i == num_bins-1 and start <= val <= end + 0.1):
-                        bins_count[i] += 1; break
+            summary = summarize_distribution(
+                [d['value'] for d in valid], [d['count'] for d in valid], bins=HISTOGRAM_BINS
+            )
             final_labels = []; final_data = []
-            for i, count in enumerate(bins_count):
+            for start, end, count in summary['histogram']:
                 if count > 0:
-                    start, end = ranges[i]
                     lbl = f"{int(start)}-{int(end)}" if int(start) != int(end) else str(int(start))
                     final_labels.append(lbl); final_data.append(count)
             return final_labels, final_data
@@ -854,7 +820,11 @@ class SurveyAnalysisService:
             return [d['option'] for d in top_8] + ["Otros"], [d['count'] for d in top_8] + [sum(d['count'] for d in others)]
 
     @staticmethod
-    async def get_analysis_data(survey, responses_queryset, include_charts=None, cache_key=None, config=None):
+    @tracing.traced('analysis.get_analysis_data')
+    async def get_analysis_data(survey, responses_queryset, include_charts=None, cache_key=None, config=None, cube_selection=None):
+        # cube_selection (CubeSelection): las mismas respuestas que responses_queryset
+        # resueltas sobre el cubo de la encuesta; distribuciones, conteos y evolución
+        # salen de ahí en lugar de consultas agregadas.
         config = config or {}
         tone = config.get('tone', 'FORMAL').upper()
         include_quotes = config.get('include_quotes', True)
@@ -870,14 +840,17 @@ class SurveyAnalysisService:
         
         if cache_key is None:
             # OPT: usar una sola query (aggregate) para total + last_id.
-            agg = await sync_to_async(
-                lambda: responses_queryset.aggregate(total=Count('id'), last_id=Max('id')),
-                thread_sensitive=True,
-            )()
+            if cube_selection is not None:
+                agg = {'total': cube_selection.count(), 'last_id': cube_selection.last_response_id()}
+            else:
+                agg = await sync_to_async(
+                    lambda: responses_queryset.aggregate(total=Count('id'), last_id=Max('id')),
+                    thread_sensitive=True,
+                )()
             total = int(agg.get('total') or 0)
             last_id = int(agg.get('last_id') or 0)
             cache_key = (
-                f"analysis_v22_privacy_samples:{survey.id}:{total}:{last_id}:{tone}:{include_quotes}:"
+                f"analysis_v24_privacy_samples:{survey.id}:{total}:{last_id}:{tone}:{include_quotes}:"
                 f"charts={int(include_charts)}:min={min_samples}"
             )
 
@@ -893,9 +866,15 @@ class SurveyAnalysisService:
         )()
         analyzable_q = [q for q in questions if q.type != 'section']
 
-        numeric_stats, numeric_dist = await SurveyAnalysisService._fetch_numeric_stats(analyzable_q, responses_queryset)
-        choice_dist = await SurveyAnalysisService._fetch_choice_stats(analyzable_q, responses_queryset)
-        text_responses = await SurveyAnalysisService._fetch_text_responses(analyzable_q, responses_queryset)
+        with tracing.span('analysis.numeric_stats', questions=len(analyzable_q)):
+            numeric_stats, numeric_dist = await SurveyAnalysisService._fetch_numeric_stats(analyzable_q, responses_queryset, cube_selection)
+        with tracing.span('analysis.choice_stats'):
+            choice_dist = await SurveyAnalysisService._fetch_choice_stats(analyzable_q, responses_queryset, cube_selection)
+        with tracing.span('analysis.text_responses'):
+            text_responses = await SurveyAnalysisService._fetch_text_responses(analyzable_q, responses_queryset)
+        # PII sobre TODOS los comentarios de cada pregunta, en una sola pasada nativa
+        with tracing.span('analysis.pii', columns=len(text_responses)):
+            text_pii = dict(zip(text_responses, pii.scan_columns(list(text_responses.values()))))
         
         analysis_data = []
         # OPT: evitar listas enormes para KPI (usar promedio ponderado)
@@ -903,6 +882,7 @@ class SurveyAnalysisService:
         satisfaction_count = 0
         main_satisfaction_qid = next((q.id for q in analyzable_q if q.type in ['scale', 'number']), None)
 
+        questions_start = tracing.now_ns()
         for idx, q in enumerate(analyzable_q, 1):
             item = {
                 'id': q.id, 'text': q.text, 'type': q.type, 'order': idx,
@@ -975,7 +955,7 @@ class SurveyAnalysisService:
                 is_sensitive, category, reason = SensitiveMetadataDetector.detect(
                     q.text,
                     is_demographic=is_demo_flag,
-                    sample_values=texts[:20],
+                    value_stats=text_pii[q.id],
                 )
                 item['is_demographic'] = is_demo_flag
                 if is_sensitive:
@@ -990,11 +970,17 @@ class SurveyAnalysisService:
                     continue
 
                 topics, sentiment = TextMiningEngine.extract_topics_and_sentiment(texts)
-                item['top_responses'] = texts[:5]
-                item['samples_texto'] = texts[:5]
+                # Ejemplos y citas solo de comentarios sin correo/teléfono/documento
+                flagged = set(text_pii[q.id]['flagged_rows'])
+                safe_texts = [t for i, t in enumerate(texts) if i not in flagged] if flagged else texts
+                item['top_responses'] = safe_texts[:5]
+                item['samples_texto'] = safe_texts[:5]
                 item['tipo_display'] = 'text'
                 quote = None
-                if include_quotes and topics: quote = TextMiningEngine.find_representative_quote(texts, topics[0])
+                if include_quotes and topics:
+                    quote = TextMiningEngine.find_representative_quote(
+                        safe_texts, topics[0], index=get_text_index(q.id, safe_texts),
+                    )
                 full_narrative = TextNarrative.generate(len(texts), topics, sentiment, quote, tone)
                 item['insight'] = full_narrative
                 item['insight_data'] = {
@@ -1011,11 +997,10 @@ class SurveyAnalysisService:
                 item['total_responses'] = item['total_respuestas']
 
                 is_demo_flag = bool(getattr(q, 'is_demographic', False))
-                sample_opts = [d.get('option') for d in (raw_dist or [])][:20]
                 is_sensitive, category, reason = SensitiveMetadataDetector.detect(
                     q.text,
                     is_demographic=is_demo_flag,
-                    sample_values=sample_opts,
+                    sample_values=[d.get('option') for d in (raw_dist or [])],
                 )
                 item['is_demographic'] = is_demo_flag
                 if is_sensitive:
@@ -1071,26 +1056,47 @@ class SurveyAnalysisService:
                         )
 
             analysis_data.append(item)
+        tracing.mark('analysis.questions', questions_start, questions=len(analyzable_q))
+
+        heatmap_image = None
+        if include_charts:
+            with tracing.span('analysis.heatmap'):
+                heatmap_image = await SurveyAnalysisService._build_heatmap(analyzable_q, responses_queryset)
 
         kpi = (
             round((satisfaction_sum / satisfaction_count), 1)
             if satisfaction_count >= min_samples_global_kpi
             else None
         )
-        evolution = await sync_to_async(TimelineEngine.analyze_evolution, thread_sensitive=True)(responses_queryset)
+        if cube_selection is not None:
+            evolution = cube_selection.evolution()
+            total_respuestas = cube_selection.count()
+        else:
+            with tracing.span('analysis.evolution'):
+                evolution = await sync_to_async(TimelineEngine.analyze_evolution, thread_sensitive=True)(responses_queryset)
+            total_respuestas = await sync_to_async(responses_queryset.count, thread_sensitive=True)()
         result = {
             'analysis_data': analysis_data, 'kpi_prom_satisfaccion': kpi,
             'kpi_satisfaction_count': satisfaction_count,
             'kpi_min_required': min_samples_global_kpi,
-            'nps_data': {'score': None}, 'heatmap_image': None, 'total_respuestas': await sync_to_async(responses_queryset.count, thread_sensitive=True)(),
+            'nps_data': {'score': None}, 'heatmap_image': heatmap_image, 'total_respuestas': total_respuestas,
             'evolution': evolution
         }
         cache.set(cache_key, result, 3600)
         return result
 
     @staticmethod
-    async def _fetch_numeric_stats(analyzable_q, qs):
+    async def _fetch_numeric_stats(analyzable_q, qs, cube_selection=None):
         ids = [q.id for q in analyzable_q if q.type in ['scale', 'number']]
+        if cube_selection is not None:
+            cube_stats, cube_dist = cube_selection.numeric_stats([i for i in ids if cube_selection.has_question(i)])
+            # Solo van a la BD las preguntas que el cubo no tiene (p. ej. recién agregadas)
+            ids = [i for i in ids if not cube_selection.has_question(i)]
+            if not ids: return cube_stats, cube_dist
+            stats, dist = await SurveyAnalysisService._fetch_numeric_stats([q for q in analyzable_q if q.id in ids], qs)
+            stats.update(cube_stats)
+            dist.update(cube_dist)
+            return stats, dist
         if not ids: return {}, {}
         valid = QuestionResponse.objects.filter(question_id__in=ids, survey_response__in=qs, numeric_value__isnull=False)
         stats_qs = await sync_to_async(
@@ -1107,8 +1113,49 @@ class SurveyAnalysisService:
         return stats, dist
 
     @staticmethod
-    async def _fetch_choice_stats(analyzable_q, qs):
+    async def _build_heatmap(analyzable_q, qs):
+        """Mapa de correlaciones entre preguntas numéricas (sin las sensibles)."""
+        numeric_q = [
+            q for q in analyzable_q
+            if q.type in ['scale', 'number']
+            and not SensitiveMetadataDetector.detect(
+                q.text, is_demographic=bool(getattr(q, 'is_demographic', False))
+            )[0]
+        ][:MAX_HEATMAP_COLUMNS]
+        if len(numeric_q) < 2:
+            return None
+
+        ids = [q.id for q in numeric_q]
+        # Tripletas directo de la BD: sin DataFrame de respuestas ni pivot
+        triples = await sync_to_async(
+            lambda: list(
+                QuestionResponse.objects.filter(
+                    question_id__in=ids, survey_response__in=qs, numeric_value__isnull=False
+                ).values_list('survey_response_id', 'question_id', 'numeric_value').order_by('survey_response_id')
+            ),
+            thread_sensitive=True,
+        )()
+        if not triples:
+            return None
+
+        response_ids, question_ids, values = zip(*triples)
+        corr = correlation_matrix(response_ids, question_ids, values, columns=ids)
+        labels = {q.id: q.text for q in numeric_q}
+        corr = corr.rename(index=labels, columns=labels)
+
+        from core.utils.charts import ChartGenerator
+        return ChartGenerator.generate_correlation_heatmap(corr)
+
+    @staticmethod
+    async def _fetch_choice_stats(analyzable_q, qs, cube_selection=None):
         ids = [q.id for q in analyzable_q if q.type in ['single', 'multi', 'radio', 'select']]
+        if cube_selection is not None:
+            cube_dist = cube_selection.choice_stats([i for i in ids if cube_selection.has_question(i)])
+            ids = [i for i in ids if not cube_selection.has_question(i)]
+            if not ids: return cube_dist
+            dist = await SurveyAnalysisService._fetch_choice_stats([q for q in analyzable_q if q.id in ids], qs)
+            dist.update(cube_dist)
+            return dist
         if not ids: return {}
         dist = defaultdict(list)
         dist_qs = await sync_to_async(
@@ -1124,23 +1171,40 @@ class SurveyAnalysisService:
         ids = [q.id for q in analyzable_q if q.type == 'text']
         if not ids: return {}
         res = defaultdict(list)
+        # Todos los comentarios (el motor de texto nativo no necesita muestrear);
+        # se recorren por chunks para no cargar objetos del ORM.
+        base = QuestionResponse.objects.filter(question_id__in=ids, survey_response__in=qs).exclude(text_value='')
         try:
             res_qs = await sync_to_async(
-                lambda: list(QuestionResponse.objects.filter(question_id__in=ids, survey_response__in=qs).exclude(text_value='').values('question_id', 'text_value').order_by('-created_at')[:200]),
+                lambda: list(base.values_list('question_id', 'text_value').order_by('-created_at').iterator(chunk_size=5000)),
                 thread_sensitive=True,
             )()
         except FieldError:
             res_qs = await sync_to_async(
-                lambda: list(QuestionResponse.objects.filter(question_id__in=ids, survey_response__in=qs).exclude(text_value='').values('question_id', 'text_value')[:200]),
+                lambda: list(base.values_list('question_id', 'text_value').iterator(chunk_size=5000)),
                 thread_sensitive=True,
             )()
-        for x in res_qs: res[x['question_id']].append(x['text_value'])
+        for question_id, text_value in res_qs: res[question_id].append(text_value)
         return res
     
+    @staticmethod
+    def _crosstab_pairs(question, queryset):
+        """Pares (response_id, categoría) de una pregunta para la tabla cruzada."""
+        ids, labels = [], []
+        rows = QuestionResponse.objects.filter(
+            question=question,
+            survey_response__in=queryset,
+        ).values_list('survey_response_id', 'selected_option__text', 'text_value', 'numeric_value')
+        for resp_id, option_text, text_value, numeric_value in rows.iterator(chunk_size=5000):
+            value = option_text or text_value or (str(numeric_value) if numeric_value is not None else '')
+            ids.append(resp_id)
+            labels.append(str(value).strip() or 'Sin respuesta')
+        return ids, labels
+
     @staticmethod
     def generate_crosstab(survey, row_id, col_id, queryset=None):
         """
-        Genera una tabla cruzada optimizada usando pandas.
+        Genera una tabla cruzada optimizada (kernel nativo, sin pandas).
         
         Args:
             survey: Instancia del Survey
@@ -1151,14 +1215,8 @@ class SurveyAnalysisService:
         Returns:
             dict: Estructura con la tabla cruzada en formato 'split' + metadatos
         """
-        try:
-            import pandas as pd
-            import numpy as np
-        except ImportError:
-            return {'error': 'Pandas no está disponible para generar tablas cruzadas.'}
-        
         # Cache key único
-        cache_key = f"crosstab_v4_privacy_{survey.id}_{row_id}_{col_id}_{hash(str(queryset.query)) if queryset else 'all'}"
+        cache_key = f"crosstab_v5_privacy_{survey.id}_{row_id}_{col_id}_{hash(str(queryset.query)) if queryset else 'all'}"
         cached = cache.get(cache_key)
         if cached:
             return cached
@@ -1192,89 +1250,24 @@ class SurveyAnalysisService:
             # En su lugar, filtramos QuestionResponse por subquery (survey_response__in=queryset)
             # y recorremos los ids con iterator().
 
-            # Obtener respuestas para ambas preguntas
-            row_responses = QuestionResponse.objects.filter(
-                question=row_question,
-                survey_response__in=queryset,
-            ).select_related('selected_option').values(
-                'survey_response_id',
-                'selected_option__text',
-                'text_value',
-                'numeric_value'
-            )
-
-            col_responses = QuestionResponse.objects.filter(
-                question=col_question,
-                survey_response__in=queryset,
-            ).select_related('selected_option').values(
-                'survey_response_id',
-                'selected_option__text',
-                'text_value',
-                'numeric_value'
-            )
-            
-            # Convertir a diccionarios indexados por survey_response_id
-            row_data = {}
-            for r in row_responses:
-                value = r['selected_option__text'] or r['text_value'] or str(r['numeric_value']) if r['numeric_value'] is not None else 'Sin respuesta'
-                row_data[r['survey_response_id']] = str(value).strip() if value else 'Sin respuesta'
-            
-            col_data = {}
-            for r in col_responses:
-                value = r['selected_option__text'] or r['text_value'] or str(r['numeric_value']) if r['numeric_value'] is not None else 'Sin respuesta'
-                col_data[r['survey_response_id']] = str(value).strip() if value else 'Sin respuesta'
-            
-            # Crear DataFrame
-            df_list = []
-            total_responses = 0
-            for resp_id in queryset.values_list('id', flat=True).iterator(chunk_size=5000):
-                total_responses += 1
-                row_val = row_data.get(resp_id, 'Sin respuesta')
-                col_val = col_data.get(resp_id, 'Sin respuesta')
-                df_list.append({'row': row_val, 'col': col_val})
+            # Pares (response_id, categoría) de cada pregunta
+            row_ids, row_labels = SurveyAnalysisService._crosstab_pairs(row_question, queryset)
+            col_ids, col_labels = SurveyAnalysisService._crosstab_pairs(col_question, queryset)
+            universe = list(queryset.values_list('id', flat=True).iterator(chunk_size=5000))
             
-            if not df_list:
+            if not universe:
                 return {'error': 'No hay datos suficientes para cruzar.'}
             
-            df = pd.DataFrame(df_list)
+            # Conteo, márgenes, orden por totales y top-10 + "Otros"
+            table = build_crosstab(universe, row_ids, row_labels, col_ids, col_labels)
             
-            # Generar tabla cruzada con pandas
-            crosstab = pd.crosstab(
-                df['row'],
-                df['col'],
-                margins=True,
-                margins_name='Total'
-            )
-            
-            # Ordenar por totales (descendente) excepto la fila Total
-            row_totals = crosstab['Total'].drop('Total')
-            sorted_rows = row_totals.sort_values(ascending=False).index.tolist()
-            sorted_rows.append('Total')  # Total al final
-            crosstab = crosstab.reindex(sorted_rows)
-            
-            # Ordenar columnas por totales (descendente) excepto Total
-            col_totals = crosstab.loc['Total'].drop('Total')
-            sorted_cols = col_totals.sort_values(ascending=False).index.tolist()
-            sorted_cols.append('Total')  # Total al final
-            crosstab = crosstab[sorted_cols]
-            
-            # Limitar a top 10 categorías para cada eje (más Total)
-            if len(crosstab.index) > 11:  # 10 + Total
-                top_rows = list(crosstab.index[:10]) + ['Total']
-                crosstab = crosstab.loc[top_rows]
-            
-            if len(crosstab.columns) > 11:
-                top_cols = list(crosstab.columns[:10]) + ['Total']
-                crosstab = crosstab[top_cols]
-            
-            # Convertir a formato 'split' para JSON serialization
             result = {
-                'data': crosstab.to_dict('split'),
+                'data': table['data'],
                 'row_label': row_question.text[:50],
                 'col_label': col_question.text[:50],
-                'total_responses': total_responses,
-                'row_categories': len(crosstab.index) - 1,  # Sin contar Total
-                'col_categories': len(crosstab.columns) - 1  # Sin contar Total
+                'total_responses': table['total_responses'],
+                'row_categories': table['row_categories'],  # Sin contar Total
+                'col_categories': table['col_categories'],  # Sin contar Total
             }
             
             # Cache por 10 minutos
@@ -1291,4 +1284,60 @@ class SurveyAnalysisService:
                     'col_id': col_id,
                 },
             )
-            return {'error': 'Error interno generando tabla cruzada.'}
\ No newline at end of file
+            return {'error': 'Error interno generando tabla cruzada.'}
+
+    @staticmethod
+    def keyword_in_context(survey, question_id, term, queryset=None, width=40, limit=20):
+        """
+        Apariciones de una palabra o frase en los comentarios de una pregunta
+        de texto, con contexto (KWIC) para el dashboard de resultados.
+
+        Usa el índice invertido en caché de la pregunta; nunca muestra
+        preguntas sensibles ni comentarios con correo/teléfono/documento.
+
+        Returns:
+            dict: {'term', 'question_id', 'total_texts', 'contexts': [{row, left, match, right}]}
+        """
+        term = (term or '').strip()
+        if not fold_text(term).strip():
+            return {'error': 'Término de búsqueda vacío.'}
+        try:
+            question = survey.questions.filter(id=question_id, type='text').first()
+            if not question:
+                return {'error': 'La pregunta no existe o no es de texto.'}
+
+            if queryset is None:
+                from surveys.models import SurveyResponse
+                queryset = SurveyResponse.objects.filter(survey=survey)
+            texts = list(
+                QuestionResponse.objects.filter(question=question, survey_response__in=queryset)
+                .exclude(text_value='')
+                .order_by('-created_at')
+                .values_list('text_value', flat=True)
+                .iterator(chunk_size=5000)
+            )
+
+            stats = pii.scan_values(texts)
+            is_sensitive, _, _ = SensitiveMetadataDetector.detect(
+                question.text,
+                is_demographic=bool(getattr(question, 'is_demographic', False)),
+                value_stats=stats,
+            )
+            if is_sensitive:
+                return {'error': 'Búsqueda no disponible para preguntas de metadatos/datos sensibles.'}
+
+            flagged = set(stats['flagged_rows'])
+            safe_texts = [t for i, t in enumerate(texts) if i not in flagged] if flagged else texts
+            index = get_text_index(question.id, safe_texts)
+            return {
+                'term': term,
+                'question_id': question.id,
+                'total_texts': len(safe_texts),
+                'contexts': index.keyword_in_context(term, width, limit),
+            }
+        except Exception:
+            logger.exception(
+                "Error interno buscando palabra en contexto",
+                extra={'survey_id': getattr(survey, 'id', None), 'question_id': question_id},
+            )
+            return {'error': 'Error interno buscando en comentarios.'}
@@ -0,0 +1,364 @@
+"""
+Cubo columnar por encuesta (core/utils/survey_cube.py) ligado a la BD.
+
+El cubo se construye una vez por versión de la encuesta (respuestas, respuestas
+por pregunta, preguntas y opciones), se guarda en SURVEY_CUBE_DIR y los procesos lo
+abren con mmap. Los tableros resuelven fechas y segmentos sobre el cubo y
+obtienen distribuciones, estadísticas y evolución sin consultas agregadas.
+
+Los segmentos guardados (AnalysisSegment) combinan condiciones por pregunta;
+cada una es un bitmap del cubo y la combinación se evalúa con AND/OR/NOT
+sobre bitmaps, sin subconsultas por respuesta.
+"""
+import logging
+import math
+import os
+import re
+import threading
+import zlib
+from collections import OrderedDict, defaultdict
+from pathlib import Path
+
+from django.conf import settings
+from django.core.exceptions import ValidationError
+from django.db.models import Count, Max, Sum
+from django.db.models.functions import TruncDate
+
+from core.utils.survey_cube import NUMERIC, SurveyCube
+from core.validators import DateFilterValidator
+from surveys.models import AnswerOption, QuestionResponse, SurveyResponse
+
+logger = logging.getLogger(__name__)
+
+CHOICE_TYPES = ('single', 'multi', 'radio', 'select')
+NUMERIC_TYPES = ('scale', 'number')
+CUBE_CACHE_SIZE = 16
+CRITERIA_KEY = re.compile(r'^question_(\d+)(?:_(min|max|not))?$')
+
+_cubes = OrderedDict()  # survey_id -> (versión, SurveyCube)
+_cubes_lock = threading.Lock()
+
+
+class CubeSelection:
+    """
+    Respuestas de un cubo tras aplicar filtros; da a get_analysis_data lo
+    que antes salía de consultas agregadas, en el mismo formato.
+    """
+
+    def __init__(self, cube, rows=None):
+        self.cube = cube
+        self.rows = rows
+
+    def count(self):
+        return self.cube.count(self.rows)
+
+    def last_response_id(self):
+        return self.cube.last_response_id(self.rows)
+
+    def has_question(self, question_id):
+        return self.cube.has_question(question_id)
+
+    def numeric_stats(self, question_ids):
+        """({qid: {count, avg, max, min}}, {qid: [{value, count}]}) como _fetch_numeric_stats."""
+        stats, dist = {}, defaultdict(list)
+        for qid in question_ids:
+            pairs = self.cube.numeric_distribution(qid, self.rows)
+            if not pairs:
+                continue
+            pairs = [(_as_number(v), n) for v, n in pairs]
+            total = sum(n for _, n in pairs)
+            stats[qid] = {
+                'count': total,
+                'avg': sum(v * n for v, n in pairs) / total,
+                'max': pairs[-1][0],
+                'min': pairs[0][0],
+            }
+            dist[qid] = [{'value': v, 'count': n} for v, n in pairs]
+        return stats, dist
+
+    def choice_stats(self, question_ids):
+        """{qid: [{option, count}]} como _fetch_choice_stats (solo etiquetas de opción)."""
+        dist = defaultdict(list)
+        for qid in question_ids:
+            for label, n in self.cube.choice_counts(qid, self.rows):
+                dist[qid].append({'option': label, 'count': n})
+        return dist
+
+    def evolution(self):
+        """{'labels': ['dd/mm'], 'data': [conteo]} como TimelineEngine.analyze_evolution."""
+        pairs = self.cube.day_counts(self.rows)
+        return {'labels': [d.strftime('%d/%m') for d, _ in pairs], 'data': [n for _, n in pairs]}
+
+
+def segment_conditions(criteria):
+    """
+    Condiciones por pregunta de AnalysisSegment.filters_criteria:
+
+        {'question_5': 'Norte' | ['Norte', 'Sur'],   # alguna de las opciones
+         'question_7_min': 30, 'question_7_max': 45,   # rango numérico
+         'question_9_not': 'No aplica'}                # ninguna de las opciones
+
+    Regresa {question_id: {'in': [...], 'not': [...], 'min': x, 'max': y}}.
+    Las preguntas distintas se combinan con AND.
+    """
+    conditions = defaultdict(dict)
+    for key, value in (criteria or {}).items():
+        match = CRITERIA_KEY.match(str(key))
+        if not match or value in (None, '', []):
+            continue
+        qid, op = int(match.group(1)), match.group(2) or 'in'
+        if op in ('min', 'max'):
+            try:
+                conditions[qid][op] = float(value)
+            except (TypeError, ValueError):
+                continue
+        else:
+            values = value if isinstance(value, (list, tuple)) else [value]
+            conditions[qid].setdefault(op, []).extend(str(v) for v in values if v not in (None, ''))
+    return dict(conditions)
+
+
+def _numbers(values):
+    out = []
+    for value in values:
+        try:
+            out.append(float(value))
+        except (TypeError, ValueError):
+            pass
+    return out
+
+
+def _condition_rows(cube, question_id, condition):
+    """Bitmap de las respuestas que cumplen la condición de una pregunta; None si el cubo no la resuelve."""
+    if not cube.has_question(question_id):
+        return None
+    numeric = cube.kind(question_id) == NUMERIC
+
+    def matching(values):
+        if numeric:
+            return cube.rows_with_numbers(question_id, _numbers(values))
+        return cube.rows_with_labels(question_id, values)
+
+    rows = None
+    if 'in' in condition:
+        rows = matching(condition['in'])
+    if 'min' in condition or 'max' in condition:
+        if not numeric:
+            return None
+        in_range = cube.rows_with_values(question_id, condition.get('min', -math.inf), condition.get('max', math.inf))
+        rows = in_range if rows is None else rows & in_range
+    if 'not' in condition:
+        rows = (cube.all_rows() if rows is None else rows) - matching(condition['not'])
+    return rows
+
+
+def _as_number(value):
+    # numeric_value es entero en la BD: se conserva el tipo en los resultados
+    return int(value) if float(value).is_integer() else value
+
+
+class SurveyCubeService:
+
+    @staticmethod
+    def cube_dir():
+        return Path(getattr(settings, 'SURVEY_CUBE_DIR', Path(settings.BASE_DIR) / 'cache' / 'survey_cubes'))
+
+    @staticmethod
+    def _cube_questions(survey):
+        """Preguntas que entran al cubo: opciones, escalas/números y textos demográficos."""
+        return [
+            q for q in survey.questions.all()
+            if q.type in CHOICE_TYPES or q.type in NUMERIC_TYPES
+            or (q.type == 'text' and getattr(q, 'is_demographic', False))
+        ]
+
+    @staticmethod
+    def _version(survey, questions):
+        """
+        Versión del cubo: respuestas, respuestas por pregunta (la suma de
+        opciones elegidas cambia al reasignar o soltar una opción) y una
+        suma de control de preguntas y de los ids y textos de sus opciones
+        (editar un borrador las borra y recrea sin tocar las respuestas).
+        Otras ediciones en sitio las descarta surveys.signals.
+        """
+        agg = SurveyResponse.objects.filter(survey=survey).aggregate(total=Count('id'), last_id=Max('id'))
+        answers = QuestionResponse.objects.filter(survey_response__survey=survey).aggregate(
+            total=Count('id'), last_id=Max('id'), options=Sum('selected_option_id'),
+        )
+        shape = ','.join(f"{q.id}:{q.type}:{int(bool(q.is_demographic))}" for q in sorted(questions, key=lambda q: q.id))
+        options = AnswerOption.objects.filter(
+            question_id__in=[q.id for q in questions if q.type in CHOICE_TYPES],
+        ).order_by('id').values_list('id', 'text')
+        checksum = zlib.crc32(shape.encode())
+        for option_id, text in options.iterator(chunk_size=5000):
+            checksum = zlib.crc32(f"|{option_id}:{text}".encode(), checksum)
+        counts = [agg['total'], agg['last_id'], answers['total'], answers['last_id'], answers['options']]
+        return '_'.join(str(int(value or 0)) for value in counts) + f"_{checksum:08x}"
+
+    @staticmethod
+    def build_cube(survey, questions=None):
+        """Cubo de la encuesta desde la BD (tres consultas, recorridas por chunks)."""
+        questions = SurveyCubeService._cube_questions(survey) if questions is None else questions
+        numeric_ids = [q.id for q in questions if q.type in NUMERIC_TYPES]
+        choice_ids = [q.id for q in questions if q.type not in NUMERIC_TYPES]
+
+        response_ids, days = [], []
+        responses = (
+            SurveyResponse.objects.filter(survey=survey)
+            .annotate(day=TruncDate('created_at'))
+            .values_list('id', 'day')
+            .order_by()
+        )
+        for response_id, day in responses.iterator(chunk_size=5000):
+            response_ids.append(response_id)
+            days.append(day)
+
+        choice_columns = {qid: ([], [], []) for qid in choice_ids}
+        if choice_ids:
+            rows = QuestionResponse.objects.filter(
+                question_id__in=choice_ids, survey_response__survey=survey,
+            ).values_list('question_id', 'survey_response_id', 'selected_option__text', 'text_value').order_by()
+            for qid, response_id, option_text, text_value in rows.iterator(chunk_size=5000):
+                ids, labels, from_option = choice_columns[qid]
+                ids.append(response_id)
+                labels.append(option_text or text_value or '')
+                from_option.append(bool(option_text))
+
+        numeric_columns = {qid: ([], []) for qid in numeric_ids}
+        if numeric_ids:
+            rows = QuestionResponse.objects.filter(
+                question_id__in=numeric_ids, survey_response__survey=survey, numeric_value__isnull=False,
+            ).values_list('question_id', 'survey_response_id', 'numeric_value').order_by()
+            for qid, response_id, value in rows.iterator(chunk_size=5000):
+                ids, values = numeric_columns[qid]
+                ids.append(response_id)
+                values.append(value)
+
+        return SurveyCube.build(response_ids, days, choice_columns, numeric_columns)
+
+    @staticmethod
+    def get_cube(survey):
+        """
+        Cubo vigente de la encuesta: de la caché del proceso, del archivo
+        (mmap) o construido y guardado. None si no se pudo construir.
+        """
+        questions = SurveyCubeService._cube_questions(survey)
+        version = SurveyCubeService._version(survey, questions)
+        with _cubes_lock:
+            cached = _cubes.get(survey.id)
+            if cached and cached[0] == version:
+                _cubes.move_to_end(survey.id)
+                return cached[1]
+
+        try:
+            cube = SurveyCubeService._load_or_build(survey, questions, version)
+        except Exception:
+            logger.exception("No se pudo construir el cubo de la encuesta %s", survey.id)
+            return None
+
+        with _cubes_lock:
+            _cubes[survey.id] = (version, cube)
+            _cubes.move_to_end(survey.id)
+            while len(_cubes) > CUBE_CACHE_SIZE:
+                _cubes.popitem(last=False)
+        return cube
+
+    @staticmethod
+    def _load_or_build(survey, questions, version):
+        directory = SurveyCubeService.cube_dir()
+        path = directory / f"survey_{survey.id}_{version}.cube"
+        if path.exists():
+            try:
+                cube = SurveyCube.open(path)
+                if cube is not None:
+                    return cube
+            except (OSError, RuntimeError):
+                logger.warning("Cubo ilegible, se reconstruye: %s", path, exc_info=True)
+
+        cube = SurveyCubeService.build_cube(survey, questions)
+        try:
+            directory.mkdir(parents=True, exist_ok=True)
+            tmp = path.with_suffix(f".{os.getpid()}.tmp")
+            if cube.save(tmp):
+                os.replace(tmp, path)
+                SurveyCubeService.discard(survey.id, keep=path)
+                # El archivo se abre proyectado para compartir páginas entre procesos
+                return SurveyCube.open(path)
+        except OSError:
+            logger.warning("No se pudo guardar el cubo de la encuesta %s", survey.id, exc_info=True)
+        return cube
+
+    @staticmethod
+    def discard(survey_id, keep=None):
+        """Borra los archivos de cubo de la encuesta (salvo `keep`) y su entrada en caché."""
+        if keep is None:
+            with _cubes_lock:
+                _cubes.pop(survey_id, None)
+        directory = SurveyCubeService.cube_dir()
+        if not directory.exists():
+            return
+        for stale in directory.glob(f"survey_{survey_id}_*.cube"):
+            if keep is not None and stale == keep:
+                continue
+            try:
+                stale.unlink()
+            except OSError:
+                pass
+
+    @staticmethod
+    def select(survey, start=None, end=None, segment_col=None, segment_val=None, segment_demo=None,
+               criteria=None):
+        """
+        Las respuestas que dejan DateFilterHelper.apply_filters,
+        _apply_segment_filter y _apply_segment_criteria (condiciones de un
+        AnalysisSegment), resueltas sobre el cubo. None si no hay cubo o un
+        filtro usa una pregunta que el cubo no tiene (se usa la BD).
+        """
+        cube = SurveyCubeService.get_cube(survey)
+        if cube is None:
+            return None
+
+        rows = None
+        if start or end:
+            try:
+                first = DateFilterValidator.validate_date_string(start, 'start_date') if start else None
+                last = DateFilterValidator.validate_date_string(end, 'end_date') if end else None
+            except ValidationError:
+                return None
+            rows = cube.rows_between(first, last)
+
+        if segment_col:
+            try:
+                question = next((q for q in survey.questions.all() if q.id == int(segment_col)), None)
+            except (TypeError, ValueError):
+                question = None
+            segment = None
+            if question is not None and (segment_demo or segment_val):
+                if not cube.has_question(question.id):
+                    return None
+                if segment_demo:
+                    segment = cube.rows_containing(question.id, segment_demo)
+                elif question.type == 'scale':
+                    try:
+                        value = float(segment_val)
+                        segment = cube.rows_with_values(question.id, value, value)
+                    except ValueError:
+                        pass
+                elif cube.kind(question.id) == NUMERIC:
+                    # El filtro por texto de una pregunta numérica se deja a la BD
+                    return None
+                else:
+                    segment = cube.rows_containing(question.id, segment_val)
+            if segment is not None:
+                rows = segment if rows is None else rows & segment
+
+        question_ids = {q.id for q in survey.questions.all()}
+        for question_id, condition in segment_conditions(criteria).items():
+            if question_id not in question_ids:
+                continue
+            matched = _condition_rows(cube, question_id, condition)
+            if matched is None:
+                return None
+            rows = matched if rows is None else rows & matched
+
+        return CubeSelection(cube, rows)
@@ -0,0 +1,92 @@
+"""
+Exportación CSV de respuestas por lotes (core/utils/csv_export.py).
+
+Cada lote es una página por (created_at, id) de SurveyResponse más una
+consulta plana de sus QuestionResponse; no se instancian modelos ni se
+arma la tabla completa en memoria, así que la vista puede transmitir el
+archivo con StreamingHttpResponse.
+"""
+import math
+
+from django.db.models import Q
+
+from core.utils.csv_export import NO_CODE, build_table_encoder
+from surveys.models import AnswerOption, QuestionResponse, SurveyResponse
+
+LEADING_COLUMNS = ['ID', 'Fecha', 'Usuario']
+EXPORT_BATCH_SIZE = 2000
+
+
+class SurveyCsvExporter:
+    """
+    Tabla de exportación de una encuesta: una fila por respuesta (ordenadas
+    por fecha) y una columna por pregunta. Las opciones se codifican contra
+    el diccionario de su pregunta; varias respuestas a la misma pregunta se
+    unen con ", ".
+    """
+
+    def __init__(self, survey, batch_size=EXPORT_BATCH_SIZE):
+        self.survey = survey
+        self.batch_size = batch_size
+        questions = list(survey.questions.all().order_by('order'))
+        self._column_of = {q.id: len(LEADING_COLUMNS) + i for i, q in enumerate(questions)}
+
+        self._option_code = {}
+        dictionaries = {}
+        options = AnswerOption.objects.filter(question__survey=survey).values_list('id', 'question_id', 'text').order_by('id')
+        for option_id, question_id, label in options:
+            column = self._column_of.get(question_id)
+            if column is None:
+                continue
+            labels = dictionaries.setdefault(column, [])
+            self._option_code[option_id] = len(labels)
+            labels.append(label or '')
+
+        self._encoder = build_table_encoder(LEADING_COLUMNS + [q.text for q in questions], dictionaries)
+
+    def header(self):
+        # BOM para que Excel abra el archivo como UTF-8
+        return '\ufeff'.encode('utf-8') + self._encoder.header()
+
+    def encode_batch(self, after=None):
+        """
+        Siguiente lote: ([bytes], cursor). `after` es el cursor del lote
+        anterior (None = desde el inicio); el cursor es None al terminar.
+        """
+        responses = SurveyResponse.objects.filter(survey=self.survey)
+        if after is not None:
+            created_at, response_id = after
+            responses = responses.filter(Q(created_at__gt=created_at) | Q(created_at=created_at, id__gt=response_id))
+        page = list(
+            responses.order_by('created_at', 'id')
+            .values_list('id', 'created_at', 'user__username')[:self.batch_size]
+        )
+        if not page:
+            return [], None
+
+        row_of = {response_id: row for row, (response_id, _, _) in enumerate(page)}
+        leading = [
+            [str(response_id) for response_id, _, _ in page],
+            [str(created_at) for _, created_at, _ in page],
+            [username or 'Anon' for _, _, username in page],
+        ]
+
+        cell_rows, cell_columns, texts, numbers, codes = [], [], [], [], []
+        answers = (
+            QuestionResponse.objects.filter(survey_response_id__in=row_of)
+            .values_list('survey_response_id', 'question_id', 'text_value', 'numeric_value', 'selected_option_id')
+            .order_by('id')
+        )
+        for response_id, question_id, text_value, numeric_value, option_id in answers:
+            column = self._column_of.get(question_id)
+            if column is None:
+                continue
+            cell_rows.append(row_of[response_id])
+            cell_columns.append(column)
+            texts.append(text_value or '')
+            numbers.append(math.nan if numeric_value is None else float(numeric_value))
+            codes.append(self._option_code.get(option_id, NO_CODE))
+
+        chunks = self._encoder.encode(len(page), leading, cell_rows, cell_columns, texts, numbers, codes)
+        cursor = (page[-1][1], page[-1][0]) if len(page) == self.batch_size else None
+        return chunks, cursor
@@ -285,9 +285,7 @@ class ChartGenerator:
 
     @classmethod
     def generate_heatmap(cls, df, dark_mode=False):
-        # ... (Mantener código original, asegúrate de importar sns y plt arriba) ...
-        # Por brevedad asumo que este código no cambia mucho, 
-        # pero asegúrate de que fig_width no sea excesivo.
+        """Mapa de calor desde un DataFrame de respuestas (una columna por pregunta)."""
         if df is None or df.empty:
             return None
         try:
@@ -300,15 +298,26 @@ class ChartGenerator:
                 return None
             if df_numeric.shape[1] > 20:
                 df_numeric = df_numeric.iloc[:, :20]
-            corr_matrix = (
-                df_numeric.corr()
-                .dropna(how='all', axis=0)
-                .dropna(how='all', axis=1)
-            )
-            if corr_matrix.empty:
-                return None
+            corr_matrix = df_numeric.corr()
         except Exception:
             return None
+        return cls.generate_correlation_heatmap(corr_matrix, dark_mode=dark_mode)
+
+    @classmethod
+    def generate_correlation_heatmap(cls, corr_matrix, dark_mode=False):
+        """
+        Mapa de calor desde una matriz de correlación ya calculada (p. ej. la
+        de core.utils.correlation, sin pasar por un DataFrame de respuestas).
+        """
+        if corr_matrix is None or corr_matrix.empty:
+            return None
+        corr_matrix = (
+            corr_matrix
+            .dropna(how='all', axis=0)
+            .dropna(how='all', axis=1)
+        )
+        if corr_matrix.empty:
+            return None
 
         n_cols = corr_matrix.shape[1]
         # Ajustamos tamaños para que no sean gigantes
@@ -0,0 +1,46 @@
+"""
+Matriz de correlación entre preguntas numéricas para el mapa de calor.
+
+Trabaja sobre tripletas (response_id, question_id, valor) que salen directo
+de la BD. Usa el kernel nativo de cpp_csv cuando está compilado; si no,
+pivot + DataFrame.corr de pandas. Ambos usan observaciones pairwise-complete.
+"""
+import pandas as pd
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+MAX_HEATMAP_COLUMNS = 20
+
+
+def correlation_matrix(response_ids, question_ids, values, columns=None,
+                       method='pearson', max_columns=MAX_HEATMAP_COLUMNS):
+    """
+    Correlaciones entre preguntas (pearson o spearman).
+
+    Args:
+        columns: question_id a incluir, en orden (None = todos, ascendente)
+        max_columns: Tope de columnas (las que muestra el mapa de calor)
+
+    Returns:
+        DataFrame cuadrado indexado por question_id; NaN donde no hay datos
+        suficientes (menos de 2 pares o varianza nula).
+    """
+    if cpp_csv is not None:
+        result = cpp_csv.correlation_matrix(
+            response_ids, question_ids, values, columns, method, max_columns,
+        )
+        return pd.DataFrame(
+            result['matrix'], index=result['columns'], columns=result['columns'], dtype=float,
+        )
+
+    df = pd.DataFrame({'response_id': response_ids, 'question_id': question_ids, 'value': values})
+    if df.empty:
+        return pd.DataFrame()
+    wide = df.pivot_table(index='response_id', columns='question_id', values='value', aggfunc='last')
+    selected = list(columns) if columns else sorted(wide.columns)
+    selected = [c for c in selected if c in wide.columns][:max_columns]
+    return wide[selected].astype(float).corr(method=method)
@@ -0,0 +1,82 @@
+"""
+Tablas cruzadas de dos preguntas a partir de pares (response_id, categoría).
+
+Usa el kernel nativo de cpp_csv cuando está compilado; si no, un conteo
+equivalente en Python. Ninguno de los dos caminos necesita pandas.
+"""
+from collections import Counter
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+TOP_K = 10
+MISSING_LABEL = 'Sin respuesta'
+OTHER_LABEL = 'Otros'
+TOTAL_LABEL = 'Total'
+
+
+def build_crosstab(universe, row_ids, row_labels, col_ids, col_labels, top_k=TOP_K):
+    """
+    Cruza dos preguntas por response_id.
+
+    Las categorías se ordenan por total descendente (empate por nombre); si
+    hay más de `top_k`, el resto se agrupa en "Otros". Las respuestas sin
+    valor en una pregunta cuentan como "Sin respuesta" y, si un response_id
+    tiene varias categorías, gana la última.
+
+    Returns:
+        {'data': {'index', 'columns', 'data'} (formato 'split', con márgenes
+         Total al final), 'total_responses', 'row_categories', 'col_categories'}
+    """
+    if cpp_csv is not None:
+        return cpp_csv.build_crosstab(
+            universe, row_ids, row_labels, col_ids, col_labels, top_k,
+            MISSING_LABEL, OTHER_LABEL, TOTAL_LABEL,
+        )
+
+    row_map = dict(zip(row_ids, row_labels))
+    col_map = dict(zip(col_ids, col_labels))
+    pairs = Counter()
+    for resp_id in universe:
+        pairs[(row_map.get(resp_id, MISSING_LABEL), col_map.get(resp_id, MISSING_LABEL))] += 1
+
+    row_totals = Counter()
+    col_totals = Counter()
+    for (row, col), count in pairs.items():
+        row_totals[row] += count
+        col_totals[col] += count
+
+    row_slots, rows = _layout(row_totals, top_k)
+    col_slots, cols = _layout(col_totals, top_k)
+
+    width = len(cols) + 1
+    matrix = [[0] * width for _ in range(len(rows) + 1)]
+    for (row, col), count in pairs.items():
+        r, c = row_slots[row], col_slots[col]
+        matrix[r][c] += count
+        matrix[r][-1] += count
+        matrix[-1][c] += count
+    matrix[-1][-1] = sum(pairs.values())
+
+    return {
+        'data': {
+            'index': rows + [TOTAL_LABEL],
+            'columns': cols + [TOTAL_LABEL],
+            'data': matrix,
+        },
+        'total_responses': matrix[-1][-1],
+        'row_categories': len(rows),
+        'col_categories': len(cols),
+    }
+
+
+def _layout(totals, top_k):
+    """Orden de un eje y posición de cada categoría (las recortadas van a "Otros")."""
+    order = sorted(totals, key=lambda label: (-totals[label], label))
+    if len(order) <= top_k:
+        return {label: i for i, label in enumerate(order)}, order
+    slots = {label: min(i, top_k) for i, label in enumerate(order)}
+    return slots, order[:top_k] + [OTHER_LABEL]
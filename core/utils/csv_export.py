@@ -0,0 +1,102 @@
+"""
+Codificación CSV por lotes para exportar tablas de respuestas.
+
+El codificador recibe una tabla por lotes: columnas fijas (id, fecha,
+usuario) y celdas sueltas (fila, columna, texto, número, código de opción)
+tal como salen de la BD, y regresa bloques de bytes listos para un
+StreamingHttpResponse. La memoria depende del lote, no de la encuesta.
+
+Usa el codificador nativo de cpp_csv cuando está compilado y, si no,
+csv.writer con las mismas reglas (RFC 4180, QUOTE_MINIMAL, \\r\\n).
+"""
+import csv
+import io
+import math
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+DEFAULT_CHUNK_SIZE = 64 * 1024
+NO_CODE = -1
+
+
+def format_number(value):
+    """Como el codificador nativo: '3' para 3.0, '2.5' para 2.5."""
+    if float(value).is_integer() and abs(value) < 1e15:
+        return str(int(value))
+    return format(value, '.15g')
+
+
+def build_table_encoder(header, dictionaries=None, delimiter=',', multi_separator=', ',
+                        chunk_size=DEFAULT_CHUNK_SIZE):
+    """
+    Args:
+        header: Nombres de columna
+        dictionaries: {índice de columna: [etiquetas]} para las celdas con código
+        multi_separator: Unión de varias respuestas en la misma celda
+
+    El codificador tiene header() -> bytes y
+    encode(rows, leading, cell_rows, cell_columns, texts, numbers, codes) -> [bytes]:
+    por celda se usa el texto, si no el número (NaN = sin número), si no la
+    etiqueta del código (NO_CODE = sin código).
+    """
+    if cpp_csv is not None:
+        return cpp_csv.build_csv_encoder(header, dictionaries, delimiter, multi_separator, chunk_size)
+    return _PyTableEncoder(header, dictionaries, delimiter, multi_separator, chunk_size)
+
+
+class _PyTableEncoder:
+
+    def __init__(self, header, dictionaries, delimiter, multi_separator, chunk_size):
+        self._header = [str(h) for h in header]
+        self._dictionaries = {int(c): [str(label) for label in labels] for c, labels in (dictionaries or {}).items()}
+        self._delimiter = delimiter
+        self._multi_separator = multi_separator
+        self._chunk_size = max(int(chunk_size), 1)
+
+    @property
+    def columns(self):
+        return len(self._header)
+
+    def header(self):
+        buffer = io.StringIO()
+        csv.writer(buffer, delimiter=self._delimiter).writerow(self._header)
+        return buffer.getvalue().encode('utf-8')
+
+    def _value(self, column, text, number, code):
+        if text:
+            return text
+        if number is not None and not math.isnan(number):
+            return format_number(number)
+        labels = self._dictionaries.get(column, ())
+        return labels[code] if 0 <= code < len(labels) else ''
+
+    def encode(self, rows, leading, cell_rows, cell_columns, texts, numbers, codes):
+        cells = {}
+        for row, column, text, number, code in zip(cell_rows, cell_columns, texts, numbers, codes):
+            if not (0 <= row < rows and len(leading) <= column < len(self._header)):
+                raise IndexError("Celda fuera de la tabla")
+            value = self._value(column, text, number, code)
+            if value:
+                cells.setdefault((row, column), []).append(value)
+
+        chunks = []
+        buffer = io.StringIO()
+        writer = csv.writer(buffer, delimiter=self._delimiter)
+        for row in range(rows):
+            line = [column[row] or '' for column in leading]
+            line.extend(
+                self._multi_separator.join(cells.get((row, column), ()))
+                for column in range(len(leading), len(self._header))
+            )
+            writer.writerow(line)
+            if buffer.tell() >= self._chunk_size:
+                chunks.append(buffer.getvalue().encode('utf-8'))
+                buffer.seek(0)
+                buffer.truncate()
+        if buffer.tell():
+            chunks.append(buffer.getvalue().encode('utf-8'))
+        return chunks
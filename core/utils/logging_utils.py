@@ -114,6 +114,49 @@ def log_data_change(model_name: str, operation: str, instance_id: Any, user_id:
     logger.info(log_message)
 
 
+# Fases que reporta cpp_csv en `stats` ('<fase>_ns'), en orden del pipeline
+CPP_CSV_PHASES = ('io', 'tokenize', 'filter', 'validate', 'aggregate', 'convert', 'wait')
+
+
+def log_cpp_csv_stats(stage: str, stats: dict, tag: str = 'IMPORT', logger: logging.Logger = None):
+    """
+    Emite los contadores por fase de una llamada de cpp_csv (el dict `stats`
+    de sus lectores o de pybind_csv.collect_stats) en el formato de los logs
+    de importación, como pares key=value para poder graficarlos:
+
+        [IMPORT][STATS][READ] rows=120000 bytes=48213312 parse_mb_s=310.5 io_ms=20.1 ...
+
+    `parse_mb_s` es el throughput del parseo (bytes / io + tokenize + filter).
+    Sin contadores (stats vacío o sin 'total_ns') no emite nada.
+    """
+    if not stats or 'total_ns' not in stats:
+        return
+    bytes_read = stats.get('bytes_read', 0)
+    parse_ns = sum(stats.get(f'{phase}_ns', 0) for phase in ('io', 'tokenize', 'filter'))
+    parse_mb_s = (bytes_read / (1024 * 1024)) / (parse_ns / 1e9) if parse_ns else 0.0
+
+    parts = [
+        f"rows={stats.get('rows', 0)}",
+        f"bytes={bytes_read}",
+        f"parse_mb_s={parse_mb_s:.1f}",
+    ]
+    parts += [
+        f"{phase}_ms={stats[f'{phase}_ns'] / 1e6:.1f}"
+        for phase in CPP_CSV_PHASES if stats.get(f'{phase}_ns')
+    ]
+    parts += [
+        f"gil_ms={stats.get('gil_ns', 0) / 1e6:.1f}",
+        f"total_ms={stats['total_ns'] / 1e6:.1f}",
+        f"cells={stats.get('cells', 0)}",
+        f"filtered={stats.get('filtered_rows', 0)}",
+        f"allocations={stats.get('allocations', 0)}",
+        f"errors={stats.get('errors', 0)}",
+    ]
+    if stats.get('peak_bytes'):
+        parts.append(f"peak_mb={stats['peak_bytes'] / (1024 * 1024):.1f}")
+    (logger or performance_logger).info(f"[{tag}][STATS][{stage}] {' '.join(parts)}")
+
+
 class StructuredLogger:
     async def debug_async(self, message: str, *args, **context):
         await sync_to_async(self.debug)(message, *args, **context)
@@ -1,6 +1,7 @@
 """
 Monitoreo de recursos optimizado para 4GB RAM
 """
+import contextvars
 import psutil
 import logging
 from functools import wraps
@@ -11,6 +12,10 @@ logger = logging.getLogger(__name__)
 MEMORY_WARNING_THRESHOLD = 3200  # Advertencia al 80% de 4GB
 MEMORY_CRITICAL_THRESHOLD = 3600  # Crítico al 90% de 4GB
 
+# (max_memory_mb, memoria al entrar) del memory_guard activo, para que el
+# código nativo pueda respetar el mismo límite (ver native_memory_budget)
+_active_guard = contextvars.ContextVar('memory_guard', default=None)
+
 
 def get_memory_usage():
     """Obtiene el uso de memoria del proceso actual"""
@@ -49,10 +54,13 @@ def memory_guard(max_memory_mb=None):
             if status == 'critical':
                 raise MemoryError(f"Memoria crítica alcanzada: {mem_before:.1f}MB")
             
+            token = _active_guard.set((max_memory_mb, mem_before)) if max_memory_mb else None
             try:
                 result = func(*args, **kwargs)
                 return result
             finally:
+                if token is not None:
+                    _active_guard.reset(token)
                 # Memoria final
                 mem_after = get_memory_usage()
                 mem_delta = mem_after - mem_before
@@ -66,6 +74,37 @@ def memory_guard(max_memory_mb=None):
     return decorator
 
 
+def native_memory_budget():
+    """
+    Bytes que le quedan al memory_guard activo, para pasarlos como
+    `memory_limit` a cpp_csv: el límite del guard menos lo que el proceso ya
+    creció desde que entró. 0 (sin límite) si no hay guard con límite.
+
+    El guard solo muestrea el RSS al entrar y salir; con esto la lectura
+    nativa se achica o lanza MemoryError antes de pasarse.
+    """
+    guard = _active_guard.get()
+    if guard is None:
+        return 0
+    max_memory_mb, mem_before = guard
+    remaining_mb = max_memory_mb - max(get_memory_usage() - mem_before, 0)
+    # Sin margen se pide 1 byte: cualquier reserva nativa lanza MemoryError
+    return max(int(remaining_mb * 1024 * 1024), 1)
+
+
+def log_native_memory(label, stats):
+    """Log de la memoria medida por cpp_csv (el dict `stats` de sus lectores)"""
+    if not stats:
+        return
+    mb = 1024 * 1024
+    limit = stats.get('memory_limit', 0)
+    logger.info(
+        f"[MEMORY][{label}] cpp_csv pico: {stats.get('peak_bytes', 0) / mb:.1f}MB "
+        f"(arena {stats.get('arena_bytes', 0) / mb:.1f}MB, objetos {stats.get('python_bytes', 0) / mb:.1f}MB) "
+        f"| Límite: {f'{limit / mb:.1f}MB' if limit else 'sin límite'}"
+    )
+
+
 def force_garbage_collection():
     """Fuerza recolección de basura y retorna memoria liberada"""
     import gc
@@ -0,0 +1,115 @@
+"""
+Net Promoter Score global y por segmento desde distribuciones (valor, conteo).
+
+Promotores >= 9, pasivos 7-8, detractores <= 6 (los valores intermedios solo
+cuentan en el total). Cada grupo trae su intervalo de confianza analítico
+(Wald sobre la media de +1/0/-1). Usa el kernel nativo de cpp_csv cuando está
+compilado; si no, un cálculo equivalente en Python.
+"""
+import math
+from statistics import NormalDist
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+PROMOTER_MIN = 9
+PASSIVE_RANGE = (7, 8)
+DETRACTOR_MAX = 6
+CONFIDENCE = 0.95
+
+
+def nps_breakdown(values, counts=None, segments=None, num_segments=0, confidence=CONFIDENCE):
+    """
+    NPS de una pregunta, global y por segmento, en una pasada.
+
+    Args:
+        values: Valores de la escala (distintos o crudos); None y NaN se ignoran
+        counts: Conteo de cada valor (None = 1 por valor)
+        segments: Código de segmento de cada valor (None = sin segmentos);
+            los negativos solo cuentan en el global
+        num_segments: Segmentos a reportar (0 = código mayor + 1); se
+            reportan aunque ningún valor caiga en ellos
+        confidence: Confianza del intervalo
+
+    Returns:
+        {'overall': grupo, 'segments': [grupo, ...]}; cada grupo es
+        {'total', 'promoters', 'passives', 'detractors', 'score', 'margin',
+         'ci_low', 'ci_high'} con score en [-100, 100]. Sin respuestas,
+        score, margin e intervalo son None.
+    """
+    values = list(values)
+    counts = [1] * len(values) if counts is None else list(counts)
+    codes = [-1] * len(values) if segments is None else list(segments)
+    if not (len(values) == len(counts) == len(codes)):
+        raise ValueError("values, counts y segments deben tener la misma longitud")
+
+    rows = [
+        (float(v), int(c), int(s)) for v, c, s in zip(values, counts, codes)
+        if v is not None and c and c > 0 and not math.isnan(float(v))
+    ]
+    if cpp_csv is not None:
+        return cpp_csv.nps_breakdown(
+            [v for v, _, _ in rows],
+            [c for _, c, _ in rows],
+            [s for _, _, s in rows] if segments is not None else None,
+            num_segments,
+            confidence,
+        )
+    return _breakdown_python(rows, segments is not None, num_segments, confidence)
+
+
+def _z_score(confidence):
+    if not 0 < confidence < 1:
+        return 0.0
+    return NormalDist().inv_cdf(1 - (1 - confidence) / 2)
+
+
+def _empty_group():
+    return {'total': 0, 'promoters': 0, 'passives': 0, 'detractors': 0}
+
+
+def _finish(group, z):
+    n = group['total']
+    if not n:
+        group.update(score=None, margin=None, ci_low=None, ci_high=None)
+        return group
+    p = group['promoters'] / n
+    d = group['detractors'] / n
+    score = (p - d) * 100
+    margin = z * math.sqrt(max(0.0, (p + d) - (p - d) ** 2) / n) * 100
+    group.update(
+        score=score,
+        margin=margin,
+        ci_low=max(-100.0, score - margin),
+        ci_high=min(100.0, score + margin),
+    )
+    return group
+
+
+def _breakdown_python(rows, segmented, num_segments, confidence):
+    if segmented and not num_segments:
+        num_segments = max((s + 1 for _, _, s in rows if s >= 0), default=0)
+    overall = _empty_group()
+    groups = [_empty_group() for _ in range(num_segments if segmented or num_segments else 0)]
+
+    for value, count, code in rows:
+        targets = [overall]
+        if 0 <= code < len(groups):
+            targets.append(groups[code])
+        for group in targets:
+            group['total'] += count
+            if value >= PROMOTER_MIN:
+                group['promoters'] += count
+            elif value <= DETRACTOR_MAX:
+                group['detractors'] += count
+            elif PASSIVE_RANGE[0] <= value <= PASSIVE_RANGE[1]:
+                group['passives'] += count
+
+    z = _z_score(confidence)
+    return {
+        'overall': _finish(overall, z),
+        'segments': [_finish(group, z) for group in groups],
+    }
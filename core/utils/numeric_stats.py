@@ -0,0 +1,130 @@
+"""
+Estadísticas de preguntas numéricas sobre distribuciones (valor, conteo).
+
+Usa el motor nativo de cpp_csv cuando está compilado; si no, un cálculo
+equivalente en Python. En ambos casos el costo es O(valores distintos):
+nunca se expande una lista con una entrada por respuesta.
+"""
+import math
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+HISTOGRAM_BINS = 10
+
+
+def summarize_distribution(values, counts=None, quantiles=(), bins=HISTOGRAM_BINS):
+    """
+    Resumen de una distribución numérica.
+
+    Args:
+        values: Valores distintos (o crudos); None y NaN se ignoran
+        counts: Conteo de cada valor (None = 1 por valor)
+        quantiles: Cuantiles extra, p. ej. (0.25, 0.75)
+        bins: Rangos del histograma (los de las gráficas numéricas)
+
+    Returns:
+        dict con count, sum, mean, variance (muestral), stddev, min, max,
+        median, quantiles {q: valor} e histogram [(inicio, fin, conteo)].
+        Sin observaciones, las estadísticas son None.
+    """
+    values = list(values)
+    counts = [1] * len(values) if counts is None else list(counts)
+    if len(values) != len(counts):
+        raise ValueError("values y counts deben tener la misma longitud")
+
+    pairs = [
+        (float(v), int(c)) for v, c in zip(values, counts)
+        if v is not None and c and c > 0 and not math.isnan(float(v))
+    ]
+    if cpp_csv is not None:
+        return cpp_csv.numeric_stats(
+            [v for v, _ in pairs], [c for _, c in pairs], quantiles, bins,
+        )
+    return _summarize_python(pairs, quantiles, bins)
+
+
+def _summarize_python(pairs, quantiles, bins):
+    merged = {}
+    for value, count in pairs:
+        merged[value] = merged.get(value, 0) + count
+    dist = sorted(merged.items())
+    total = sum(c for _, c in dist)
+
+    if not total:
+        result = dict.fromkeys(('sum', 'mean', 'variance', 'stddev', 'min', 'max', 'median'))
+        result.update(count=0, quantiles={}, histogram=[])
+        return result
+
+    total_sum = math.fsum(v * c for v, c in dist)
+    mean = total_sum / total
+    variance = (
+        math.fsum((v - mean) ** 2 * c for v, c in dist) / (total - 1)
+        if total > 1 else 0.0
+    )
+
+    # Acumulado para ubicar la observación k sin expandir
+    cumulative = []
+    running = 0
+    for _, c in dist:
+        running += c
+        cumulative.append(running)
+
+    def value_at(k):
+        lo, hi = 0, len(cumulative) - 1
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if cumulative[mid] > k:
+                hi = mid
+            else:
+                lo = mid + 1
+        return dist[lo][0]
+
+    def quantile(q):
+        if not 0.0 <= q <= 1.0:
+            raise ValueError("el cuantil debe estar entre 0 y 1")
+        h = (total - 1) * q
+        lo = math.floor(h)
+        lo_value = value_at(lo)
+        if lo + 1 >= total or h == lo:
+            return lo_value
+        return lo_value + (h - lo) * (value_at(lo + 1) - lo_value)
+
+    return {
+        'count': total,
+        'sum': total_sum,
+        'mean': mean,
+        'variance': variance,
+        'stddev': math.sqrt(variance),
+        'min': dist[0][0],
+        'max': dist[-1][0],
+        'median': quantile(0.5),
+        'quantiles': {q: quantile(q) for q in quantiles},
+        'histogram': _histogram_python(dist, bins),
+    }
+
+
+def _histogram_python(dist, num_bins):
+    if not num_bins:
+        return []
+    min_val, max_val = dist[0][0], dist[-1][0]
+    interval = (max_val - min_val) / num_bins
+    if interval < 1:
+        interval = 1
+    ranges = []
+    curr = min_val
+    for _ in range(num_bins):
+        end = curr + interval
+        ranges.append((curr, end))
+        curr = end
+
+    bins_count = [0] * num_bins
+    for value, count in dist:
+        for i, (start, end) in enumerate(ranges):
+            if start <= value < end or (i == num_bins - 1 and start <= value <= end + 0.1):
+                bins_count[i] += count
+                break
+    return [(start, end, count) for (start, end), count in zip(ranges, bins_count)]
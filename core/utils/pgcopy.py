@@ -0,0 +1,122 @@
+"""
+COPY binario de PostgreSQL (FORMAT BINARY) para inserciones masivas.
+
+En formato binario el servidor recibe enteros de ancho fijo en orden de
+red y textos con prefijo de longitud (-1 = NULL): no vuelve a parsear
+números ni a desescapar texto, así que el COPY cuesta menos CPU que en CSV.
+Los anchos deben coincidir exactamente con los de la tabla (int4 != int8),
+por eso se derivan de los campos del modelo.
+
+Usa el codificador nativo de cpp_csv cuando está compilado y, si no,
+struct con el mismo resultado.
+"""
+import io
+import struct
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+COPY_SIGNATURE = b'PGCOPY\n\xff\r\n\x00'
+COPY_HEADER = COPY_SIGNATURE + struct.pack('>ii', 0, 0)
+COPY_TRAILER = struct.pack('>h', -1)
+
+# db_type de Django (PostgreSQL) -> tipo del codificador
+DB_COPY_TYPES = {
+    'smallint': 'int2',
+    'integer': 'int4',
+    'bigint': 'int8',
+    'text': 'text',
+    'varchar': 'text',
+}
+
+_INT_FORMATS = {'int2': ('>ih', 2), 'int4': ('>ii', 4), 'int8': ('>iq', 8)}
+# Nombres de PostgreSQL que también acepta el codificador nativo
+_TYPE_ALIASES = {'smallint': 'int2', 'integer': 'int4', 'bigint': 'int8'}
+
+
+def copy_types(model, fields, connection):
+    """Tipos de COPY de `fields` según las columnas reales del modelo."""
+    types = []
+    for name in fields:
+        field = model._meta.get_field(name)
+        db_type = (field.db_type(connection) or '').split('(')[0].strip().lower()
+        if db_type not in DB_COPY_TYPES:
+            raise ValueError(f"Tipo de columna no soportado para COPY binario: {name} ({db_type})")
+        types.append(DB_COPY_TYPES[db_type])
+    return types
+
+
+def build_copy_encoder(types):
+    """
+    Codificador con encode(columns, header=True, trailer=True) -> bytes;
+    columns = [[int|str|None] por fila] por columna, None es NULL.
+    """
+    if cpp_csv is not None:
+        return cpp_csv.build_copy_encoder(types)
+    return _PyCopyEncoder(types)
+
+
+def copy_binary(cursor, table, fields, payload):
+    """
+    Ejecuta COPY table (fields) FROM STDIN WITH (FORMAT BINARY) con los
+    bytes de `payload` (encabezado + tuplas + terminador), con psycopg2 o
+    psycopg 3. Lanza NotImplementedError si el driver no soporta COPY.
+    """
+    sql = f"COPY {table} ({', '.join(fields)}) FROM STDIN WITH (FORMAT BINARY)"
+    raw_cursor = getattr(cursor, 'cursor', cursor)
+    if hasattr(raw_cursor, 'copy_expert'):
+        raw_cursor.copy_expert(sql, io.BytesIO(payload))
+    elif hasattr(raw_cursor, 'copy'):
+        with raw_cursor.copy(sql) as copy:
+            copy.write(payload)
+    else:
+        raise NotImplementedError("Driver incompatible con COPY")
+
+
+class _PyCopyEncoder:
+
+    def __init__(self, types):
+        if not types:
+            raise ValueError("COPY necesita al menos una columna")
+        types = [_TYPE_ALIASES.get(t, t) for t in types]
+        for t in types:
+            if t not in ('int2', 'int4', 'int8', 'text'):
+                raise ValueError(f"Tipo de COPY no soportado: {t}")
+        self._types = types
+        self._tuple_header = struct.pack('>h', len(self._types))
+
+    @property
+    def columns(self):
+        return len(self._types)
+
+    def encode(self, columns, header=True, trailer=True):
+        if len(columns) != len(self._types):
+            raise ValueError(f"Se esperaban {len(self._types)} columnas")
+        rows = len(columns[0])
+        if any(len(column) != rows for column in columns):
+            raise ValueError("Todas las columnas del COPY deben tener el mismo número de filas")
+
+        null = struct.pack('>i', -1)
+        parts = [COPY_HEADER] if header else []
+        for r in range(rows):
+            parts.append(self._tuple_header)
+            for kind, column in zip(self._types, columns):
+                value = column[r]
+                if value is None:
+                    parts.append(null)
+                elif kind == 'text':
+                    data = value.encode('utf-8')
+                    parts.append(struct.pack('>i', len(data)))
+                    parts.append(data)
+                else:
+                    fmt, size = _INT_FORMATS[kind]
+                    try:
+                        parts.append(struct.pack(fmt, size, value))
+                    except struct.error:
+                        raise OverflowError(f"Valor {value} fuera de rango para {kind}") from None
+        if trailer:
+            parts.append(COPY_TRAILER)
+        return b''.join(parts)
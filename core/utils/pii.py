@@ -0,0 +1,131 @@
+"""
+Detección de datos personales (PII) en los valores de una pregunta.
+
+Revisa columnas completas (no una muestra) buscando correos, teléfonos,
+identificadores tipo folio y documentos oficiales (RFC, CURP, DNI). Usa los
+autómatas nativos de cpp_csv cuando están compilados; si no, las mismas
+reglas con expresiones regulares.
+"""
+import re
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+EMAIL_RE = re.compile(r"\b[a-z0-9._%+-]+@[a-z0-9.-]+\.[a-z]{2,}\b", re.IGNORECASE)
+# Teléfonos comunes: admite +, espacios, guiones, paréntesis; valida longitud de dígitos.
+PHONE_CANDIDATE_RE = re.compile(r"\+?\d[\d\s\-().]{6,}\d")
+
+_ID_TOKEN_RE = re.compile(r"[A-Za-z0-9&Ññ]+")
+_RFC_RE = re.compile(r"[A-Za-zÑñ&]{3,4}([0-9]{6})[A-Za-z0-9]{3}")
+_CURP_RE = re.compile(r"[A-Za-z]{4}([0-9]{6})[HMhm][A-Za-z]{5}[A-Za-z0-9][0-9]")
+_DNI_RE = re.compile(r"[0-9]{8}[A-Za-z]")
+
+COUNT_KEYS = ('emails', 'phones', 'identifiers', 'national_ids')
+
+
+def looks_like_phone(value) -> bool:
+    if not value:
+        return False
+    s = str(value).strip()
+    if not PHONE_CANDIDATE_RE.search(s):
+        return False
+    digits = re.sub(r"\D", "", s)
+    return 7 <= len(digits) <= 15
+
+
+def looks_like_identifier(value) -> bool:
+    """Detecta IDs típicos: mezcla alfanumérica o números largos.
+
+    Heurística para columnas como Reserva_ID/BookingCode aunque el label sea raro.
+    """
+    if value is None:
+        return False
+    s = str(value).strip()
+    if not s:
+        return False
+    # Normalizar separadores comunes en IDs
+    s_clean = re.sub(r"[\s_\-]+", "", s)
+    if len(s_clean) < 6 or len(s_clean) > 64:
+        return False
+    if not re.fullmatch(r"[A-Za-z0-9]+", s_clean):
+        return False
+    has_alpha = bool(re.search(r"[A-Za-z]", s_clean))
+    has_digit = bool(re.search(r"\d", s_clean))
+    if has_alpha and has_digit:
+        return True
+    # Solo dígitos, pero largo (ej. folio numérico)
+    if (not has_alpha) and has_digit and len(s_clean) >= 8:
+        return True
+    return False
+
+
+def _valid_date(digits):
+    month, day = int(digits[2:4]), int(digits[4:6])
+    return 1 <= month <= 12 and 1 <= day <= 31
+
+
+def contains_national_id(value) -> bool:
+    """RFC (persona física o moral), CURP o DNI en algún token del valor."""
+    for token in _ID_TOKEN_RE.findall(str(value or '')):
+        if len(token) in (12, 13):
+            match = _RFC_RE.fullmatch(token)
+        elif len(token) == 18:
+            match = _CURP_RE.fullmatch(token)
+        elif len(token) == 9:
+            if _DNI_RE.fullmatch(token):
+                return True
+            continue
+        else:
+            continue
+        if match and _valid_date(match.group(1)):
+            return True
+    return False
+
+
+def scan_columns(columns):
+    """
+    Cuenta PII en columnas completas de valores.
+
+    Args:
+        columns: Lista de columnas; cada una, lista de valores (None se omite)
+
+    Returns:
+        Por columna: {'values', 'distinct', 'emails', 'phones', 'identifiers',
+        'national_ids', '<tipo>_ratio' (sobre values), 'flagged_rows'}.
+        flagged_rows son los índices (tras omitir None) con correo, teléfono
+        o documento oficial.
+    """
+    columns = [[v if isinstance(v, str) else str(v) for v in column if v is not None] for column in columns]
+    if cpp_csv is not None:
+        reports = cpp_csv.scan_pii(columns)
+    else:
+        reports = [_scan_python(values) for values in columns]
+    for report in reports:
+        n = max(report['values'], 1)
+        for key in COUNT_KEYS:
+            report[f"{key[:-1]}_ratio"] = report[key] / n
+    return reports
+
+
+def scan_values(values):
+    """`scan_columns` para una sola columna."""
+    return scan_columns([values])[0]
+
+
+def _scan_python(values):
+    report = dict.fromkeys(COUNT_KEYS, 0)
+    report.update(values=len(values), distinct=len(set(values)), flagged_rows=[])
+    for row, value in enumerate(values):
+        email = bool(EMAIL_RE.search(value))
+        phone = looks_like_phone(value)
+        national_id = contains_national_id(value)
+        report['emails'] += email
+        report['phones'] += phone
+        report['identifiers'] += looks_like_identifier(value)
+        report['national_ids'] += national_id
+        if email or phone or national_id:
+            report['flagged_rows'].append(row)
+    return report
@@ -0,0 +1,130 @@
+"""
+Puntuación de sentimiento con léxicos de palabras y frases.
+
+Usa el autómata nativo de cpp_csv (Aho–Corasick, una pasada por texto)
+cuando está compilado; si no, un recorrido equivalente en Python. Ambos
+normalizan con `fold_text`, comparan palabras completas, prefieren la frase
+más larga ("no funciona" antes que "no") y aplican ventanas de negación
+("no es bueno" cuenta como negativo).
+"""
+from core.utils.text_mining import fold_text
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+NEGATORS_ES = ('no', 'nunca', 'jamas', 'ni', 'tampoco', 'sin', 'nada', 'para nada')
+NEGATION_WINDOW = 3
+
+
+def build_terms(positive=(), negative=()):
+    """{término: peso} con +1 para positivos y -1 para negativos (gana el último)."""
+    terms = {word: 1.0 for word in positive}
+    terms.update((word, -1.0) for word in negative)
+    return terms
+
+
+class SentimentLexicon:
+    """
+    Léxico compilado una sola vez y reutilizable entre peticiones.
+
+    Args:
+        terms: {palabra o frase: peso} (> 0 positivo, < 0 negativo)
+        negators: Invierten el signo de los términos que empiezan a menos
+            de `window` tokens después de ellos
+    """
+
+    def __init__(self, terms, negators=NEGATORS_ES, window=NEGATION_WINDOW):
+        self.window = window
+        if cpp_csv is not None:
+            self._native = cpp_csv.build_sentiment_lexicon(terms, negators, window)
+            return
+        self._native = None
+        self._phrases = {}
+        for phrase, weight in dict(terms).items():
+            self._add(phrase, float(weight), False)
+        for phrase in negators:
+            self._add(phrase, 0.0, True)
+        self._longest = max(map(len, self._phrases), default=0)
+
+    def _add(self, phrase, weight, negator):
+        key = tuple(fold_text(phrase).split())
+        if key:
+            self._phrases[key] = (weight, negator)
+
+    def score(self, texts):
+        """
+        Puntúa cada texto y agrega los totales.
+
+        Returns:
+            {'scores': [float] (uno por texto), 'positive', 'negative'
+             (aportes totales, negative en valor absoluto), 'matches',
+             'positive_texts', 'negative_texts', 'neutral_texts'}
+        """
+        texts = [t if isinstance(t, str) else '' for t in texts]
+        if self._native is not None:
+            return self._native.score(texts)
+
+        result = {
+            'scores': [], 'positive': 0.0, 'negative': 0.0, 'matches': 0,
+            'positive_texts': 0, 'negative_texts': 0, 'neutral_texts': 0,
+        }
+        for text in texts:
+            score, positive, negative, matches = self._score_text(text)
+            result['scores'].append(score)
+            result['positive'] += positive
+            result['negative'] += negative
+            result['matches'] += matches
+            if score > 0:
+                result['positive_texts'] += 1
+            elif score < 0:
+                result['negative_texts'] += 1
+            else:
+                result['neutral_texts'] += 1
+        return result
+
+    def _score_text(self, text):
+        tokens = fold_text(text).split()
+        score = positive = negative = 0.0
+        matches = 0
+        negator_end = None
+        i = 0
+        while i < len(tokens):
+            # La frase más larga que empieza en i
+            for size in range(min(self._longest, len(tokens) - i), 0, -1):
+                entry = self._phrases.get(tuple(tokens[i:i + size]))
+                if entry:
+                    break
+            else:
+                i += 1
+                continue
+
+            weight, negator = entry
+            if negator:
+                negator_end = i + size
+            else:
+                if negator_end is not None and i - negator_end < self.window:
+                    weight = -weight
+                score += weight
+                if weight > 0:
+                    positive += weight
+                else:
+                    negative -= weight
+                matches += 1
+            i += size
+        return score, positive, negative, matches
+
+
+def sentiment_label(result, threshold=0.15):
+    """'Positivo' / 'Negativo' / 'Neutral' según (pos - neg) / (pos + neg) del agregado."""
+    total = result['positive'] + result['negative']
+    if total <= 0:
+        return 'Neutral'
+    balance = (result['positive'] - result['negative']) / total
+    if balance > threshold:
+        return 'Positivo'
+    if balance < -threshold:
+        return 'Negativo'
+    return 'Neutral'
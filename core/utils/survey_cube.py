@@ -0,0 +1,327 @@
+"""
+Cubo columnar de una encuesta para los tableros de resultados.
+
+Por pregunta guarda la fila (respuesta) y un código de diccionario por cada
+respuesta individual: etiquetas para opciones y datos demográficos, valores
+distintos ordenados para escalas y números. Con eso se contestan
+distribuciones, estadísticas y conteos filtrados (fechas, segmentos) en el
+proceso, sin consultas agregadas a la BD.
+
+Usa el cubo nativo de cpp_csv cuando está compilado (se guarda en un archivo
+y se abre con mmap); si no, uno equivalente en memoria en Python.
+"""
+import math
+from datetime import date
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+CHOICE = 'choice'
+NUMERIC = 'numeric'
+
+
+class SurveyCube:
+    """
+    Cubo de una encuesta. Los métodos `rows_*` regresan conjuntos de filas
+    (bitmaps comprimidos en el cubo nativo) que admiten &, |, - (diferencia),
+    ~ y len(); los métodos de conteo reciben uno de ellos (None = todas las
+    respuestas).
+    """
+
+    def __init__(self, impl):
+        self._impl = impl
+        self._dictionaries = {}
+
+    @classmethod
+    def build(cls, response_ids, days, choice_columns=None, numeric_columns=None):
+        """
+        Args:
+            response_ids: Universo de respuestas (SurveyResponse.id)
+            days: Fecha (date) u ordinal de cada respuesta; None = sin fecha
+            choice_columns: {question_id: (response_ids, labels, from_option)}
+            numeric_columns: {question_id: (response_ids, values)}
+        """
+        days = [_ordinal(d) for d in days]
+        choice = [(qid, *column) for qid, column in (choice_columns or {}).items()]
+        numeric = [(qid, *column) for qid, column in (numeric_columns or {}).items()]
+        if cpp_csv is not None:
+            return cls(cpp_csv.build_survey_cube(response_ids, days, choice, numeric))
+        return cls(_PyCube(response_ids, days, choice, numeric))
+
+    @classmethod
+    def open(cls, path):
+        """Abre un cubo guardado con `save`; None sin el módulo nativo."""
+        if cpp_csv is None:
+            return None
+        return cls(cpp_csv.open_survey_cube(path))
+
+    def save(self, path):
+        """Guarda el cubo en `path`. False si el cubo es el de Python (solo vive en memoria)."""
+        if isinstance(self._impl, _PyCube):
+            return False
+        self._impl.save(str(path))
+        return True
+
+    @property
+    def rows(self):
+        return self._impl.rows
+
+    @property
+    def nbytes(self):
+        return self._impl.bytes
+
+    @property
+    def mapped(self):
+        return self._impl.mapped
+
+    def has_question(self, question_id):
+        return question_id in self._dictionary_cache()
+
+    def kind(self, question_id):
+        """CHOICE o NUMERIC."""
+        return self._impl.kind(question_id)
+
+    # --- Selección de filas ---
+
+    def all_rows(self):
+        return self._impl.all()
+
+    def rows_between(self, start=None, end=None):
+        """Respuestas con fecha en [start, end] (fechas o None = sin límite)."""
+        first = _ordinal(start) if start else -2 ** 31
+        last = _ordinal(end) if end else 2 ** 31 - 1
+        return self._impl.days_between(first, last)
+
+    def rows_with_labels(self, question_id, labels):
+        """Respuestas con alguna etiqueta exactamente igual a una de `labels`."""
+        wanted = set(labels)
+        codes = [code for code, (label, _) in self._labels(question_id) if label in wanted]
+        return self._impl.with_codes(question_id, codes)
+
+    def rows_containing(self, question_id, text):
+        """Respuestas con alguna etiqueta que contiene `text` (sin distinguir mayúsculas, como icontains)."""
+        needle = str(text).casefold()
+        codes = [code for code, (label, _) in self._labels(question_id) if needle in label.casefold()]
+        return self._impl.with_codes(question_id, codes)
+
+    def rows_with_numbers(self, question_id, values):
+        """Respuestas con algún valor numérico igual a uno de `values`."""
+        wanted = {float(v) for v in values}
+        codes = []
+        if self.kind(question_id) == NUMERIC:
+            codes = [code for code, value in enumerate(self._dictionary(question_id)) if value in wanted]
+        return self._impl.with_codes(question_id, codes)
+
+    def rows_with_values(self, question_id, low, high):
+        """Respuestas con algún valor numérico en [low, high]."""
+        return self._impl.with_values(question_id, float(low), float(high))
+
+    # --- Conteos ---
+
+    def count(self, rows=None):
+        return self.rows if rows is None else len(rows)
+
+    def last_response_id(self, rows=None):
+        return self._impl.last_response_id(rows)
+
+    def response_ids(self, rows=None):
+        return self._impl.response_ids(rows)
+
+    def choice_counts(self, question_id, rows=None, options_only=True):
+        """[(etiqueta, respuestas)] sin ceros; options_only omite el texto libre."""
+        counts = self._impl.code_counts(question_id, rows)
+        return [
+            (label, n)
+            for (label, from_option), n in zip(self._dictionary(question_id), counts)
+            if n and (from_option or not options_only)
+        ]
+
+    def numeric_distribution(self, question_id, rows=None):
+        """[(valor, respuestas)] ordenado por valor, sin ceros."""
+        counts = self._impl.code_counts(question_id, rows)
+        return [(value, n) for value, n in zip(self._dictionary(question_id), counts) if n]
+
+    def day_counts(self, rows=None):
+        """[(date, respuestas)] ordenado por fecha."""
+        return [(date.fromordinal(day), n) for day, n in self._impl.day_counts(rows) if day > 0]
+
+    def _dictionary_cache(self):
+        if not self._dictionaries:
+            self._dictionaries = {qid: None for qid in self._impl.question_ids()}
+        return self._dictionaries
+
+    def _labels(self, question_id):
+        """(código, (etiqueta, de_opción)) de una columna CHOICE; vacío en las numéricas."""
+        if self.kind(question_id) != CHOICE:
+            return []
+        return enumerate(self._dictionary(question_id))
+
+    def _dictionary(self, question_id):
+        cache = self._dictionary_cache()
+        if question_id not in cache:
+            raise KeyError(question_id)
+        if cache[question_id] is None:
+            cache[question_id] = self._impl.dictionary(question_id)
+        return cache[question_id]
+
+
+def _ordinal(day):
+    if day is None:
+        return 0
+    if isinstance(day, date):
+        return day.toordinal()
+    return int(day)
+
+
+# ---------------------------------------------------------------------------
+# Implementación en Python (misma semántica que core/cube.cpp)
+# ---------------------------------------------------------------------------
+
+
+class _Rows:
+    """Conjunto de filas como entero de bits (bit i = fila i)."""
+
+    __slots__ = ('mask', 'size')
+
+    def __init__(self, mask, size):
+        self.mask = mask
+        self.size = size
+
+    def __and__(self, other):
+        return _Rows(self.mask & other.mask, self.size)
+
+    def __or__(self, other):
+        return _Rows(self.mask | other.mask, self.size)
+
+    def __sub__(self, other):
+        return _Rows(self.mask & ~other.mask, self.size)
+
+    def __invert__(self):
+        return _Rows(~self.mask & ((1 << self.size) - 1), self.size)
+
+    def __eq__(self, other):
+        return isinstance(other, _Rows) and (self.mask, self.size) == (other.mask, other.size)
+
+    __hash__ = None
+
+    def __contains__(self, row):
+        return 0 <= row < self.size and bool(self.mask >> row & 1)
+
+    def __len__(self):
+        return bin(self.mask).count('1')
+
+    def count(self):
+        return len(self)
+
+    def rows(self):
+        return [i for i, flag in enumerate(self.flags()) if flag]
+
+    def flags(self):
+        """bytearray con un byte por fila (1 = seleccionada)."""
+        bits = self.mask.to_bytes((self.size + 7) // 8 or 1, 'little')
+        return bytearray((bits[i >> 3] >> (i & 7)) & 1 for i in range(self.size))
+
+    @classmethod
+    def from_rows(cls, rows, size):
+        bits = bytearray((size + 7) // 8 or 1)
+        for row in rows:
+            bits[row >> 3] |= 1 << (row & 7)
+        return cls(int.from_bytes(bits, 'little'), size)
+
+
+class _PyCube:
+    bytes = 0
+    mapped = False
+
+    def __init__(self, response_ids, days, choice_columns, numeric_columns):
+        pairs = {}
+        for response_id, day in zip(response_ids, days):
+            pairs.setdefault(int(response_id), day)
+        self._response_ids = sorted(pairs)
+        self._days = [pairs[r] for r in self._response_ids]
+        self._row_of = {r: i for i, r in enumerate(self._response_ids)}
+        self._columns = {}
+
+        for qid, ids, labels, from_option in choice_columns:
+            codes, dictionary, entries = {}, [], []
+            for response_id, label, flag in zip(ids, labels, from_option):
+                row = self._row_of.get(int(response_id))
+                if row is None or not label:
+                    continue
+                key = (bool(flag), str(label))
+                if key not in codes:
+                    codes[key] = len(dictionary)
+                    dictionary.append((key[1], key[0]))
+                entries.append((row, codes[key]))
+            self._columns.setdefault(qid, (dictionary, entries, CHOICE))
+
+        for qid, ids, values in numeric_columns:
+            raw = []
+            for response_id, value in zip(ids, values):
+                row = self._row_of.get(int(response_id))
+                if row is None or value is None or math.isnan(float(value)):
+                    continue
+                raw.append((row, float(value)))
+            dictionary = sorted({v for _, v in raw})
+            index = {v: i for i, v in enumerate(dictionary)}
+            self._columns.setdefault(qid, (dictionary, [(row, index[v]) for row, v in raw], NUMERIC))
+
+    @property
+    def rows(self):
+        return len(self._response_ids)
+
+    def question_ids(self):
+        return list(self._columns)
+
+    def kind(self, question_id):
+        return self._columns[question_id][2]
+
+    def dictionary(self, question_id):
+        return list(self._columns[question_id][0])
+
+    def all(self):
+        return _Rows((1 << self.rows) - 1, self.rows)
+
+    def days_between(self, first, last):
+        return _Rows.from_rows((r for r, d in enumerate(self._days) if first <= d <= last), self.rows)
+
+    def with_codes(self, question_id, codes):
+        wanted = set(codes)
+        entries = self._columns[question_id][1]
+        return _Rows.from_rows((row for row, code in entries if code in wanted), self.rows)
+
+    def with_values(self, question_id, low, high):
+        dictionary, _, kind = self._columns[question_id]
+        codes = [i for i, v in enumerate(dictionary) if kind == NUMERIC and low <= v <= high]
+        return self.with_codes(question_id, codes)
+
+    def code_counts(self, question_id, rows=None):
+        dictionary, entries, _ = self._columns[question_id]
+        counts = [0] * len(dictionary)
+        selected = rows.flags() if rows is not None else None
+        for row, code in entries:
+            if selected is None or selected[row]:
+                counts[code] += 1
+        return counts
+
+    def day_counts(self, rows=None):
+        selected = rows.flags() if rows is not None else None
+        counts = {}
+        for row, day in enumerate(self._days):
+            if selected is None or selected[row]:
+                counts[day] = counts.get(day, 0) + 1
+        return sorted(counts.items())
+
+    def last_response_id(self, rows=None):
+        selected = rows.flags() if rows is not None else None
+        for row in range(self.rows - 1, -1, -1):
+            if selected is None or selected[row]:
+                return self._response_ids[row]
+        return 0
+
+    def response_ids(self, rows=None):
+        selected = rows.flags() if rows is not None else None
+        return [r for i, r in enumerate(self._response_ids) if selected is None or selected[i]]
@@ -0,0 +1,168 @@
+"""
+Índice invertido de respuestas abiertas para citas representativas y
+palabras en contexto (KWIC).
+
+Los términos salen de `fold_text` (minúsculas, sin acentos), así que
+"atencion" encuentra "Atención". Usa el índice nativo de cpp_csv cuando
+está compilado; si no, uno equivalente en Python. Los índices se guardan
+en una caché por proceso para no reconstruirlos en cada tono o render.
+"""
+import threading
+from collections import OrderedDict
+from functools import lru_cache
+
+from core.utils.text_mining import fold_text
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+QUOTE_MIN_LENGTH = 20
+QUOTE_MAX_LENGTH = 110
+CONTEXT_WIDTH = 40
+CONTEXT_LIMIT = 20
+INDEX_CACHE_SIZE = 32
+
+
+class TextIndex:
+    """Índice de una lista de textos; las filas son posiciones en `texts`."""
+
+    def __init__(self, texts):
+        self.texts = [t if isinstance(t, str) else '' for t in texts]
+        if cpp_csv is not None:
+            self._native = cpp_csv.build_text_index(self.texts)
+            return
+        self._native = None
+        self._tokens = []     # por texto: [(término, inicio, fin)] en caracteres
+        self._postings = {}   # término -> [(fila, posición)]
+        for row, text in enumerate(self.texts):
+            tokens = _tokenize(text)
+            self._tokens.append(tokens)
+            for position, (term, _, _) in enumerate(tokens):
+                self._postings.setdefault(term, []).append((row, position))
+
+    @property
+    def documents(self):
+        return self._native.documents if self._native is not None else len(self.texts)
+
+    @property
+    def terms(self):
+        return self._native.terms if self._native is not None else len(self._postings)
+
+    def postings(self, term):
+        """[(fila, posición)] de un término."""
+        if self._native is not None:
+            return self._native.postings(term)
+        return list(self._postings.get(fold_text(term).strip(), []))
+
+    def best_quote(self, terms, min_length=QUOTE_MIN_LENGTH, max_length=QUOTE_MAX_LENGTH):
+        """
+        Fila del texto que contiene todos los términos (o frases) con largo
+        dentro de (min_length, max_length): el de más apariciones y, en
+        empate, el primero. None si ninguno cumple.
+        """
+        terms = list(terms)
+        if self._native is not None:
+            return self._native.best_quote(terms, min_length, max_length)
+        if not terms:
+            return None
+        candidates = None
+        for term in terms:
+            counts = {}
+            for row, _, _ in self._find(term, 0):
+                counts[row] = counts.get(row, 0) + 1
+            if candidates is None:
+                candidates = counts
+            else:
+                candidates = {row: n + counts[row] for row, n in candidates.items() if row in counts}
+            if not candidates:
+                return None
+        best, best_count = None, 0
+        for row in sorted(candidates):
+            if min_length < len(self.texts[row]) < max_length and candidates[row] > best_count:
+                best, best_count = row, candidates[row]
+        return best
+
+    def keyword_in_context(self, term, width=CONTEXT_WIDTH, limit=CONTEXT_LIMIT):
+        """Apariciones de una palabra o frase: [{'row', 'left', 'match', 'right'}]."""
+        if self._native is not None:
+            return self._native.keyword_in_context(term, width, limit)
+        contexts = []
+        for row, begin, end in self._find(term, limit):
+            text = self.texts[row]
+            contexts.append({
+                'row': row,
+                'left': text[max(0, begin - width):begin],
+                'match': text[begin:end],
+                'right': text[end:end + width],
+            })
+        return contexts
+
+    def _find(self, phrase, limit):
+        terms = fold_text(phrase).split()
+        if not terms or any(t not in self._postings for t in terms):
+            return []
+        # Se recorre la lista más corta y el resto se verifica en el texto
+        anchor = min(range(len(terms)), key=lambda i: len(self._postings[terms[i]]))
+        hits = []
+        for row, position in self._postings[terms[anchor]]:
+            start = position - anchor
+            tokens = self._tokens[row]
+            if start < 0 or start + len(terms) > len(tokens):
+                continue
+            if all(tokens[start + i][0] == term for i, term in enumerate(terms)):
+                hits.append((row, tokens[start][1], tokens[start + len(terms) - 1][2]))
+                if limit and len(hits) >= limit:
+                    break
+        return hits
+
+
+@lru_cache(maxsize=4096)
+def _fold_char(ch):
+    return fold_text(ch)
+
+
+def _tokenize(text):
+    """Tokens normalizados con su tramo [inicio, fin) en el texto original."""
+    tokens = []
+    current = []
+    start = None
+    for i, ch in enumerate(text):
+        for c in _fold_char(ch):
+            if c == ' ':
+                if current:
+                    tokens.append((''.join(current), start, i))
+                    current = []
+            else:
+                if not current:
+                    start = i
+                current.append(c)
+    if current:
+        tokens.append((''.join(current), start, len(text)))
+    return tokens
+
+
+_cache = OrderedDict()
+_cache_lock = threading.Lock()
+
+
+def get_text_index(key, texts):
+    """
+    Índice de `texts` reutilizando uno ya construido para la misma llave y
+    los mismos textos (LRU de INDEX_CACHE_SIZE índices por proceso).
+    """
+    texts = list(texts)
+    cache_key = (key, len(texts), hash(tuple(texts)))
+    with _cache_lock:
+        index = _cache.get(cache_key)
+        if index is not None:
+            _cache.move_to_end(cache_key)
+            return index
+    index = TextIndex(texts)
+    with _cache_lock:
+        _cache[cache_key] = index
+        while len(_cache) > INDEX_CACHE_SIZE:
+            _cache.popitem(last=False)
+    return index
@@ -0,0 +1,84 @@
+"""
+Minería de texto para respuestas abiertas: normalización, tokens y conteo
+de palabras / bigramas.
+
+Usa el motor nativo de cpp_csv cuando está compilado; si no, un cálculo
+equivalente en Python. Ambos quitan acentos igual (NFKD sin marcas
+combinantes) y tratan lo que no es letra o dígito ASCII como separador.
+"""
+import re
+import unicodedata
+from collections import Counter
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+# Palabras vacías del español (ya sin acentos) que no aportan como tema.
+STOPWORDS_ES = frozenset({
+    'algo', 'algun', 'alguna', 'algunos', 'ante', 'antes', 'aqui', 'asi', 'aunque',
+    'cada', 'casi', 'como', 'con', 'contra', 'cual', 'cuando', 'del', 'desde', 'donde',
+    'durante', 'ella', 'ellos', 'entre', 'era', 'eran', 'esa', 'ese', 'eso', 'esta',
+    'estaba', 'estan', 'estar', 'este', 'esto', 'estos', 'fue', 'fueron', 'hace', 'hacer',
+    'hasta', 'hay', 'las', 'les', 'los', 'mas', 'mismo', 'mucho', 'muy', 'nada', 'nos',
+    'nosotros', 'otra', 'otro', 'otros', 'para', 'pero', 'poco', 'por', 'porque', 'que',
+    'quien', 'sea', 'ser', 'sido', 'sin', 'sobre', 'solo', 'son', 'sus', 'tambien',
+    'tan', 'tanto', 'tener', 'tengo', 'tiene', 'tienen', 'todo', 'todos', 'una', 'uno',
+    'unos', 'usted', 'ustedes', 'ver', 'vez', 'yo',
+})
+
+_NON_ALNUM_RE = re.compile(r'[^a-z0-9]')
+
+
+def fold_text(text):
+    """Minúsculas sin acentos ("Atención" -> "atencion"); lo no alfanumérico queda como espacio."""
+    if not text:
+        return ''
+    if cpp_csv is not None:
+        return cpp_csv.fold_text(str(text))
+    decomposed = unicodedata.normalize('NFKD', str(text).lower())
+    stripped = ''.join(c for c in decomposed if not unicodedata.combining(c))
+    return _NON_ALNUM_RE.sub(' ', stripped.encode('ascii', 'replace').decode('ascii'))
+
+
+def analyze_texts(texts, min_length=3, stopwords=(), top_k=20, bigrams=True, track=()):
+    """
+    Cuenta palabras y bigramas de todos los textos.
+
+    Los bigramas unen tokens consecutivos ya filtrados (sin stopwords ni
+    tokens cortos) dentro del mismo texto. El top se ordena por conteo y,
+    en empate, alfabéticamente.
+
+    Returns:
+        {'words': [(palabra, conteo)], 'bigrams': [(bigrama, conteo)],
+         'tracked': {término: conteo}, 'tokens': int, 'documents': int}
+    """
+    if cpp_csv is not None:
+        return cpp_csv.analyze_texts(texts, min_length, stopwords, top_k, bigrams, track)
+
+    stop = {fold_text(w).strip() for w in stopwords}
+    words = Counter()
+    pairs = Counter()
+    documents = 0
+    for text in texts:
+        if not text:
+            continue
+        documents += 1
+        tokens = [t for t in fold_text(text).split() if len(t) >= min_length and t not in stop]
+        words.update(tokens)
+        if bigrams:
+            pairs.update(f"{a} {b}" for a, b in zip(tokens, tokens[1:]))
+
+    def top(counter):
+        ranked = sorted(counter.items(), key=lambda kv: (-kv[1], kv[0]))
+        return ranked[:top_k] if top_k else ranked
+
+    return {
+        'words': top(words),
+        'bigrams': top(pairs) if bigrams else [],
+        'tracked': {term: words.get(fold_text(term).strip(), 0) for term in track},
+        'tokens': sum(words.values()),
+        'documents': documents,
+    }
@@ -0,0 +1,98 @@
+"""
+Línea de tiempo de una petición o importación en formato Chrome Trace Event
+(se abre en chrome://tracing o https://ui.perfetto.dev).
+
+Los spans nativos de cpp_csv (lectura por chunk, rangos de discover, kernels
+de análisis) y las etapas de Python marcadas con span() / mark() comparten
+reloj, así que se ve qué corrió en cada hilo y cuánto tardó. Solo se mide con
+una sesión abierta (trace_to_file); sin ella o sin cpp_csv nada cuesta.
+"""
+import contextlib
+import functools
+import inspect
+import logging
+import os
+import re
+import time
+import types
+
+from django.conf import settings
+
+# El módulo nativo es opcional: las vistas y los tests funcionan sin él.
+try:
+    from tools.cpp_csv import pybind_csv as cpp_csv
+except ImportError:  # pragma: no cover - depende de la compilación local
+    cpp_csv = None
+
+logger = logging.getLogger(__name__)
+
+
+def span(name, **args):
+    """Etapa de Python en la línea de tiempo (args: hasta 3 enteros)."""
+    if cpp_csv is None:
+        return contextlib.nullcontext()
+    return cpp_csv.span(name, **args)
+
+
+def now_ns():
+    """Inicio de una etapa para mark(); 0 sin cpp_csv."""
+    return cpp_csv.trace_now_ns() if cpp_csv is not None else 0
+
+
+def mark(name, start_ns, **args):
+    """Span de `start_ns` (now_ns()) a ahora, para etapas que no caben en un with."""
+    if cpp_csv is not None:
+        cpp_csv.trace_mark(name, start_ns, **args)
+
+
+def traced(name):
+    """Decorador: la función (sync o async) completa como un span."""
+    def decorator(func):
+        if inspect.iscoroutinefunction(func):
+            @functools.wraps(func)
+            async def async_wrapper(*args, **kwargs):
+                with span(name):
+                    return await func(*args, **kwargs)
+            return async_wrapper
+
+        @functools.wraps(func)
+        def wrapper(*args, **kwargs):
+            with span(name):
+                return func(*args, **kwargs)
+        return wrapper
+    return decorator
+
+
+def trace_dir():
+    """Directorio de CPP_CSV_TRACE_DIR ('' = tracing apagado)."""
+    return getattr(settings, 'CPP_CSV_TRACE_DIR', '') or ''
+
+
+@contextlib.contextmanager
+def trace_to_file(label, enabled=True):
+    """
+    Abre una sesión de tracing durante el bloque y al salir la guarda en
+    <CPP_CSV_TRACE_DIR>/<label>-<fecha>-<pid>.json. Regresa un objeto cuyo
+    `path` queda con la ruta al salir (None si no se guardó: enabled=False,
+    sin directorio configurado o sin cpp_csv).
+    """
+    result = types.SimpleNamespace(path=None, dropped=0)
+    directory = trace_dir()
+    if not enabled or not directory or cpp_csv is None:
+        yield result
+        return
+
+    with cpp_csv.trace_session() as session:
+        yield result
+
+    safe_label = re.sub(r'[^A-Za-z0-9_.-]+', '_', label).strip('_') or 'trace'
+    path = os.path.join(directory, f"{safe_label}-{time.strftime('%Y%m%d-%H%M%S')}-{os.getpid()}.json")
+    try:
+        os.makedirs(directory, exist_ok=True)
+        session.save(path)
+    except OSError:
+        logger.warning("[TRACE] No se pudo guardar %s", path, exc_info=True)
+        return
+    result.path = path
+    result.dropped = session.dropped
+    logger.info("[TRACE] %s guardado en %s (eventos perdidos: %s)", label, path, session.dropped)
@@ -4,6 +4,7 @@ Setup for building the cpp_csv C++ extension module with pybind11.
 
 from setuptools import setup, Extension
 from setuptools.command.build_ext import build_ext
+import glob
 import sys
 import setuptools
 import pybind11
@@ -16,11 +17,13 @@ class get_pybind_include:
 ext_modules = [
     Extension(
         'cpp_csv',  # name of the compiled module
-        ['tools/cpp_csv/cpp_csv.cpp'],  # source files
+        # source files: pybind11 layer + pure C++ core
+        ['tools/cpp_csv/cpp_csv.cpp'] + sorted(glob.glob('tools/cpp_csv/core/*.cpp')),
         include_dirs=[
             get_pybind_include(),
         ],
-        extra_compile_args=['/std:c++17'] if sys.platform == 'win32' else ['-std=c++17'],
+        extra_compile_args=['/std:c++17'] if sys.platform == 'win32' else ['-std=c++17', '-pthread'],
+        extra_link_args=[] if sys.platform == 'win32' else ['-pthread'],
         language='c++',
     ),
 ]
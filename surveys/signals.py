@@ -63,6 +63,15 @@ def invalidate_pattern(pattern):
         pass
 
 
+def discard_survey_cube(survey_id):
+    """Descarta el cubo columnar de la encuesta en este proceso y sus archivos."""
+    from core.services.survey_cube import SurveyCubeService
+    try:
+        SurveyCubeService.discard(survey_id)
+    except Exception:
+        logger.warning("No se pudo descartar el cubo de la encuesta %s", survey_id, exc_info=True)
+
+
 @receiver(post_save, sender=Survey)
 @receiver(post_delete, sender=Survey)
 def invalidate_survey_cache(sender, instance, created=False, **kwargs):
@@ -166,6 +175,7 @@ def invalidate_option_cache(sender, instance, created=False, **kwargs):
     results_pattern = f"survey_results_{survey.id}_*"
     invalidate_pattern(analysis_pattern)
     invalidate_pattern(results_pattern)
+    discard_survey_cube(survey.id)
     
     logger.debug(f"✅ Opción respuesta {instance.id} ({action}) - Encuesta {survey.id} - Caché actualizada")
 
@@ -246,6 +256,9 @@ def invalidate_question_response_cache(sender, instance, created=False, **kwargs
         stats_key = f"survey_stats_{survey.id}"
         cache.delete(stats_key)
         
+        # Cubo columnar (editar una respuesta en sitio no cambia su versión)
+        discard_survey_cube(survey.id)
+        
         logger.debug(f"📋 Respuesta a pregunta actualizada en encuesta {survey.id}")
     except (AttributeError, SurveyResponse.DoesNotExist, Exception):
         # La respuesta padre ya fue eliminada, ignorar silenciosamente
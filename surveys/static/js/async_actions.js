@@ -223,6 +223,16 @@ const AsyncManager = {
                 // Mostrar mensaje de error
                 const card = document.getElementById(`job-card-${jobId}`);
                 card.innerHTML += `<small class="text-danger d-block">${data.error_message}</small>`;
+            } else if (data.status === 'cancelled') {
+                clearInterval(interval);
+                statusText.innerText = '⏹️ Cancelada';
+                statusText.classList.add('text-warning');
+                progressBar.classList.remove('progress-bar-striped', 'progress-bar-animated');
+                progressBar.classList.add('bg-warning');
+            } else if (data.progress) {
+                // Avance real reportado por la tarea (bytes leídos del CSV)
+                progressBar.style.width = `${data.progress}%`;
+                statusText.innerText = `Procesando... ${data.progress}% (${data.processed_rows || 0} filas)`;
             }
         }, 1500);
     }
@@ -1,10 +1,12 @@
 import logging
 import os
 import gc
+import time
 from celery import shared_task
 from django.contrib.auth import get_user_model
 from django.core.cache import cache
 from django.core.files.uploadedfile import SimpleUploadedFile
+from django.utils import timezone
 
 # Monitoreo de recursos
 from core.utils.memory_monitor import (
@@ -17,6 +19,28 @@ from core.utils.memory_monitor import (
 logger = logging.getLogger(__name__)
 User = get_user_model()
 
+# Cancelación de importaciones: la vista marca la llave en el cache (compartido
+# entre web y workers) y la tarea la revisa en cada reporte de avance
+IMPORT_CANCEL_KEY = "import_cancel:{}"
+IMPORT_OWNER_KEY = "import_owner:{}"
+IMPORT_KEY_TIMEOUT = 6 * 3600
+# Segundos mínimos entre actualizaciones del estado PROGRESS
+IMPORT_PROGRESS_INTERVAL = 1.0
+
+
+def register_import_owner(task_id: str, user_id: int) -> None:
+    """Recuerda quién lanzó la importación (solo esa persona puede cancelarla)."""
+    cache.set(IMPORT_OWNER_KEY.format(task_id), user_id, IMPORT_KEY_TIMEOUT)
+
+
+def request_import_cancel(task_id: str, user_id: int) -> bool:
+    """Pide cancelar la importación `task_id`; False si no es de `user_id`."""
+    if cache.get(IMPORT_OWNER_KEY.format(task_id)) != user_id:
+        return False
+    cache.set(IMPORT_CANCEL_KEY.format(task_id), True, IMPORT_KEY_TIMEOUT)
+    return True
+
+
 def _run_import_job_by_id(job_id: int) -> dict:
     """Compatibilidad para la suite de tests: procesa un ImportJob por id."""
     from surveys.models import ImportJob
@@ -41,7 +65,20 @@ def _run_import_job_by_id(job_id: int) -> dict:
         with open(job.csv_file, "rb") as fh:
             content = fh.read()
         upload = SimpleUploadedFile(job.original_filename or os.path.basename(job.csv_file), content, content_type="text/csv")
-        survey, total_rows, _info = _process_single_csv_import(upload, job.user)
+        reported = {'at': 0.0}
+
+        def on_progress(rows, total_rows):
+            # Avance visible en el estado del job mientras importa (a lo más
+            # una escritura por intervalo)
+            now = time.monotonic()
+            if now - reported['at'] < IMPORT_PROGRESS_INTERVAL:
+                return
+            reported['at'] = now
+            ImportJob.objects.filter(id=job.id).update(
+                processed_rows=rows, total_rows=total_rows, updated_at=timezone.now(),
+            )
+
+        survey, total_rows, _info = _process_single_csv_import(upload, job.user, progress=on_progress)
 
         job.survey = survey
         job.total_rows = total_rows
@@ -61,11 +98,22 @@ def _run_import_job_by_id(job_id: int) -> dict:
 
 @shared_task(bind=True)
 @memory_guard(max_memory_mb=500)  # Límite de 500MB por importación
-def process_survey_import(self, survey_id: int = None, file_path: str = None, filename: str = None, user_id: int = None) -> dict:
+def process_survey_import(self, survey_id: int = None, file_path: str = None, filename: str = None, user_id: int = None,
+                          responses_since: str = None, responses_until: str = None) -> dict:
     """
     Tarea Celery optimizada para importación con monitoreo de memoria.
     Soporta múltiples importaciones simultáneas en 4GB RAM.
 
+    `responses_since` / `responses_until` (fechas ISO) limitan la importación a
+    las respuestas en ese rango según la columna de fecha del CSV (reimportaciones
+    parciales); el filtro se aplica en C++ al parsear.
+
+    Publica el avance como estado PROGRESS ({'progress': %, 'processed_rows'})
+    y se puede cancelar con request_import_cancel: la llave se revisa también
+    durante la muestra y el descubrimiento de opciones, la lectura nativa se
+    corta en el siguiente chunk y la tarea termina con status CANCELLED. Los
+    chunks ya confirmados quedan importados.
+
     También permite invocarse con solo el id de ImportJob (modo tests).
     """
     # Modo compatibilidad con tests: solo se pasa job_id
@@ -77,13 +125,56 @@ def process_survey_import(self, survey_id: int = None, file_path: str = None, fi
     
     # Importación local para evitar ciclos y asegurar carga de apps
     from surveys.models import Survey
-    from surveys.utils.bulk_import import bulk_import_responses_postgres
-    
+    from surveys.utils.bulk_import import bulk_import_responses_postgres, cpp_csv
+
+    task_id = self.request.id
+    cancel = cpp_csv.CancelToken()
+    done = {'rows': 0, 'reported_at': 0.0, 'checked_at': 0.0}
+
+    def poll_cancel():
+        # Lee la llave a lo más una vez por intervalo; True si se pidió cancelar
+        now = time.monotonic()
+        if not task_id or now - done['checked_at'] < IMPORT_PROGRESS_INTERVAL:
+            return cancel.cancelled
+        done['checked_at'] = now
+        if cache.get(IMPORT_CANCEL_KEY.format(task_id)):
+            cancel.cancel()
+        return cancel.cancelled
+
+    def on_scan(rows, bytes_read, total_bytes):
+        # Muestra y descubrimiento de opciones: aún no hay filas importadas
+        poll_cancel()
+
+    def on_progress(rows, bytes_read, total_bytes):
+        done['rows'] = rows
+        now = time.monotonic()
+        if not task_id or now - done['reported_at'] < IMPORT_PROGRESS_INTERVAL:
+            return
+        done['reported_at'] = now
+        if poll_cancel():
+            return
+        percent = int(bytes_read * 100 / total_bytes) if total_bytes else 0
+        self.update_state(state='PROGRESS', meta={'progress': min(percent, 99), 'processed_rows': rows})
+
     try:
         survey = Survey.objects.get(id=survey_id)
+        if task_id and cache.get(IMPORT_CANCEL_KEY.format(task_id)):
+            cancel.cancel()
 
         # Llamada a la función que usa C++ internamente
-        result = bulk_import_responses_postgres(file_path, survey)
+        try:
+            result = bulk_import_responses_postgres(
+                file_path, survey, responses_since=responses_since, responses_until=responses_until,
+                progress=on_progress, cancel=cancel, scan_progress=on_scan,
+            )
+        except cpp_csv.OperationCancelled:
+            logger.warning("[TASK][IMPORT] Cancelada para encuesta %s tras %s filas", survey_id, done['rows'])
+            return {
+                'status': 'CANCELLED',
+                'processed_rows': done['rows'],
+                'survey_public_id': survey.public_id,
+                'message': 'Importación cancelada; las filas ya procesadas se conservan.'
+            }
 
         # Si retorna dict con errores de validación, propagarlo
         if isinstance(result, dict) and not result.get('success', True):
@@ -101,6 +192,13 @@ def process_survey_import(self, survey_id: int = None, file_path: str = None, fi
             imported_rows,
         )
 
+        # Deja listo el cubo columnar para que el primer tablero no lo construya
+        try:
+            from core.services.survey_cube import SurveyCubeService
+            SurveyCubeService.get_cube(survey)
+        except Exception:
+            logger.warning("[TASK][IMPORT] No se pudo preparar el cubo de la encuesta %s", survey_id, exc_info=True)
+
         return {
             'status': 'SUCCESS',
             'imported_count': imported_rows,
@@ -119,6 +217,9 @@ def process_survey_import(self, survey_id: int = None, file_path: str = None, fi
         raise
         
     finally:
+        if task_id:
+            cache.delete_many([IMPORT_CANCEL_KEY.format(task_id), IMPORT_OWNER_KEY.format(task_id)])
+
         # Siempre limpiar el archivo temporal
         if file_path and os.path.exists(file_path):
             try:
@@ -156,6 +257,9 @@ def delete_surveys_task(survey_ids: list, user_id: int = None):
             pass
     
     if result['status'] == 'SUCCESS':
+        from core.services.survey_cube import SurveyCubeService
+        for survey_id in survey_ids:
+            SurveyCubeService.discard(survey_id)
         logger.info("[TASK][DELETE] ✅ Completado - %s encuestas eliminadas", result['deleted'])
     else:
         logger.error("[TASK][DELETE] ❌ Error: %s", result.get('error', 'Unknown'))
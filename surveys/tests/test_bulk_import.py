@@ -0,0 +1,81 @@
+"""
+Tests de la preparación de preguntas y opciones de la importación masiva
+(surveys.utils.bulk_import). El COPY necesita Postgres, así que aquí se prueba
+_prepare_questions_map directamente; requiere cpp_csv compilado.
+"""
+import pytest
+from django.contrib.auth import get_user_model
+
+pytest.importorskip("tools.cpp_csv.pybind_csv")
+
+from surveys.models import AnswerOption, Question, Survey  # noqa: E402
+from surveys.utils.bulk_import import _prepare_questions_map  # noqa: E402
+
+
+def _departments_csv(tmp_path):
+    # Las primeras filas (la muestra) solo traen 3 departamentos; el archivo
+    # completo trae 40 distintos.
+    rows = [{'Departamento': ['Ventas', 'IT', 'RRHH'][i % 3]} for i in range(60)]
+    rows += [{'Departamento': f'Depto {i}'} for i in range(40)]
+    path = tmp_path / 'departamentos.csv'
+    path.write_text('Departamento\n' + '\n'.join(r['Departamento'] for r in rows) + '\n', encoding='utf-8')
+    return str(path), rows
+
+
+@pytest.fixture
+def survey(db):
+    user = get_user_model().objects.create_user(username='bulkuser', password='pass')
+    return Survey.objects.create(author=user, title='Importada')
+
+
+@pytest.mark.django_db
+def test_new_choice_column_with_too_many_values_becomes_text(survey, tmp_path, settings):
+    settings.SURVEY_IMPORT_MAX_OPTIONS = 10
+    path, rows = _departments_csv(tmp_path)
+
+    qmap = _prepare_questions_map(survey, ['Departamento'], rows[:50], None, file_path=path)
+
+    assert qmap['Departamento']['dtype'] == 'text'
+    assert survey.questions.get(text='Departamento').type == 'text'
+    assert not AnswerOption.objects.filter(question__survey=survey).exists()
+
+
+@pytest.mark.django_db
+def test_existing_choice_question_keeps_type_on_reimport(survey, tmp_path, settings):
+    settings.SURVEY_IMPORT_MAX_OPTIONS = 10
+    question = Question.objects.create(survey=survey, text='Departamento', type='single', order=1)
+    ventas = AnswerOption.objects.create(question=question, text='Ventas')
+    it = AnswerOption.objects.create(question=question, text='IT')
+    path, rows = _departments_csv(tmp_path)
+
+    qmap = _prepare_questions_map(survey, ['Departamento'], rows[:50], None, file_path=path)
+
+    question.refresh_from_db()
+    assert question.type == 'single'
+    assert qmap['Departamento']['dtype'] == 'single'
+    # Las opciones conocidas se siguen mapeando; no se crean las 40 nuevas
+    assert {text: opt.id for text, opt in qmap['Departamento']['options'].items()} == {
+        'Ventas': ventas.id, 'IT': it.id,
+    }
+    assert AnswerOption.objects.filter(question=question).count() == 2
+
+
+@pytest.mark.django_db
+def test_scan_progress_can_cancel_option_discovery(survey, tmp_path):
+    # El callback de la pasada de descubrimiento cancela y la pasada se corta
+    from surveys.utils.bulk_import import cpp_csv
+
+    path = tmp_path / 'grande.csv'
+    path.write_text('Opcion\n' + ''.join(f'o{i % 5}\n' for i in range(200000)), encoding='utf-8')
+    cancel = cpp_csv.CancelToken()
+    calls = []
+
+    def on_scan(rows, bytes_read, total_bytes):
+        calls.append(rows)
+        cancel.cancel()
+
+    with pytest.raises(cpp_csv.OperationCancelled):
+        _prepare_questions_map(survey, ['Opcion'], [{'Opcion': f'o{i % 5}'} for i in range(50)], None,
+                               file_path=str(path), cancel=cancel, scan_progress=on_scan)
+
+    assert calls
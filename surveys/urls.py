@@ -33,6 +33,7 @@ urlpatterns = [
     
     # 3. Polling de Estado (Para ambos casos)
     path('task_status/<str:task_id>/', import_views.get_task_status_view, name='task_status'),
+    path('task_status/<str:task_id>/cancel/', import_views.cancel_task_view, name='task_cancel'),
     # Alias para compatibilidad con código JS antiguo si es necesario
     path('import-job/<str:task_id>/status/', import_views.get_task_status_view, name='import_job_status'),
 
@@ -77,6 +78,9 @@ urlpatterns = [
     
     path("<str:public_id>/api/crosstab/", report_views.api_crosstab_view, name="api_crosstab"),
     
+    path("<str:public_id>/api/keyword-context/", report_views.api_keyword_context_view, name="api_keyword_context"),
+    path("<str:public_id>/api/nps-segments/", report_views.api_nps_segments_view, name="api_nps_segments"),
+    
     path("<str:public_id>/api/save-segment/", report_views.save_analysis_segment_view, name="save_segment"),
     
     # Detalle (Al final)
@@ -1,5 +1,4 @@
-import csv
-import io
+import os
 import re
 import logging
 from typing import Optional, Tuple, List, Any, Dict
@@ -21,8 +20,19 @@ from django.db import connection, transaction
 from django.utils import timezone
 from dateutil import parser
 
+from core.utils.logging_utils import log_cpp_csv_stats
+from core.utils import tracing
+from core.utils.memory_monitor import log_native_memory, native_memory_budget
+from core.utils.pgcopy import build_copy_encoder, copy_binary, copy_types
 from surveys.models import SurveyResponse, QuestionResponse, Question, AnswerOption
 
+# Columnas de QuestionResponse que se cargan con COPY, en este orden
+QR_COPY_FIELDS = ('survey_response_id', 'question_id', 'selected_option_id', 'text_value', 'numeric_value')
+
+# Equivalente en patrones de cpp_csv (glob, sin mayúsculas) de _is_metadata_column:
+# esas columnas se descartan al parsear en lugar de convertirse a str
+METADATA_DROP_PATTERNS = ('id', 'pk', 'unnamed*')
+
 # =============================================================================
 # Helpers de Limpieza y Detección
 # =============================================================================
@@ -41,6 +51,26 @@ def _is_metadata_column(header: str) -> bool:
     h = _normalize_header(header)
     return h in ('id', 'pk') or h.startswith('unnamed')
 
+def _row_filter(date_column: Optional[str], responses_since=None, responses_until=None,
+                where: Optional[Dict[str, Any]] = None) -> Optional[Dict[str, Any]]:
+    """
+    Filtro de filas para cpp_csv (`where`): rango sobre la columna de fecha
+    detectada más un filtro adicional. None si no hay nada que filtrar.
+    """
+    conditions = []
+    if responses_since or responses_until:
+        if not date_column:
+            raise ValueError("El CSV no tiene una columna de fecha para filtrar respuestas por fecha")
+        if responses_since:
+            conditions.append({'column': date_column, 'op': '>=', 'value': responses_since, 'type': 'date'})
+        if responses_until:
+            conditions.append({'column': date_column, 'op': '<=', 'value': responses_until, 'type': 'date'})
+    if where:
+        conditions.append(where)
+    if not conditions:
+        return None
+    return conditions[0] if len(conditions) == 1 else {'and': conditions}
+
 def parse_date_safe(value: str) -> Optional[Any]:
     """Intenta parsear una fecha desde string."""
     if not value:
@@ -93,9 +123,43 @@ def _infer_column_type(header: str, sample_values: List[str]) -> str:
 
     return 'text'
 
-def _prepare_questions_map(survey, headers: List[str], rows: List[Dict[str, str]], date_col: str) -> Dict[str, Any]:
+def _phase_stats() -> Optional[Dict[str, Any]]:
+    """
+    dict para los contadores por fase de cpp_csv si CPP_CSV_IMPORT_STATS está
+    activo; si no None (medirlos cuesta ~15-20% del parseo). Dentro de
+    pybind_csv.collect_stats() se miden de todos modos.
+    """
+    return {} if getattr(settings, "CPP_CSV_IMPORT_STATS", False) else None
+
+def _discover_options(file_path: str, cols_analysis: List[Dict[str, Any]], cancel=None,
+                      where=None, progress=None) -> Dict[str, Any]:
+    """
+    Cuenta en C++ los valores distintos de las columnas single/multi en todo
+    el archivo, no solo en la muestra. Con `where` solo cuenta las filas que
+    se van a importar. `progress` se llama durante la pasada (puede ser desde
+    un hilo nativo); si cancela `cancel`, la pasada se corta.
+    """
+    choice_cols = [item['col_name'] for item in cols_analysis if item['dtype'] in ('single', 'multi')]
+    if not choice_cols:
+        return {}
+    multi_cols = [item['col_name'] for item in cols_analysis if item['dtype'] == 'multi']
+    max_options = getattr(settings, "SURVEY_IMPORT_MAX_OPTIONS", 200)
+    discover_stats = _phase_stats()
+    options = cpp_csv.discover_column_values(
+        file_path, columns=choice_cols, multi_columns=multi_cols, max_distinct=max_options,
+        stats=discover_stats, progress=progress, cancel=cancel, where=where,
+    )
+    log_cpp_csv_stats("DISCOVER", discover_stats, logger=logger)
+    return options
+
+def _prepare_questions_map(survey, headers: List[str], rows: List[Dict[str, str]], date_col: str,
+                           file_path: Optional[str] = None, cancel=None, where=None,
+                           scan_progress=None) -> Dict[str, Any]:
     """
     Asegura que existan las preguntas en la BD y retorna un mapa para la importación.
+    Si se da `file_path`, las opciones se descubren sobre el archivo completo
+    (solo las filas que cumplen `where`, el mismo filtro de la importación);
+    `scan_progress` es el callback de avance de esa pasada.
     """
     questions_map = {}
     
@@ -132,6 +196,27 @@ def _prepare_questions_map(survey, headers: List[str], rows: List[Dict[str, str]
             'sample': sample
         })
 
+    # Opciones del archivo completo: una columna single/multi nueva con
+    # demasiados valores distintos en realidad es texto libre. Una pregunta
+    # que ya existe conserva su tipo (sus gráficas y cruces dependen de las
+    # opciones): se mapean las opciones conocidas y el resto queda como
+    # respuesta abierta.
+    discovered = _discover_options(file_path, cols_analysis, cancel=cancel, where=where,
+                                   progress=scan_progress) if file_path else {}
+    for item in cols_analysis:
+        info = discovered.get(item['col_name'])
+        if not info or not info['free_text']:
+            continue
+        if item['question'].id is None:
+            item['dtype'] = 'text'
+            item['question'].type = 'text'
+        elif item['dtype'] in ('single', 'multi'):
+            logger.warning(
+                "[IMPORT][OPTIONS] '%s' tiene más de %s valores distintos; se conserva como %s "
+                "y los valores sin opción se guardan como texto",
+                item['col_name'], getattr(settings, "SURVEY_IMPORT_MAX_OPTIONS", 200), item['dtype'],
+            )
+
     # Crear preguntas nuevas en masa
     if questions_to_create:
         Question.objects.bulk_create(questions_to_create)
@@ -159,15 +244,19 @@ def _prepare_questions_map(survey, headers: List[str], rows: List[Dict[str, str]
             if q.id not in options_cache:
                 options_cache[q.id] = {}
             
-            # Detectar opciones únicas en la muestra
-            unique_vals = set()
-            for r in rows:
-                val = r.get(item['col_name'], '')
-                if not val: continue
-                parts = [val] if item['dtype'] == 'single' else val.replace(';', ',').split(',')
-                for p in parts:
-                    clean = p.strip()
-                    if clean: unique_vals.add(clean)
+            if item['col_name'] in discovered:
+                # Opciones únicas en todo el archivo (ya limpias)
+                unique_vals = discovered[item['col_name']]['values'].keys()
+            else:
+                # Detectar opciones únicas en la muestra
+                unique_vals = set()
+                for r in rows:
+                    val = r.get(item['col_name'], '')
+                    if not val: continue
+                    parts = [val] if item['dtype'] == 'single' else cpp_csv.split_multi_select(val)
+                    for p in parts:
+                        clean = p.strip()
+                        if clean: unique_vals.add(clean)
             
             for val_text in unique_vals:
                 if val_text not in options_cache[q.id]:
@@ -190,10 +279,16 @@ def _prepare_questions_map(survey, headers: List[str], rows: List[Dict[str, str]
     # Construir mapa final
     for item in cols_analysis:
         q = item['question']
+        options = options_cache.get(q.id, {})
         questions_map[item['col_name']] = {
             'question': q,
             'dtype': item['dtype'],
-            'options': options_cache.get(q.id, {})
+            'options': options,
+            # Las columnas multi se mapean por columna completa en C++
+            'multi_mapper': (
+                cpp_csv.build_multi_select_mapper({text: opt.id for text, opt in options.items()})
+                if item['dtype'] == 'multi' else None
+            ),
         }
         
     return questions_map
@@ -202,20 +297,67 @@ def _prepare_questions_map(survey, headers: List[str], rows: List[Dict[str, str]
 # Función Principal
 # =============================================================================
 
-def bulk_import_responses_postgres(file_path: str, survey) -> Tuple[int, int]:
+def bulk_import_responses_postgres(file_path: str, survey, responses_since=None, responses_until=None,
+                                   where: Optional[Dict[str, Any]] = None,
+                                   trace: Optional[bool] = None, progress=None,
+                                   cancel=None, scan_progress=None) -> Tuple[int, int]:
     """
     Importación optimizada usando C++ para lectura en streaming y COPY para escritura.
     Optimizado para 4GB RAM y múltiples importaciones simultáneas.
+
+    `responses_since` / `responses_until` (fecha o texto ISO) y `where` (filtro
+    de cpp_csv, ver pybind_csv.read_csv_dicts) limitan qué filas se importan;
+    el filtro se evalúa en C++ sobre las celdas crudas, así que el costo crece
+    con las filas que pasan y no con el tamaño del archivo.
+
+    Con `trace` (por defecto CPP_CSV_TRACE_IMPORTS) y CPP_CSV_TRACE_DIR se
+    guarda la línea de tiempo de la importación (etapas de Python y spans
+    nativos de cpp_csv) como JSON de Chrome Trace Event.
+
+    `progress(filas, bytes_leídos, bytes_totales)` se llama después de cada
+    chunk confirmado. Con `cancel` (cpp_csv.CancelToken) la lectura nativa
+    se corta en el siguiente chunk y se lanza cpp_csv.OperationCancelled; los
+    chunks ya confirmados quedan en la base.
+
+    `scan_progress(filas, bytes_leídos, bytes_totales)` cubre las pasadas
+    previas al COPY, que no confirman filas: se llama tras la muestra y
+    durante el descubrimiento de opciones (desde hilos nativos), para que
+    quien llama pueda cancelar `cancel` también en esas fases.
     """
+    if trace is None:
+        trace = getattr(settings, "CPP_CSV_TRACE_IMPORTS", False)
+    with tracing.trace_to_file(f"import-{survey.id}", enabled=trace):
+        with tracing.span("import.bulk_import", survey=survey.id):
+            return _bulk_import_responses_postgres(file_path, survey, responses_since, responses_until, where,
+                                                   progress, cancel, scan_progress)
+
+
+def _bulk_import_responses_postgres(file_path, survey, responses_since, responses_until, where,
+                                    progress=None, cancel=None, scan_progress=None):
     import gc  # Para liberar memoria explícitamente
     
     # 1. Lectura con C++ - Usar sampling para preparación inicial
     logger.info("[IMPORT][MEMORY] Iniciando importación optimizada para 4GB")
     
     try:
-        # Primero leer solo una muestra para analizar estructura
+        # Primero leer solo una muestra para analizar estructura: el primer
+        # chunk del lector, sin convertir el resto del archivo. cpp_csv respeta
+        # lo que le queda al memory_guard de la tarea (MemoryError si no alcanza)
         sample_size = min(getattr(settings, "SURVEY_IMPORT_SAMPLE_SIZE", 5000), 5000)
-        sample_rows = cpp_csv.read_csv_dicts(file_path)[:sample_size]
+        with tracing.span("import.sample"), cpp_csv.iter_csv_dict_chunks(
+            file_path, chunk_size=sample_size, prefetch=1, drop_patterns=METADATA_DROP_PATTERNS,
+            memory_limit=native_memory_budget(), stats=_phase_stats(), cancel=cancel,
+        ) as sample_reader:
+            sample_rows = next(sample_reader, [])
+        # Memoria siempre; los contadores por fase solo si se pidieron
+        sample_stats = sample_reader.stats
+        log_native_memory("bulk_import.sample", sample_stats)
+        log_cpp_csv_stats("SAMPLE", sample_stats, logger=logger)
+        if scan_progress is not None:
+            # El iterador no reporta avance: la muestra es un solo chunk, se
+            # reporta al terminarla (una cancelación pedida durante la muestra
+            # corta el descubrimiento antes de empezar)
+            scan_progress(len(sample_rows), sample_stats.get('bytes_read', 0), os.path.getsize(file_path))
         
         if not sample_rows:
             logger.warning("[IMPORT] CSV vacío o sin datos válidos")
@@ -223,6 +365,8 @@ def bulk_import_responses_postgres(file_path: str, survey) -> Tuple[int, int]:
             
         headers = list(sample_rows[0].keys())
         
+    except cpp_csv.OperationCancelled:
+        raise
     except Exception:
         logger.exception("[IMPORT][ERROR] Error leyendo CSV con módulo C++")
         raise
@@ -233,10 +377,15 @@ def bulk_import_responses_postgres(file_path: str, survey) -> Tuple[int, int]:
         if _is_date_column(h):
             date_column = h
             break
+    row_filter = _row_filter(date_column, responses_since, responses_until, where)
+    if row_filter:
+        logger.info("[IMPORT][FILTER] Importando solo filas que cumplen %s", row_filter)
             
     # 3. Preparar Estructura (Preguntas y Opciones) - solo con muestra
     logger.info("[IMPORT][PREP] Preparando estructura con muestra de %s filas", len(sample_rows))
-    questions_map = _prepare_questions_map(survey, headers, sample_rows, date_column)
+    with tracing.span("import.prepare_questions", columns=len(headers)):
+        questions_map = _prepare_questions_map(survey, headers, sample_rows, date_column, file_path=file_path,
+                                               cancel=cancel, where=row_filter, scan_progress=scan_progress)
     
     # Liberar memoria de la muestra
     del sample_rows
@@ -246,151 +395,180 @@ def bulk_import_responses_postgres(file_path: str, survey) -> Tuple[int, int]:
     chunk_size = getattr(settings, "SURVEY_IMPORT_CHUNK_SIZE", 2500)  # Más pequeño para 4GB
     total_rows_processed = 0
     final_rows_inserted = 0
+    total_bytes = os.path.getsize(file_path)
     
     logger.info("[IMPORT][START] Procesando archivo completo con chunks de %s", chunk_size)
     
-    # Leer archivo completo de una vez (cpp_csv es eficiente)
+    # Lectura en pipeline: cpp_csv parsea el siguiente chunk en un hilo nativo
+    # mientras aquí se mapean filas y se ejecuta el COPY del chunk actual.
+    prefetch = getattr(settings, "SURVEY_IMPORT_PREFETCH_CHUNKS", 2)
+    # Solo se construyen las columnas mapeadas a preguntas y la de fecha
+    usecols = list(questions_map)
+    if date_column and date_column not in questions_map:
+        usecols.append(date_column)
     try:
-        all_rows = cpp_csv.read_csv_dicts(file_path)
-        total_rows = len(all_rows)
-        logger.info("[IMPORT][LOADED] %s filas cargadas desde CSV", total_rows)
+        # Contadores por fase del parseo (io / tokenize / filter / convert / wait)
+        # solo si se pidieron; chunk_reader.stats trae siempre memoria y bytes_read
+        chunk_reader = cpp_csv.iter_csv_dict_chunks(
+            file_path, chunk_size=chunk_size, prefetch=prefetch, usecols=usecols, where=row_filter,
+            memory_limit=native_memory_budget(), stats=_phase_stats(), cancel=cancel,
+        )
     except Exception:
         logger.exception("[IMPORT][ERROR] Error en lectura completa")
         raise
     
+    # Un codificador de COPY binario por importación: sus buffers se reutilizan entre chunks
+    copy_encoder = build_copy_encoder(copy_types(QuestionResponse, QR_COPY_FIELDS, connection))
+
     # Procesar en chunks para controlar memoria (MAGIA NEGRA™)
-    for chunk_idx, i in enumerate(range(0, total_rows, chunk_size)):
-        chunk_rows = all_rows[i : i + chunk_size]
-        chunk_size_actual = len(chunk_rows)
-        
-        logger.info(
-            "[IMPORT][CHUNK %s] Procesando %s filas (offset %s)",
-            chunk_idx,
-            chunk_size_actual,
-            i,
-        )
-        
-        with transaction.atomic():
-            # A. Crear SurveyResponses con bulk_create optimizado
-            sr_objects = []
-            for row in chunk_rows:
-                dt = timezone.now()
-                if date_column and row.get(date_column):
-                    parsed = parse_date_safe(row[date_column])
-                    if parsed: 
-                        if timezone.is_naive(parsed):
-                            parsed = timezone.make_aware(parsed)
-                        dt = parsed
-                
-                sr_objects.append(SurveyResponse(survey=survey, created_at=dt, is_anonymous=True))
-            
-            # bulk_create sin retrieve de IDs cuando no es necesario
-            created_srs = SurveyResponse.objects.bulk_create(sr_objects, batch_size=1000)
-            
-            # B. Preparar buffer para COPY
-            qr_buffer = io.StringIO()
-            qr_writer = csv.writer(qr_buffer, delimiter="\t", quotechar='"', quoting=csv.QUOTE_MINIMAL)
-            
-            batch_qr_count = 0
-            
-            for idx, row in enumerate(chunk_rows):
-                sr_id = created_srs[idx].id
-                
-                for col_name, val_str in row.items():
-                    # Ignorar metadatos o columnas no mapeadas
-                    if col_name not in questions_map:
-                        continue
-                        
-                    val_str = val_str.strip()
-                    if not val_str:
-                        continue
-                        
-                    q_map = questions_map[col_name]
-                    q_id = q_map['question'].id
-                    dtype = q_map['dtype']
-                    options = q_map['options']
-                    
-                    # Valores por defecto para COPY (\N es NULL en postgres text format)
-                    so_id = "\\N"
-                    text_val = "\\N"
-                    num_val = "\\N"
-                    
-                    # Lógica de mapeo según tipo
-                    if dtype in ('single', 'multi'):
-                        # Intentar separar si es multi
-                        parts = [val_str] if dtype == 'single' else val_str.replace(';', ',').split(',')
-                        for p in parts:
-                            p_clean = p.strip()
-                            if not p_clean: continue
-                            
-                            if p_clean in options:
+    with chunk_reader:
+        for chunk_idx, chunk_rows in enumerate(chunk_reader):
+            chunk_size_actual = len(chunk_rows)
+
+            logger.info(
+                "[IMPORT][CHUNK %s] Procesando %s filas (offset %s)",
+                chunk_idx,
+                chunk_size_actual,
+                total_rows_processed,
+            )
+
+            chunk_start = tracing.now_ns()
+            with transaction.atomic():
+                # A. Crear SurveyResponses con bulk_create optimizado
+                sr_objects = []
+                for row in chunk_rows:
+                    dt = timezone.now()
+                    if date_column and row.get(date_column):
+                        parsed = parse_date_safe(row[date_column])
+                        if parsed:
+                            if timezone.is_naive(parsed):
+                                parsed = timezone.make_aware(parsed)
+                            dt = parsed
+
+                    sr_objects.append(SurveyResponse(survey=survey, created_at=dt, is_anonymous=True))
+
+                # bulk_create sin retrieve de IDs cuando no es necesario
+                created_srs = SurveyResponse.objects.bulk_create(sr_objects, batch_size=1000)
+
+                # B. Preparar columnas para COPY binario (None es NULL)
+                qr_columns = ([], [], [], [], [])
+                sr_col, q_col, so_col, text_col, num_col = qr_columns
+
+                def add_qr(sr_id, q_id, so_id, text_val, num_val):
+                    sr_col.append(sr_id)
+                    q_col.append(q_id)
+                    so_col.append(so_id)
+                    text_col.append(text_val)
+                    num_col.append(num_val)
+
+                batch_qr_count = 0
+
+                for idx, row in enumerate(chunk_rows):
+                    sr_id = created_srs[idx].id
+
+                    for col_name, val_str in row.items():
+                        # Ignorar metadatos o columnas no mapeadas
+                        if col_name not in questions_map:
+                            continue
+
+                        val_str = val_str.strip()
+                        if not val_str:
+                            continue
+
+                        q_map = questions_map[col_name]
+                        q_id = q_map['question'].id
+                        dtype = q_map['dtype']
+                        options = q_map['options']
+
+                        text_val = None
+                        num_val = None
+
+                        # Lógica de mapeo según tipo
+                        if dtype == 'multi':
+                            continue # Se mapea por columna completa después del loop
+
+                        if dtype == 'single':
+                            if val_str in options:
                                 # Opción encontrada
-                                qr_writer.writerow([sr_id, q_id, options[p_clean].id, "\\N", "\\N"])
+                                add_qr(sr_id, q_id, options[val_str].id, None, None)
                             else:
                                 # Opción abierta/otra
-                                clean_txt = p_clean.replace("\n", " ").replace("\r", "")[:2000]
-                                qr_writer.writerow([sr_id, q_id, "\\N", clean_txt, "\\N"])
+                                clean_txt = val_str.replace("\n", " ").replace("\r", "")[:2000]
+                                add_qr(sr_id, q_id, None, clean_txt, None)
                             batch_qr_count += 1
-                        continue # Ya escribimos las filas para esta columna
-                        
-                    elif dtype in ('number', 'scale'):
-                        # Intentar sacar número
-                        try:
-                            clean_num_str = re.sub(r'[^\d\.\-]', '', val_str.replace(',', '.'))
-                            if clean_num_str:
-                                num_val = int(float(clean_num_str))
-                            else:
+                            continue # Ya escribimos las filas para esta columna
+
+                        elif dtype in ('number', 'scale'):
+                            # Intentar sacar número
+                            try:
+                                clean_num_str = re.sub(r'[^\d\.\-]', '', val_str.replace(',', '.'))
+                                if clean_num_str:
+                                    num_val = int(float(clean_num_str))
+                                else:
+                                    text_val = val_str.replace("\n", " ").replace("\r", "")[:2000]
+                            except (ValueError, TypeError):
                                 text_val = val_str.replace("\n", " ").replace("\r", "")[:2000]
-                        except (ValueError, TypeError):
-                            text_val = val_str.replace("\n", " ").replace("\r", "")[:2000]
-                            
-                    else: # Texto
-                        text_val = val_str.replace("\n", " ").replace("\r", "")[:5000]
 
-                    qr_writer.writerow([sr_id, q_id, so_id, text_val, num_val])
-                    batch_qr_count += 1
+                        else: # Texto
+                            text_val = val_str.replace("\n", " ").replace("\r", "")[:5000]
 
-            final_rows_inserted += batch_qr_count
-            logger.info("[IMPORT][CHUNK %s] Insertadas %s respuestas", chunk_idx, batch_qr_count)
-            
-            # C. Ejecutar COPY con acceso al cursor nativo (MAGIA NEGRA™)
-            qr_buffer.seek(0)
-            table_name = QuestionResponse._meta.db_table
-            sql = f"COPY {table_name} (survey_response_id, question_id, selected_option_id, text_value, numeric_value) FROM STDIN WITH (FORMAT CSV, DELIMITER '\t', QUOTE '\"', NULL '\\N')"
-            
-            with connection.cursor() as cursor:
-                try:
-                    raw_cursor = getattr(cursor, 'cursor', cursor) 
-
-                    # Psycopg2 o Psycopg 3
-                    if hasattr(raw_cursor, 'copy_expert'):
-                        raw_cursor.copy_expert(sql, qr_buffer)
-                    elif hasattr(raw_cursor, 'copy'):
-                        with raw_cursor.copy(sql) as copy:
-                            copy.write(qr_buffer.read())
-                    else:
+                        add_qr(sr_id, q_id, None, text_val, num_val)
+                        batch_qr_count += 1
+
+                # Columnas multi: C++ divide, limpia y mapea toda la columna del chunk
+                for col_name, q_map in questions_map.items():
+                    mapper = q_map['multi_mapper']
+                    if mapper is None:
+                        continue
+                    q_id = q_map['question'].id
+                    mapped = mapper.map([row.get(col_name, '') for row in chunk_rows])
+
+                    for row_idx, option_id in zip(mapped['rows'], mapped['option_ids']):
+                        add_qr(created_srs[row_idx].id, q_id, option_id, None, None)
+
+                    for row_idx, token in zip(mapped['unknown_rows'], mapped['unknown_tokens']):
+                        # Opción abierta/otra
+                        clean_txt = token.replace("\n", " ").replace("\r", "")[:2000]
+                        add_qr(created_srs[row_idx].id, q_id, None, clean_txt, None)
+
+                    batch_qr_count += len(mapped['rows']) + len(mapped['unknown_rows'])
+
+                final_rows_inserted += batch_qr_count
+                logger.info("[IMPORT][CHUNK %s] Insertadas %s respuestas", chunk_idx, batch_qr_count)
+
+                tracing.mark("import.map_chunk", chunk_start, chunk=chunk_idx, rows=chunk_size_actual)
+
+                # C. Ejecutar COPY binario con acceso al cursor nativo (MAGIA NEGRA™)
+                copy_start = tracing.now_ns()
+                qr_payload = copy_encoder.encode(list(qr_columns))
+
+                with connection.cursor() as cursor:
+                    try:
+                        copy_binary(cursor, QuestionResponse._meta.db_table, QR_COPY_FIELDS, qr_payload)
+                    except NotImplementedError:
                         logger.error("[IMPORT][ERROR] Driver no soporta COPY masivo")
-                        raise NotImplementedError("Driver incompatible con COPY")
-                        
-                except Exception:
-                    logger.exception("[IMPORT][ERROR] Error crítico en COPY")
-                    raise
-        
-        # Liberar memoria después de cada chunk (MAGIA NEGRA™)
-        total_rows_processed += chunk_size_actual
-        del chunk_rows, sr_objects, created_srs
-        gc.collect()
-        
-        logger.info(
-            "[IMPORT][PROGRESS] %s/%s filas procesadas (%.1f%%)",
-            total_rows_processed,
-            total_rows,
-            (total_rows_processed / total_rows) * 100,
-        )
+                        raise
+                    except Exception:
+                        logger.exception("[IMPORT][ERROR] Error crítico en COPY")
+                        raise
+                tracing.mark("import.copy", copy_start, chunk=chunk_idx, responses=batch_qr_count)
 
-    # Liberar memoria final
-    del all_rows
-    gc.collect()
+            # Liberar memoria después de cada chunk (MAGIA NEGRA™)
+            total_rows_processed += chunk_size_actual
+            del chunk_rows, sr_objects, created_srs
+            gc.collect()
+
+            logger.info("[IMPORT][PROGRESS] %s filas procesadas", total_rows_processed)
+            if progress is not None:
+                # bytes_read va adelantado por los chunks en prefetch
+                bytes_read = chunk_reader.stats.get('bytes_read', 0)
+                progress(total_rows_processed, min(bytes_read, total_bytes), total_bytes)
+
+    read_stats = chunk_reader.stats
+    log_native_memory("bulk_import.read", read_stats)
+    log_cpp_csv_stats("READ", read_stats, logger=logger)
+
+    total_rows = total_rows_processed
     
     logger.info("[IMPORT][COMPLETE] Total: %s filas, %s respuestas insertadas", total_rows, final_rows_inserted)
     return total_rows, final_rows_inserted
\ No newline at end of file
@@ -114,12 +114,13 @@ def _save_uploaded_csv(upload) -> str:
     return tmp_path
 
 
-def _process_single_csv_import(upload, user):
+def _process_single_csv_import(upload, user, progress=None):
     """
     Synchronous helper used by the test suite to import a small CSV.
 
     It creates a survey plus minimal question responses and returns
-    (survey, total_rows, info_dict).
+    (survey, total_rows, info_dict). `progress(rows, total_rows)` is called
+    after each imported row.
     """
     from surveys.models import Survey, Question, AnswerOption, SurveyResponse, QuestionResponse
     from surveys.utils.bulk_import import _infer_column_type
@@ -222,6 +223,8 @@ def _process_single_csv_import(upload, user):
                         question=q,
                         text_value=raw_val,
                     )
+        if progress is not None:
+            progress(idx + 1, total_rows)
 
     info = {"created_questions": len(questions)}
     return survey, total_rows, info
@@ -272,42 +275,39 @@ def import_new_view(request: HttpRequest):
 # Servicios Síncronos (Lógica de Negocio + DB + Celery)
 # =============================================================================
 
-def service_create_import_job(user, uploaded_file, survey_title=None, is_bulk=False):
-    """
-    Maneja la creación de la encuesta, guardado de archivo y lanzamiento de Celery
-    de forma atómica y síncrona.
-    """
-    from surveys.tasks import process_survey_import
-    from surveys.utils.bulk_import import _infer_column_type
+def _import_sample_size():
+    return min(getattr(settings, "SURVEY_IMPORT_SAMPLE_SIZE", 5000), 5000)
 
-    # 1. Guardar archivo temporalmente
-    file_path = _save_uploaded_csv(uploaded_file)
 
-    # 2. Leer primeras filas para inferir esquema (con límite de muestra como en bulk_import)
-    sample_size = min(getattr(settings, "SURVEY_IMPORT_SAMPLE_SIZE", 5000), 5000)
-    rows = cpp_csv.read_csv_dicts(file_path)[:sample_size]
-    if not rows:
-        return {'success': False, 'error': 'El archivo CSV está vacío o no tiene datos válidos.'}
-    first_row = rows[0]
+def _infer_import_schema(rows):
+    """Esquema de validación (columna -> tipo) a partir de la muestra."""
+    from surveys.utils.bulk_import import _infer_column_type
+
     schema = {}
-    for col in first_row:
+    for col in rows[0]:
         # Tomar muestra de hasta 50 valores no vacíos
         sample = [str(r.get(col, '')) for r in rows[:50] if r.get(col, '')]
-        dtype = _infer_column_type(col, sample)
-        schema[col] = {'type': dtype}
+        schema[col] = {'type': _infer_column_type(col, sample)}
+    return schema
+
+
+def _validation_failure(validation_result):
+    return {
+        'success': False,
+        'error': 'Errores de validación en el archivo CSV.',
+        'validation_errors': validation_result['errors']
+    }
 
-    # 3. Validar todo el archivo con cpp_csv
-    validation_result = cpp_csv.read_and_validate_csv(file_path, schema)
-    if validation_result.get('errors'):
-        return {
-            'success': False,
-            'error': 'Errores de validación en el archivo CSV.',
-            'validation_errors': validation_result['errors']
-        }
+
+def _launch_import_job(user, filename, file_path, survey_title=None, is_bulk=False):
+    """
+    Crea la encuesta y lanza la tarea de Celery (DB + red; contexto síncrono).
+    """
+    from surveys.tasks import process_survey_import, register_import_owner
 
     # 4. Crear registro en DB solo si pasa validación
     with transaction.atomic():
-        title_to_use = survey_title or uploaded_file.name
+        title_to_use = survey_title or filename
         new_survey = Survey.objects.create(
             author=user,
             title=title_to_use,
@@ -320,23 +320,67 @@ def service_create_import_job(user, uploaded_file, survey_title=None, is_bulk=Fa
     task = process_survey_import.delay(
         survey_id=new_survey.id,
         file_path=file_path,
-        filename=uploaded_file.name,
+        filename=filename,
         user_id=user.id
     )
+    register_import_owner(task.id, user.id)
 
     return {
         'success': True,
         'job_id': task.id,
-        'filename': uploaded_file.name,
+        'filename': filename,
         'survey_public_id': new_survey.public_id,
         'survey_id': new_survey.id
     }
 
+
+def service_create_import_job(user, uploaded_file, survey_title=None, is_bulk=False):
+    """
+    Maneja la creación de la encuesta, guardado de archivo y lanzamiento de Celery
+    de forma atómica y síncrona.
+    """
+    # 1. Guardar archivo temporalmente
+    file_path = _save_uploaded_csv(uploaded_file)
+
+    # 2. Leer primeras filas para inferir esquema (con límite de muestra como en bulk_import)
+    rows = cpp_csv.read_csv_dicts(file_path)[:_import_sample_size()]
+    if not rows:
+        return {'success': False, 'error': 'El archivo CSV está vacío o no tiene datos válidos.'}
+    schema = _infer_import_schema(rows)
+
+    # 3. Validar todo el archivo con cpp_csv
+    validation_result = cpp_csv.read_and_validate_csv(file_path, schema)
+    if validation_result.get('errors'):
+        return _validation_failure(validation_result)
+
+    return _launch_import_job(user, uploaded_file.name, file_path, survey_title, is_bulk)
+
+
+async def service_create_import_job_async(user, uploaded_file, survey_title=None, is_bulk=False):
+    """
+    Igual que service_create_import_job, pero el parseo y la validación
+    corren en el pool nativo de cpp_csv (awaitable) en lugar de ocupar el
+    hilo sync compartido; solo la escritura del archivo y la DB pasan por
+    sync_to_async.
+    """
+    file_path = await sync_to_async(_save_uploaded_csv, thread_sensitive=False)(uploaded_file)
+
+    rows = (await cpp_csv.read_csv_dicts_async(file_path))[:_import_sample_size()]
+    if not rows:
+        return {'success': False, 'error': 'El archivo CSV está vacío o no tiene datos válidos.'}
+    schema = _infer_import_schema(rows)
+
+    validation_result = await cpp_csv.read_and_validate_csv_async(file_path, schema)
+    if validation_result.get('errors'):
+        return _validation_failure(validation_result)
+
+    return await sync_to_async(_launch_import_job)(user, uploaded_file.name, file_path, survey_title, is_bulk)
+
 def service_import_to_existing_survey(user, public_id, uploaded_file):
     """
     Importa CSV a una encuesta existente.
     """
-    from surveys.tasks import process_survey_import
+    from surveys.tasks import process_survey_import, register_import_owner
     
     survey = Survey.objects.filter(public_id=public_id, author=user).first()
     if not survey:
@@ -350,56 +394,90 @@ def service_import_to_existing_survey(user, public_id, uploaded_file):
         filename=uploaded_file.name,
         user_id=user.id
     )
+    register_import_owner(task.id, user.id)
     
     return {
         'task_id': task.id,
         'survey_public_id': survey.public_id
     }
 
+def _build_preview(rows, filename):
+    """Respuesta del preview a partir de las filas de muestra."""
+    if not rows:
+        return {"success": False, "error": "El archivo está vacío o no tiene datos válidos."}
+    from surveys.utils.bulk_import import _infer_column_type
+
+    columns_info = []
+    # Tomar las claves del primer dict como columnas
+    first_row = rows[0]
+    for col in first_row:
+        sample = [str(r.get(col, '')) for r in rows if r.get(col, '')]
+        dtype = _infer_column_type(col, sample)
+        sample_values = list({str(r.get(col, '')) for r in rows if r.get(col, '')})[:10]
+        columns_info.append({
+            "name": col,
+            "dtype": dtype,
+            "type": dtype,
+            "display_name": col,
+            "unique_values": len(set(sample)),
+            "sample_values": sample_values
+        })
+    sample_rows = [[r.get(col, '') for col in first_row] for r in rows[:5]]
+    return {
+        "success": True,
+        "columns": columns_info,
+        "sample_rows": sample_rows,
+        "filename": filename,
+        "total_rows": len(rows)
+    }
+
+
+def _write_preview_tmp(uploaded_file):
+    """Copia el archivo subido a un temporal para pasarlo a C++."""
+    tmp = tempfile.NamedTemporaryFile(delete=False, suffix='.csv')
+    try:
+        uploaded_file.seek(0)
+        for chunk in uploaded_file.chunks():
+            tmp.write(chunk)
+    finally:
+        tmp.close()
+    return tmp.name
+
+
 def service_generate_preview(uploaded_file):
     """
     Genera el preview usando cpp_csv de forma síncrona.
     """
+    tmp_path = None
     try:
-        # Guardar archivo temporal para pasarlo a C++
-        import tempfile
-        with tempfile.NamedTemporaryFile(delete=True, suffix='.csv') as tmp:
-            uploaded_file.seek(0)
-            for chunk in uploaded_file.chunks():
-                tmp.write(chunk)
-            tmp.flush()
-            # Leer con cpp_csv (con límite de muestra como en bulk_import)
-            sample_size = min(getattr(settings, "SURVEY_IMPORT_SAMPLE_SIZE", 5000), 5000)
-            rows = cpp_csv.read_csv_dicts(tmp.name)[:sample_size]
-            if not rows:
-                return {"success": False, "error": "El archivo está vacío o no tiene datos válidos."}
-            columns_info = []
-            from surveys.utils.bulk_import import _infer_column_type
-            # Tomar las claves del primer dict como columnas
-            first_row = rows[0]
-            for col in first_row:
-                sample = [str(r.get(col, '')) for r in rows if r.get(col, '')]
-                dtype = _infer_column_type(col, sample)
-                sample_values = list({str(r.get(col, '')) for r in rows if r.get(col, '')})[:10]
-                columns_info.append({
-                    "name": col,
-                    "dtype": dtype,
-                    "type": dtype,
-                    "display_name": col,
-                    "unique_values": len(set(sample)),
-                    "sample_values": sample_values
-                })
-            sample_rows = [[r.get(col, '') for col in first_row] for r in rows[:5]]
-            return {
-                "success": True,
-                "columns": columns_info,
-                "sample_rows": sample_rows,
-                "filename": uploaded_file.name,
-                "total_rows": len(rows)
-            }
+        tmp_path = _write_preview_tmp(uploaded_file)
+        # Leer con cpp_csv (con límite de muestra como en bulk_import)
+        rows = cpp_csv.read_csv_dicts(tmp_path)[:_import_sample_size()]
+        return _build_preview(rows, uploaded_file.name)
+    except Exception:
+        logger.exception("[IMPORT_PREVIEW][ERROR]")
+        return {"success": False, "error": "Error interno generando preview."}
+    finally:
+        if tmp_path:
+            os.unlink(tmp_path)
+
+
+async def service_generate_preview_async(uploaded_file):
+    """
+    Preview con la lectura en el pool nativo de cpp_csv: un archivo grande
+    no detiene las demás peticiones que comparten el hilo sync.
+    """
+    tmp_path = None
+    try:
+        tmp_path = await sync_to_async(_write_preview_tmp, thread_sensitive=False)(uploaded_file)
+        rows = (await cpp_csv.read_csv_dicts_async(tmp_path))[:_import_sample_size()]
+        return _build_preview(rows, uploaded_file.name)
     except Exception:
         logger.exception("[IMPORT_PREVIEW][ERROR]")
         return {"success": False, "error": "Error interno generando preview."}
+    finally:
+        if tmp_path:
+            os.unlink(tmp_path)
 
 # =============================================================================
 # Vistas Async (Corregidas para acceso seguro al Usuario y DB)
@@ -544,7 +622,7 @@ async def csv_create_start_import_async(request: HttpRequest) -> JsonResponse:
             files = request.FILES.getlist('csv_files')
             jobs = []
             for uploaded_file in files:
-                result = await sync_to_async(service_create_import_job)(
+                result = await service_create_import_job_async(
                     user=user,  # Pasamos el usuario ya cargado
                     uploaded_file=uploaded_file, 
                     is_bulk=True
@@ -571,7 +649,7 @@ async def csv_create_start_import_async(request: HttpRequest) -> JsonResponse:
             uploaded_file = request.FILES['csv_file']
             survey_title = request.POST.get('survey_title', '').strip()
 
-            result = await sync_to_async(service_create_import_job)(
+            result = await service_create_import_job_async(
                 user=user, # Pasamos el usuario ya cargado
                 uploaded_file=uploaded_file,
                 survey_title=survey_title,
@@ -672,7 +750,8 @@ async def get_task_status_view(request: HttpRequest, task_id: str) -> JsonRespon
         response = {'task_id': tid, 'status': result.status.lower()}
 
         if result.state == 'SUCCESS':
-            response['status'] = 'completed'
+            cancelled = isinstance(result.result, dict) and result.result.get('status') == 'CANCELLED'
+            response['status'] = 'cancelled' if cancelled else 'completed'
             response['result'] = result.result
         elif result.state == 'FAILURE':
             # Si el resultado es un dict con errores de validación, propagarlo
@@ -687,6 +766,7 @@ async def get_task_status_view(request: HttpRequest, task_id: str) -> JsonRespon
             response['status'] = 'processing'
             if isinstance(result.info, dict):
                 response['progress'] = result.info.get('progress', 0)
+                response['processed_rows'] = result.info.get('processed_rows', 0)
         return response
 
     try:
@@ -697,6 +777,26 @@ async def get_task_status_view(request: HttpRequest, task_id: str) -> JsonRespon
         return JsonResponse({"status": "failed", "error": "Error interno consultando estado."}, status=500)
 
 
+async def cancel_task_view(request: HttpRequest, task_id: str) -> JsonResponse:
+    """Pide cancelar una importación en curso (la tarea se detiene en el siguiente chunk)."""
+    user, auth_error = await _get_async_authenticated_user(request)
+    if auth_error:
+        return auth_error
+    if request.method != 'POST':
+        return _method_not_allowed_json()
+
+    from surveys.tasks import request_import_cancel
+
+    try:
+        accepted = await sync_to_async(request_import_cancel)(task_id, user.id)
+    except Exception:
+        logger.exception("[TASK_CANCEL][ERROR]")
+        return JsonResponse({'success': False, 'error': 'Error interno cancelando la importación.'}, status=500)
+    if not accepted:
+        return JsonResponse({'success': False, 'error': 'Importación no encontrada.'}, status=404)
+    return JsonResponse({'success': True, 'task_id': task_id, 'status': 'cancelling'})
+
+
 async def csv_preview_view(request: HttpRequest, public_id: str = None) -> JsonResponse:
     _user, auth_error = await _get_async_authenticated_user(request)
     if auth_error:
@@ -707,7 +807,7 @@ async def csv_preview_view(request: HttpRequest, public_id: str = None) -> JsonR
     if not uploaded_file:
         return JsonResponse({'success': False, 'error': 'No file uploaded'}, status=400)
 
-    response_data = await sync_to_async(service_generate_preview)(uploaded_file)
+    response_data = await service_generate_preview_async(uploaded_file)
     
     status_code = 200 if response_data.get('success') else 400
     return JsonResponse(response_data, status=status_code)
@@ -2,14 +2,14 @@
 surveys/views/report_views.py
 Optimized report views for survey results.
 """
-import csv
 import json
 from datetime import datetime
 
 
 from django.contrib.auth.views import redirect_to_login
+from django.core.handlers.asgi import ASGIRequest
 from django.shortcuts import render, get_object_or_404, redirect
-from django.http import HttpResponse, JsonResponse, Http404
+from django.http import FileResponse, HttpResponse, JsonResponse, Http404, StreamingHttpResponse
 from django.contrib import messages
 from django.template.loader import render_to_string
 from django.db.models import Q, Count, Max
@@ -24,6 +24,9 @@ from surveys.models import Survey, SurveyResponse, QuestionResponse, ImportJob
 from surveys.models_analytics import AnalysisSegment
 from core.utils.logging_utils import StructuredLogger
 from core.utils.helpers import PermissionHelper, DateFilterHelper
+from core.services.analysis_service import NPSCalculator
+from core.services.survey_cube import SurveyCubeService, segment_conditions
+from core.services.survey_export import SurveyCsvExporter
 from core.services.survey_analysis import SurveyAnalysisService
 
 logger = StructuredLogger('surveys')
@@ -129,6 +132,39 @@ def _apply_segment_filter(respuestas_qs, survey, segment_col, segment_val, segme
     
     return respuestas_qs
 
+def _apply_segment_criteria(respuestas_qs, survey, criteria):
+    """Condiciones por pregunta de un AnalysisSegment (ver segment_conditions), en la BD."""
+    question_ids = set(survey.questions.values_list('id', flat=True))
+    for pregunta_id, condition in segment_conditions(criteria).items():
+        if pregunta_id not in question_ids:
+            continue
+        answers = QuestionResponse.objects.filter(question_id=pregunta_id)
+
+        def matching(values):
+            numbers = []
+            for value in values:
+                try:
+                    numbers.append(float(value))
+                except ValueError:
+                    pass
+            q_filter = Q(selected_option__text__in=values) | Q(text_value__in=values)
+            if numbers:
+                q_filter |= Q(numeric_value__in=numbers)
+            return answers.filter(q_filter).values_list('survey_response_id', flat=True)
+
+        if 'in' in condition:
+            respuestas_qs = respuestas_qs.filter(id__in=matching(condition['in']))
+        if 'min' in condition or 'max' in condition:
+            q_range = Q(numeric_value__isnull=False)
+            if 'min' in condition:
+                q_range &= Q(numeric_value__gte=condition['min'])
+            if 'max' in condition:
+                q_range &= Q(numeric_value__lte=condition['max'])
+            respuestas_qs = respuestas_qs.filter(id__in=answers.filter(q_range).values_list('survey_response_id', flat=True))
+        if 'not' in condition:
+            respuestas_qs = respuestas_qs.exclude(id__in=matching(condition['not']))
+    return respuestas_qs
+
 def _process_crosstab_for_template(crosstab_raw):
     """
     Transforma el diccionario 'split' de Pandas (del servicio) 
@@ -233,7 +269,23 @@ async def survey_results_view(request, public_id):
     crosstab_row = request.GET.get('crosstab_row', '').strip()  # NUEVO
     crosstab_col = request.GET.get('crosstab_col', '').strip()  # Ya existente
 
-    has_filters = bool(start or end or segment_col)
+    # Segmento guardado: sus criterios completan los filtros que no vienen en la URL
+    saved_segment = None
+    segment_id = request.GET.get('segment', '').strip()
+    if segment_id.isdigit():
+        saved_segment = await sync_to_async(
+            lambda: AnalysisSegment.objects.filter(id=int(segment_id), survey=survey, user=user).first(),
+            thread_sensitive=True,
+        )()
+    segment_criteria = (saved_segment.filters_criteria or {}) if saved_segment else {}
+    if segment_criteria:
+        start = start or segment_criteria.get('start') or None
+        end = end or segment_criteria.get('end') or None
+        segment_col = segment_col or str(segment_criteria.get('segment_col') or '')
+        segment_val = segment_val or str(segment_criteria.get('segment_val') or '')
+        segment_demo = segment_demo or str(segment_criteria.get('segment_demo') or '')
+
+    has_filters = bool(start or end or segment_col or segment_criteria)
 
     respuestas_qs = await sync_to_async(lambda: SurveyResponse.objects.filter(survey=survey), thread_sensitive=True)()
 
@@ -254,22 +306,39 @@ async def survey_results_view(request, public_id):
         else:
             respuestas_qs = maybe_coroutine
 
+    if segment_criteria:
+        respuestas_qs = await sync_to_async(_apply_segment_criteria, thread_sensitive=True)(
+            respuestas_qs, survey, segment_criteria
+        )
+
+    # Los mismos filtros sobre el cubo columnar de la encuesta (None = solo BD)
+    cube_selection = await sync_to_async(SurveyCubeService.select, thread_sensitive=True)(
+        survey, start=start, end=end,
+        segment_col=segment_col, segment_val=segment_val, segment_demo=segment_demo,
+        criteria=segment_criteria,
+    )
+
     # --- 2. Obtener Análisis General ---
     # OPT: calcular total + last_id una sola vez y usarlo para key de caché.
     # Esto evita hacer múltiples .count() y reduce recomputación tras restart.
-    totals = await sync_to_async(
-        lambda: respuestas_qs.aggregate(total=Count('id'), last_id=Max('id')),
-        thread_sensitive=True,
-    )()
+    if cube_selection is not None:
+        totals = {'total': cube_selection.count(), 'last_id': cube_selection.last_response_id()}
+    else:
+        totals = await sync_to_async(
+            lambda: respuestas_qs.aggregate(total=Count('id'), last_id=Max('id')),
+            thread_sensitive=True,
+        )()
     total_respuestas = int(totals.get('total') or 0)
     last_response_id = int(totals.get('last_id') or 0)
-    cache_key = f"analysis_view_v17_{survey.id}_{start}_{end}_{segment_col}_{segment_val}:{total_respuestas}:{last_response_id}"
+    segment_key = f"seg{saved_segment.id}.{int(saved_segment.updated_at.timestamp())}" if saved_segment else ''
+    cache_key = f"analysis_view_v17_{survey.id}_{start}_{end}_{segment_col}_{segment_val}_{segment_demo}_{segment_key}:{total_respuestas}:{last_response_id}"
 
     analysis_result = await SurveyAnalysisService.get_analysis_data(
         survey,
         respuestas_qs,
         cache_key=cache_key,
-        config={'tone': 'FORMAL', 'include_quotes': True}
+        config={'tone': 'FORMAL', 'include_quotes': True},
+        cube_selection=cube_selection,
     )
 
     # Serializar Charts para el Template (asegura chart_json como string JSON)
@@ -475,31 +544,43 @@ async def export_survey_csv_view(request, public_id):
         import_job = await sync_to_async(lambda: ImportJob.objects.filter(survey=survey, status="completed").order_by('-created_at').first(), thread_sensitive=True)()
         import os
         if import_job and import_job.csv_file and os.path.exists(import_job.csv_file):
-            with open(import_job.csv_file, 'rb') as f:
-                response = HttpResponse(f.read(), content_type='text/csv')
-                response['Content-Disposition'] = f'attachment; filename="{import_job.original_filename or "data.csv"}"'
-                return response
+            # FileResponse transmite el archivo por bloques en lugar de leerlo completo
+            return FileResponse(
+                open(import_job.csv_file, 'rb'),
+                as_attachment=True,
+                filename=import_job.original_filename or "data.csv",
+                content_type='text/csv',
+            )
 
-    # Caso 2: Nativa (Generar)
-    respuestas = await sync_to_async(lambda: SurveyResponse.objects.filter(survey=survey).order_by('created_at').prefetch_related('question_responses__question'), thread_sensitive=True)()
-    
-    response = HttpResponse(content_type='text/csv; charset=utf-8-sig')
-    filename = f"{survey.title[:20]}_{datetime.now().strftime('%Y%m%d')}.csv"
-    response['Content-Disposition'] = f'attachment; filename="{filename}"'
-    response.write('\ufeff')
+    # Caso 2: Nativa (Generar): se transmite por lotes con memoria constante
+    exporter = await sync_to_async(SurveyCsvExporter, thread_sensitive=True)(survey)
 
-    writer = csv.writer(response)
-    preguntas = await sync_to_async(lambda: list(survey.questions.all().order_by('order')), thread_sensitive=True)()
-    headers = ['ID', 'Fecha', 'Usuario'] + [p.text for p in preguntas]
-    writer.writerow(headers)
+    def stream():
+        yield exporter.header()
+        cursor = None
+        while True:
+            chunks, cursor = exporter.encode_batch(cursor)
+            yield from chunks
+            if cursor is None:
+                break
 
-    for r in respuestas:
-        row = [r.id, r.created_at, r.user.username if r.user else 'Anon']
-        q_map = {qr.question_id: (qr.text_value or str(qr.numeric_value or '')) for qr in r.question_responses.all()}
-        for p in preguntas:
-            row.append(q_map.get(p.id, ''))
-        writer.writerow(row)
+    async def astream():
+        yield exporter.header()
+        cursor = None
+        while True:
+            chunks, cursor = await sync_to_async(exporter.encode_batch, thread_sensitive=True)(cursor)
+            for chunk in chunks:
+                yield chunk
+            if cursor is None:
+                break
 
+    # Django junta en memoria un iterador que no coincide con el servidor
+    # (asíncrono bajo WSGI/gunicorn, síncrono bajo ASGI): se elige el que
+    # el handler puede transmitir por lotes.
+    content = astream() if isinstance(request, ASGIRequest) else stream()
+    response = StreamingHttpResponse(content, content_type='text/csv; charset=utf-8-sig')
+    filename = f"{survey.title[:20]}_{datetime.now().strftime('%Y%m%d')}.csv"
+    response['Content-Disposition'] = f'attachment; filename="{filename}"'
     return response
 
 # ============================================================
@@ -549,6 +630,81 @@ async def api_crosstab_view(request, public_id):
         )
         return JsonResponse({'error': 'Error interno generando cruce de variables'}, status=500)
 
+async def api_keyword_context_view(request, public_id):
+    """API para buscar una palabra en los comentarios de una pregunta (KWIC) vía AJAX."""
+    question_id = request.GET.get('question')
+    term = request.GET.get('q', '')
+    try:
+        survey, _user = await _get_authorized_survey(request, public_id)
+        if not question_id or not term.strip():
+            return JsonResponse({'error': 'Faltan parámetros question/q'}, status=400)
+        try:
+            width = min(max(int(request.GET.get('width', 40)), 5), 200)
+            limit = min(max(int(request.GET.get('limit', 20)), 1), 100)
+        except ValueError:
+            return JsonResponse({'error': 'Parámetros width/limit inválidos'}, status=400)
+        result = await sync_to_async(SurveyAnalysisService.keyword_in_context, thread_sensitive=True)(
+            survey, question_id, term, width=width, limit=limit,
+        )
+        if 'error' in result:
+            return JsonResponse(result, status=400)
+        return JsonResponse({'success': True, **result})
+
+    except PermissionDenied:
+        return JsonResponse({'error': 'No tienes permisos para acceder a esta encuesta.'}, status=403)
+    except Exception:
+        logger.exception(
+            "Error en api_keyword_context_view",
+            public_id=public_id,
+            question_id=question_id,
+        )
+        return JsonResponse({'error': 'Error interno buscando en comentarios'}, status=500)
+
+async def api_nps_segments_view(request, public_id):
+    """API del NPS de una pregunta por cada segmento demográfico (o las preguntas indicadas) vía AJAX."""
+    question_id = request.GET.get('question')
+    try:
+        survey, _user = await _get_authorized_survey(request, public_id)
+        if not question_id:
+            return JsonResponse({'error': 'Falta el parámetro question'}, status=400)
+        try:
+            segment_ids = [int(x) for x in request.GET.get('segments', '').split(',') if x.strip()]
+            question_id = int(question_id)
+        except ValueError:
+            return JsonResponse({'error': 'Parámetros question/segments inválidos'}, status=400)
+
+        def compute():
+            question = survey.questions.filter(id=question_id, type__in=('scale', 'number')).first()
+            if question is None:
+                return None
+            segment_qs = survey.questions.exclude(id=question_id)
+            segment_qs = segment_qs.filter(id__in=segment_ids) if segment_ids else segment_qs.filter(is_demographic=True)
+            segment_questions = list(segment_qs.order_by('order'))
+            responses = SurveyResponse.objects.filter(survey=survey)
+            by_segment = NPSCalculator.calculate_nps_by_segments(question, responses, segment_questions)
+            return {
+                'overall': NPSCalculator.calculate_nps(question, responses),
+                'segments': [
+                    {'question_id': q.id, 'question': q.text, 'groups': by_segment.get(q.id, [])}
+                    for q in segment_questions
+                ],
+            }
+
+        result = await sync_to_async(compute, thread_sensitive=True)()
+        if result is None:
+            return JsonResponse({'error': 'La pregunta no existe o no es de escala.'}, status=400)
+        return JsonResponse({'success': True, **result})
+
+    except PermissionDenied:
+        return JsonResponse({'error': 'No tienes permisos para acceder a esta encuesta.'}, status=403)
+    except Exception:
+        logger.exception(
+            "Error en api_nps_segments_view",
+            public_id=public_id,
+            question_id=question_id,
+        )
+        return JsonResponse({'error': 'Error interno calculando NPS por segmento'}, status=500)
+
 async def debug_analysis_view(request, public_id):
     """Vista de depuración para verificar qué está viendo el sistema."""
     survey, _user = await _get_authorized_survey(request, public_id)
@@ -657,7 +813,15 @@ async def save_analysis_segment_view(request, public_id):
             'end': data.get('end', ''),
             'segment_col': data.get('segment_col', ''),
             'segment_val': data.get('segment_val', ''),
+            'segment_demo': data.get('segment_demo', ''),
         }
+        # Condiciones por pregunta (question_<id>, question_<id>_min/_max/_not)
+        conditions = data.get('conditions') or {}
+        if not isinstance(conditions, dict):
+            return JsonResponse({'error': 'Las condiciones del segmento no son válidas'}, status=400)
+        filters_criteria.update({key: value for key, value in conditions.items() if key.startswith('question_')})
+        if conditions and not segment_conditions(filters_criteria):
+            return JsonResponse({'error': 'Las condiciones del segmento no son válidas'}, status=400)
         
         # Crear el segmento
         segment = await sync_to_async(AnalysisSegment.objects.create, thread_sensitive=True)(
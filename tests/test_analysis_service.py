@@ -74,3 +74,17 @@ def test_nps_calculator_calculate_nps_runs():
         def count(self): return 0
     result = analysis_service.NPSCalculator.calculate_nps(1, DummyQS())
     assert isinstance(result, dict) or result is None
+
+SPLIT_CASES = ["Ventas; IT, RRHH", " IT ,IT;; Ventas ,", "Ventas", "", " ; , "]
+
+@pytest.mark.parametrize("cell", SPLIT_CASES)
+def test_split_choice_values_native_matches_python(monkeypatch, cell):
+    if analysis_service.cpp_csv is None:
+        pytest.skip("cpp_csv no está compilado")
+    native = analysis_service.split_choice_values(cell)
+    monkeypatch.setattr(analysis_service, "cpp_csv", None)
+    assert analysis_service.split_choice_values(cell) == native
+
+def test_split_choice_values_python_fallback(monkeypatch):
+    monkeypatch.setattr(analysis_service, "cpp_csv", None)
+    assert analysis_service.split_choice_values(" IT ,IT;; Ventas ,") == ["IT", "Ventas"]
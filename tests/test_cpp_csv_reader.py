@@ -0,0 +1,543 @@
+"""
+Tests del lector nativo cpp_csv (tools/cpp_csv): parseo, proyección, filtros,
+multi-selección, descubrimiento de opciones, llamadas awaitable,
+presupuesto de memoria, línea de tiempo (tracing) y cancelación.
+
+Se saltan si el módulo no está compilado (python setup_cpp_csv.py build_ext).
+"""
+import asyncio
+import csv
+import io
+import json
+from datetime import date, datetime
+
+import pytest
+
+cpp_csv = pytest.importorskip("tools.cpp_csv.pybind_csv")
+
+
+def _write(tmp_path, text, name="datos.csv"):
+    path = tmp_path / name
+    path.write_bytes(text.encode("utf-8"))
+    return str(path)
+
+
+# =============================================================================
+# Parseo (arena)
+# =============================================================================
+
+# El módulo csv de Python es la referencia: mismas filas, mismas celdas
+PARSE_CASES = {
+    "crlf": 'id,nombre\r\n1,Ana\r\n2,Luis\r\n',
+    "comillas": 'id,nombre,comentario\n1,"Ana, María","dijo ""hola"""\n2,Luis,a"b\n',
+    "salto_en_comillas": 'id,comentario\n1,"linea uno\nlinea dos"\n2,"uno\r\ndos"\r\n',
+    "sin_salto_final": 'id,nombre\n1,Ana\n2,Luis',
+    "celdas_vacias": 'a,b,c\n,,\n1,,3\n',
+}
+
+
+@pytest.mark.parametrize("text", PARSE_CASES.values(), ids=PARSE_CASES.keys())
+def test_read_csv_matches_python_csv(tmp_path, text):
+    path = _write(tmp_path, text)
+
+    assert cpp_csv.read_csv(path) == list(csv.reader(io.StringIO(text, newline="")))
+
+
+@pytest.mark.parametrize("text", PARSE_CASES.values(), ids=PARSE_CASES.keys())
+def test_read_csv_dicts_matches_dict_reader(tmp_path, text):
+    path = _write(tmp_path, text)
+
+    assert cpp_csv.read_csv_dicts(path) == list(csv.DictReader(io.StringIO(text, newline="")))
+
+
+def test_read_csv_dicts_multiline_records_across_chunks(tmp_path):
+    # Más filas que un chunk del arena (4096) y todas con un campo multilínea
+    text = "id,comentario\r\n" + "".join(f'{i},"fila {i}\r\nsigue"\r\n' for i in range(10000))
+    path = _write(tmp_path, text)
+
+    rows = cpp_csv.read_csv_dicts(path)
+
+    assert len(rows) == 10000
+    assert rows[4095] == {"id": "4095", "comentario": "fila 4095\r\nsigue"}
+    assert rows[-1] == {"id": "9999", "comentario": "fila 9999\r\nsigue"}
+
+
+# =============================================================================
+# Iterador por chunks (prefetch)
+# =============================================================================
+
+@pytest.mark.parametrize("prefetch", [1, 2, 4])
+def test_chunk_iterator_yields_same_rows_as_read_csv_dicts(tmp_path, prefetch):
+    text = "id,nombre,comentario\n" + "".join(f'{i},n{i},"c\n{i}"\n' for i in range(1050))
+    path = _write(tmp_path, text)
+
+    with cpp_csv.iter_csv_dict_chunks(path, chunk_size=100, prefetch=prefetch) as chunks:
+        assert chunks.header == ["id", "nombre", "comentario"]
+        sizes = []
+        rows = []
+        for chunk in chunks:
+            sizes.append(len(chunk))
+            rows.extend(chunk)
+
+    assert sizes == [100] * 10 + [50]
+    assert rows == cpp_csv.read_csv_dicts(path)
+
+
+def test_chunk_iterator_close_before_end_stops_reading(tmp_path):
+    text = "id\n" + "".join(f"{i}\n" for i in range(100000))
+    path = _write(tmp_path, text)
+
+    with cpp_csv.iter_csv_dict_chunks(path, chunk_size=10, prefetch=2) as chunks:
+        first = next(chunks)
+
+    assert first == [{"id": str(i)} for i in range(10)]
+    # El hilo de prefetch solo se adelanta `prefetch` chunks y se detiene al cerrar
+    assert chunks.stats["bytes_read"] < len(text) // 10
+
+
+# =============================================================================
+# Proyección de columnas
+# =============================================================================
+
+WIDE_CSV = "ID,Edad, Unnamed: 0 ,Ciudad,pk,utm_source\n1,30,x,MX,9,g\n2,41,y,AR,8,f\n"
+
+
+def test_usecols_by_name_and_index_keeps_header_order(tmp_path):
+    path = _write(tmp_path, WIDE_CSV)
+
+    assert cpp_csv.read_csv_dicts(path, usecols=["Ciudad", 1]) == [
+        {"Edad": "30", "Ciudad": "MX"}, {"Edad": "41", "Ciudad": "AR"},
+    ]
+    assert cpp_csv.read_csv(path, usecols=[3, "ID"]) == [["ID", "Ciudad"], ["1", "MX"], ["2", "AR"]]
+    assert cpp_csv.read_csv(path, usecols="Edad") == [["Edad"], ["30"], ["41"]]
+
+
+def test_drop_patterns_are_case_insensitive_globs(tmp_path):
+    path = _write(tmp_path, WIDE_CSV)
+
+    rows = cpp_csv.read_csv_dicts(path, drop_patterns=["id", "pk", "unnamed*", "utm_?ource"])
+
+    assert rows == [{"Edad": "30", "Ciudad": "MX"}, {"Edad": "41", "Ciudad": "AR"}]
+    # Se aplican después de usecols
+    assert cpp_csv.read_csv_dicts(path, usecols=["ID", "Edad"], drop_patterns=["id"]) == [
+        {"Edad": "30"}, {"Edad": "41"},
+    ]
+
+
+def test_usecols_repeated_header_name_selects_every_column(tmp_path):
+    path = _write(tmp_path, "a,a,b\n1,2,3\n")
+
+    assert cpp_csv.read_csv(path, usecols=["a"]) == [["a", "a"], ["1", "2"]]
+
+
+def test_chunk_iterator_reports_projected_columns(tmp_path):
+    path = _write(tmp_path, WIDE_CSV)
+
+    with cpp_csv.iter_csv_dict_chunks(path, usecols=["Ciudad", "Edad"]) as chunks:
+        assert chunks.columns == ["Edad", "Ciudad"]
+        assert [row for chunk in chunks for row in chunk] == [
+            {"Edad": "30", "Ciudad": "MX"}, {"Edad": "41", "Ciudad": "AR"},
+        ]
+
+
+@pytest.mark.parametrize("usecols, error", [
+    (["Nope"], ValueError),
+    ([9], IndexError),
+    ([-1], IndexError),
+])
+def test_usecols_unknown_column_raises(tmp_path, usecols, error):
+    path = _write(tmp_path, WIDE_CSV)
+
+    with pytest.raises(error):
+        cpp_csv.read_csv_dicts(path, usecols=usecols)
+
+
+# =============================================================================
+# Filtro de filas (where)
+# =============================================================================
+
+WHERE_CSV = (
+    "id,Fecha,Edad,Pais,Comentario\n"
+    "1,2024-01-05,17,MX,\n"
+    "2,2024/02/10 3:30 p. m.,30,CO,  hola\n"
+    "3,15/03/2024,abc,AR,ok\n"
+    "4,,65,mx,ok\n"
+    "5,03/04/2024,66, CO , \n"
+)
+
+
+@pytest.mark.parametrize("where, ids", [
+    ({"column": "Edad", "op": ">=", "value": 18}, ["2", "4", "5"]),
+    ({"column": "Edad", "op": "between", "value": [18, 65]}, ["2", "4"]),
+    # Una celda que no es número no cumple ninguna comparación, ni !=
+    ({"column": "Edad", "op": "!=", "value": 30}, ["1", "4", "5"]),
+    # El texto se compara recortado y distingue mayúsculas
+    ({"column": "Pais", "op": "==", "value": "CO"}, ["2", "5"]),
+    ({"column": "Pais", "op": "in", "value": ["MX", "CO"]}, ["1", "2", "5"]),
+    ({"column": "Comentario", "op": "empty"}, ["1", "5"]),
+    ({"column": "Comentario", "op": "not_empty"}, ["2", "3", "4"]),
+    # DD/MM si el primer número pasa de 12; si no, MM/DD
+    ({"column": "Fecha", "op": ">=", "value": date(2024, 2, 1)}, ["2", "3", "5"]),
+    ({"column": "Fecha", "op": "<", "value": datetime(2024, 2, 10, 15, 30)}, ["1"]),
+    ({"and": [
+        {"not": {"column": "Comentario", "op": "empty"}},
+        {"or": [{"column": "Pais", "op": "==", "value": "AR"}, {"column": "Edad", "op": ">", "value": 60}]},
+    ]}, ["3", "4"]),
+])
+def test_where_filters_rows(tmp_path, where, ids):
+    path = _write(tmp_path, WHERE_CSV)
+
+    assert [row["id"] for row in cpp_csv.read_csv_dicts(path, where=where)] == ids
+
+
+def test_where_reads_columns_outside_usecols(tmp_path):
+    path = _write(tmp_path, WHERE_CSV)
+
+    rows = cpp_csv.read_csv_dicts(path, usecols=["id"], where={"column": "Pais", "op": "==", "value": "AR"})
+
+    assert rows == [{"id": "3"}]
+
+
+@pytest.mark.parametrize("where", [
+    {"column": "Nope", "op": "==", "value": "x"},
+    {"column": "Edad", "op": "~", "value": 1},
+    {"column": "Edad", "op": "between", "value": [1]},
+    {"column": "Edad", "op": ">="},
+])
+def test_where_invalid_condition_raises(tmp_path, where):
+    path = _write(tmp_path, WHERE_CSV)
+
+    with pytest.raises(ValueError):
+        cpp_csv.read_csv_dicts(path, where=where)
+
+
+# =============================================================================
+# Multi-selección
+# =============================================================================
+
+@pytest.mark.parametrize("cell, expected", [
+    ("Ventas; IT, RRHH", ["Ventas", "IT", "RRHH"]),
+    (" IT ,IT;; Ventas ,", ["IT", "Ventas"]),
+    ('"Ventas, Norte"; IT', ["Ventas, Norte", "IT"]),
+    ('"Dijo ""si""", No', ['Dijo "si"', "No"]),
+    (" ; , ", []),
+])
+def test_split_multi_select(cell, expected):
+    assert cpp_csv.split_multi_select(cell) == expected
+
+
+def test_multi_select_mapper_maps_known_options_and_reports_unknown():
+    mapper = cpp_csv.build_multi_select_mapper({"Ventas": 10, "IT": 11, "Ventas, Norte": 12})
+
+    result = mapper.map(["Ventas; IT", "IT, Otro", "", '"Ventas, Norte",Ventas', "IT;IT", None])
+
+    assert list(zip(result["rows"], result["option_ids"])) == [
+        (0, 10), (0, 11), (1, 11), (3, 12), (3, 10), (4, 11),
+    ]
+    assert result["unknown_rows"] == [1]
+    assert result["unknown_tokens"] == ["Otro"]
+
+
+# =============================================================================
+# Descubrimiento de opciones
+# =============================================================================
+
+def test_discover_counts_single_multi_and_free_text(tmp_path):
+    rows = [(["Ventas", " IT ", "", "RRHH"][i % 4], ["Ventas; IT", "IT", "", "RRHH, IT"][i % 4], f"Ciudad {i}")
+            for i in range(400)]
+    text = "depto,areas,ciudad\n" + "".join(f'{d},"{a}",{c}\n' for d, a, c in rows)
+    path = _write(tmp_path, text)
+
+    result = cpp_csv.discover_column_values(
+        path, columns=["depto", "areas", "ciudad"], multi_columns=["areas"], max_distinct=50,
+    )
+
+    # Las celdas se recortan y las vacías no cuentan
+    assert result["depto"] == {
+        "values": {"IT": 100, "RRHH": 100, "Ventas": 100}, "distinct": 3, "non_empty": 300, "free_text": False,
+    }
+    # Más frecuentes primero
+    assert list(result["depto"]["values"]) == ["IT", "RRHH", "Ventas"]
+    assert result["areas"]["values"] == {"IT": 300, "Ventas": 100, "RRHH": 100}
+    assert result["areas"]["non_empty"] == 300
+    assert result["ciudad"]["free_text"]
+    assert result["ciudad"]["values"] == {}
+    assert result["ciudad"]["non_empty"] == 400
+
+
+def test_discover_free_text_threshold_is_max_distinct(tmp_path):
+    path = _write(tmp_path, "opcion\n" + "".join(f"v{i % 5}\n" for i in range(100)))
+
+    assert not cpp_csv.discover_column_values(path, max_distinct=5)["opcion"]["free_text"]
+    assert cpp_csv.discover_column_values(path, max_distinct=4)["opcion"]["free_text"]
+
+
+def _multiline_csv(rows):
+    # La primera línea física de cada registro es larga, así que los cortes
+    # entre rangos casi siempre caen dentro de un campo multilínea cuya
+    # segunda línea parece otra fila.
+    opts = ["Si", "No", "Tal vez"]
+    lines = ["id,opcion,pais,comentario\n"]
+    for i in range(rows):
+        lines.append(
+            f'{i},{opts[i % 3]},MX,"{"x" * 80}\n'
+            f'{i},Fantasma {i % 97},XX,\nfin"\n'
+        )
+    return "".join(lines)
+
+
+@pytest.mark.parametrize("rows", [30000, 30001, 30002])
+def test_discover_multiline_field_across_range_boundary(tmp_path, rows):
+    cpp_csv.configure_threads(4, 4)  # solo aplica si el planificador no ha arrancado
+    if cpp_csv.scheduler_stats()["per_call_limit"] < 2:
+        pytest.skip("el planificador corre un solo rango por llamada")
+    path = _write(tmp_path, _multiline_csv(rows))
+
+    result = cpp_csv.discover_column_values(path, columns=["opcion", "pais"], max_distinct=50)
+
+    assert not result["opcion"]["free_text"]
+    assert result["opcion"]["values"] == {
+        "Si": (rows + 2) // 3,
+        "No": (rows + 1) // 3,
+        "Tal vez": rows // 3,
+    }
+    assert result["pais"]["values"] == {"MX": rows}
+    assert result["opcion"]["non_empty"] == rows
+
+
+def test_discover_counts_only_rows_matching_where(tmp_path):
+    lines = ["id,opcion,pais\n"]
+    lines += [f"{i},{['Si', 'No', 'Tal vez'][i % 3]},{'MX' if i % 2 else 'AR'}\n" for i in range(300)]
+    path = _write(tmp_path, "".join(lines))
+
+    result = cpp_csv.discover_column_values(
+        path, columns=["opcion"], where={"column": "pais", "op": "==", "value": "MX"},
+    )
+
+    assert result["opcion"]["non_empty"] == 150
+    assert result["opcion"]["values"] == {"Si": 50, "No": 50, "Tal vez": 50}
+
+
+# =============================================================================
+# Llamadas awaitable
+# =============================================================================
+
+def test_read_csv_dicts_async_matches_sync(tmp_path):
+    path = _write(tmp_path, "id,nombre\n" + "".join(f"{i},n{i}\n" for i in range(500)))
+
+    async def main():
+        return await asyncio.gather(*(cpp_csv.read_csv_dicts_async(path) for _ in range(3)))
+
+    assert asyncio.run(main()) == [cpp_csv.read_csv_dicts(path)] * 3
+
+
+def test_run_async_propagates_errors(tmp_path):
+    missing = str(tmp_path / "no_existe.csv")
+    with pytest.raises(Exception) as sync_error:
+        cpp_csv.read_csv_dicts(missing)
+
+    with pytest.raises(sync_error.type):
+        asyncio.run(cpp_csv.run_async(cpp_csv.read_csv_dicts, missing))
+
+
+def test_cancelling_the_await_cancels_the_token(tmp_path):
+    path = _write(tmp_path, "id,valor\n" + "".join(f"{i},v{i}\n" for i in range(200000)))
+    token = cpp_csv.CancelToken()
+
+    async def main():
+        task = asyncio.ensure_future(cpp_csv.read_csv_dicts_async(path, cancel=token))
+        await asyncio.sleep(0)  # la tarea llega al await del future
+        task.cancel()
+        with pytest.raises(asyncio.CancelledError):
+            await task
+
+    asyncio.run(main())
+
+    assert token.cancelled
+
+
+def test_scheduler_is_shared_and_counts_tasks(tmp_path):
+    path = _write(tmp_path, "id\n1\n")
+    before = cpp_csv.scheduler_stats()
+
+    asyncio.run(cpp_csv.run_async(cpp_csv.read_csv_dicts, path))
+    stats = cpp_csv.scheduler_stats()
+
+    assert set(stats) == {"threads", "per_call_limit", "queued", "active", "submitted", "executed", "steals"}
+    assert 1 <= stats["per_call_limit"] <= stats["threads"]
+    assert stats["submitted"] > before["submitted"]
+    # Ya está corriendo: el tamaño no cambia a media vida del proceso
+    assert not cpp_csv.configure_threads(stats["threads"] + 1)
+    assert cpp_csv.scheduler_stats()["threads"] == stats["threads"]
+
+
+# =============================================================================
+# Presupuesto de memoria
+# =============================================================================
+
+def _budget_csv(tmp_path, rows=20000):
+    return _write(tmp_path, "a,b,c\n" + "".join(f'{i},texto {i},"x,y"\n' for i in range(rows)))
+
+
+def test_memory_limit_raises_memory_error_before_exceeding(tmp_path):
+    path = _budget_csv(tmp_path)
+
+    with pytest.raises(MemoryError):
+        cpp_csv.read_csv_dicts(path, memory_limit=64 << 10)
+    with pytest.raises(MemoryError):
+        cpp_csv.read_csv(path, memory_limit=64 << 10)
+
+
+def test_memory_limit_large_enough_reads_everything_within_budget(tmp_path):
+    path = _budget_csv(tmp_path)
+    limit = 64 << 20
+    stats = {}
+
+    rows = cpp_csv.read_csv_dicts(path, memory_limit=limit, stats=stats)
+
+    assert rows == cpp_csv.read_csv_dicts(path)
+    assert stats["memory_limit"] == limit
+    assert 0 < stats["peak_bytes"] <= limit
+    assert stats["arena_bytes"] > 0 and stats["python_bytes"] > 0
+
+
+def test_chunk_iterator_memory_limit_applies_per_chunk(tmp_path):
+    # El iterador suelta cada chunk: el archivo completo no tiene que caber
+    path = _budget_csv(tmp_path)
+    stats = {}
+
+    with cpp_csv.iter_csv_dict_chunks(path, chunk_size=500, memory_limit=2 << 20, stats=stats) as chunks:
+        total = sum(len(chunk) for chunk in chunks)
+
+    assert total == 20000
+    assert stats["peak_bytes"] <= 2 << 20
+
+
+# =============================================================================
+# Contadores y memoria del iterador por chunks
+# =============================================================================
+
+def test_chunk_iterator_reports_memory_and_bytes_without_phase_counters(tmp_path):
+    text = "id,valor\n" + "".join(f"{i},v{i}\n" for i in range(1000))
+    path = _write(tmp_path, text)
+
+    with cpp_csv.iter_csv_dict_chunks(path, chunk_size=100) as chunks:
+        rows = sum(len(chunk) for chunk in chunks)
+        stats = chunks.stats
+
+    assert rows == 1000
+    assert len(text) - len("id,valor\n") <= stats["bytes_read"] <= len(text)
+    assert stats["peak_bytes"] > 0
+    assert "total_ns" not in stats  # sin `stats` no se leen los relojes
+
+
+def test_chunk_iterator_measures_phases_when_stats_requested(tmp_path):
+    path = _write(tmp_path, "id,valor\n" + "".join(f"{i},v{i}\n" for i in range(1000)))
+    stats = {}
+
+    with cpp_csv.iter_csv_dict_chunks(path, chunk_size=100, stats=stats) as chunks:
+        for _ in chunks:
+            pass
+
+    assert stats["rows"] == 1000
+    assert stats["total_ns"] > 0
+    assert stats["peak_bytes"] > 0
+
+
+# =============================================================================
+# Línea de tiempo (trace_session)
+# =============================================================================
+
+def test_trace_session_records_native_and_python_spans(tmp_path):
+    path = _write(tmp_path, "id,valor\n1,a\n2,b\n3,c\n")
+    assert not cpp_csv.trace_enabled()
+
+    with cpp_csv.trace_session() as session:
+        assert cpp_csv.trace_enabled()
+        with cpp_csv.span("etapa", filas=3):
+            cpp_csv.read_csv_dicts(path)
+
+    assert not cpp_csv.trace_enabled()
+    assert session.dropped == 0
+    events = json.loads(session.json)["traceEvents"]
+    spans = {event["name"]: event for event in events if event["ph"] == "X"}
+    assert spans["read_csv_dicts"]["cat"] == "cpp_csv"
+    assert sum(event["args"]["rows"] for event in events if event["name"] == "read_chunk") == 3
+    assert spans["etapa"]["cat"] == "python"
+    assert spans["etapa"]["args"] == {"filas": 3}
+    # La etapa de Python envuelve la lectura nativa
+    assert spans["etapa"]["ts"] <= spans["read_csv_dicts"]["ts"]
+    assert spans["etapa"]["dur"] >= spans["read_csv_dicts"]["dur"]
+
+    saved = session.save(tmp_path / "traza.json")
+    assert json.loads(open(saved, encoding="utf-8").read())["traceEvents"] == events
+
+
+def test_span_outside_session_records_nothing(tmp_path):
+    path = _write(tmp_path, "id\n1\n")
+    with cpp_csv.span("fuera"):
+        cpp_csv.read_csv_dicts(path)
+
+    with cpp_csv.trace_session() as session:
+        pass
+
+    names = {event["name"] for event in json.loads(session.json)["traceEvents"]}
+    assert "fuera" not in names and "read_csv_dicts" not in names
+
+
+# =============================================================================
+# Cancelación (CancelToken)
+# =============================================================================
+
+def _cancel_csv(tmp_path, rows=10000):
+    return _write(tmp_path, "id,opcion\n" + "".join(f"{i},o{i % 7}\n" for i in range(rows)))
+
+
+@pytest.mark.parametrize("call", [
+    lambda path, token: cpp_csv.read_csv_dicts(path, cancel=token),
+    lambda path, token: cpp_csv.read_csv(path, cancel=token),
+    lambda path, token: cpp_csv.discover_column_values(path, cancel=token),
+], ids=["read_csv_dicts", "read_csv", "discover_column_values"])
+def test_cancelled_token_raises_operation_cancelled(tmp_path, call):
+    path = _cancel_csv(tmp_path)
+    token = cpp_csv.CancelToken()
+    token.cancel()
+
+    with pytest.raises(cpp_csv.OperationCancelled):
+        call(path, token)
+
+
+def test_cancel_from_progress_callback_stops_the_read(tmp_path):
+    # 10000 filas son más de un chunk: el primer reporte cancela y la
+    # lectura se corta ahí, sin llegar al final
+    path = _cancel_csv(tmp_path)
+    token = cpp_csv.CancelToken()
+    reports = []
+
+    def progress(rows, read, total):
+        reports.append(rows)
+        token.cancel()
+
+    with pytest.raises(cpp_csv.OperationCancelled):
+        cpp_csv.read_csv_dicts(path, progress=progress, progress_rows=1000, cancel=token)
+
+    assert len(reports) == 1 and 0 < reports[0] < 10000
+
+
+def test_chunk_iterator_raises_operation_cancelled_after_cancel(tmp_path):
+    path = _cancel_csv(tmp_path)
+    token = cpp_csv.CancelToken()
+
+    with cpp_csv.iter_csv_dict_chunks(path, chunk_size=100, cancel=token) as chunks:
+        assert len(next(chunks)) == 100
+        token.cancel()
+        with pytest.raises(cpp_csv.OperationCancelled):
+            next(chunks)
+
+
+def test_untouched_token_does_not_change_the_result(tmp_path):
+    path = _cancel_csv(tmp_path, rows=50)
+    token = cpp_csv.CancelToken()
+
+    assert cpp_csv.read_csv_dicts(path, cancel=token) == cpp_csv.read_csv_dicts(path)
+    assert not token.cancelled
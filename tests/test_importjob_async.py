@@ -42,6 +42,27 @@ def test_importjob_creation_and_task_success(test_user, temp_csv_file):
     assert job.total_rows > 0
     assert result['success'] is True
 
+def test_importjob_processed_rows_updates_during_import(monkeypatch, test_user, temp_csv_file):
+    # Cada fila importada reporta avance; el job lo refleja antes de terminar
+    from surveys import tasks
+    from surveys.views import import_views
+
+    monkeypatch.setattr(tasks, 'IMPORT_PROGRESS_INTERVAL', 0)
+    job = ImportJob.objects.create(user=test_user, csv_file=temp_csv_file, status='pending')
+    seen = []
+    original = import_views._process_single_csv_import
+
+    def tracked(upload, user, progress=None):
+        def spy(rows, total_rows):
+            progress(rows, total_rows)
+            seen.append(ImportJob.objects.values_list('processed_rows', 'total_rows').get(id=job.id))
+        return original(upload, user, progress=spy)
+
+    monkeypatch.setattr(import_views, '_process_single_csv_import', tracked)
+    process_survey_import(job.id)
+
+    assert seen == [(1, 3), (2, 3), (3, 3)]
+
 def test_importjob_task_failure(test_user):
     # Archivo inexistente debe fallar
     job = ImportJob.objects.create(user=test_user, csv_file='no_existe.csv', status='pending')
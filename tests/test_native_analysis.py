@@ -0,0 +1,419 @@
+"""
+Tests de los kernels de análisis de cpp_csv y sus fallbacks de Python
+(core/utils). Cada test corre con los dos backends y espera el mismo
+resultado; el nativo se salta si el módulo no está compilado.
+"""
+import math
+import random
+import statistics
+
+import pytest
+
+from core.utils import correlation, crosstab, nps, numeric_stats, pii, sentiment, text_index, text_mining
+
+
+@pytest.fixture(params=["python", "native"])
+def backend(request, monkeypatch):
+    """Devuelve `use(module)`, que fija el backend del módulo para el test."""
+    def use(module):
+        if request.param == "python":
+            monkeypatch.setattr(module, "cpp_csv", None)
+        elif module.cpp_csv is None:
+            pytest.skip("cpp_csv no está compilado")
+        return module
+    return use
+
+
+# =============================================================================
+# Estadísticas numéricas
+# =============================================================================
+
+def test_numeric_summary_and_quantiles(backend):
+    stats = backend(numeric_stats)
+    values = [1, 2, 3, 4, 10, 2, None, float("nan"), 99]
+    counts = [2, 1, 1, 3, 1, 2, 5, 5, 0]  # None, NaN y conteo 0 se ignoran
+
+    result = stats.summarize_distribution(values, counts, quantiles=(0.25, 0.75, 0.9), bins=4)
+
+    observations = [1, 1, 2, 2, 2, 3, 4, 4, 4, 10]
+    assert result["count"] == 10
+    assert result["sum"] == 33
+    assert result["mean"] == pytest.approx(statistics.mean(observations))
+    assert result["variance"] == pytest.approx(statistics.variance(observations))
+    assert result["stddev"] == pytest.approx(statistics.stdev(observations))
+    assert (result["min"], result["max"]) == (1, 10)
+    assert result["median"] == statistics.median(observations)
+    assert result["quantiles"] == pytest.approx({0.25: 2.0, 0.75: 4.0, 0.9: 4.6})
+
+
+def test_numeric_histogram_ranges(backend):
+    stats = backend(numeric_stats)
+
+    result = stats.summarize_distribution([1, 2, 3, 4, 10], [2, 3, 1, 3, 1], bins=4)
+
+    assert [tuple(b) for b in result["histogram"]] == [
+        (1.0, 3.25, 6), (3.25, 5.5, 3), (5.5, 7.75, 0), (7.75, 10.0, 1),
+    ]
+
+
+def test_numeric_histogram_minimum_width_is_one(backend):
+    stats = backend(numeric_stats)
+
+    result = stats.summarize_distribution([7], [3], bins=3)
+
+    assert [tuple(b) for b in result["histogram"]] == [(7.0, 8.0, 3), (8.0, 9.0, 0), (9.0, 10.0, 0)]
+
+
+def test_numeric_empty_distribution(backend):
+    stats = backend(numeric_stats)
+
+    result = stats.summarize_distribution([None, float("nan")], quantiles=(0.5,))
+
+    assert result["count"] == 0
+    assert result["mean"] is None and result["median"] is None
+    assert result["quantiles"] == {} and result["histogram"] == []
+
+
+# =============================================================================
+# Tablas cruzadas
+# =============================================================================
+
+def test_crosstab_order_top_k_and_other(backend):
+    ct = backend(crosstab)
+    universe = list(range(1, 31))
+    # R0..R5 con 4 respuestas cada una; la 25 responde dos veces (gana R0)
+    # y de la 26 a la 30 no responden
+    row_ids = list(range(1, 25)) + [25, 25]
+    row_labels = [f"R{i % 6}" for i in range(1, 25)] + ["R5", "R0"]
+    col_ids = list(range(1, 21))
+    col_labels = ["Si" if i % 3 else "No" for i in range(1, 21)]
+
+    result = ct.build_crosstab(universe, row_ids, row_labels, col_ids, col_labels, top_k=3)
+
+    # Total descendente, empates por nombre; lo que pasa del top-3 va a Otros
+    assert result["data"] == {
+        "index": ["R0", "Sin respuesta", "R1", "Otros", "Total"],
+        "columns": ["Si", "Sin respuesta", "No", "Total"],
+        "data": [
+            [0, 2, 3, 5],
+            [0, 5, 0, 5],
+            [4, 0, 0, 4],
+            [10, 3, 3, 16],
+            [14, 10, 6, 30],
+        ],
+    }
+    assert result["total_responses"] == 30
+    assert (result["row_categories"], result["col_categories"]) == (4, 3)
+
+
+def test_crosstab_default_top_10_keeps_all_categories(backend):
+    ct = backend(crosstab)
+    ids = list(range(1, 11))
+    labels = [f"Opcion {i:02d}" for i in ids]
+
+    result = ct.build_crosstab(ids, ids, labels, ids, ["X"] * 10)
+
+    assert result["data"]["index"] == labels + ["Total"]
+    assert "Otros" not in result["data"]["index"]
+
+    result = ct.build_crosstab(ids + [11], ids + [11], labels + ["Opcion 11"], ids, ["X"] * 10)
+
+    # Con 11 categorías la última por nombre (empate en total) cae en Otros;
+    # la respuesta 11 no tiene columna, así que cuenta como Sin respuesta
+    assert result["data"]["index"] == labels + ["Otros", "Total"]
+    assert result["data"]["columns"] == ["X", "Sin respuesta", "Total"]
+    assert result["data"]["data"][10] == [0, 1, 1]
+
+
+# =============================================================================
+# NPS
+# =============================================================================
+
+def test_nps_groups_and_confidence_interval(backend):
+    result = backend(nps).nps_breakdown(
+        [10, 9, 8, 7, 6, 0, 8.5, None],
+        [3, 2, 1, 1, 2, 1, 4, 5],
+        [0, 1, 0, 1, 0, 2, -1, 0],
+    )
+
+    # 8.5 solo cuenta en el total y el segmento -1 solo en el global
+    overall = result["overall"]
+    assert (overall["total"], overall["promoters"], overall["passives"], overall["detractors"]) == (14, 5, 2, 3)
+    assert overall["score"] == pytest.approx(100 * 2 / 14)
+    assert overall["margin"] == pytest.approx(38.88372968)
+    assert (overall["ci_low"], overall["ci_high"]) == pytest.approx((-24.59801539, 53.16944397))
+    assert [(g["total"], g["promoters"], g["passives"], g["detractors"]) for g in result["segments"]] == [
+        (6, 3, 1, 2), (3, 2, 1, 0), (1, 0, 0, 1),
+    ]
+    assert [g["score"] for g in result["segments"]] == pytest.approx([100 / 6, 200 / 3, -100])
+    # El intervalo se recorta a [-100, 100]
+    assert result["segments"][1]["ci_high"] == 100
+    assert result["segments"][2]["margin"] == 0
+
+
+def test_nps_confidence_changes_margin(backend):
+    breakdown = backend(nps).nps_breakdown
+
+    assert breakdown([10, 0], [3, 1])["overall"]["margin"] == pytest.approx(84.86893006)
+    assert breakdown([10, 0], [3, 1], confidence=0.9)["overall"]["margin"] == pytest.approx(71.22425132)
+    assert breakdown([10, 0], [3, 1])["segments"] == []
+
+
+def test_nps_without_answers_keeps_requested_segments(backend):
+    result = backend(nps).nps_breakdown([None, float("nan")], [2, 1], [0, 1], num_segments=2)
+
+    empty = {"total": 0, "promoters": 0, "passives": 0, "detractors": 0,
+             "score": None, "margin": None, "ci_low": None, "ci_high": None}
+    assert result == {"overall": empty, "segments": [empty, empty]}
+
+
+# =============================================================================
+# Correlaciones
+# =============================================================================
+
+def _correlation_triplets():
+    # 10 y 20 comparten las respuestas 1-4 (20 = 10³), 40 baja de 6 a 1 y 30
+    # es constante; la respuesta 1 repite la 10 (gana el último valor)
+    triplets = [(1, 10, 100.0)]
+    triplets += [(r, 10, float(r)) for r in range(1, 6)]
+    triplets += [(r, 20, float(r ** 3)) for r in (1, 2, 3, 4, 6)]
+    triplets += [(r, 30, 3.0) for r in range(1, 7)]
+    triplets += [(r, 40, float(7 - r)) for r in range(1, 7)]
+    return [list(column) for column in zip(*triplets)]
+
+
+def _matrix(frame):
+    return [[None if math.isnan(v) else round(v, 9) for v in row] for row in frame.values.tolist()]
+
+
+def test_pearson_uses_pairwise_complete_observations(backend):
+    corr = backend(correlation)
+
+    frame = corr.correlation_matrix(*_correlation_triplets())
+
+    assert list(frame.index) == [10, 20, 30, 40]
+    # (10, 20) usa las respuestas 1-4 y (20, 40) las 1-4 y 6; 30 no tiene varianza
+    assert _matrix(frame) == [
+        [1.0, 0.951369856, None, -1.0],
+        [0.951369856, 1.0, None, -0.934466519],
+        [None, None, None, None],
+        [-1.0, -0.934466519, None, 1.0],
+    ]
+
+
+def test_spearman_reranks_each_pair(backend):
+    corr = backend(correlation)
+
+    frame = corr.correlation_matrix(*_correlation_triplets(), method="spearman")
+
+    assert _matrix(frame) == [
+        [1.0, 1.0, None, -1.0],
+        [1.0, 1.0, None, -1.0],
+        [None, None, None, None],
+        [-1.0, -1.0, None, 1.0],
+    ]
+
+
+def test_correlation_columns_and_max_columns(backend):
+    corr = backend(correlation)
+    triplets = _correlation_triplets()
+
+    frame = corr.correlation_matrix(*triplets, columns=[40, 10])
+    assert list(frame.columns) == [40, 10]
+    assert frame.loc[40, 10] == pytest.approx(-1.0)
+
+    assert list(corr.correlation_matrix(*triplets, max_columns=2).columns) == [10, 20]
+
+
+# =============================================================================
+# Minería de texto
+# =============================================================================
+
+@pytest.mark.parametrize("text, expected", [
+    ("¡Atención! El café, la niñez y PINGÜINO 2024", " atencion  el cafe  la ninez y pinguino 2024"),
+    ("Ærø Straße", " r  stra e"),
+    ("e\u0301xito", "exito"),  # NFD: la marca combinante no corta la palabra
+    ("", ""),
+])
+def test_fold_text(backend, text, expected):
+    # Cada carácter que no es alfanumérico queda como un espacio
+    assert backend(text_mining).fold_text(text) == expected
+
+
+TEXTS = [
+    "¡La atención fue excelente!",
+    "Atención lenta, pero el café excelente.",
+    "",
+    None,
+    "Excelente atención; muy buena atención",
+    "ok",
+]
+STOPWORDS = ["la", "el", "pero", "muy", "fue"]
+
+
+def test_analyze_texts_top_terms_and_bigrams(backend):
+    tm = backend(text_mining)
+
+    result = tm.analyze_texts(TEXTS, stopwords=STOPWORDS, top_k=3, track=["Atención!", "servicio"])
+
+    assert [tuple(w) for w in result["words"]] == [("atencion", 4), ("excelente", 3), ("buena", 1)]
+    # Los bigramas saltan stopwords y tokens cortos; empates en orden alfabético
+    assert [tuple(b) for b in result["bigrams"]] == [
+        ("atencion buena", 1), ("atencion excelente", 1), ("atencion lenta", 1),
+    ]
+    assert result["tracked"] == {"Atención!": 4, "servicio": 0}
+    assert (result["tokens"], result["documents"]) == (10, 4)
+
+
+def test_analyze_texts_all_terms_without_bigrams(backend):
+    tm = backend(text_mining)
+
+    result = tm.analyze_texts(TEXTS, stopwords=STOPWORDS, top_k=0, bigrams=False)
+
+    assert [tuple(w) for w in result["words"]] == [
+        ("atencion", 4), ("excelente", 3), ("buena", 1), ("cafe", 1), ("lenta", 1),
+    ]
+    assert result["bigrams"] == []
+
+
+# =============================================================================
+# Sentimiento
+# =============================================================================
+
+LEXICON_TERMS = sentiment.build_terms(
+    positive=["bueno", "excelente", "me gusta"], negative=["malo", "no funciona", "lento"],
+)
+
+
+@pytest.mark.parametrize("text, expected", [
+    ("Es bueno", 1.0),
+    ("No es bueno", -1.0),
+    ("no es muy bueno", -1.0),             # el término empieza 2 tokens después
+    ("no es que bueno", -1.0),
+    ("no es que sea bueno", 1.0),          # 3 tokens después: fuera de la ventana
+    ("no, la verdad es que bueno", 1.0),
+    ("No funciona, es malo", -2.0),        # la frase más larga gana a "no"
+    ("Nunca es lento y es excelente", 2.0),
+    ("para nada me gusta", -1.0),          # negador de dos palabras
+    ("sin quejas", 0.0),
+    ("Excelente!! Bueno.", 2.0),
+])
+def test_sentiment_negation_window(backend, text, expected):
+    lexicon = backend(sentiment).SentimentLexicon(LEXICON_TERMS)
+
+    assert lexicon.score([text])["scores"] == [expected]
+
+
+def test_sentiment_custom_window_and_totals(backend):
+    lexicon = backend(sentiment).SentimentLexicon(LEXICON_TERMS, window=1)
+
+    result = lexicon.score(["no bueno", "No es bueno", "Nunca es lento y es excelente", None, "malo malo"])
+
+    assert result["scores"] == [-1.0, 1.0, 0.0, 0.0, -2.0]
+    assert (result["positive"], result["negative"], result["matches"]) == (2.0, 4.0, 6)
+    assert (result["positive_texts"], result["negative_texts"], result["neutral_texts"]) == (1, 2, 2)
+
+
+# =============================================================================
+# Datos personales (PII)
+# =============================================================================
+
+@pytest.mark.parametrize("value, kinds", [
+    ("ana.lopez+x@mi-dominio.com.mx", {"emails"}),
+    ("foo@bar", set()),
+    ("+52 (55) 1234-5678", {"phones"}),
+    ("12345", set()),
+    ("A1B2C3D4", {"identifiers"}),
+    ("12345678", {"phones", "identifiers"}),
+    ("ABCDEFG", set()),
+    ("GODE561231GR8", {"identifiers", "national_ids"}),      # RFC
+    ("GODE561331GR8", {"identifiers"}),                      # mes 13: no es RFC
+    ("GODE561231HDFRRN09", {"identifiers", "national_ids"}), # CURP
+    ("mi DNI es 12345678Z.", {"phones", "national_ids"}),
+    ("RESERVA 2024-0001", {"phones", "identifiers"}),
+])
+def test_pii_detectors(backend, value, kinds):
+    report = backend(pii).scan_values([value])
+
+    assert {key for key in pii.COUNT_KEYS if report[key]} == kinds
+
+
+def test_pii_column_report(backend):
+    scanner = backend(pii)
+
+    report = scanner.scan_values(["ana@example.com", "Ventas", None, "Ventas", "55 1234 5678", "GODE561231GR8", ""])
+
+    # None se omite; las filas marcadas son índices tras omitirlo
+    assert (report["values"], report["distinct"]) == (6, 5)
+    assert (report["emails"], report["phones"], report["identifiers"], report["national_ids"]) == (1, 1, 2, 1)
+    assert report["flagged_rows"] == [0, 3, 4]
+    assert report["identifier_ratio"] == pytest.approx(2 / 6)
+
+
+def test_pii_native_matches_python_on_random_values(monkeypatch):
+    if pii.cpp_csv is None:
+        pytest.skip("cpp_csv no está compilado")
+    rng = random.Random(7)
+    values = ["".join(rng.choice("abcXYZ019@._-+ ()Ññé&%") for _ in range(rng.randint(1, 20))) for _ in range(3000)]
+    values += ["".join(rng.choice("0123456789 -().+") for _ in range(rng.randint(5, 22))) for _ in range(1000)]
+
+    native = [pii.scan_values([v]) for v in values]
+    monkeypatch.setattr(pii, "cpp_csv", None)
+    python = [pii.scan_values([v]) for v in values]
+
+    assert [[r[k] for k in pii.COUNT_KEYS] for r in native] == [[r[k] for k in pii.COUNT_KEYS] for r in python]
+
+
+# =============================================================================
+# Índice de textos: citas y palabras en contexto
+# =============================================================================
+
+INDEX_TEXTS = [
+    "La atención fue excelente y rápida.",
+    "Atención regular.",
+    "Muy buena atención, excelente servicio; la atención al cliente mejoró.",
+    "Sin comentarios",
+    None,
+    "El servicio al cliente fue excelente, la atención también.",
+]
+
+
+def test_text_index_postings(backend):
+    index = backend(text_index).TextIndex(INDEX_TEXTS)
+
+    assert (index.documents, index.terms) == (6, 17)
+    assert index.postings("Atención") == [(0, 1), (1, 0), (2, 2), (2, 6), (5, 7)]
+    assert index.postings(" servicio ") == [(2, 4), (5, 1)]
+    assert index.postings("nada") == []
+
+
+@pytest.mark.parametrize("terms, kwargs, expected", [
+    (["atencion"], {}, 2),                      # más apariciones; la fila 1 es muy corta
+    (["atencion"], {"max_length": 40}, 0),
+    (["excelente", "servicio"], {}, 2),         # empate con la fila 5: gana la primera
+    (["atencion al cliente"], {}, 2),           # frase = tokens consecutivos
+    (["atención", "regular"], {}, None),        # la única fila con ambos no cumple el largo
+    (["inexistente"], {}, None),
+    ([], {}, None),
+])
+def test_text_index_best_quote(backend, terms, kwargs, expected):
+    index = backend(text_index).TextIndex(INDEX_TEXTS)
+
+    assert index.best_quote(terms, **kwargs) == expected
+
+
+def test_text_index_keyword_in_context(backend):
+    index = backend(text_index).TextIndex(INDEX_TEXTS)
+
+    # El contexto se cuenta en caracteres y la coincidencia conserva el texto original
+    assert index.keyword_in_context("ATENCION al", width=6) == [
+        {"row": 2, "left": "o; la ", "match": "atención al", "right": " clien"},
+    ]
+    assert index.keyword_in_context("atención", width=4, limit=2) == [
+        {"row": 0, "left": "La ", "match": "atención", "right": " fue"},
+        {"row": 1, "left": "", "match": "Atención", "right": " reg"},
+    ]
+    assert index.keyword_in_context("rápida", width=100) == [
+        {"row": 0, "left": "La atención fue excelente y ", "match": "rápida", "right": "."},
+    ]
+    assert index.keyword_in_context("nada") == []
@@ -0,0 +1,312 @@
+"""
+Tests del cubo columnar de encuestas (core/utils/survey_cube), de sus
+conjuntos de filas y de los codificadores de exportación (CSV) e
+importación (COPY binario). Cada test corre con el kernel nativo de cpp_csv
+y con el de Python y espera el mismo resultado; el nativo se salta si el
+módulo no está compilado.
+"""
+import csv
+import io
+import struct
+from datetime import date
+
+import pytest
+
+from core.utils import csv_export, pgcopy, survey_cube
+from core.utils.survey_cube import CHOICE, NUMERIC, SurveyCube
+
+
+@pytest.fixture(params=["python", "native"])
+def backend(request, monkeypatch):
+    """Devuelve `use(module)`, que fija el backend del módulo para el test."""
+    def use(module):
+        if request.param == "python":
+            monkeypatch.setattr(module, "cpp_csv", None)
+        elif module.cpp_csv is None:
+            pytest.skip("cpp_csv no está compilado")
+        return module
+    return use
+
+
+# =============================================================================
+# Cubo
+# =============================================================================
+
+def _small_cube():
+    # El 10 repetido conserva la primera fecha; la respuesta 99 no está en el
+    # universo y la etiqueta vacía y el NaN se descartan.
+    return SurveyCube.build(
+        [30, 10, 20, 40, 10],
+        [date(2024, 1, 3), date(2024, 1, 1), date(2024, 1, 1), None, date(2024, 1, 9)],
+        choice_columns={
+            1: (
+                [10, 20, 20, 30, 40, 99, 30, 40],
+                ["Ventas", "IT", "Ventas", "IT", "", "Ventas", "Otro depto", "Ventas Norte"],
+                [1, 1, 1, 1, 1, 1, 0, 1],
+            ),
+        },
+        numeric_columns={2: ([10, 20, 30, 40, 20], [5, 3, 5, float("nan"), 9])},
+    )
+
+
+def test_cube_columns_and_counts(backend):
+    backend(survey_cube)
+    cube = _small_cube()
+
+    assert cube.rows == 4
+    assert (cube.kind(1), cube.kind(2)) == (CHOICE, NUMERIC)
+    assert cube.has_question(1) and not cube.has_question(3)
+    assert cube.response_ids() == [10, 20, 30, 40]
+    assert cube.last_response_id() == 40
+    assert cube.choice_counts(1) == [("Ventas", 2), ("IT", 2), ("Ventas Norte", 1)]
+    assert cube.choice_counts(1, options_only=False) == [
+        ("Ventas", 2), ("IT", 2), ("Otro depto", 1), ("Ventas Norte", 1),
+    ]
+    assert cube.numeric_distribution(2) == [(3.0, 1), (5.0, 2), (9.0, 1)]
+    # Las respuestas sin fecha no aparecen en la serie diaria
+    assert cube.day_counts() == [(date(2024, 1, 1), 2), (date(2024, 1, 3), 1)]
+
+
+def test_cube_row_selections(backend):
+    backend(survey_cube)
+    cube = _small_cube()
+
+    assert cube.rows_between(date(2024, 1, 1), date(2024, 1, 2)).rows() == [0, 1]
+    assert cube.rows_with_labels(1, ["IT"]).rows() == [1, 2]
+    assert cube.rows_containing(1, "VENTAS").rows() == [0, 1, 3]
+    assert cube.rows_with_numbers(2, [5]).rows() == [0, 2]
+    assert cube.rows_with_numbers(1, [5]).rows() == []  # columna de opciones
+    assert cube.rows_with_values(2, 4, 10).rows() == [0, 1, 2]
+
+
+def test_cube_counts_within_rows(backend):
+    backend(survey_cube)
+    cube = _small_cube()
+    it = cube.rows_with_labels(1, ["IT"])
+    subset = cube.rows_containing(1, "ventas") & cube.rows_with_values(2, 4, 10)
+
+    assert (subset.rows(), len(subset), cube.count(subset)) == ([0, 1], 2, 2)
+    assert cube.choice_counts(1, subset) == [("Ventas", 2), ("IT", 1)]
+    assert cube.numeric_distribution(2, ~it) == [(5.0, 1)]
+    assert cube.last_response_id(it) == 30
+    assert cube.response_ids(it) == [20, 30]
+    assert cube.day_counts(it) == [(date(2024, 1, 1), 1), (date(2024, 1, 3), 1)]
+
+
+def test_cube_save_and_open_native(tmp_path):
+    if survey_cube.cpp_csv is None:
+        pytest.skip("cpp_csv no está compilado")
+    path = tmp_path / "encuesta.cube"
+
+    assert _small_cube().save(path)
+    cube = SurveyCube.open(str(path))
+
+    assert cube.mapped and cube.nbytes > 0
+    assert cube.choice_counts(1, cube.rows_with_labels(1, ["IT"])) == [("Ventas", 1), ("IT", 2)]
+    assert cube.numeric_distribution(2) == [(3.0, 1), (5.0, 2), (9.0, 1)]
+
+
+def test_python_cube_is_memory_only(monkeypatch, tmp_path):
+    monkeypatch.setattr(survey_cube, "cpp_csv", None)
+
+    assert not _small_cube().save(tmp_path / "encuesta.cube")
+    assert SurveyCube.open(str(tmp_path / "encuesta.cube")) is None
+
+
+# =============================================================================
+# Álgebra de conjuntos de filas
+# =============================================================================
+
+# Más de dos bloques de 65536 filas: conjuntos densos (contenedores bitset)
+# y dispersos (contenedores de arreglo) en el cubo nativo.
+ROWS = 140000
+
+
+def _large_cube():
+    labels = {1: ([], [], [])}
+    for i in range(ROWS):
+        for label in ["par" if i % 2 == 0 else "impar"] + (["mil"] if i % 1000 == 0 else []):
+            labels[1][0].append(i + 1)
+            labels[1][1].append(label)
+            labels[1][2].append(1)
+    numbers = [i + 1 for i in range(0, ROWS, 3)]
+    return SurveyCube.build(
+        list(range(1, ROWS + 1)),
+        [1 + i // 40000 for i in range(ROWS)],  # días ordinales 1..4
+        choice_columns=labels,
+        numeric_columns={2: (numbers, [(n - 1) % 7 for n in numbers])},
+    )
+
+
+def test_row_set_algebra_matches_python_sets(backend):
+    backend(survey_cube)
+    cube = _large_cube()
+    par = cube.rows_with_labels(1, ["par"])
+    mil = cube.rows_with_labels(1, ["mil"])
+    bajos = cube.rows_with_values(2, 0, 2)
+    fecha = cube.rows_between(2, 3)
+
+    everything = set(range(ROWS))
+    s_par = {i for i in everything if i % 2 == 0}
+    s_mil = {i for i in everything if i % 1000 == 0}
+    s_bajos = {i for i in everything if i % 3 == 0 and i % 7 <= 2}
+    s_fecha = set(range(40000, 120000))
+
+    assert (len(par), len(mil), len(bajos), len(fecha)) == (70000, 140, len(s_bajos), 80000)
+    assert ((par & fecha) - mil).rows() == sorted((s_par & s_fecha) - s_mil)
+    assert ((mil | bajos) & ~par).rows() == sorted((s_mil | s_bajos) - s_par)
+    assert (~fecha).rows() == sorted(everything - s_fecha)
+    assert (par - par).rows() == []
+    assert len(fecha | ~fecha) == ROWS
+    assert ~~fecha == fecha
+    assert 65536 in par and 65537 not in par and ROWS not in par
+    assert cube.count(mil & fecha) == 80
+
+
+def test_row_set_counts_and_ids(backend):
+    backend(survey_cube)
+    cube = _large_cube()
+    subset = cube.rows_with_labels(1, ["mil"]) - cube.rows_between(1, 1)
+
+    assert cube.choice_counts(1, subset) == [("par", 100), ("mil", 100)]
+    assert cube.response_ids(subset)[:2] == [40001, 41001]
+    assert cube.last_response_id(subset) == 139001
+    assert cube.day_counts(subset) == [(date.fromordinal(d), n) for d, n in [(2, 40), (3, 40), (4, 20)]]
+
+
+# =============================================================================
+# Codificador CSV de exportación
+# =============================================================================
+
+NAN = float("nan")
+
+
+def _encode(encoder, rows, leading, cells):
+    columns = [list(column) for column in zip(*cells)] or [[]] * 5
+    return b"".join(encoder.encode(rows, leading, *columns))
+
+
+def test_csv_encoder_quoting_and_cell_values(backend):
+    encoder = backend(csv_export).build_table_encoder(
+        ["ID", "Fecha", "Comentario", "Área", "Puntaje"],
+        {3: ["Ventas, Norte", 'Dijo "sí"', "IT"]},
+    )
+    # (fila, columna, texto, número, código), en desorden; el código 7 no
+    # está en el diccionario y no deja separador colgando
+    cells = [
+        (2, 3, "", NAN, 7), (2, 3, "", NAN, 2), (2, 4, "", NAN, -1),
+        (0, 4, "", 5.0, -1), (0, 2, "hola, mundo", NAN, -1), (0, 3, "", NAN, 0),
+        (1, 2, "línea\nnueva", NAN, -1), (1, 3, "", NAN, 1), (1, 3, "", NAN, 2), (1, 4, "", 2.5, -1),
+    ]
+
+    data = _encode(encoder, 3, [["1", "2", "3"], ["2024-01-01", None, "2024-01-03"]], cells)
+
+    assert encoder.columns == 5
+    assert encoder.header() == "ID,Fecha,Comentario,Área,Puntaje\r\n".encode()
+    assert data.decode() == (
+        '1,2024-01-01,"hola, mundo","Ventas, Norte",5\r\n'
+        '2,,"línea\nnueva","Dijo ""sí"", IT",2.5\r\n'
+        "3,2024-01-03,,IT,\r\n"
+    )
+    assert list(csv.reader(io.StringIO(data.decode(), newline=""))) == [
+        ["1", "2024-01-01", "hola, mundo", "Ventas, Norte", "5"],
+        ["2", "", "línea\nnueva", 'Dijo "sí", IT', "2.5"],
+        ["3", "2024-01-03", "", "IT", ""],
+    ]
+
+
+def test_csv_encoder_delimiter_separator_and_chunks(backend):
+    encoder = backend(csv_export).build_table_encoder(
+        ["a;b", "c"], delimiter=";", multi_separator="|", chunk_size=8,
+    )
+
+    chunks = encoder.encode(
+        3, [["x;1", "y", "z"]], [0, 0, 2], [1, 1, 1], ["p", "q", ""], [NAN, NAN, -0.5], [-1, -1, -1],
+    )
+
+    assert encoder.header() == b'"a;b";c\r\n'
+    assert b"".join(chunks) == b'"x;1";p|q\r\ny;\r\nz;-0.5\r\n'
+    assert len(chunks) > 1 and all(chunk.endswith(b"\r\n") for chunk in chunks)
+
+
+def test_csv_encoder_single_empty_field_is_quoted(backend):
+    encoder = backend(csv_export).build_table_encoder(["solo"])
+
+    # Una línea en blanco se perdería al leer el archivo
+    assert _encode(encoder, 2, [["", "x"]], []) == b'""\r\nx\r\n'
+
+
+def test_csv_encoder_rejects_cells_outside_table(backend):
+    encoder = backend(csv_export).build_table_encoder(["ID", "P1"])
+
+    with pytest.raises(IndexError):
+        encoder.encode(1, [["1"]], [0], [0], ["x"], [NAN], [-1])
+    with pytest.raises(IndexError):
+        encoder.encode(1, [["1"]], [1], [1], ["x"], [NAN], [-1])
+
+
+# =============================================================================
+# COPY binario de PostgreSQL
+# =============================================================================
+
+def _field(fmt, *values):
+    data = struct.pack(fmt, *values)
+    return struct.pack(">i", len(data)) + data
+
+
+def test_copy_encoder_byte_layout(backend):
+    encoder = backend(pgcopy).build_copy_encoder(["int2", "text", "int8"])
+
+    data = encoder.encode([[1, None, -2], ["añ", "", None], [2 ** 40, 0, None]])
+
+    null = struct.pack(">i", -1)
+    fields = struct.pack(">h", 3)
+    assert encoder.columns == 3
+    assert data == (
+        b"PGCOPY\n\xff\r\n\x00" + struct.pack(">ii", 0, 0)
+        + fields + _field(">h", 1) + _field("3s", "añ".encode()) + _field(">q", 2 ** 40)
+        + fields + null + struct.pack(">i", 0) + _field(">q", 0)
+        + fields + _field(">h", -2) + null + null
+        + b"\xff\xff"
+    )
+
+
+def test_copy_encoder_batches_concatenate(backend):
+    module = backend(pgcopy)
+    encoder = module.build_copy_encoder(["int4", "text"])
+    columns = [[1, 2, 3], ["a", "b", None]]
+
+    batches = (
+        encoder.encode([columns[0][:2], columns[1][:2]], trailer=False)
+        + encoder.encode([columns[0][2:], columns[1][2:]], header=False)
+    )
+
+    assert batches == encoder.encode(columns)
+    assert encoder.encode([[], []]) == module.COPY_HEADER + module.COPY_TRAILER
+    # Los nombres de PostgreSQL son alias de los anchos
+    assert module.build_copy_encoder(["integer", "text"]).encode(columns) == encoder.encode(columns)
+
+
+@pytest.mark.parametrize("kind, value", [
+    ("int2", 2 ** 15), ("int2", -2 ** 15 - 1), ("int4", 2 ** 31), ("int8", 2 ** 63),
+])
+def test_copy_encoder_rejects_out_of_range_integers(backend, kind, value):
+    encoder = backend(pgcopy).build_copy_encoder([kind])
+
+    assert encoder.encode([[value - 1 if value > 0 else value + 1]])
+    with pytest.raises(OverflowError):
+        encoder.encode([[value]])
+
+
+def test_copy_encoder_validates_shape_and_types(backend):
+    module = backend(pgcopy)
+    encoder = module.build_copy_encoder(["int4", "text"])
+
+    with pytest.raises(ValueError):
+        encoder.encode([[1]])
+    with pytest.raises(ValueError):
+        encoder.encode([[1, 2], ["a"]])
+    with pytest.raises(ValueError):
+        module.build_copy_encoder(["float8"])
+    with pytest.raises(ValueError):
+        module.build_copy_encoder([])
@@ -1,5 +1,6 @@
 """
-Tests unitarios para TextAnalyzer, DataFrameBuilder, QuestionAnalyzer y NPSCalculator
+Tests unitarios para TextAnalyzer, DataFrameBuilder, QuestionAnalyzer, NPSCalculator
+y la versión del cubo de SurveyCubeService
 """
 import pytest
 from unittest.mock import patch
@@ -14,6 +15,7 @@ from core.services.analysis_service import (
     QuestionAnalyzer,
     NPSCalculator,
 )
+from core.services.survey_cube import SurveyCubeService
 
 
 # ============================================================================
@@ -726,3 +728,55 @@ class TestNPSCalculator:
         
         # NPS = (0% promoters) - (0% detractors) = 0
         assert result['score'] == 0.0
+
+
+# ============================================================================
+# TESTS: SurveyCubeService (versión del cubo)
+# ============================================================================
+
+class TestSurveyCubeVersion:
+    """La versión cambia con cualquier edición que altere el contenido del cubo."""
+
+    @staticmethod
+    def _version(survey):
+        return SurveyCubeService._version(survey, SurveyCubeService._cube_questions(survey))
+
+    @pytest.fixture
+    def answered(self, question_single, survey_response):
+        red = question_single.options.get(text='Red')
+        return QuestionResponse.objects.create(
+            survey_response=survey_response, question=question_single, selected_option=red,
+        )
+
+    @pytest.mark.django_db
+    def test_version_is_stable_without_changes(self, survey, answered):
+        assert self._version(survey) == self._version(survey)
+
+    @pytest.mark.django_db
+    def test_version_changes_when_answer_is_reassigned(self, survey, question_single, answered):
+        before = self._version(survey)
+        QuestionResponse.objects.filter(id=answered.id).update(
+            selected_option=question_single.options.get(text='Blue'),
+        )
+        assert self._version(survey) != before
+
+    @pytest.mark.django_db
+    def test_version_changes_when_options_are_recreated(self, survey, question_single, answered):
+        # Como la edición de un borrador: se borran y se recrean las opciones
+        before = self._version(survey)
+        question_single.options.all().delete()
+        for text in ('Red', 'Blue', 'Green'):
+            AnswerOption.objects.create(question=question_single, text=text)
+        assert self._version(survey) != before
+
+    @pytest.mark.django_db
+    def test_version_changes_when_option_is_renamed(self, survey, question_single, answered):
+        before = self._version(survey)
+        AnswerOption.objects.filter(question=question_single, text='Red').update(text='Rojo')
+        assert self._version(survey) != before
+
+    @pytest.mark.django_db
+    def test_version_changes_when_answer_is_added(self, survey, question_scale, survey_response, answered):
+        before = self._version(survey)
+        QuestionResponse.objects.create(survey_response=survey_response, question=question_scale, numeric_value=7)
+        assert self._version(survey) != before
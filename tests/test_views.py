@@ -25,3 +25,28 @@ def test_dashboard_results_view_authenticated():
     assert response.status_code == 200
     assert 'total_responses' in response.context
     assert 'global_satisfaction' in response.context
+
+
+@pytest.mark.django_db
+def test_export_survey_csv_streams_synchronously_under_wsgi():
+    from surveys.models import AnswerOption, Question, QuestionResponse, Survey, SurveyResponse
+
+    user = User.objects.create_user(username='testuser', password='testpass')
+    survey = Survey.objects.create(author=user, title='Exportable')
+    question = Question.objects.create(survey=survey, text='Color', type='single', order=1)
+    rojo = AnswerOption.objects.create(question=question, text='Rojo')
+    for _ in range(3):
+        response = SurveyResponse.objects.create(survey=survey, user=user)
+        QuestionResponse.objects.create(survey_response=response, question=question, selected_option=rojo)
+    client = Client()
+    client.login(username='testuser', password='testpass')
+
+    response = client.get(reverse('surveys:export', args=[survey.public_id]))
+
+    assert response.status_code == 200
+    # Bajo WSGI el contenido es un iterador síncrono: Django no lo junta en memoria
+    assert not response.is_async
+    lines = b''.join(response.streaming_content).decode('utf-8-sig').splitlines()
+    assert lines[0] == 'ID,Fecha,Usuario,Color'
+    assert len(lines) == 4
+    assert all(line.endswith(',testuser,Rojo') for line in lines[1:])
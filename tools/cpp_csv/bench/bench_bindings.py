@@ -0,0 +1,93 @@
+"""
+Benchmark de la capa pybind11 (incluye la creación de dicts/objetos de Python).
+
+Complementa a cpp_csv_bench, que mide solo el núcleo C++. Escribe el mismo
+formato JSON de Google Benchmark para usarlo con compare_results.py:
+
+    python tools/cpp_csv/bench/bench_bindings.py archivo.csv [...] --out bindings.json
+
+Los CSV pueden ser los generados por cpp_csv_bench en $CPP_CSV_BENCH_DATA.
+"""
+import argparse
+import csv
+import json
+import os
+import sys
+import time
+
+sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..', '..')))
+
+from tools.cpp_csv import pybind_csv  # noqa: E402
+
+RESULTS_SCHEMA = '1'
+
+
+def python_dicts(path):
+    with open(path, newline='', encoding='utf-8') as fh:
+        return list(csv.DictReader(fh))
+
+
+def iter_chunks(path):
+    rows = 0
+    for chunk in pybind_csv.iter_csv_dict_chunks(path):
+        rows += len(chunk)
+    return rows
+
+
+def projected_dicts(path):
+    # Solo las dos primeras columnas (usecols): el resto no crea objetos
+    return pybind_csv.read_csv_dicts(path, usecols=[0, 1])
+
+
+CASES = {
+    'BM_PyDictReader': python_dicts,
+    'BM_ReadCsvDicts': pybind_csv.read_csv_dicts,
+    'BM_ReadCsvDictsProjected': projected_dicts,
+    'BM_IterCsvDictChunks': iter_chunks,
+}
+
+
+def run_case(func, path, repetitions):
+    best = float('inf')
+    for _ in range(repetitions):
+        start = time.perf_counter()
+        func(path)
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('files', nargs='+')
+    parser.add_argument('--repetitions', type=int, default=3)
+    parser.add_argument('--out', help='archivo JSON de salida (formato Google Benchmark)')
+    args = parser.parse_args(argv)
+
+    benchmarks = []
+    for path in args.files:
+        size = os.path.getsize(path)
+        label = os.path.splitext(os.path.basename(path))[0]
+        for name, func in CASES.items():
+            seconds = run_case(func, path, args.repetitions)
+            benchmarks.append({
+                'name': f'{name}/{label}',
+                'run_type': 'iteration',
+                'iterations': args.repetitions,
+                'real_time': seconds * 1e3,
+                'cpu_time': seconds * 1e3,
+                'time_unit': 'ms',
+                'bytes_per_second': size / seconds if seconds else 0.0,
+            })
+            print(f"{name + '/' + label:<55} {seconds * 1e3:>10.2f} ms")
+
+    if args.out:
+        result = {
+            'context': {'cpp_csv.results_schema': RESULTS_SCHEMA, 'library': 'pybind_csv'},
+            'benchmarks': benchmarks,
+        }
+        with open(args.out, 'w', encoding='utf-8') as fh:
+            json.dump(result, fh, indent=2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,76 @@
+"""
+Compara dos resultados de Google Benchmark (JSON) y falla si hay regresiones.
+
+Uso:
+    python compare_results.py baseline.json results.json [--threshold 0.10]
+
+Ambos archivos se generan con:
+    cpp_csv_bench --benchmark_out=results.json --benchmark_out_format=json
+(o con bench_bindings.py, que escribe el mismo formato).
+
+Sale con código 1 si algún benchmark es más lento que el baseline por encima
+del umbral (real_time), para poder usarlo en CI.
+"""
+import argparse
+import json
+import sys
+
+RESULTS_SCHEMA_KEY = 'cpp_csv.results_schema'
+
+
+def load(path):
+    with open(path, encoding='utf-8') as fh:
+        data = json.load(fh)
+    results = {}
+    for bench in data.get('benchmarks', []):
+        # Solo corridas individuales (no agregados mean/median/stddev)
+        if bench.get('run_type', 'iteration') != 'iteration' or bench.get('error_occurred'):
+            continue
+        results[bench['name']] = bench
+    return data.get('context', {}), results
+
+
+def to_ns(bench):
+    factor = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}[bench.get('time_unit', 'ns')]
+    return bench['real_time'] * factor
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help='regresión relativa tolerada (0.10 = 10%%)')
+    args = parser.parse_args(argv)
+
+    base_ctx, baseline = load(args.baseline)
+    curr_ctx, current = load(args.current)
+
+    if base_ctx.get(RESULTS_SCHEMA_KEY) != curr_ctx.get(RESULTS_SCHEMA_KEY):
+        print(f"⚠️  Versión de resultados distinta ({base_ctx.get(RESULTS_SCHEMA_KEY)} vs "
+              f"{curr_ctx.get(RESULTS_SCHEMA_KEY)}): la comparación puede no ser válida")
+
+    regressions = []
+    print(f"{'benchmark':<55} {'baseline':>12} {'actual':>12} {'cambio':>9}")
+    for name in sorted(baseline.keys() & current.keys()):
+        before, after = to_ns(baseline[name]), to_ns(current[name])
+        change = (after - before) / before if before else 0.0
+        flag = ''
+        if change > args.threshold:
+            regressions.append(name)
+            flag = '  ❌'
+        print(f"{name:<55} {before / 1e6:>10.3f}ms {after / 1e6:>10.3f}ms {change:>+8.1%}{flag}")
+
+    missing = sorted(baseline.keys() - current.keys())
+    if missing:
+        print(f"\nSin resultado actual ({len(missing)}): {', '.join(missing)}")
+
+    if regressions:
+        print(f"\n❌ {len(regressions)} regresiones por encima de {args.threshold:.0%}")
+        return 1
+    print(f"\n✅ Sin regresiones por encima de {args.threshold:.0%}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
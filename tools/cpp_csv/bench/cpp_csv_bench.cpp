@@ -0,0 +1,1009 @@
+// Benchmarks del núcleo de cpp_csv (Google Benchmark).
+//
+// Los archivos de prueba se generan una vez (determinísticos) en
+// $CPP_CSV_BENCH_DATA (o el directorio temporal) y se reutilizan entre
+// corridas. Formas: narrow, wide, text (texto largo) y quoted_newline
+// (comentarios con saltos de línea entre comillas); tamaños de 10k, 100k y
+// 1M filas ($CPP_CSV_BENCH_MAX_ROWS limita el máximo).
+//
+// Resultados para seguimiento entre versiones:
+//   cpp_csv_bench --benchmark_out=results.json --benchmark_out_format=json
+//   python bench/compare_results.py baseline.json results.json
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/arena.hpp"
+#include "core/correlation.hpp"
+#include "core/crosstab.hpp"
+#include "core/cube.hpp"
+#include "core/discovery.hpp"
+#include "core/lexicon.hpp"
+#include "core/memory_budget.hpp"
+#include "core/metrics.hpp"
+#include "core/multiselect.hpp"
+#include "core/nps.hpp"
+#include "core/pgcopy.hpp"
+#include "core/pii.hpp"
+#include "core/predicate.hpp"
+#include "core/prefetch_reader.hpp"
+#include "core/progress.hpp"
+#include "core/projection.hpp"
+#include "core/reader.hpp"
+#include "core/roaring.hpp"
+#include "core/scheduler.hpp"
+#include "core/search.hpp"
+#include "core/stats.hpp"
+#include "core/text.hpp"
+#include "core/trace.hpp"
+#include "core/validation.hpp"
+#include "core/writer.hpp"
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace csvcore;
+
+// Versión del formato de resultados (subir si cambian nombres/argumentos
+// de los benchmarks, para no comparar cosas distintas).
+constexpr const char *kResultsSchema = "1";
+
+enum Shape : int64_t { NARROW = 0, WIDE = 1, TEXT = 2, QUOTED_NEWLINE = 3 };
+
+const char *shape_name(int64_t shape) {
+    switch (shape) {
+        case NARROW: return "narrow";
+        case WIDE: return "wide";
+        case TEXT: return "text";
+        default: return "quoted_newline";
+    }
+}
+
+// Generador determinístico (LCG): mismos archivos en cada máquina.
+class Rng {
+public:
+    explicit Rng(std::uint64_t seed) : state_(seed) {}
+    std::uint32_t next() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<std::uint32_t>(state_ >> 33);
+    }
+    std::uint32_t below(std::uint32_t n) { return next() % n; }
+
+private:
+    std::uint64_t state_;
+};
+
+const char *const kDepartments[] = {"Ventas", "IT", "RRHH", "Marketing", "Finanzas"};
+const char *const kServices[] = {"Limpieza", "Comida", "Wifi", "Atención", "Precio"};
+const char *const kWords[] = {"excelente", "servicio", "muy", "bueno", "la", "atención",
+                              "mala", "lento", "personal", "amable", "precio", "alto"};
+
+void write_sentence(std::ostream &out, Rng &rng, int words) {
+    for (int w = 0; w < words; ++w) {
+        out << (w ? " " : "") << kWords[rng.below(12)];
+        if (rng.below(8) == 0) out << ",";
+    }
+}
+
+void generate(const fs::path &path, int64_t shape, int64_t rows) {
+    std::ofstream out(path, std::ios::binary);
+    Rng rng(static_cast<std::uint64_t>(shape * 1000003 + rows));
+
+    switch (shape) {
+        case NARROW:
+            out << "id,Fecha,Edad,Satisfaccion,Departamento,Servicios,NPS,Comentario\n";
+            for (int64_t r = 0; r < rows; ++r) {
+                out << r << ",2025-0" << 1 + rng.below(9) << "-1" << rng.below(10) << ","
+                    << 18 + rng.below(60) << "," << rng.below(11) << ","
+                    << kDepartments[rng.below(5)] << ",\""
+                    << kServices[rng.below(5)] << "; " << kServices[rng.below(5)] << "\","
+                    << rng.below(11) << "," << kWords[rng.below(12)] << "\n";
+            }
+            break;
+
+        case WIDE:
+            out << "id";
+            for (int c = 1; c < 60; ++c) out << ",Pregunta " << c;
+            out << "\n";
+            for (int64_t r = 0; r < rows; ++r) {
+                out << r;
+                for (int c = 1; c < 60; ++c) {
+                    if (c % 3 == 0) out << "," << kDepartments[rng.below(5)];
+                    else out << "," << rng.below(11);
+                }
+                out << "\n";
+            }
+            break;
+
+        case TEXT:
+            out << "id,Comentario,Sugerencias,Queja,Satisfaccion\n";
+            for (int64_t r = 0; r < rows; ++r) {
+                out << r;
+                for (int c = 0; c < 3; ++c) {
+                    out << ",\"";
+                    write_sentence(out, rng, 20 + static_cast<int>(rng.below(20)));
+                    out << "\"";
+                }
+                out << "," << rng.below(11) << "\n";
+            }
+            break;
+
+        default:  // QUOTED_NEWLINE
+            out << "id,Comentario,Satisfaccion\n";
+            for (int64_t r = 0; r < rows; ++r) {
+                out << r << ",\"";
+                write_sentence(out, rng, 8);
+                out << "\n";
+                write_sentence(out, rng, 6);
+                out << " \"\"cita\"\"\r\n";
+                write_sentence(out, rng, 4);
+                out << "\"," << rng.below(11) << "\r\n";
+            }
+            break;
+    }
+}
+
+int64_t max_rows() {
+    const char *env = std::getenv("CPP_CSV_BENCH_MAX_ROWS");
+    return env ? std::atoll(env) : 1000000;
+}
+
+// Ruta del archivo de prueba (se genera la primera vez).
+std::string dataset(int64_t shape, int64_t rows) {
+    const char *env = std::getenv("CPP_CSV_BENCH_DATA");
+    fs::path dir = env ? fs::path(env) : fs::temp_directory_path() / "cpp_csv_bench";
+    fs::create_directories(dir);
+    fs::path path = dir / (std::string(shape_name(shape)) + "_" + std::to_string(rows) + ".csv");
+    if (!fs::exists(path)) {
+        generate(path, shape, rows);
+    }
+    return path.string();
+}
+
+// Prepara el estado del benchmark; false si el tamaño excede el máximo.
+bool setup(benchmark::State &state, int64_t shape, int64_t rows, std::string &path) {
+    if (rows > max_rows()) {
+        state.SkipWithError("omitido por CPP_CSV_BENCH_MAX_ROWS");
+        return false;
+    }
+    path = dataset(shape, rows);
+    state.SetLabel(shape_name(shape));
+    return true;
+}
+
+void finish(benchmark::State &state, const std::string &path, int64_t rows) {
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file_size(path)));
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+
+void ShapeAndRows(benchmark::internal::Benchmark *b) {
+    b->ArgNames({"shape", "rows"});
+    for (int64_t shape : {NARROW, WIDE, TEXT, QUOTED_NEWLINE}) {
+        for (int64_t rows : {10000, 100000, 1000000}) {
+            b->Args({shape, rows});
+        }
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+void NarrowRows(benchmark::internal::Benchmark *b) {
+    b->ArgNames({"rows"});
+    for (int64_t rows : {10000, 100000, 1000000}) {
+        b->Arg(rows);
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+// --- Tokenización: archivo -> arena, chunk por chunk ---
+void BM_Tokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, state.range(0), state.range(1), path)) return;
+
+    ChunkArena arena;
+    for (auto _ : state) {
+        CsvChunkReader reader(path, ',');
+        std::size_t cells = 0;
+        while (reader.next_chunk(arena)) {
+            for (std::size_t r = 0; r < arena.rows(); ++r) cells += arena.row_size(r);
+        }
+        benchmark::DoNotOptimize(cells);
+    }
+    finish(state, path, state.range(1));
+}
+BENCHMARK(BM_Tokenize)->Apply(ShapeAndRows);
+
+// --- Igual, con el hilo de prefetch (lo que usa CsvChunkIterator) ---
+void BM_PrefetchTokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, state.range(0), state.range(1), path)) return;
+
+    for (auto _ : state) {
+        PrefetchReader reader(path, ',', 2500, 2);
+        std::size_t rows = 0;
+        while (ChunkArena *arena = reader.next()) {
+            rows += arena->rows();
+            reader.release(arena);
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+    finish(state, path, state.range(1));
+}
+BENCHMARK(BM_PrefetchTokenize)->Apply(ShapeAndRows)->UseRealTime();
+
+// --- Conversión a "dicts": la parte C++ de read_csv_dicts (header -> celda).
+// La creación de objetos de Python se mide en bench/bench_bindings.py.
+void BM_DictsConversion(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, state.range(0), state.range(1), path)) return;
+
+    ChunkArena arena;
+    for (auto _ : state) {
+        CsvChunkReader reader(path, ',');
+        std::vector<std::string> header = read_header(reader, arena);
+        std::size_t total = 0;
+        std::unordered_map<std::string_view, std::string_view> row;
+        while (reader.next_chunk(arena)) {
+            for (std::size_t r = 0; r < arena.rows(); ++r) {
+                row.clear();
+                std::size_t cols = std::min(header.size(), arena.row_size(r));
+                for (std::size_t j = 0; j < cols; ++j) row[header[j]] = arena.cell(r, j);
+                total += row.size();
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    finish(state, path, state.range(1));
+}
+BENCHMARK(BM_DictsConversion)->Apply(ShapeAndRows);
+
+// --- Validación completa (read_and_validate_csv) sobre el archivo narrow ---
+void BM_Validate(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    using namespace validation;
+    std::unordered_map<std::string, ValidationRule> rules;
+    rules["Edad"].type = FieldType::NUMBER;
+    rules["Satisfaccion"].type = FieldType::SCALE;
+    rules["NPS"].type = FieldType::SCALE;
+    rules["Departamento"].type = FieldType::SINGLE;
+    rules["Departamento"].valid_options = {"Ventas", "IT", "RRHH", "Marketing", "Finanzas"};
+    rules["Comentario"].type = FieldType::TEXT;
+
+    ChunkArena arena;
+    for (auto _ : state) {
+        CsvChunkReader reader(path, ',');
+        std::vector<std::string> header = read_header(reader, arena);
+        std::vector<const ValidationRule *> column_rules;
+        for (const auto &name : header) {
+            auto it = rules.find(name);
+            column_rules.push_back(it != rules.end() ? &it->second : nullptr);
+        }
+        std::vector<ValidationError> errors;
+        std::size_t row_index = 0, converted = 0;
+        while (reader.next_chunk(arena)) {
+            for (std::size_t r = 0; r < arena.rows(); ++r) {
+                ++row_index;
+                std::size_t cols = std::min(header.size(), arena.row_size(r));
+                for (std::size_t j = 0; j < cols; ++j) {
+                    if (column_rules[j] == nullptr) continue;
+                    ValidatedValue v = validate_value(arena.cell(r, j), *column_rules[j],
+                                                      row_index, header[j], errors);
+                    converted += v.kind != ValueKind::NONE;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(converted);
+    }
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_Validate)->Apply(NarrowRows);
+
+// --- Cada ruta de tipo de validate_value sobre celdas en memoria ---
+void BM_ValidateDtype(benchmark::State &state) {
+    using namespace validation;
+    const auto type = static_cast<FieldType>(state.range(0));
+    const char *names[] = {"text", "number", "scale", "single"};
+    state.SetLabel(names[state.range(0)]);
+
+    ValidationRule rule;
+    rule.type = type;
+    rule.valid_options = {"Ventas", "IT", "RRHH", "Marketing", "Finanzas"};
+
+    Rng rng(42);
+    std::vector<std::string> cells;
+    for (int i = 0; i < 100000; ++i) {
+        switch (type) {
+            case FieldType::NUMBER: cells.push_back(std::to_string(rng.below(100000)) + ".5"); break;
+            case FieldType::SCALE: cells.push_back(" " + std::to_string(rng.below(11)) + " "); break;
+            case FieldType::SINGLE: cells.push_back(kDepartments[rng.below(5)]); break;
+            default: cells.push_back(std::string(" ") + kWords[rng.below(12)] + " " + kWords[rng.below(12)]); break;
+        }
+    }
+
+    const std::string column = "columna";
+    std::vector<ValidationError> errors;
+    for (auto _ : state) {
+        std::size_t converted = 0;
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            converted += validate_value(cells[i], rule, i, column, errors).kind != ValueKind::NONE;
+        }
+        benchmark::DoNotOptimize(converted);
+        errors.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(cells.size()));
+}
+BENCHMARK(BM_ValidateDtype)
+    ->ArgName("dtype")
+    ->DenseRange(static_cast<int>(validation::FieldType::TEXT),
+                 static_cast<int>(validation::FieldType::SINGLE));
+
+// --- Multi-selección: split + mapeo a option_id de la columna Servicios ---
+void BM_MultiSelectMap(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    std::vector<std::pair<std::string, long long>> options;
+    for (long long i = 0; i < 4; ++i) options.emplace_back(kServices[i], i + 1);  // "Precio" queda desconocido
+    multiselect::OptionMapper mapper(options, ",;", '"');
+
+    // La columna se materializa una vez: solo se mide el kernel
+    std::vector<std::string> storage;
+    ChunkArena arena;
+    CsvChunkReader reader(path, ',');
+    read_header(reader, arena);
+    while (reader.next_chunk(arena)) {
+        for (std::size_t r = 0; r < arena.rows(); ++r) storage.emplace_back(arena.cell(r, 5));
+    }
+    std::vector<std::string_view> cells(storage.begin(), storage.end());
+
+    for (auto _ : state) {
+        auto mapped = mapper.map(cells);
+        benchmark::DoNotOptimize(mapped.rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(cells.size()));
+}
+BENCHMARK(BM_MultiSelectMap)->Apply(NarrowRows);
+
+// --- Descubrimiento de opciones (single + multi) con 1 hilo y con todos ---
+void BM_DiscoverOptions(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    ChunkArena arena;
+    CsvChunkReader header_reader(path, ',');
+    read_header(header_reader, arena);
+    const std::uint64_t body_begin = header_reader.position();
+    const std::vector<discovery::ColumnSpec> specs = {{4, false}, {5, true}, {7, false}};
+
+    for (auto _ : state) {
+        auto counts = discovery::discover(path, ',', body_begin, specs, 200, ",;",
+                                          static_cast<std::size_t>(state.range(1)));
+        benchmark::DoNotOptimize(counts.data());
+    }
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_DiscoverOptions)
+    ->ArgNames({"rows", "threads"})
+    ->ArgsProduct({{10000, 100000, 1000000}, {1, 0}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// --- Estadísticas numéricas desde (valor, conteo): `distinct` valores ---
+void BM_NumericStats(benchmark::State &state) {
+    const auto distinct = static_cast<std::size_t>(state.range(0));
+    Rng rng(7);
+    std::vector<double> values;
+    std::vector<std::int64_t> counts;
+    for (std::size_t i = 0; i < distinct; ++i) {
+        values.push_back(static_cast<double>(rng.below(1000000)) / 10.0);
+        counts.push_back(1 + rng.below(500));
+    }
+
+    for (auto _ : state) {
+        stats::Distribution dist = stats::build_distribution(values, counts);
+        stats::Summary summary = stats::summarize(dist);
+        double q = stats::quantile(dist, 0.5) + stats::quantile(dist, 0.25) + stats::quantile(dist, 0.75);
+        stats::Histogram hist = stats::histogram(dist, 10);
+        benchmark::DoNotOptimize(summary.variance + q + static_cast<double>(hist.counts[0]));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(distinct));
+}
+BENCHMARK(BM_NumericStats)->ArgName("distinct")->RangeMultiplier(10)->Range(10, 100000);
+
+// --- NPS: histograma 0..10 de 40 segmentos (`entries` pares valor/segmento) ---
+void BM_NpsBreakdown(benchmark::State &state) {
+    const auto entries = static_cast<std::size_t>(state.range(0));
+    Rng rng(9);
+    std::vector<double> values;
+    std::vector<std::int64_t> counts;
+    std::vector<std::int32_t> segments;
+    for (std::size_t i = 0; i < entries; ++i) {
+        values.push_back(static_cast<double>(rng.below(11)));
+        counts.push_back(1 + rng.below(50));
+        segments.push_back(static_cast<std::int32_t>(rng.below(40)));
+    }
+
+    for (auto _ : state) {
+        nps::Breakdown breakdown = nps::compute(values, counts, segments, 40, 0.95);
+        benchmark::DoNotOptimize(breakdown.overall.score + breakdown.segments[0].margin);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries));
+}
+BENCHMARK(BM_NpsBreakdown)->ArgName("entries")->RangeMultiplier(10)->Range(100, 1000000);
+
+// --- Tabla cruzada: `responses` respuestas, 8 x 40 categorías (con recorte) ---
+void BM_Crosstab(benchmark::State &state) {
+    const auto responses = static_cast<std::size_t>(state.range(0));
+    Rng rng(11);
+    std::vector<std::string> row_names, col_names;
+    for (int i = 0; i < 8; ++i) row_names.push_back("Fila " + std::to_string(i));
+    for (int i = 0; i < 40; ++i) col_names.push_back("Columna " + std::to_string(i));
+
+    std::vector<std::int64_t> universe, row_ids, col_ids;
+    std::vector<std::string_view> row_labels, col_labels;
+    for (std::size_t i = 0; i < responses; ++i) {
+        const auto id = static_cast<std::int64_t>(1000 + i);
+        universe.push_back(id);
+        if (rng.below(10) != 0) {  // ~10% sin respuesta
+            row_ids.push_back(id);
+            row_labels.push_back(row_names[rng.below(8)]);
+        }
+        col_ids.push_back(id);
+        col_labels.push_back(col_names[rng.below(40)]);
+    }
+
+    crosstab::Options options;
+    for (auto _ : state) {
+        crosstab::Table table = crosstab::build(universe, row_ids, row_labels, col_ids, col_labels, options);
+        benchmark::DoNotOptimize(table.counts.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(responses));
+}
+BENCHMARK(BM_Crosstab)
+    ->ArgName("responses")
+    ->Arg(10000)->Arg(100000)->Arg(500000)
+    ->Unit(benchmark::kMillisecond);
+
+// --- Correlaciones del mapa de calor: 20 preguntas, ~10% de celdas vacías ---
+void BM_CorrelationMatrix(benchmark::State &state) {
+    const auto responses = static_cast<std::size_t>(state.range(0));
+    const auto method = static_cast<correlation::Method>(state.range(1));
+    state.SetLabel(method == correlation::Method::PEARSON ? "pearson" : "spearman");
+
+    Rng rng(13);
+    std::vector<std::int64_t> response_ids, question_ids;
+    std::vector<double> values;
+    for (std::size_t r = 0; r < responses; ++r) {
+        const double base = rng.below(11);
+        for (std::int64_t q = 0; q < 20; ++q) {
+            if (rng.below(10) == 0) continue;
+            response_ids.push_back(static_cast<std::int64_t>(r));
+            question_ids.push_back(q);
+            values.push_back(std::min(10.0, base + rng.below(3)));
+        }
+    }
+
+    for (auto _ : state) {
+        correlation::Result result = correlation::compute(response_ids, question_ids, values, {}, method, 20);
+        benchmark::DoNotOptimize(result.matrix.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(values.size()));
+}
+BENCHMARK(BM_CorrelationMatrix)
+    ->ArgNames({"responses", "method"})
+    ->ArgsProduct({{10000, 100000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// --- Palabras y bigramas de `texts` comentarios abiertos con acentos ---
+void BM_TextAnalyze(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    static const char *const kOpenWords[] = {
+        "atención", "servicio", "excelente", "pésimo", "habitación", "limpieza", "el", "de",
+        "desayuno", "recepción", "rápido", "lento", "ubicación", "precio", "muy", "bueno",
+    };
+    Rng rng(17);
+    std::vector<std::string> texts(count);
+    std::size_t bytes = 0;
+    for (auto &text : texts) {
+        const auto words = 6 + rng.below(20);
+        for (std::uint32_t w = 0; w < words; ++w) {
+            text += kOpenWords[rng.below(16)];
+            text += rng.below(8) == 0 ? ", " : " ";
+        }
+        bytes += text.size();
+    }
+
+    text::Options options;
+    options.stopwords = {"el", "de", "muy"};
+    for (auto _ : state) {
+        text::Analyzer analyzer(options);
+        for (const auto &t : texts) analyzer.add(t);
+        auto top = analyzer.top_bigrams(20);
+        benchmark::DoNotOptimize(top.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_TextAnalyze)
+    ->ArgName("texts")
+    ->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+// --- Sentimiento con léxico: `texts` comentarios, ~400 términos + frases ---
+void BM_SentimentScore(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    static const char *const kCommentWords[] = {
+        "no", "es", "bueno", "malo", "muy", "excelente", "pésimo", "servicio", "atención",
+        "me", "gusta", "funciona", "habitación", "nunca", "limpia", "rápido",
+    };
+    lexicon::Lexicon lex;
+    for (int i = 0; i < 400; ++i) lex.terms.emplace_back("termino" + std::to_string(i), i % 2 ? 1.0 : -1.0);
+    lex.terms.emplace_back("bueno", 1.0);
+    lex.terms.emplace_back("excelente", 1.0);
+    lex.terms.emplace_back("me gusta", 1.0);
+    lex.terms.emplace_back("malo", -1.0);
+    lex.terms.emplace_back("pésimo", -1.0);
+    lex.terms.emplace_back("no funciona", -1.0);
+    lex.negators = {"no", "nunca", "ni", "sin"};
+    const lexicon::Matcher matcher(lex);
+
+    Rng rng(19);
+    std::vector<std::string> texts(count);
+    std::size_t bytes = 0;
+    for (auto &text : texts) {
+        const auto words = 6 + rng.below(20);
+        for (std::uint32_t w = 0; w < words; ++w) {
+            text += kCommentWords[rng.below(16)];
+            text += rng.below(8) == 0 ? ", " : " ";
+        }
+        bytes += text.size();
+    }
+    const std::vector<std::string_view> views(texts.begin(), texts.end());
+
+    for (auto _ : state) {
+        lexicon::Summary summary = lexicon::score_all(matcher, views);
+        benchmark::DoNotOptimize(summary.per_text.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_SentimentScore)
+    ->ArgName("texts")
+    ->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+// --- PII en una columna de `values` comentarios (~5% con correo/teléfono) ---
+void BM_PiiScan(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    static const char *const kPlain[] = {
+        "El servicio fue excelente y la habitación muy limpia",
+        "Tardaron en atender, pero el desayuno estuvo bien",
+        "Todo perfecto, volvería con mi familia",
+        "La recepción 24 h ayudó con el check-in a las 23:40",
+    };
+    static const char *const kSensitive[] = {
+        "Escríbanme a maria.lopez@example.com por favor",
+        "Mi cel es +52 (55) 1234-5678",
+        "RFC GODE561231GR8 para la factura",
+    };
+    Rng rng(23);
+    std::vector<std::string> values(count);
+    std::size_t bytes = 0;
+    for (auto &value : values) {
+        value = rng.below(20) == 0 ? kSensitive[rng.below(3)] : kPlain[rng.below(4)];
+        value += " #" + std::to_string(rng.below(100000));
+        bytes += value.size();
+    }
+    const std::vector<std::string_view> views(values.begin(), values.end());
+
+    for (auto _ : state) {
+        pii::ColumnReport report = pii::scan_column(views);
+        benchmark::DoNotOptimize(report.flagged_rows.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_PiiScan)
+    ->ArgName("values")
+    ->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+// --- Índice invertido: construir con `texts` comentarios y consultar citas/KWIC ---
+void BM_TextIndex(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    static const char *const kIndexWords[] = {
+        "atención", "servicio", "excelente", "pésimo", "habitación", "limpieza", "el", "de",
+        "desayuno", "recepción", "rápido", "lento", "ubicación", "precio", "muy", "bueno",
+    };
+    Rng rng(29);
+    std::vector<std::string> texts(count);
+    std::size_t bytes = 0;
+    for (auto &text : texts) {
+        const auto words = 4 + rng.below(16);
+        for (std::uint32_t w = 0; w < words; ++w) {
+            text += kIndexWords[rng.below(16)];
+            text += rng.below(8) == 0 ? ", " : " ";
+        }
+        bytes += text.size();
+    }
+    const std::vector<std::string_view> views(texts.begin(), texts.end());
+    const std::vector<std::string> topics = {"atencion", "servicio excelente"};
+
+    for (auto _ : state) {
+        search::TextIndex index(views);
+        std::int64_t quote = index.best_quote(topics, 20, 110);
+        auto contexts = index.keyword_in_context("pesimo", 40, 20);
+        benchmark::DoNotOptimize(quote);
+        benchmark::DoNotOptimize(contexts.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_TextIndex)
+    ->ArgName("texts")
+    ->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+// --- Cubo de encuesta: filtrar por fechas y segmento, contar una columna ---
+void BM_SurveyCube(benchmark::State &state) {
+    const auto responses = static_cast<std::size_t>(state.range(0));
+    static const char *const kCubeLabels[] = {"Norte", "Sur", "Centro", "Occidente", "Bajío"};
+    Rng rng(31);
+    std::vector<std::int64_t> ids(responses);
+    std::vector<std::int32_t> days(responses);
+    for (std::size_t i = 0; i < responses; ++i) {
+        ids[i] = static_cast<std::int64_t>(i + 1);
+        days[i] = 738000 + static_cast<std::int32_t>(rng.below(365));
+    }
+    std::vector<std::string_view> labels(responses);
+    std::vector<std::uint8_t> flags(responses, 1);
+    std::vector<double> values(responses);
+    for (std::size_t i = 0; i < responses; ++i) {
+        labels[i] = kCubeLabels[rng.below(5)];
+        values[i] = static_cast<double>(rng.below(11));
+    }
+    cube::Builder builder(ids, days);
+    builder.add_choice(1, ids, labels, flags);
+    builder.add_numeric(2, ids, values);
+    auto survey = cube::Cube::from_bytes(builder.serialize());
+    const auto &region = *survey->column(1);
+    const auto &score = *survey->column(2);
+
+    for (auto _ : state) {
+        auto rows = survey->days_between(738090, 738180);
+        rows &= survey->with_codes(region, {0, 2});
+        auto counts = survey->code_counts(score, &rows);
+        auto timeline = survey->day_counts(&rows);
+        benchmark::DoNotOptimize(counts.data());
+        benchmark::DoNotOptimize(timeline.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(responses));
+}
+BENCHMARK(BM_SurveyCube)->ArgName("responses")->RangeMultiplier(10)->Range(10000, 1000000);
+
+// --- Bitmaps de segmentos: (opción A | opción B) & ~rango & fechas sobre `responses` filas ---
+void BM_RoaringSegments(benchmark::State &state) {
+    const auto responses = static_cast<std::uint32_t>(state.range(0));
+    Rng rng(37);
+    std::vector<std::uint32_t> option_a, option_b, low_scores;
+    for (std::uint32_t r = 0; r < responses; ++r) {
+        if (rng.below(4) == 0) option_a.push_back(r);
+        if (rng.below(50) == 0) option_b.push_back(r);
+        if (rng.below(3) == 0) low_scores.push_back(r);
+    }
+    const auto a = roaring::Bitmap::from_sorted(option_a.data(), option_a.size());
+    const auto b = roaring::Bitmap::from_sorted(option_b.data(), option_b.size());
+    const auto low = roaring::Bitmap::from_sorted(low_scores.data(), low_scores.size());
+    const auto dates = roaring::Bitmap::range(responses / 4, responses - responses / 4);
+
+    for (auto _ : state) {
+        auto segment = roaring::Bitmap::union_of({&a, &b});
+        segment -= low;
+        segment &= dates;
+        benchmark::DoNotOptimize(segment.cardinality());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(responses));
+}
+BENCHMARK(BM_RoaringSegments)->ArgName("responses")->RangeMultiplier(10)->Range(10000, 1000000);
+
+// --- Exportación CSV: `responses` filas × 12 preguntas (opciones, números y texto) ---
+void BM_CsvExport(benchmark::State &state) {
+    const auto responses = static_cast<std::uint32_t>(state.range(0));
+    static const char *const kExportTexts[] = {
+        "Muy buena atención", "Tardaron, pero resolvieron", "Dijo \"excelente\"", "", "Sin comentarios",
+    };
+    constexpr std::uint32_t kQuestions = 12;
+    std::vector<std::string> header = {"ID", "Fecha", "Usuario"};
+    for (std::uint32_t q = 0; q < kQuestions; ++q) header.push_back("Pregunta " + std::to_string(q + 1));
+    writer::TableEncoder encoder(header);
+    const std::vector<std::string_view> options = {"Sí", "No", "Tal vez, depende", "No aplica"};
+    for (std::uint32_t q = 0; q < kQuestions; q += 3) encoder.set_dictionary(3 + q, options);
+
+    Rng rng(41);
+    std::vector<std::string> ids(responses), dates(responses);
+    for (std::uint32_t r = 0; r < responses; ++r) {
+        ids[r] = std::to_string(100000 + r);
+        dates[r] = "2025-03-0" + std::to_string(1 + r % 9) + " 10:15:00+00:00";
+    }
+    const std::vector<std::vector<std::string_view>> leading = {
+        {ids.begin(), ids.end()}, {dates.begin(), dates.end()}, std::vector<std::string_view>(responses, "Anon")};
+    std::vector<writer::Cell> cells;
+    for (std::uint32_t r = 0; r < responses; ++r) {
+        for (std::uint32_t q = 0; q < kQuestions; ++q) {
+            writer::Cell cell{r, 3 + q, {}, std::numeric_limits<double>::quiet_NaN(), writer::kNoCode};
+            if (q % 3 == 0) cell.code = rng.below(4);
+            else if (q % 3 == 1) cell.number = rng.below(11);
+            else cell.text = kExportTexts[rng.below(5)];
+            cells.push_back(cell);
+        }
+    }
+
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        auto chunks = encoder.encode(responses, leading, cells);
+        bytes = 0;
+        for (const auto &chunk : chunks) bytes += chunk.size();
+        benchmark::DoNotOptimize(chunks.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_CsvExport)->ArgName("responses")->Arg(10000)->Arg(200000)->Unit(benchmark::kMillisecond);
+
+// Lote de QuestionResponse para COPY binario: (respuesta, pregunta,
+// opción | NULL, texto | NULL, número | NULL), con buffers reutilizados.
+void BM_PgCopyEncode(benchmark::State &state) {
+    const auto rows = static_cast<std::size_t>(state.range(0));
+    static const char *const kCopyTexts[] = {
+        "Muy buena atención", "Tardaron, pero resolvieron", "Dijo \"excelente\"", "Sin comentarios",
+    };
+    pgcopy::Encoder encoder({pgcopy::Type::Int8, pgcopy::Type::Int8, pgcopy::Type::Int8, pgcopy::Type::Text,
+                             pgcopy::Type::Int4});
+    Rng rng(42);
+    std::vector<std::uint32_t> kinds(rows);
+    for (auto &kind : kinds) kind = rng.below(3);
+
+    std::size_t bytes = 0;
+    std::string out;
+    for (auto _ : state) {
+        encoder.clear();
+        for (std::size_t r = 0; r < rows; ++r) {
+            const std::uint32_t kind = kinds[r];
+            encoder.column(0).ints.push_back(static_cast<std::int64_t>(500000 + r / 12));
+            encoder.column(1).ints.push_back(static_cast<std::int64_t>(9000 + r % 12));
+            encoder.column(2).ints.push_back(kind == 0 ? static_cast<std::int64_t>(70000 + r % 4) : 0);
+            encoder.column(3).texts.push_back(kind == 2 ? kCopyTexts[r % 4] : std::string_view());
+            encoder.column(4).ints.push_back(kind == 1 ? static_cast<std::int64_t>(r % 11) : 0);
+            encoder.column(0).nulls.push_back(0);
+            encoder.column(1).nulls.push_back(0);
+            encoder.column(2).nulls.push_back(kind != 0);
+            encoder.column(3).nulls.push_back(kind != 2);
+            encoder.column(4).nulls.push_back(kind != 1);
+        }
+        out.resize(encoder.encoded_size(true, true));
+        encoder.write(out.data(), true, true);
+        bytes = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rows));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_PgCopyEncode)->ArgName("rows")->Arg(30000)->Arg(300000)->Unit(benchmark::kMillisecond);
+
+// Costo de repartir trabajo en el planificador compartido: `tasks` tareas
+// chicas por llamada (suma de un bloque) con el límite por llamada por defecto.
+void BM_SchedulerTaskGroup(benchmark::State &state) {
+    const auto tasks = static_cast<std::size_t>(state.range(0));
+    constexpr std::size_t kBlock = 4096;
+    std::vector<std::uint32_t> data(tasks * kBlock);
+    Rng rng(44);
+    for (auto &v : data) v = rng.below(1000);
+    std::vector<std::uint64_t> sums(tasks);
+    Scheduler &scheduler = Scheduler::instance();
+
+    for (auto _ : state) {
+        TaskGroup group(&scheduler);
+        for (std::size_t t = 0; t < tasks; ++t) {
+            group.run([&, t] {
+                std::uint64_t sum = 0;
+                for (std::size_t i = t * kBlock; i < (t + 1) * kBlock; ++i) sum += data[i];
+                sums[t] = sum;
+            });
+        }
+        group.wait();
+        benchmark::DoNotOptimize(sums.data());
+    }
+    const SchedulerStats stats = scheduler.stats();
+    state.counters["threads"] = static_cast<double>(stats.threads);
+    state.counters["steals"] = static_cast<double>(stats.steals);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tasks));
+}
+BENCHMARK(BM_SchedulerTaskGroup)->ArgName("tasks")->Arg(64)->Arg(4096)->UseRealTime();
+
+// --- Proyección de columnas (usecols) sobre el archivo wide: el parser
+// recorre las 60 columnas pero solo copia `keep` al arena ---
+void BM_ProjectedTokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, WIDE, state.range(0), path)) return;
+    projection::Spec spec;
+    spec.select = true;
+    for (int64_t c = 0; c < state.range(1); ++c) spec.indices.push_back(static_cast<std::size_t>(c * 60 / state.range(1)));
+
+    ChunkArena arena;
+    for (auto _ : state) {
+        CsvChunkReader reader(path, ',');
+        const projection::Selection selection = projection::resolve(read_header(reader, arena), spec);
+        reader.set_projection(selection.keep);
+        std::size_t bytes = 0;
+        while (reader.next_chunk(arena)) {
+            for (std::size_t r = 0; r < arena.rows(); ++r) {
+                for (std::size_t j : selection.columns) bytes += arena.cell(r, j).size();
+            }
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_ProjectedTokenize)
+    ->ArgNames({"rows", "keep"})
+    ->ArgsProduct({{10000, 100000, 1000000}, {6, 60}})
+    ->Unit(benchmark::kMillisecond);
+
+// --- Filtro de filas (where) sobre el archivo narrow: Fecha >= 2025-09-01
+// deja ~1/9 de las filas en el arena ---
+void BM_FilteredTokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    ChunkArena arena;
+    std::size_t kept = 0;
+    for (auto _ : state) {
+        auto filter = std::make_shared<predicate::Expr>();
+        filter->column = "Fecha";
+        filter->op = predicate::Op::GE;
+        filter->type = predicate::Type::DATE;
+        predicate::set_bounds(*filter, "2025-09-01");
+
+        CsvChunkReader reader(path, ',');
+        prepare_reader(reader, read_header(reader, arena), projection::Spec(), filter);
+        kept = 0;
+        while (reader.next_chunk(arena)) kept += arena.rows();
+        benchmark::DoNotOptimize(kept);
+    }
+    state.counters["kept"] = static_cast<double>(kept);
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_FilteredTokenize)->Apply(NarrowRows);
+
+
+// --- Prefetch con presupuesto de memoria (memory_limit): chunks de hasta
+// 1M filas acotados solo por bytes; con presupuesto se achican para que el
+// pool quepa. budget_mb = 0 mide sin límite ---
+void BM_BudgetedPrefetch(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, WIDE, state.range(0), path)) return;
+
+    std::size_t peak = 0, chunks = 0;
+    for (auto _ : state) {
+        MemoryBudget budget(static_cast<std::size_t>(state.range(1)) << 20);
+        {
+            PrefetchReader reader(path, ',', 1000000, 2, projection::Spec(), nullptr, &budget);
+            chunks = 0;
+            while (ChunkArena *arena = reader.next()) {
+                ++chunks;
+                reader.release(arena);
+            }
+        }
+        peak = budget.peak();
+        benchmark::DoNotOptimize(chunks);
+    }
+    state.counters["peak_mb"] = static_cast<double>(peak) / (1 << 20);
+    state.counters["chunks"] = static_cast<double>(chunks);
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_BudgetedPrefetch)
+    ->ArgNames({"rows", "budget_mb"})
+    ->ArgsProduct({{100000, 1000000}, {0, 16}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+
+// --- Costo de los contadores por fase (stats=...): mismo parseo con y sin
+// CallStats; con stats se leen dos relojes por fila ---
+void BM_InstrumentedTokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    ChunkArena arena;
+    metrics::CallStats stats;
+    for (auto _ : state) {
+        CsvChunkReader reader(path, ',');
+        reader.set_stats(state.range(1) ? &stats : nullptr);
+        std::size_t rows = 0;
+        while (reader.next_chunk(arena)) rows += arena.rows();
+        benchmark::DoNotOptimize(rows);
+    }
+    if (state.range(1)) {
+        const double total = static_cast<double>(metrics::read(stats.phase_ns[metrics::IO]) +
+                                                 metrics::read(stats.phase_ns[metrics::TOKENIZE]));
+        state.counters["io_share"] = total > 0 ? metrics::read(stats.phase_ns[metrics::IO]) / total : 0.0;
+    }
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_InstrumentedTokenize)
+    ->ArgNames({"rows", "stats"})
+    ->ArgsProduct({{100000, 1000000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// --- Costo del tracing: mismo parseo sin sesión (un atómico por chunk) y
+// con una sesión abierta (un span por chunk al ring) ---
+void BM_TracedTokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    ChunkArena arena;
+    const std::uint64_t cursor = state.range(1) ? trace::start() : 0;
+    for (auto _ : state) {
+        CsvChunkReader reader(path, ',');
+        std::size_t rows = 0;
+        while (reader.next_chunk(arena)) rows += arena.rows();
+        benchmark::DoNotOptimize(rows);
+    }
+    if (state.range(1)) {
+        std::uint64_t dropped = 0;
+        state.counters["json_bytes"] = static_cast<double>(trace::stop(cursor, &dropped).size());
+        state.counters["dropped"] = static_cast<double>(dropped);
+    }
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_TracedTokenize)
+    ->ArgNames({"rows", "trace"})
+    ->ArgsProduct({{100000, 1000000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// --- Costo del avance: mismo parseo sin Tracker y con token + callback
+// cada 50000 filas (revisión del token y dos atómicos por chunk) ---
+void BM_ProgressTokenize(benchmark::State &state) {
+    std::string path;
+    if (!setup(state, NARROW, state.range(0), path)) return;
+
+    ChunkArena arena;
+    progress::CancelToken token;
+    std::uint64_t reports = 0;
+    for (auto _ : state) {
+        progress::Tracker tracker(&token, [&reports](std::uint64_t, std::uint64_t) { ++reports; });
+        CsvChunkReader reader(path, ',');
+        reader.set_progress(state.range(1) ? &tracker : nullptr);
+        std::size_t rows = 0;
+        while (reader.next_chunk(arena)) rows += arena.rows();
+        tracker.finish();
+        benchmark::DoNotOptimize(rows);
+    }
+    state.counters["reports"] = benchmark::Counter(static_cast<double>(reports), benchmark::Counter::kAvgIterations);
+    finish(state, path, state.range(0));
+}
+BENCHMARK(BM_ProgressTokenize)
+    ->ArgNames({"rows", "progress"})
+    ->ArgsProduct({{100000, 1000000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    benchmark::AddCustomContext("cpp_csv.results_schema", kResultsSchema);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace csvcore {
+
+// Rango de una celda dentro del buffer de bytes del arena.
+struct CellSpan {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+// Filas por chunk y tope de bytes por chunk (los offsets del arena son de
+// 32 bits, así que un chunk nunca debe pasar de 4 GB).
+constexpr std::size_t kChunkRows = 4096;
+constexpr std::size_t kChunkMaxBytes = std::size_t(64) << 20;
+
+// Arena por chunk: los bytes de todas las celdas viven contiguos en `bytes_`
+// y las filas son rangos [row_offsets_[r], row_offsets_[r + 1]) dentro de
+// `cells_`. reset() conserva la capacidad, así que entre chunks no se vuelve
+// a pedir memoria y no hay malloc/free por celda.
+class ChunkArena {
+public:
+    ChunkArena() { reset(); }
+
+    void reset() {
+        bytes_.clear();
+        cells_.clear();
+        row_offsets_.assign(1, 0);
+    }
+
+    std::size_t rows() const { return row_offsets_.size() - 1; }
+    std::size_t byte_size() const { return bytes_.size(); }
+    std::size_t cell_count() const { return cells_.size(); }
+
+    // Memoria reservada por el arena (capacidad, no solo lo ocupado): lo que
+    // se carga al presupuesto de memoria.
+    std::size_t footprint() const {
+        return bytes_.capacity() + cells_.capacity() * sizeof(CellSpan) +
+               row_offsets_.capacity() * sizeof(std::uint32_t);
+    }
+
+    std::size_t row_size(std::size_t row) const {
+        return row_offsets_[row + 1] - row_offsets_[row];
+    }
+
+    std::string_view cell(std::size_t row, std::size_t col) const {
+        const CellSpan &span = cells_[row_offsets_[row] + col];
+        return std::string_view(bytes_.data() + span.offset, span.length);
+    }
+
+    // Construcción de celdas: begin_cell() marca el inicio, push() agrega
+    // bytes y end_cell() registra el rango.
+    void begin_cell() { cell_start_ = bytes_.size(); }
+    void push(char c) { bytes_.push_back(c); }
+    void append(const char *data, std::size_t n) { bytes_.insert(bytes_.end(), data, data + n); }
+    void end_cell() {
+        cells_.push_back({static_cast<std::uint32_t>(cell_start_),
+                          static_cast<std::uint32_t>(bytes_.size() - cell_start_)});
+    }
+    void end_row() { row_offsets_.push_back(static_cast<std::uint32_t>(cells_.size())); }
+
+    // Descarta la última fila completa (filtros de filas): libera sus celdas
+    // y sus bytes para que la siguiente fila ocupe su lugar.
+    void pop_row() {
+        row_offsets_.pop_back();
+        const std::uint32_t first = row_offsets_.back();
+        if (first < cells_.size()) bytes_.resize(cells_[first].offset);
+        cells_.resize(first);
+    }
+
+private:
+    std::vector<char> bytes_;
+    std::vector<CellSpan> cells_;
+    std::vector<std::uint32_t> row_offsets_;
+    std::size_t cell_start_ = 0;
+};
+
+}  // namespace csvcore
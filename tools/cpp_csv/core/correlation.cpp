@@ -0,0 +1,266 @@
+#include "correlation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CSVCORE_HAS_SSE2 1
+#endif
+
+namespace csvcore {
+namespace correlation {
+
+double dot(const double *a, const double *b, std::size_t n) {
+    std::size_t i = 0;
+#ifdef CSVCORE_HAS_SSE2
+    // Dos acumuladores de 2 doubles para no encadenar cada suma
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    double sum = lanes[0] + lanes[1];
+#else
+    double sum = 0.0;
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// Columna densa: valor (0 si falta), máscara (1/0) y valor al cuadrado.
+struct Column {
+    std::vector<double> x;
+    std::vector<double> mask;
+    std::vector<double> x2;
+    std::size_t present = 0;
+};
+
+// Filas con valor de la columna, ordenadas por valor (se ordena una vez).
+std::vector<std::size_t> sorted_rows(const Column &col) {
+    std::vector<std::size_t> order;
+    order.reserve(col.present);
+    for (std::size_t r = 0; r < col.x.size(); ++r) {
+        if (col.mask[r] != 0.0) order.push_back(r);
+    }
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t a, std::size_t b) { return col.x[a] < col.x[b]; });
+    return order;
+}
+
+// Rangos promedio (empates comparten el promedio) de las filas marcadas en
+// `mask`, recorriendo el orden ya calculado: O(n) por par en vez de ordenar.
+std::vector<double> average_ranks(const Column &col, const std::vector<std::size_t> &order,
+                                  const std::vector<double> &mask) {
+    std::vector<std::size_t> kept;
+    kept.reserve(order.size());
+    for (std::size_t r : order) {
+        if (mask[r] != 0.0) kept.push_back(r);
+    }
+
+    std::vector<double> ranks(col.x.size(), 0.0);
+    for (std::size_t i = 0; i < kept.size();) {
+        std::size_t j = i;
+        while (j + 1 < kept.size() && col.x[kept[j + 1]] == col.x[kept[i]]) ++j;
+        const double rank = (static_cast<double>(i + j) / 2.0) + 1.0;
+        for (std::size_t k = i; k <= j; ++k) ranks[kept[k]] = rank;
+        i = j + 1;
+    }
+    return ranks;
+}
+
+// Centra los valores presentes (mejor estabilidad numérica) y precalcula x².
+void finalize(Column &col) {
+    double sum = 0.0;
+    for (std::size_t r = 0; r < col.x.size(); ++r) sum += col.x[r];
+    const double mean = col.present ? sum / static_cast<double>(col.present) : 0.0;
+    col.x2.resize(col.x.size());
+    for (std::size_t r = 0; r < col.x.size(); ++r) {
+        if (col.mask[r] != 0.0) col.x[r] -= mean;
+        col.x2[r] = col.x[r] * col.x[r];
+    }
+}
+
+// Sumas de un par de columnas sobre las filas que tienen ambas.
+struct PairSums {
+    double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, syy = 0.0, sxy = 0.0;
+};
+
+// Seis productos punto sobre [begin, begin + len): la máscara de cada
+// columna anula las filas donde falta la otra.
+void accumulate(const Column &a, const Column &b, std::size_t begin, std::size_t len,
+                PairSums &sums) {
+    sums.n += dot(a.mask.data() + begin, b.mask.data() + begin, len);
+    sums.sx += dot(a.x.data() + begin, b.mask.data() + begin, len);
+    sums.sy += dot(a.mask.data() + begin, b.x.data() + begin, len);
+    sums.sxx += dot(a.x2.data() + begin, b.mask.data() + begin, len);
+    sums.syy += dot(a.mask.data() + begin, b.x2.data() + begin, len);
+    sums.sxy += dot(a.x.data() + begin, b.x.data() + begin, len);
+}
+
+double pearson(const PairSums &s, std::uint64_t &pairs) {
+    pairs = static_cast<std::uint64_t>(s.n);
+    if (s.n < 2.0) return kNaN;
+
+    const double cov = s.n * s.sxy - s.sx * s.sy;
+    const double var_x = s.n * s.sxx - s.sx * s.sx;
+    const double var_y = s.n * s.syy - s.sy * s.sy;
+    // Varianza nula (columna constante en el par), con tolerancia al redondeo
+    constexpr double kRelativeEps = 1e-12;
+    if (var_x <= kRelativeEps * s.n * s.sxx || var_y <= kRelativeEps * s.n * s.syy) return kNaN;
+    return std::clamp(cov / std::sqrt(var_x * var_y), -1.0, 1.0);
+}
+
+double pearson(const Column &a, const Column &b, std::uint64_t &pairs) {
+    PairSums sums;
+    accumulate(a, b, 0, a.x.size(), sums);
+    return pearson(sums, pairs);
+}
+
+// Filas por bloque: 20 columnas x 3 arreglos de un bloque caben en L2, así
+// los 190 pares leen de caché en vez de recorrer la memoria 190 veces.
+constexpr std::size_t kBlockRows = 2048;
+
+// Columna de rangos (Spearman) de las filas marcadas en `mask`.
+Column ranked_column(const Column &source, const std::vector<std::size_t> &order,
+                     const std::vector<double> &mask) {
+    Column col;
+    col.x = average_ranks(source, order, mask);
+    col.mask = mask;
+    col.present = static_cast<std::size_t>(std::count(mask.begin(), mask.end(), 1.0));
+    finalize(col);
+    return col;
+}
+
+}  // namespace
+
+Result compute(const std::vector<std::int64_t> &response_ids,
+               const std::vector<std::int64_t> &question_ids,
+               const std::vector<double> &values,
+               std::vector<std::int64_t> columns,
+               Method method,
+               std::size_t max_columns) {
+    if (response_ids.size() != question_ids.size() || response_ids.size() != values.size()) {
+        throw std::invalid_argument("response_ids, question_ids y values deben tener la misma longitud");
+    }
+
+    if (columns.empty()) {
+        std::unordered_set<std::int64_t> distinct(question_ids.begin(), question_ids.end());
+        columns.assign(distinct.begin(), distinct.end());
+        std::sort(columns.begin(), columns.end());
+    }
+    if (columns.size() > max_columns) columns.resize(max_columns);
+
+    // Filas densas: una por response_id con al menos un valor en las columnas.
+    // Las tripletas suelen venir agrupadas por respuesta: se reutiliza la fila
+    // anterior sin tocar el hash, y las columnas (<= 20) se buscan linealmente.
+    std::unordered_map<std::int64_t, std::size_t> row_index;
+    row_index.reserve(values.size() / std::max<std::size_t>(columns.size(), 1) + 1);
+    std::vector<std::size_t> cell_row(values.size(), 0);
+    std::vector<std::size_t> cell_col(values.size(), columns.size());
+    std::int64_t last_response = 0;
+    std::size_t last_row = 0;
+    bool has_last = false;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto col = static_cast<std::size_t>(
+            std::find(columns.begin(), columns.end(), question_ids[i]) - columns.begin());
+        if (col == columns.size() || std::isnan(values[i])) continue;
+        if (!has_last || response_ids[i] != last_response) {
+            last_response = response_ids[i];
+            last_row = row_index.emplace(last_response, row_index.size()).first->second;
+            has_last = true;
+        }
+        cell_row[i] = last_row;
+        cell_col[i] = col;
+    }
+
+    const std::size_t rows = row_index.size();
+    std::vector<Column> data(columns.size());
+    for (auto &col : data) {
+        col.x.assign(rows, 0.0);
+        col.mask.assign(rows, 0.0);
+    }
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (cell_col[i] == columns.size()) continue;
+        Column &col = data[cell_col[i]];
+        col.x[cell_row[i]] = values[i];
+        col.mask[cell_row[i]] = 1.0;
+    }
+    for (auto &col : data) {
+        col.present = static_cast<std::size_t>(std::count(col.mask.begin(), col.mask.end(), 1.0));
+    }
+
+    // Spearman: Pearson sobre rangos. Los rangos de la columna completa sirven
+    // cuando ambas columnas tienen las mismas filas; si no, se re-rankea el par.
+    std::vector<std::vector<std::size_t>> orders(columns.size());
+    std::vector<Column> prepared;
+    if (method == Method::SPEARMAN) {
+        prepared = data;
+    } else {
+        prepared = std::move(data);
+    }
+    for (std::size_t c = 0; c < prepared.size(); ++c) {
+        if (method == Method::SPEARMAN) {
+            orders[c] = sorted_rows(data[c]);
+            prepared[c] = ranked_column(data[c], orders[c], data[c].mask);
+        } else {
+            finalize(prepared[c]);
+        }
+    }
+
+    Result result;
+    result.columns = columns;
+    const std::size_t n = columns.size();
+    result.matrix.assign(n * n, kNaN);
+    result.pairs.assign(n * n, 0);
+
+    // Pares que se re-rankean (Spearman con filas distintas) van aparte;
+    // el resto se acumula por bloques de filas.
+    auto rerank = [&](std::size_t a, std::size_t b) {
+        return method == Method::SPEARMAN && a != b && data[a].mask != data[b].mask;
+    };
+    std::vector<PairSums> sums(n * n);
+    for (std::size_t begin = 0; begin < rows; begin += kBlockRows) {
+        const std::size_t len = std::min(kBlockRows, rows - begin);
+        for (std::size_t a = 0; a < n; ++a) {
+            for (std::size_t b = a; b < n; ++b) {
+                if (!rerank(a, b)) accumulate(prepared[a], prepared[b], begin, len, sums[a * n + b]);
+            }
+        }
+    }
+
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t b = a; b < n; ++b) {
+            std::uint64_t pairs = 0;
+            double r;
+            if (rerank(a, b)) {
+                std::vector<double> both(rows);
+                for (std::size_t k = 0; k < rows; ++k) both[k] = data[a].mask[k] * data[b].mask[k];
+                r = pearson(ranked_column(data[a], orders[a], both),
+                            ranked_column(data[b], orders[b], both), pairs);
+            } else {
+                r = pearson(sums[a * n + b], pairs);
+            }
+            result.matrix[a * n + b] = result.matrix[b * n + a] = r;
+            result.pairs[a * n + b] = result.pairs[b * n + a] = pairs;
+        }
+    }
+    return result;
+}
+
+}  // namespace correlation
+}  // namespace csvcore
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace csvcore {
+
+// Matriz de correlación entre preguntas numéricas a partir de tripletas
+// (response_id, question_id, valor), con observaciones pairwise-complete
+// (cada par usa solo las respuestas que contestaron ambas preguntas).
+namespace correlation {
+
+enum class Method { PEARSON, SPEARMAN };
+
+struct Result {
+    std::vector<std::int64_t> columns;  // question_id de cada columna
+    std::vector<double> matrix;         // columns x columns, NaN si no se puede calcular
+    std::vector<std::uint64_t> pairs;   // observaciones usadas por celda
+};
+
+// `columns` fija qué preguntas y en qué orden; vacío = question_id
+// distintos en orden ascendente. Se usan a lo más `max_columns`. Si una
+// respuesta repite pregunta, gana el último valor.
+Result compute(const std::vector<std::int64_t> &response_ids,
+               const std::vector<std::int64_t> &question_ids,
+               const std::vector<double> &values,
+               std::vector<std::int64_t> columns,
+               Method method,
+               std::size_t max_columns);
+
+// Producto punto (SSE2 cuando está disponible).
+double dot(const double *a, const double *b, std::size_t n);
+
+}  // namespace correlation
+
+}  // namespace csvcore
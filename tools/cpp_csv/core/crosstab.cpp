@@ -0,0 +1,139 @@
+#include "crosstab.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace csvcore {
+namespace crosstab {
+
+namespace {
+
+// Una pregunta codificada: diccionario de categorías y response_id -> código.
+class EncodedAxis {
+public:
+    EncodedAxis(const std::vector<std::int64_t> &ids,
+                const std::vector<std::string_view> &labels,
+                std::string_view missing_label) {
+        if (ids.size() != labels.size()) {
+            throw std::invalid_argument("ids y categorías deben tener la misma longitud");
+        }
+        by_response_.reserve(ids.size());
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            by_response_[ids[i]] = code_for(labels[i]);
+        }
+        missing_ = code_for(missing_label);
+    }
+
+    std::uint32_t code(std::int64_t response_id) const {
+        auto it = by_response_.find(response_id);
+        return it != by_response_.end() ? it->second : missing_;
+    }
+
+    std::size_t size() const { return labels_.size(); }
+    std::string_view label(std::uint32_t code) const { return labels_[code]; }
+
+private:
+    std::uint32_t code_for(std::string_view label) {
+        auto [it, inserted] = codes_.emplace(label, static_cast<std::uint32_t>(labels_.size()));
+        if (inserted) labels_.push_back(label);
+        return it->second;
+    }
+
+    std::unordered_map<std::string_view, std::uint32_t> codes_;
+    std::vector<std::string_view> labels_;
+    std::unordered_map<std::int64_t, std::uint32_t> by_response_;
+    std::uint32_t missing_ = 0;
+};
+
+// Orden y recorte de un eje: posición final de cada código (las categorías
+// fuera del top-K van a la posición de "Otros").
+struct AxisLayout {
+    std::vector<std::uint32_t> slot;  // código -> posición
+    std::vector<std::string> labels;  // sin Total
+};
+
+AxisLayout layout(const EncodedAxis &axis, const std::vector<std::uint64_t> &totals,
+                  const Options &options) {
+    std::vector<std::uint32_t> order;
+    for (std::uint32_t c = 0; c < axis.size(); ++c) {
+        if (totals[c] > 0) order.push_back(c);  // como pd.crosstab: solo lo observado
+    }
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        if (totals[a] != totals[b]) return totals[a] > totals[b];
+        return axis.label(a) < axis.label(b);
+    });
+
+    AxisLayout out;
+    out.slot.assign(axis.size(), 0);
+    const bool collapse = order.size() > options.top_k;
+    const std::size_t kept = collapse ? options.top_k : order.size();
+    for (std::size_t i = 0; i < kept; ++i) {
+        out.slot[order[i]] = static_cast<std::uint32_t>(i);
+        out.labels.emplace_back(axis.label(order[i]));
+    }
+    if (collapse) {
+        for (std::size_t i = kept; i < order.size(); ++i) {
+            out.slot[order[i]] = static_cast<std::uint32_t>(kept);
+        }
+        out.labels.push_back(options.other_label);
+    }
+    return out;
+}
+
+}  // namespace
+
+Table build(const std::vector<std::int64_t> &universe,
+            const std::vector<std::int64_t> &row_ids,
+            const std::vector<std::string_view> &row_labels,
+            const std::vector<std::int64_t> &col_ids,
+            const std::vector<std::string_view> &col_labels,
+            const Options &options) {
+    const EncodedAxis row_axis(row_ids, row_labels, options.missing_label);
+    const EncodedAxis col_axis(col_ids, col_labels, options.missing_label);
+
+    // Una pasada para codificar cada respuesta y obtener los totales por eje;
+    // el recorte se decide antes de contar, así la matriz es a lo más
+    // (top_k + 1) x (top_k + 1) aunque haya miles de categorías.
+    std::vector<std::uint32_t> row_code(universe.size());
+    std::vector<std::uint32_t> col_code(universe.size());
+    std::vector<std::uint64_t> row_totals(row_axis.size(), 0);
+    std::vector<std::uint64_t> col_totals(col_axis.size(), 0);
+    for (std::size_t i = 0; i < universe.size(); ++i) {
+        row_code[i] = row_axis.code(universe[i]);
+        col_code[i] = col_axis.code(universe[i]);
+        ++row_totals[row_code[i]];
+        ++col_totals[col_code[i]];
+    }
+
+    const AxisLayout rows = layout(row_axis, row_totals, options);
+    const AxisLayout cols = layout(col_axis, col_totals, options);
+
+    Table table;
+    table.rows = rows.labels;
+    table.cols = cols.labels;
+    table.row_categories = rows.labels.size();
+    table.col_categories = cols.labels.size();
+    table.rows.push_back(options.total_label);
+    table.cols.push_back(options.total_label);
+    table.total = universe.size();
+
+    // Conteo denso con márgenes (última fila/columna)
+    const std::size_t width = table.cols.size();
+    const std::size_t total_row = table.rows.size() - 1;
+    const std::size_t total_col = width - 1;
+    table.counts.assign(table.rows.size() * width, 0);
+    for (std::size_t i = 0; i < universe.size(); ++i) {
+        const std::size_t r = rows.slot[row_code[i]];
+        const std::size_t c = cols.slot[col_code[i]];
+        ++table.counts[r * width + c];
+        ++table.counts[r * width + total_col];
+        ++table.counts[total_row * width + c];
+    }
+    table.counts[total_row * width + total_col] = universe.size();
+    return table;
+}
+
+}  // namespace crosstab
+}  // namespace csvcore
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace csvcore {
+
+// Tabla cruzada de dos preguntas a partir de pares (response_id, categoría).
+namespace crosstab {
+
+struct Options {
+    std::size_t top_k = 10;                    // categorías visibles por eje
+    std::string missing_label = "Sin respuesta";
+    std::string other_label = "Otros";         // agrupa lo que queda fuera del top-K
+    std::string total_label = "Total";
+};
+
+// Resultado en el orden final: categorías por total descendente (empate por
+// nombre), luego "Otros" si hubo recorte y al final la fila/columna Total.
+// `counts` es denso, rows.size() x cols.size(), por filas.
+struct Table {
+    std::vector<std::string> rows;
+    std::vector<std::string> cols;
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::size_t row_categories = 0;  // sin contar Total
+    std::size_t col_categories = 0;
+};
+
+// `universe` son todos los response_id a cruzar (los que no respondieron
+// una pregunta caen en missing_label). Si un response_id aparece varias
+// veces en una pregunta, gana la última categoría.
+Table build(const std::vector<std::int64_t> &universe,
+            const std::vector<std::int64_t> &row_ids,
+            const std::vector<std::string_view> &row_labels,
+            const std::vector<std::int64_t> &col_ids,
+            const std::vector<std::string_view> &col_labels,
+            const Options &options);
+
+}  // namespace crosstab
+
+}  // namespace csvcore
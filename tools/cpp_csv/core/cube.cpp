@@ -0,0 +1,433 @@
+#include "cube.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace csvcore {
+namespace cube {
+
+namespace {
+
+constexpr char kMagic[8] = {'B', 'N', 'K', 'C', 'U', 'B', 'E', '\x01'};
+constexpr std::uint32_t kVersion = 1;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t columns;
+    std::uint64_t rows;
+    std::uint64_t response_ids;  // offsets en bytes desde el inicio
+    std::uint64_t days;
+    std::uint64_t directory;
+    std::uint64_t size;
+};
+
+struct ColumnEntry {
+    std::int64_t question_id;
+    std::uint32_t kind;
+    std::uint32_t reserved;
+    std::uint64_t entries;
+    std::uint64_t dictionary;
+    std::uint64_t rows;
+    std::uint64_t codes;
+    std::uint64_t dictionary_data;  // CHOICE: label_offsets; NUMERIC: values
+    std::uint64_t label_bytes;
+    std::uint64_t label_flags;
+};
+
+void align(std::string &out) {
+    out.resize((out.size() + 7) & ~std::size_t{7}, '\0');
+}
+
+template <typename T>
+std::uint64_t append(std::string &out, const T *data, std::size_t n) {
+    align(out);
+    const std::uint64_t offset = out.size();
+    if (n) out.append(reinterpret_cast<const char *>(data), n * sizeof(T));
+    return offset;
+}
+
+template <typename T>
+const T *section(const char *data, std::size_t size, std::uint64_t offset, std::uint64_t n) {
+    if (offset % alignof(T) != 0 || offset > size || n > (size - offset) / sizeof(T)) {
+        throw std::runtime_error("Cubo corrupto: sección fuera del archivo");
+    }
+    return reinterpret_cast<const T *>(data + offset);
+}
+
+void check_same_cube(std::size_t a, std::size_t b) {
+    if (a != b) throw std::invalid_argument("Los conjuntos de filas son de cubos distintos");
+}
+
+}  // namespace
+
+RowSet &RowSet::operator&=(const RowSet &other) {
+    check_same_cube(size_, other.size_);
+    bits_ &= other.bits_;
+    return *this;
+}
+
+RowSet &RowSet::operator|=(const RowSet &other) {
+    check_same_cube(size_, other.size_);
+    bits_ |= other.bits_;
+    return *this;
+}
+
+RowSet &RowSet::operator-=(const RowSet &other) {
+    check_same_cube(size_, other.size_);
+    bits_ -= other.bits_;
+    return *this;
+}
+
+std::shared_ptr<Cube> Cube::open(const std::string &path) {
+    std::shared_ptr<Cube> cube(new Cube());
+    cube->mapping_ = std::make_unique<MappedFile>(path);
+    cube->data_ = cube->mapping_->data();
+    cube->size_ = cube->mapping_->size();
+    cube->parse();
+    return cube;
+}
+
+std::shared_ptr<Cube> Cube::from_bytes(std::string bytes) {
+    std::shared_ptr<Cube> cube(new Cube());
+    cube->owned_ = std::move(bytes);
+    cube->data_ = cube->owned_.data();
+    cube->size_ = cube->owned_.size();
+    cube->parse();
+    return cube;
+}
+
+void Cube::parse() {
+    Header header;
+    if (size_ < sizeof(header)) throw std::runtime_error("Cubo corrupto: archivo truncado");
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        throw std::runtime_error("El archivo no es un cubo de encuesta compatible");
+    }
+    if (header.size != size_) throw std::runtime_error("Cubo corrupto: tamaño inesperado");
+
+    rows_ = static_cast<std::size_t>(header.rows);
+    response_ids_ = section<std::int64_t>(data_, size_, header.response_ids, header.rows);
+    days_ = section<std::int32_t>(data_, size_, header.days, header.rows);
+    const ColumnEntry *directory = section<ColumnEntry>(data_, size_, header.directory, header.columns);
+
+    code_index_.resize(header.columns);
+    columns_.reserve(header.columns);
+    for (std::uint32_t c = 0; c < header.columns; ++c) {
+        const ColumnEntry &e = directory[c];
+        Column column;
+        column.question_id = e.question_id;
+        column.kind = static_cast<Kind>(e.kind);
+        column.entries = static_cast<std::size_t>(e.entries);
+        column.dictionary = static_cast<std::size_t>(e.dictionary);
+        column.rows = section<std::uint32_t>(data_, size_, e.rows, e.entries);
+        column.codes = section<std::uint32_t>(data_, size_, e.codes, e.entries);
+        if (column.kind == Kind::NUMERIC) {
+            column.values = section<double>(data_, size_, e.dictionary_data, e.dictionary);
+        } else if (column.kind == Kind::CHOICE) {
+            column.label_offsets = section<std::uint32_t>(data_, size_, e.dictionary_data, e.dictionary + 1);
+            column.label_flags = section<std::uint8_t>(data_, size_, e.label_flags, e.dictionary);
+            const std::uint32_t total = column.label_offsets[column.dictionary];
+            column.label_bytes = section<char>(data_, size_, e.label_bytes, total);
+            for (std::size_t i = 0; i < column.dictionary; ++i) {
+                if (column.label_offsets[i] > column.label_offsets[i + 1]) {
+                    throw std::runtime_error("Cubo corrupto: diccionario inválido");
+                }
+            }
+        } else {
+            throw std::runtime_error("Cubo corrupto: tipo de columna desconocido");
+        }
+        columns_.push_back(column);
+    }
+}
+
+const Column *Cube::column(std::int64_t question_id) const {
+    for (const Column &c : columns_) {
+        if (c.question_id == question_id) return &c;
+    }
+    return nullptr;
+}
+
+void Cube::save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data_, static_cast<std::streamsize>(size_));
+    if (!out) throw std::runtime_error("No se pudo escribir el cubo: " + path);
+}
+
+const std::vector<roaring::Bitmap> &Cube::code_index(const Column &column) const {
+    const std::size_t c = static_cast<std::size_t>(&column - columns_.data());
+    if (c >= columns_.size()) throw std::invalid_argument("La columna no es de este cubo");
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (!code_index_[c]) {
+        // Las entradas están ordenadas por fila: cada lista queda ordenada
+        std::vector<std::vector<std::uint32_t>> rows(column.dictionary);
+        for (std::size_t i = 0; i < column.entries; ++i) {
+            if (column.codes[i] < column.dictionary && column.rows[i] < rows_) {
+                rows[column.codes[i]].push_back(column.rows[i]);
+            }
+        }
+        auto index = std::make_unique<std::vector<roaring::Bitmap>>();
+        index->reserve(rows.size());
+        for (const auto &r : rows) index->push_back(roaring::Bitmap::from_sorted(r.data(), r.size()));
+        code_index_[c] = std::move(index);
+    }
+    return *code_index_[c];
+}
+
+const std::vector<std::pair<std::int32_t, roaring::Bitmap>> &Cube::day_index() const {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (!day_index_) {
+        std::vector<std::pair<std::int32_t, std::uint32_t>> by_day(rows_);
+        for (std::size_t r = 0; r < rows_; ++r) by_day[r] = {days_[r], static_cast<std::uint32_t>(r)};
+        std::sort(by_day.begin(), by_day.end());
+        auto index = std::make_unique<std::vector<std::pair<std::int32_t, roaring::Bitmap>>>();
+        std::vector<std::uint32_t> rows;
+        for (std::size_t i = 0; i < by_day.size();) {
+            rows.clear();
+            std::size_t j = i;
+            for (; j < by_day.size() && by_day[j].first == by_day[i].first; ++j) rows.push_back(by_day[j].second);
+            index->emplace_back(by_day[i].first, roaring::Bitmap::from_sorted(rows.data(), rows.size()));
+            i = j;
+        }
+        day_index_ = std::move(index);
+    }
+    return *day_index_;
+}
+
+RowSet Cube::days_between(std::int32_t first, std::int32_t last) const {
+    const auto &index = day_index();
+    auto begin = std::lower_bound(index.begin(), index.end(), first,
+                                  [](const auto &entry, std::int32_t day) { return entry.first < day; });
+    std::vector<const roaring::Bitmap *> parts;
+    for (auto it = begin; it != index.end() && it->first <= last; ++it) parts.push_back(&it->second);
+    return RowSet(rows_, roaring::Bitmap::union_of(parts));
+}
+
+RowSet Cube::with_codes(const Column &column, const std::vector<std::uint32_t> &codes) const {
+    const auto &index = code_index(column);
+    std::vector<const roaring::Bitmap *> parts;
+    for (std::uint32_t code : codes) {
+        if (code < index.size()) parts.push_back(&index[code]);
+    }
+    return RowSet(rows_, roaring::Bitmap::union_of(parts));
+}
+
+RowSet Cube::with_values(const Column &column, double low, double high) const {
+    std::vector<std::uint32_t> codes;
+    if (column.kind == Kind::NUMERIC) {
+        const double *begin = std::lower_bound(column.values, column.values + column.dictionary, low);
+        const double *end = std::upper_bound(column.values, column.values + column.dictionary, high);
+        for (const double *v = begin; v < end; ++v) codes.push_back(static_cast<std::uint32_t>(v - column.values));
+    }
+    return with_codes(column, codes);
+}
+
+std::vector<std::uint64_t> Cube::code_counts(const Column &column, const RowSet *rows) const {
+    std::vector<std::uint64_t> counts(column.dictionary, 0);
+    if (!rows) {
+        for (std::size_t i = 0; i < column.entries; ++i) {
+            if (column.codes[i] < column.dictionary && column.rows[i] < rows_) ++counts[column.codes[i]];
+        }
+        return counts;
+    }
+    // Por contenedor del bitmap: solo se recorren las entradas de los bloques
+    // seleccionados; en los contenedores de arreglo se avanza en paralelo
+    // (las entradas están ordenadas por fila).
+    const std::uint32_t *entry_rows = column.rows;
+    const std::uint32_t *entry_end = column.rows + column.entries;
+    for (const roaring::Container &c : rows->bits().containers()) {
+        const std::uint32_t base = std::uint32_t{c.key} << 16;
+        const std::uint32_t *it = std::lower_bound(entry_rows, entry_end, base);
+        const std::uint32_t *end = std::lower_bound(it, entry_end, std::uint64_t{base} + 0x10000);
+        std::size_t k = 0;
+        for (; it < end; ++it) {
+            const std::uint16_t low = static_cast<std::uint16_t>(*it - base);
+            bool selected;
+            if (c.is_bitset()) {
+                selected = (c.words[low >> 6] >> (low & 63)) & 1u;
+            } else {
+                while (k < c.array.size() && c.array[k] < low) ++k;
+                if (k == c.array.size()) break;
+                selected = c.array[k] == low;
+            }
+            const std::uint32_t code = column.codes[it - column.rows];
+            if (selected && code < column.dictionary) ++counts[code];
+        }
+        entry_rows = end;
+    }
+    return counts;
+}
+
+stats::Distribution Cube::distribution(const Column &column, const RowSet *rows) const {
+    stats::Distribution dist;
+    if (column.kind != Kind::NUMERIC) return dist;
+    const std::vector<std::uint64_t> counts = code_counts(column, rows);
+    for (std::size_t code = 0; code < counts.size(); ++code) {
+        if (!counts[code]) continue;
+        dist.values.push_back(column.values[code]);
+        dist.counts.push_back(counts[code]);
+        dist.total += counts[code];
+    }
+    dist.cumulative.resize(dist.counts.size());
+    std::partial_sum(dist.counts.begin(), dist.counts.end(), dist.cumulative.begin());
+    return dist;
+}
+
+std::vector<std::pair<std::int32_t, std::uint64_t>> Cube::day_counts(const RowSet *rows) const {
+    std::vector<std::pair<std::int32_t, std::uint64_t>> out;
+    if (!rows) {
+        for (const auto &entry : day_index()) out.emplace_back(entry.first, entry.second.cardinality());
+        return out;
+    }
+    std::unordered_map<std::int32_t, std::uint64_t> by_day;
+    rows->bits().for_each([&](std::uint32_t r) {
+        if (r < rows_) ++by_day[days_[r]];
+    });
+    out.assign(by_day.begin(), by_day.end());
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::int64_t Cube::last_response_id(const RowSet *rows) const {
+    // response_ids está ordenado: la fila seleccionada más alta
+    const std::int64_t row = rows ? rows->bits().maximum() : static_cast<std::int64_t>(rows_) - 1;
+    if (row < 0 || static_cast<std::size_t>(row) >= rows_) return 0;
+    return response_ids_[row];
+}
+
+Builder::Builder(const std::vector<std::int64_t> &response_ids, const std::vector<std::int32_t> &days) {
+    if (days.size() != response_ids.size()) {
+        throw std::invalid_argument("response_ids y days deben tener la misma longitud");
+    }
+    std::vector<std::size_t> order(response_ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t a, std::size_t b) { return response_ids[a] < response_ids[b]; });
+    for (std::size_t i : order) {
+        if (!response_ids_.empty() && response_ids_.back() == response_ids[i]) continue;
+        response_ids_.push_back(response_ids[i]);
+        days_.push_back(days[i]);
+    }
+}
+
+std::int64_t Builder::row_of(std::int64_t response_id) const {
+    auto it = std::lower_bound(response_ids_.begin(), response_ids_.end(), response_id);
+    if (it == response_ids_.end() || *it != response_id) return -1;
+    return it - response_ids_.begin();
+}
+
+void Builder::sort_by_row(PendingColumn &column) {
+    std::vector<std::size_t> order(column.rows.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return column.rows[a] < column.rows[b]; });
+    std::vector<std::uint32_t> rows(order.size()), codes(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        rows[i] = column.rows[order[i]];
+        codes[i] = column.codes[order[i]];
+    }
+    column.rows = std::move(rows);
+    column.codes = std::move(codes);
+}
+
+void Builder::add_choice(std::int64_t question_id, const std::vector<std::int64_t> &response_ids,
+                         const std::vector<std::string_view> &labels, const std::vector<std::uint8_t> &from_option) {
+    if (labels.size() != response_ids.size() || (!from_option.empty() && from_option.size() != labels.size())) {
+        throw std::invalid_argument("response_ids, labels y from_option deben tener la misma longitud");
+    }
+    PendingColumn column{question_id, Kind::CHOICE, {}, {}, {}, {}, {}};
+    // La llave lleva el origen: la misma etiqueta como opción y como texto
+    // libre son entradas distintas del diccionario.
+    std::unordered_map<std::string, std::uint32_t> codes;
+    std::string key;
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+        const std::int64_t row = row_of(response_ids[i]);
+        if (row < 0 || labels[i].empty()) continue;
+        const std::uint8_t flag = from_option.empty() ? 1 : (from_option[i] ? 1 : 0);
+        key.assign(1, static_cast<char>(flag));
+        key.append(labels[i]);
+        auto inserted = codes.try_emplace(key, static_cast<std::uint32_t>(column.labels.size()));
+        if (inserted.second) {
+            column.labels.emplace_back(labels[i]);
+            column.flags.push_back(flag);
+        }
+        column.rows.push_back(static_cast<std::uint32_t>(row));
+        column.codes.push_back(inserted.first->second);
+    }
+    sort_by_row(column);
+    columns_.push_back(std::move(column));
+}
+
+void Builder::add_numeric(std::int64_t question_id, const std::vector<std::int64_t> &response_ids,
+                          const std::vector<double> &values) {
+    if (values.size() != response_ids.size()) {
+        throw std::invalid_argument("response_ids y values deben tener la misma longitud");
+    }
+    PendingColumn column{question_id, Kind::NUMERIC, {}, {}, {}, {}, {}};
+    std::vector<double> raw;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const std::int64_t row = row_of(response_ids[i]);
+        if (row < 0 || std::isnan(values[i])) continue;
+        column.rows.push_back(static_cast<std::uint32_t>(row));
+        raw.push_back(values[i]);
+    }
+    column.values = raw;
+    std::sort(column.values.begin(), column.values.end());
+    column.values.erase(std::unique(column.values.begin(), column.values.end()), column.values.end());
+    column.codes.reserve(raw.size());
+    for (double v : raw) {
+        column.codes.push_back(static_cast<std::uint32_t>(
+            std::lower_bound(column.values.begin(), column.values.end(), v) - column.values.begin()));
+    }
+    sort_by_row(column);
+    columns_.push_back(std::move(column));
+}
+
+std::string Builder::serialize() const {
+    std::string out(sizeof(Header), '\0');
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.columns = static_cast<std::uint32_t>(columns_.size());
+    header.rows = response_ids_.size();
+    header.response_ids = append(out, response_ids_.data(), response_ids_.size());
+    header.days = append(out, days_.data(), days_.size());
+
+    std::vector<ColumnEntry> directory;
+    for (const PendingColumn &c : columns_) {
+        ColumnEntry e{};
+        e.question_id = c.question_id;
+        e.kind = static_cast<std::uint32_t>(c.kind);
+        e.entries = c.rows.size();
+        e.rows = append(out, c.rows.data(), c.rows.size());
+        e.codes = append(out, c.codes.data(), c.codes.size());
+        if (c.kind == Kind::NUMERIC) {
+            e.dictionary = c.values.size();
+            e.dictionary_data = append(out, c.values.data(), c.values.size());
+        } else {
+            e.dictionary = c.labels.size();
+            std::vector<std::uint32_t> offsets{0};
+            std::string bytes;
+            for (const std::string &label : c.labels) {
+                bytes.append(label);
+                offsets.push_back(static_cast<std::uint32_t>(bytes.size()));
+            }
+            e.dictionary_data = append(out, offsets.data(), offsets.size());
+            e.label_bytes = append(out, bytes.data(), bytes.size());
+            e.label_flags = append(out, c.flags.data(), c.flags.size());
+        }
+        directory.push_back(e);
+    }
+    header.directory = append(out, directory.data(), directory.size());
+    header.size = out.size();
+    std::memcpy(&out[0], &header, sizeof(header));
+    return out;
+}
+
+}  // namespace cube
+}  // namespace csvcore
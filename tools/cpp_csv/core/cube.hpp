@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "roaring.hpp"
+#include "stats.hpp"
+
+namespace csvcore {
+
+// Cubo columnar de una encuesta: por pregunta, la fila (respuesta) y el
+// código de diccionario de cada respuesta individual. Se construye una vez
+// desde la BD, se guarda en un archivo y se abre con mmap para contestar
+// distribuciones, estadísticas y conteos filtrados sin ir a Postgres.
+//
+// Formato del archivo (little endian, secciones alineadas a 8 bytes):
+//   Header | response_ids int64[rows] | days int32[rows] |
+//   por columna: rows uint32[n], codes uint32[n], diccionario |
+//   directorio de columnas (ColumnEntry[columns])
+namespace cube {
+
+enum class Kind : std::uint32_t {
+    CHOICE = 0,   // diccionario de etiquetas (texto de opción o texto libre)
+    NUMERIC = 1,  // diccionario de valores distintos, ordenados
+};
+
+// Subconjunto de filas del cubo: bitmap comprimido (roaring) sobre
+// [0, rows()). Los kernels de conteo lo recorren por contenedor.
+class RowSet {
+public:
+    RowSet() = default;
+    RowSet(std::size_t size, roaring::Bitmap bits) : size_(size), bits_(std::move(bits)) {}
+
+    std::size_t size() const { return size_; }
+    bool test(std::size_t row) const { return bits_.contains(static_cast<std::uint32_t>(row)); }
+    std::size_t count() const { return static_cast<std::size_t>(bits_.cardinality()); }
+    const roaring::Bitmap &bits() const { return bits_; }
+
+    // Los operandos deben ser del mismo cubo (mismo size()).
+    RowSet &operator&=(const RowSet &other);
+    RowSet &operator|=(const RowSet &other);
+    RowSet &operator-=(const RowSet &other);
+    RowSet operator~() const { return RowSet(size_, bits_.flip(static_cast<std::uint32_t>(size_))); }
+
+private:
+    std::size_t size_ = 0;
+    roaring::Bitmap bits_;
+};
+
+// Vista de una columna; los punteros apuntan al buffer del cubo.
+struct Column {
+    std::int64_t question_id = 0;
+    Kind kind = Kind::CHOICE;
+    std::size_t entries = 0;
+    const std::uint32_t *rows = nullptr;   // ordenadas; una fila puede repetirse (opción múltiple)
+    const std::uint32_t *codes = nullptr;  // índice en el diccionario
+    std::size_t dictionary = 0;            // tamaño del diccionario
+    // CHOICE: etiquetas y si vienen de una opción (1) o del texto libre (0)
+    const std::uint32_t *label_offsets = nullptr;  // dictionary + 1
+    const char *label_bytes = nullptr;
+    const std::uint8_t *label_flags = nullptr;
+    // NUMERIC: valores distintos ordenados
+    const double *values = nullptr;
+
+    std::string_view label(std::size_t code) const {
+        return std::string_view(label_bytes + label_offsets[code], label_offsets[code + 1] - label_offsets[code]);
+    }
+};
+
+class Cube {
+public:
+    // Proyecta un archivo escrito con save(). Lanza std::runtime_error si
+    // no existe o no es un cubo válido.
+    static std::shared_ptr<Cube> open(const std::string &path);
+    // Cubo sobre un buffer en memoria (el que produce Builder::serialize).
+    static std::shared_ptr<Cube> from_bytes(std::string bytes);
+
+    Cube(const Cube &) = delete;
+    Cube &operator=(const Cube &) = delete;
+
+    std::size_t rows() const { return rows_; }
+    std::size_t bytes() const { return size_; }
+    bool mapped() const { return mapping_ != nullptr; }
+    std::int64_t response_id(std::size_t row) const { return response_ids_[row]; }
+    std::int32_t day(std::size_t row) const { return days_[row]; }
+
+    const std::vector<Column> &columns() const { return columns_; }
+    const Column *column(std::int64_t question_id) const;
+
+    void save(const std::string &path) const;
+
+    RowSet all() const { return RowSet(rows_, roaring::Bitmap::range(0, static_cast<std::uint32_t>(rows_))); }
+    // Filas con día (ordinal) en [first, last].
+    RowSet days_between(std::int32_t first, std::int32_t last) const;
+    // Filas con alguna respuesta de la columna cuyo código está en `codes`
+    // (unión de los bitmaps del índice de la columna).
+    RowSet with_codes(const Column &column, const std::vector<std::uint32_t> &codes) const;
+    // Filas con algún valor numérico en [low, high].
+    RowSet with_values(const Column &column, double low, double high) const;
+
+    // Respuestas por código de diccionario (todas las filas si rows es nullptr).
+    std::vector<std::uint64_t> code_counts(const Column &column, const RowSet *rows) const;
+    // Distribución (valor, conteo) de una columna NUMERIC, lista para stats::.
+    stats::Distribution distribution(const Column &column, const RowSet *rows) const;
+    // Respuestas por día: pares (día, conteo) ordenados, sin días vacíos.
+    std::vector<std::pair<std::int32_t, std::uint64_t>> day_counts(const RowSet *rows) const;
+    // Mayor response_id del subconjunto (0 si está vacío).
+    std::int64_t last_response_id(const RowSet *rows) const;
+
+    // Índices de bitmaps, construidos la primera vez que se piden:
+    // filas por código de diccionario de una columna y filas por día.
+    const std::vector<roaring::Bitmap> &code_index(const Column &column) const;
+    const std::vector<std::pair<std::int32_t, roaring::Bitmap>> &day_index() const;
+
+private:
+    Cube() = default;
+    void parse();
+
+    std::unique_ptr<MappedFile> mapping_;
+    std::string owned_;
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+
+    std::size_t rows_ = 0;
+    const std::int64_t *response_ids_ = nullptr;
+    const std::int32_t *days_ = nullptr;
+    std::vector<Column> columns_;
+
+    mutable std::mutex index_mutex_;
+    mutable std::vector<std::unique_ptr<std::vector<roaring::Bitmap>>> code_index_;  // por columna
+    mutable std::unique_ptr<std::vector<std::pair<std::int32_t, roaring::Bitmap>>> day_index_;
+};
+
+// Arma el archivo del cubo. Las respuestas cuyo response_id no está en el
+// universo se descartan; las etiquetas vacías y los NaN también.
+class Builder {
+public:
+    Builder(const std::vector<std::int64_t> &response_ids, const std::vector<std::int32_t> &days);
+
+    void add_choice(std::int64_t question_id, const std::vector<std::int64_t> &response_ids,
+                    const std::vector<std::string_view> &labels, const std::vector<std::uint8_t> &from_option);
+    void add_numeric(std::int64_t question_id, const std::vector<std::int64_t> &response_ids,
+                     const std::vector<double> &values);
+
+    std::string serialize() const;
+
+private:
+    struct PendingColumn {
+        std::int64_t question_id;
+        Kind kind;
+        std::vector<std::uint32_t> rows;
+        std::vector<std::uint32_t> codes;
+        std::vector<std::string> labels;
+        std::vector<std::uint8_t> flags;
+        std::vector<double> values;
+    };
+
+    // Fila de un response_id (-1 si no está en el universo).
+    std::int64_t row_of(std::int64_t response_id) const;
+    // Ordena las entradas por fila (estable).
+    static void sort_by_row(PendingColumn &column);
+
+    std::vector<std::int64_t> response_ids_;
+    std::vector<std::int32_t> days_;
+    std::vector<PendingColumn> columns_;
+};
+
+}  // namespace cube
+
+}  // namespace csvcore
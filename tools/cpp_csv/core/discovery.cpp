@@ -0,0 +1,172 @@
+#include "discovery.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "arena.hpp"
+#include "multiselect.hpp"
+#include "reader.hpp"
+#include "scheduler.hpp"
+#include "trace.hpp"
+#include "validation.hpp"
+
+namespace csvcore {
+namespace discovery {
+
+void ColumnCounts::add(std::string_view value, std::size_t max_distinct, std::string &scratch) {
+    if (free_text) {
+        return;
+    }
+    scratch.assign(value.data(), value.size());
+    auto it = counts.find(scratch);
+    if (it != counts.end()) {
+        ++it->second;
+        return;
+    }
+    if (counts.size() >= max_distinct) {
+        free_text = true;
+        counts.clear();
+        return;
+    }
+    counts.emplace(scratch, 1);
+}
+
+void ColumnCounts::merge(ColumnCounts &&other, std::size_t max_distinct) {
+    non_empty += other.non_empty;
+    free_text = free_text || other.free_text;
+    if (free_text) {
+        counts.clear();
+        return;
+    }
+    for (auto &item : other.counts) {
+        counts[item.first] += item.second;
+    }
+    if (counts.size() > max_distinct) {
+        free_text = true;
+        counts.clear();
+    }
+}
+
+RangeCounts scan_range(const std::string &filename, char delimiter,
+                       std::uint64_t begin, std::uint64_t end,
+                       const std::vector<ColumnSpec> &columns,
+                       std::size_t max_distinct,
+                       const std::string &separators,
+                       metrics::CallStats *stats,
+                       progress::Tracker *progress,
+                       std::shared_ptr<const predicate::Expr> filter,
+                       bool at_record) {
+    trace::Span span("discover_range");
+    span.arg("bytes", static_cast<std::int64_t>(end > begin ? end - begin : 0));
+    RangeCounts range;
+    range.columns.resize(columns.size());
+    std::vector<ColumnCounts> &result = range.columns;
+    CsvChunkReader reader(filename, delimiter, begin, end, at_record);
+    range.start = reader.start();
+    reader.set_stats(stats);
+    reader.set_progress(progress);
+    // Solo se copian al arena las columnas que se cuentan y las que lee el filtro
+    std::vector<char> keep;
+    for (const ColumnSpec &spec : columns) {
+        if (spec.index >= keep.size()) keep.resize(spec.index + 1, 0);
+        keep[spec.index] = 1;
+    }
+    if (filter) {
+        predicate::require(*filter, keep);
+        reader.set_filter(std::move(filter));
+    }
+    reader.set_projection(std::move(keep));
+    ChunkArena arena;
+    multiselect::CellTokenizer tokenizer(separators, '"');
+    std::string scratch;
+
+    while (reader.next_chunk(arena)) {
+        metrics::PhaseClock clock(stats);
+        for (std::size_t r = 0; r < arena.rows(); ++r) {
+            const std::size_t cols = arena.row_size(r);
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                const ColumnSpec &spec = columns[c];
+                if (spec.index >= cols) {
+                    continue;
+                }
+                std::string_view value = arena.cell(r, spec.index);
+                ColumnCounts &counts = result[c];
+                if (spec.multi) {
+                    if (tokenizer.split(value) == 0) {
+                        continue;
+                    }
+                    ++counts.non_empty;
+                    for (std::size_t t = 0; t < tokenizer.size(); ++t) {
+                        counts.add(tokenizer.token(t), max_distinct, scratch);
+                    }
+                } else {
+                    value = validation::trim(value);
+                    if (value.empty()) {
+                        continue;
+                    }
+                    ++counts.non_empty;
+                    counts.add(value, max_distinct, scratch);
+                }
+            }
+        }
+        clock.mark(metrics::AGGREGATE);
+    }
+    range.stop = reader.position();
+    return range;
+}
+
+std::vector<ColumnCounts> discover(const std::string &filename, char delimiter,
+                                   std::uint64_t body_begin,
+                                   const std::vector<ColumnSpec> &columns,
+                                   std::size_t max_distinct,
+                                   const std::string &separators,
+                                   std::size_t threads,
+                                   metrics::CallStats *stats,
+                                   progress::Tracker *progress,
+                                   std::shared_ptr<const predicate::Expr> filter) {
+    const std::uint64_t size = file_size(filename);
+    const std::uint64_t body = size > body_begin ? size - body_begin : 0;
+
+    // Al menos ~1 MB por rango: en archivos chicos no vale la pena repartir.
+    // Los rangos corren en el planificador compartido; `threads` limita
+    // cuántos a la vez (0 = el límite por llamada del planificador).
+    constexpr std::uint64_t kMinBytesPerThread = std::uint64_t(1) << 20;
+    TaskGroup group(&Scheduler::instance(), threads);
+    const std::size_t ranges = static_cast<std::size_t>(std::max<std::uint64_t>(
+        1, std::min<std::uint64_t>(group.max_parallel(), body / kMinBytesPerThread)));
+
+    std::vector<RangeCounts> partials(ranges);
+    std::vector<std::uint64_t> ends(ranges);
+    for (std::size_t t = 0; t < ranges; ++t) {
+        const std::uint64_t begin = body_begin + body * t / ranges;
+        ends[t] = body_begin + body * (t + 1) / ranges;
+        group.run([&, t, begin] {
+            partials[t] = scan_range(filename, delimiter, begin, ends[t],
+                                     columns, max_distinct, separators, stats, progress, filter, t == 0);
+        });
+    }
+    // Relanza el primer error de un rango
+    group.wait();
+
+    // El rango 0 empieza en un registro, así que su fin es un límite real.
+    // Si el rango t no empezó ahí, su inicio cayó dentro de un campo
+    // multilínea y sus conteos no sirven: se repite desde ese límite (poco
+    // común; el avance y los contadores de esa parte se suman dos veces).
+    for (std::size_t t = 1; t < ranges; ++t) {
+        if (partials[t].start != partials[t - 1].stop) {
+            partials[t] = scan_range(filename, delimiter, partials[t - 1].stop, ends[t],
+                                     columns, max_distinct, separators, stats, progress, filter, true);
+        }
+    }
+
+    std::vector<ColumnCounts> merged = std::move(partials[0].columns);
+    for (std::size_t t = 1; t < ranges; ++t) {
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            merged[c].merge(std::move(partials[t].columns[c]), max_distinct);
+        }
+    }
+    return merged;
+}
+
+}  // namespace discovery
+}  // namespace csvcore
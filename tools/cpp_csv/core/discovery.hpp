@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "metrics.hpp"
+#include "predicate.hpp"
+#include "progress.hpp"
+
+namespace csvcore {
+
+// Descubrimiento de opciones: valores distintos por columna sobre todo el
+// archivo, en una sola pasada paralela.
+namespace discovery {
+
+struct ColumnSpec {
+    std::size_t index;  // posición en el header
+    bool multi;         // dividir la celda en opciones (multi-selección)
+};
+
+// Conteos de una columna. Al pasar de `max_distinct` valores distintos la
+// columna se marca como texto libre y se deja de contar valores.
+struct ColumnCounts {
+    std::unordered_map<std::string, std::uint64_t> counts;
+    std::uint64_t non_empty = 0;
+    bool free_text = false;
+
+    void add(std::string_view value, std::size_t max_distinct, std::string &scratch);
+    void merge(ColumnCounts &&other, std::size_t max_distinct);
+};
+
+// Conteos de un rango y dónde empezó y terminó de leer (offsets de bytes).
+struct RangeCounts {
+    std::vector<ColumnCounts> columns;
+    std::uint64_t start = 0;  // inicio del primer registro leído
+    std::uint64_t stop = 0;   // fin del último registro leído
+};
+
+// Cuenta los valores de las columnas pedidas en el rango de bytes [begin, end)
+// (ver el lector por rango de CsvChunkReader; `at_record` igual). Con `stats`
+// registra las fases del rango (io, tokenize, aggregate); con `progress`
+// suma su avance y se detiene (progress::Cancelled) al cancelarse. Con
+// `filter` (ya resuelto contra el header) solo cuenta las filas que lo cumplen.
+RangeCounts scan_range(const std::string &filename, char delimiter,
+                       std::uint64_t begin, std::uint64_t end,
+                       const std::vector<ColumnSpec> &columns,
+                       std::size_t max_distinct,
+                       const std::string &separators,
+                       metrics::CallStats *stats = nullptr,
+                       progress::Tracker *progress = nullptr,
+                       std::shared_ptr<const predicate::Expr> filter = nullptr,
+                       bool at_record = false);
+
+// Reparte el cuerpo del archivo (desde `body_begin`, después del header) en
+// rangos que corren en el planificador compartido y combina los conteos.
+// `threads` limita cuántos rangos corren a la vez (0 = límite por llamada).
+// Todos los rangos reportan al mismo `progress`. Un rango que empezó a media
+// celda (un campo multilínea cruzaba su inicio) se vuelve a contar desde
+// donde terminó el anterior, así que cada registro se cuenta una vez. Con
+// `filter` solo se cuentan las filas que lo cumplen (las que se importan).
+std::vector<ColumnCounts> discover(const std::string &filename, char delimiter,
+                                   std::uint64_t body_begin,
+                                   const std::vector<ColumnSpec> &columns,
+                                   std::size_t max_distinct,
+                                   const std::string &separators,
+                                   std::size_t threads,
+                                   metrics::CallStats *stats = nullptr,
+                                   progress::Tracker *progress = nullptr,
+                                   std::shared_ptr<const predicate::Expr> filter = nullptr);
+
+}  // namespace discovery
+
+}  // namespace csvcore
@@ -0,0 +1,195 @@
+#include "lexicon.hpp"
+
+#include <algorithm>
+#include <deque>
+
+#include "text.hpp"
+
+namespace csvcore {
+namespace lexicon {
+
+namespace {
+
+// Alfabeto del texto normalizado: espacio, a-z y 0-9.
+constexpr std::size_t kSymbols = 37;
+
+int symbol_of(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return 1 + (c - 'a');
+    if (c >= '0' && c <= '9') return 27 + (c - '0');
+    return 0;
+}
+
+// Normaliza una frase del léxico a " palabra palabra " (espacios simples y
+// un espacio en cada extremo, para que solo empate palabras completas).
+std::string pattern_of(std::string_view phrase, std::uint32_t &tokens) {
+    std::string folded;
+    text::fold(phrase, folded);
+    std::string out;
+    out.reserve(folded.size() + 2);
+    tokens = 0;
+    for (std::size_t i = 0; i < folded.size();) {
+        while (i < folded.size() && folded[i] == ' ') ++i;
+        const std::size_t start = i;
+        while (i < folded.size() && folded[i] != ' ') ++i;
+        if (i == start) break;
+        out.push_back(' ');
+        out.append(folded, start, i - start);
+        ++tokens;
+    }
+    if (tokens) out.push_back(' ');
+    return out;
+}
+
+}  // namespace
+
+Matcher::Matcher(const Lexicon &lexicon) : window_(lexicon.window) {
+    delta_.assign(kSymbols, -1);
+    outputs_.push_back(-1);
+    for (const auto &term : lexicon.terms) insert(term.first, Entry{term.second, 0, false});
+    for (const auto &negator : lexicon.negators) insert(negator, Entry{0.0, 0, true});
+    build_links();
+}
+
+void Matcher::insert(std::string_view phrase, const Entry &entry) {
+    std::uint32_t tokens = 0;
+    const std::string pattern = pattern_of(phrase, tokens);
+    if (tokens == 0) return;
+
+    std::int32_t state = 0;
+    for (unsigned char c : pattern) {
+        const std::size_t slot = static_cast<std::size_t>(state) * kSymbols + symbol_of(c);
+        if (delta_[slot] < 0) {
+            const auto next = static_cast<std::int32_t>(outputs_.size());
+            delta_[slot] = next;
+            delta_.resize(delta_.size() + kSymbols, -1);
+            outputs_.push_back(-1);
+        }
+        state = delta_[static_cast<std::size_t>(state) * kSymbols + symbol_of(c)];
+    }
+
+    Entry stored = entry;
+    stored.tokens = tokens;
+    auto &output = outputs_[static_cast<std::size_t>(state)];
+    if (output >= 0) {
+        entries_[static_cast<std::size_t>(output)] = stored;
+    } else {
+        output = static_cast<std::int32_t>(entries_.size());
+        entries_.push_back(stored);
+    }
+}
+
+void Matcher::build_links() {
+    // BFS: cada estado hereda las transiciones faltantes de su enlace de
+    // falla, que ya está completo por estar a menor profundidad.
+    std::vector<std::int32_t> fail(outputs_.size(), 0);
+    dict_links_.assign(outputs_.size(), -1);
+    std::deque<std::int32_t> queue;
+    for (std::size_t s = 0; s < kSymbols; ++s) {
+        std::int32_t &next = delta_[s];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.push_back(next);
+        }
+    }
+    while (!queue.empty()) {
+        const std::int32_t state = queue.front();
+        queue.pop_front();
+        const auto base = static_cast<std::size_t>(state) * kSymbols;
+        const auto fail_base = static_cast<std::size_t>(fail[static_cast<std::size_t>(state)]) * kSymbols;
+        for (std::size_t s = 0; s < kSymbols; ++s) {
+            std::int32_t &next = delta_[base + s];
+            if (next < 0) {
+                next = delta_[fail_base + s];
+                continue;
+            }
+            const std::int32_t f = delta_[fail_base + s];
+            fail[static_cast<std::size_t>(next)] = f;
+            dict_links_[static_cast<std::size_t>(next)] =
+                outputs_[static_cast<std::size_t>(f)] >= 0 ? f : dict_links_[static_cast<std::size_t>(f)];
+            queue.push_back(next);
+        }
+    }
+}
+
+Score Matcher::score(std::string_view utf8, Scratch &scratch) const {
+    Score result;
+    if (entries_.empty()) return result;
+    std::string &folded = scratch.folded;
+    std::vector<Match> &matches = scratch.matches;
+    text::fold(utf8, folded);
+    matches.clear();
+
+    // Recorre " tok tok ... tok " (espacios colapsados) sin materializarlo.
+    // Todas las frases terminan en espacio, así que solo ahí hay salidas.
+    std::int32_t state = delta_[0];  // espacio inicial
+    std::uint32_t spaces = 0;        // espacios emitidos después del inicial = tokens cerrados
+    bool in_space = true;
+    auto emit_space = [&]() {
+        state = delta_[static_cast<std::size_t>(state) * kSymbols];
+        ++spaces;
+        for (std::int32_t s = outputs_[static_cast<std::size_t>(state)] >= 0 ? state
+                                                                              : dict_links_[static_cast<std::size_t>(state)];
+             s >= 0; s = dict_links_[static_cast<std::size_t>(s)]) {
+            const std::int32_t entry = outputs_[static_cast<std::size_t>(s)];
+            matches.push_back({spaces - entries_[static_cast<std::size_t>(entry)].tokens, spaces, entry});
+        }
+    };
+    for (unsigned char c : folded) {
+        if (c == ' ') {
+            if (!in_space) emit_space();
+            in_space = true;
+            continue;
+        }
+        in_space = false;
+        state = delta_[static_cast<std::size_t>(state) * kSymbols + symbol_of(c)];
+    }
+    if (!in_space) emit_space();
+    if (matches.empty()) return result;
+
+    // Traslapes: gana la que empieza primero; a igual inicio, la más larga.
+    std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        if (a.start != b.start) return a.start < b.start;
+        return a.end > b.end;
+    });
+    std::uint32_t covered = 0;
+    bool negated_span = false;
+    std::uint32_t negator_end = 0;
+    for (const Match &m : matches) {
+        if (m.start < covered) continue;
+        covered = m.end;
+        const Entry &entry = entries_[static_cast<std::size_t>(m.entry)];
+        if (entry.negator) {
+            negated_span = true;
+            negator_end = m.end;
+            continue;
+        }
+        double weight = entry.weight;
+        if (negated_span && m.start - negator_end < window_) weight = -weight;
+        result.score += weight;
+        if (weight > 0) result.positive += weight;
+        else result.negative -= weight;
+        ++result.matches;
+    }
+    return result;
+}
+
+Summary score_all(const Matcher &matcher, const std::vector<std::string_view> &texts) {
+    Summary summary;
+    summary.per_text.reserve(texts.size());
+    Matcher::Scratch scratch;
+    for (std::string_view text : texts) {
+        const Score s = matcher.score(text, scratch);
+        summary.positive += s.positive;
+        summary.negative += s.negative;
+        summary.matches += s.matches;
+        if (s.score > 0) ++summary.positive_texts;
+        else if (s.score < 0) ++summary.negative_texts;
+        else ++summary.neutral_texts;
+        summary.per_text.push_back(s);
+    }
+    return summary;
+}
+
+}  // namespace lexicon
+}  // namespace csvcore
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace csvcore {
+
+// Puntuación de sentimiento con léxicos (palabras y frases) sobre texto libre.
+namespace lexicon {
+
+struct Lexicon {
+    // Frase -> peso (> 0 positivo, < 0 negativo). Se normalizan con
+    // text::fold(); si una frase se repite, gana la última.
+    std::vector<std::pair<std::string, double>> terms;
+    // Negadores ("no", "nunca", "para nada"): invierten el signo de los
+    // términos que empiezan a menos de `window` tokens después de ellos.
+    std::vector<std::string> negators;
+    std::size_t window = 3;
+};
+
+struct Score {
+    double score = 0.0;     // suma de pesos con signo (ya con negaciones)
+    double positive = 0.0;  // suma de los aportes positivos
+    double negative = 0.0;  // suma de los aportes negativos (en valor absoluto)
+    std::uint32_t matches = 0;
+};
+
+// Autómata Aho–Corasick sobre el texto normalizado: una sola pasada lineal
+// por texto, sin importar cuántas frases tenga el léxico. Las frases se
+// comparan por palabras completas; cuando se traslapan gana la que empieza
+// primero y, a igual inicio, la más larga ("no es bueno" antes que "bueno").
+// Es inmutable después de construirse: score() se puede llamar desde varios
+// hilos, cada uno con su Scratch.
+class Matcher {
+public:
+    explicit Matcher(const Lexicon &lexicon);
+
+    Matcher(const Matcher &) = delete;
+    Matcher &operator=(const Matcher &) = delete;
+
+    struct Match {
+        std::uint32_t start;  // token inicial
+        std::uint32_t end;    // token final (exclusivo)
+        std::int32_t entry;
+    };
+
+    // Buffers del llamador, reutilizados entre textos (uno por hilo).
+    struct Scratch {
+        std::string folded;
+        std::vector<Match> matches;
+    };
+
+    Score score(std::string_view utf8, Scratch &scratch) const;
+
+    std::size_t patterns() const { return entries_.size(); }
+    std::size_t states() const { return outputs_.size(); }
+    std::size_t window() const { return window_; }
+
+private:
+    struct Entry {
+        double weight;
+        std::uint32_t tokens;  // largo de la frase en tokens
+        bool negator;
+    };
+
+    void insert(std::string_view phrase, const Entry &entry);
+    void build_links();
+
+    // Tabla de transiciones densa (estado x símbolo) ya con los enlaces de
+    // falla resueltos: cada byte del texto es una sola consulta.
+    std::vector<std::int32_t> delta_;
+    std::vector<std::int32_t> outputs_;     // entrada que termina en el estado (-1 = ninguna)
+    std::vector<std::int32_t> dict_links_;  // siguiente estado con salida en la cadena de falla
+    std::vector<Entry> entries_;
+    std::size_t window_;
+};
+
+struct Summary {
+    std::vector<Score> per_text;
+    double positive = 0.0;
+    double negative = 0.0;
+    std::uint64_t matches = 0;
+    std::uint64_t positive_texts = 0;  // score > 0
+    std::uint64_t negative_texts = 0;  // score < 0
+    std::uint64_t neutral_texts = 0;
+};
+
+// Puntúa todos los textos y agrega los totales.
+Summary score_all(const Matcher &matcher, const std::vector<std::string_view> &texts);
+
+}  // namespace lexicon
+
+}  // namespace csvcore
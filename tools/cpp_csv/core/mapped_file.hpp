@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace csvcore {
+
+// Archivo de solo lectura proyectado en memoria (mmap / MapViewOfFile). Las
+// páginas se cargan bajo demanda y las comparten todos los procesos que
+// abren el mismo archivo, así que varios workers no duplican los datos.
+class MappedFile {
+public:
+    // Lanza std::runtime_error si el archivo no se puede abrir o proyectar.
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#endif
+};
+
+}  // namespace csvcore
@@ -0,0 +1,74 @@
+#include "memory_budget.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "arena.hpp"
+
+namespace csvcore {
+
+namespace {
+
+// Un byte crudo del chunk termina ocupando varios: capacidad del arena (el
+// doble en el peor caso) más el str de Python de cada celda (49 bytes de
+// encabezado + contenido) y los dicts/listas de cada fila.
+constexpr std::size_t kChunkExpansion = 8;
+constexpr std::size_t kMinChunkBytes = std::size_t(64) << 10;
+
+std::string human(std::size_t bytes) {
+    if (bytes < (std::size_t(1) << 20)) return std::to_string((bytes + 1023) >> 10) + " KB";
+    return std::to_string((bytes + (std::size_t(1) << 19)) >> 20) + " MB";
+}
+
+}  // namespace
+
+std::size_t MemoryBudget::available() const {
+    if (limit_ == 0) return std::numeric_limits<std::size_t>::max();
+    const std::size_t used = current();
+    return used >= limit_ ? 0 : limit_ - used;
+}
+
+bool MemoryBudget::try_charge(std::size_t bytes) {
+    std::size_t used = current_.load(std::memory_order_relaxed);
+    std::size_t next;
+    do {
+        if (limit_ != 0 && (bytes > limit_ || used > limit_ - bytes)) return false;
+        next = used + bytes;
+    } while (!current_.compare_exchange_weak(used, next, std::memory_order_relaxed));
+
+    std::size_t peak = peak_.load(std::memory_order_relaxed);
+    while (next > peak && !peak_.compare_exchange_weak(peak, next, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+void MemoryBudget::charge(std::size_t bytes, const char *what) {
+    if (!try_charge(bytes)) {
+        throw BudgetExceeded("cpp_csv excedería su presupuesto de memoria de " + human(limit_) +
+                             ": faltan " + human(bytes) + " para " + what + " (" + human(current()) +
+                             " en uso)");
+    }
+}
+
+void MemoryBudget::release(std::size_t bytes) {
+    current_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+std::size_t MemoryBudget::chunk_bytes(std::size_t arenas) const {
+    if (limit_ == 0) return kChunkMaxBytes;
+    const std::size_t share = available() / (kChunkExpansion * std::max<std::size_t>(arenas, 1));
+    return std::min(kChunkMaxBytes, std::max(kMinChunkBytes, share));
+}
+
+void BudgetLease::resize(std::size_t bytes) {
+    if (budget_ == nullptr || bytes == bytes_) return;
+    if (bytes > bytes_) {
+        budget_->charge(bytes - bytes_, what_);
+    } else {
+        budget_->release(bytes_ - bytes);
+    }
+    bytes_ = bytes;
+    if (bytes_ > peak_.load(std::memory_order_relaxed)) peak_.store(bytes_, std::memory_order_relaxed);
+}
+
+}  // namespace csvcore
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace csvcore {
+
+// La llamada necesitaría pasar de su presupuesto de memoria. La capa de
+// Python la traduce a MemoryError.
+class BudgetExceeded : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Presupuesto de memoria de una llamada: cuenta lo que la propia llamada
+// reserva (arenas y la estimación de los objetos de Python que crea) y
+// lleva el pico. Con límite 0 solo mide. Seguro entre hilos (el hilo de
+// prefetch y el consumidor cargan al mismo presupuesto).
+class MemoryBudget {
+public:
+    explicit MemoryBudget(std::size_t limit = 0) : limit_(limit) {}
+
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    std::size_t limit() const { return limit_; }
+    std::size_t current() const { return current_.load(std::memory_order_relaxed); }
+    std::size_t peak() const { return peak_.load(std::memory_order_relaxed); }
+
+    // Bytes que quedan antes del límite (SIZE_MAX sin límite).
+    std::size_t available() const;
+
+    // Carga `bytes` si caben; false (sin cargar nada) si no.
+    bool try_charge(std::size_t bytes);
+
+    // Igual, pero lanza BudgetExceeded con `what` en el mensaje.
+    void charge(std::size_t bytes, const char *what);
+
+    void release(std::size_t bytes);
+
+    // Tope de bytes crudos para el siguiente chunk de un lector con
+    // `arenas` arenas vivos a la vez: deja lugar para la expansión del arena
+    // y de los objetos de Python que salgan de él, así que al gastarse el
+    // presupuesto los chunks se hacen más chicos en vez de fallar.
+    std::size_t chunk_bytes(std::size_t arenas = 1) const;
+
+private:
+    std::size_t limit_;
+    std::atomic<std::size_t> current_{0};
+    std::atomic<std::size_t> peak_{0};
+};
+
+// Parte del presupuesto que sigue el tamaño de algo (un arena, los objetos
+// de un chunk): resize() carga o libera la diferencia y el destructor la
+// libera toda. Sin presupuesto no hace nada.
+class BudgetLease {
+public:
+    BudgetLease() = default;
+    BudgetLease(MemoryBudget *budget, const char *what) : budget_(budget), what_(what) {}
+    ~BudgetLease() { reset(); }
+
+    BudgetLease(const BudgetLease &) = delete;
+    BudgetLease &operator=(const BudgetLease &) = delete;
+
+    // Lanza BudgetExceeded si crecer no cabe (el tamaño anterior se conserva).
+    void resize(std::size_t bytes);
+    void add(std::size_t bytes) { resize(bytes_ + bytes); }
+    void reset() { resize(0); }
+
+    std::size_t bytes() const { return bytes_; }
+    // Se puede leer desde otro hilo (p. ej. el consumidor del prefetch).
+    std::size_t peak() const { return peak_.load(std::memory_order_relaxed); }
+
+private:
+    MemoryBudget *budget_ = nullptr;
+    const char *what_ = "";
+    std::size_t bytes_ = 0;
+    std::atomic<std::size_t> peak_{0};
+};
+
+}  // namespace csvcore
@@ -0,0 +1,20 @@
+#include "metrics.hpp"
+
+namespace csvcore {
+namespace metrics {
+
+const char *phase_name(Phase phase) {
+    switch (phase) {
+        case IO: return "io";
+        case TOKENIZE: return "tokenize";
+        case FILTER: return "filter";
+        case VALIDATE: return "validate";
+        case AGGREGATE: return "aggregate";
+        case CONVERT: return "convert";
+        case WAIT: return "wait";
+        default: return "unknown";
+    }
+}
+
+}  // namespace metrics
+}  // namespace csvcore
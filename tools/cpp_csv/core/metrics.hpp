@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace csvcore {
+
+// Contadores por fase de una llamada, opcionales: sin CallStats no se lee
+// el reloj. Los escribe el hilo que parsea y se pueden leer desde otro (el
+// consumidor del prefetch, los rangos de discover), así que son atómicos;
+// los tiempos se acumulan en local (PhaseClock) y se suman por chunk.
+namespace metrics {
+
+enum Phase : std::size_t {
+    IO,         // lectura del archivo
+    TOKENIZE,   // parseo de registros al arena
+    FILTER,     // evaluación del filtro de filas
+    VALIDATE,   // reglas de read_and_validate_csv
+    AGGREGATE,  // conteos de discover_column_values
+    CONVERT,    // creación de objetos de Python (con el GIL)
+    WAIT,       // consumidor esperando al hilo de prefetch
+    kPhases
+};
+
+// "io", "tokenize", "filter", "validate", "aggregate", "convert", "wait".
+const char *phase_name(Phase phase);
+
+inline std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+using Counter = std::atomic<std::uint64_t>;
+
+inline void bump(Counter &counter, std::uint64_t n) {
+    if (n != 0) counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+inline std::uint64_t read(const Counter &counter) {
+    return counter.load(std::memory_order_relaxed);
+}
+
+struct CallStats {
+    Counter bytes_read{0};
+    Counter rows{0};           // filas entregadas (después del filtro)
+    Counter cells{0};
+    Counter filtered_rows{0};  // descartadas por el filtro
+    Counter allocations{0};    // chunks en los que el arena tuvo que crecer
+    Counter errors{0};         // errores de validación
+    std::array<Counter, kPhases> phase_ns{};
+};
+
+// Cronómetro de fases: mark(fase) carga a esa fase el tiempo desde la marca
+// anterior (o desde restart()). Acumula en local y suma a `stats` en
+// flush() y al destruirse.
+class PhaseClock {
+public:
+    explicit PhaseClock(CallStats *stats) : stats_(stats), last_(stats ? now_ns() : 0) {}
+    ~PhaseClock() { flush(); }
+
+    PhaseClock(const PhaseClock &) = delete;
+    PhaseClock &operator=(const PhaseClock &) = delete;
+
+    void mark(Phase phase) {
+        if (stats_ == nullptr) return;
+        const std::uint64_t now = now_ns();
+        local_[phase] += now - last_;
+        last_ = now;
+    }
+
+    // Descarta el tiempo desde la última marca (p. ej. lo que corrió sin medir).
+    void restart() {
+        if (stats_ != nullptr) last_ = now_ns();
+    }
+
+    void flush() {
+        if (stats_ == nullptr) return;
+        for (std::size_t p = 0; p < kPhases; ++p) {
+            bump(stats_->phase_ns[p], local_[p]);
+            local_[p] = 0;
+        }
+    }
+
+private:
+    CallStats *stats_;
+    std::uint64_t last_;
+    std::array<std::uint64_t, kPhases> local_{};
+};
+
+}  // namespace metrics
+
+}  // namespace csvcore
@@ -0,0 +1,88 @@
+#include "multiselect.hpp"
+
+#include "validation.hpp"
+
+namespace csvcore {
+namespace multiselect {
+
+CellTokenizer::CellTokenizer(std::string_view separators, char quote) : quote_(quote) {
+    for (char c : separators) {
+        is_separator_[static_cast<unsigned char>(c)] = true;
+    }
+}
+
+std::size_t CellTokenizer::split(std::string_view cell) {
+    bytes_.clear();
+    spans_.clear();
+
+    bool in_quotes = false;
+    std::size_t token_start = 0;
+    for (std::size_t i = 0; i < cell.size(); ++i) {
+        char c = cell[i];
+        if (c == quote_) {
+            if (in_quotes && i + 1 < cell.size() && cell[i + 1] == quote_) {
+                bytes_.push_back(quote_);
+                ++i;
+            } else {
+                in_quotes = !in_quotes;
+            }
+        } else if (!in_quotes && is_separator_[static_cast<unsigned char>(c)]) {
+            finish_token(token_start);
+            token_start = bytes_.size();
+        } else {
+            bytes_.push_back(c);
+        }
+    }
+    finish_token(token_start);
+    return spans_.size();
+}
+
+void CellTokenizer::finish_token(std::size_t token_start) {
+    std::string_view raw(bytes_.data() + token_start, bytes_.size() - token_start);
+    std::string_view clean = validation::trim(raw);
+    if (!clean.empty()) {
+        bool seen = false;
+        for (std::size_t i = 0; i < spans_.size() && !seen; ++i) {
+            seen = token(i) == clean;
+        }
+        if (!seen) {
+            spans_.emplace_back(token_start + (clean.data() - raw.data()), clean.size());
+            return;
+        }
+    }
+    // Token vacío o repetido: se descartan sus bytes
+    bytes_.resize(token_start);
+}
+
+OptionMapper::OptionMapper(const std::vector<std::pair<std::string, long long>> &options,
+                           std::string separators, char quote)
+    : separators_(std::move(separators)), quote_(quote) {
+    for (const auto &option : options) {
+        keys_.emplace_back(validation::trim(option.first));
+        ids_.emplace(keys_.back(), option.second);
+    }
+}
+
+MappedColumn OptionMapper::map(const std::vector<std::string_view> &cells) const {
+    MappedColumn out;
+    CellTokenizer tokenizer(separators_, quote_);
+    for (std::size_t r = 0; r < cells.size(); ++r) {
+        tokenizer.split(cells[r]);
+        for (std::size_t t = 0; t < tokenizer.size(); ++t) {
+            std::string_view token = tokenizer.token(t);
+            auto it = ids_.find(token);
+            if (it != ids_.end()) {
+                out.rows.push_back(static_cast<long long>(r));
+                out.option_ids.push_back(it->second);
+            } else {
+                out.unknown_rows.push_back(static_cast<long long>(r));
+                out.unknown_spans.emplace_back(out.unknown_bytes.size(), token.size());
+                out.unknown_bytes.append(token.data(), token.size());
+            }
+        }
+    }
+    return out;
+}
+
+}  // namespace multiselect
+}  // namespace csvcore
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace csvcore {
+
+// Celdas multi-selección ("Ventas; IT, RRHH")
+namespace multiselect {
+
+// Divide una celda en tokens: separadores configurables, respeta comillas
+// ("a, b" es un solo token, "" es una comilla literal), recorta espacios y
+// elimina duplicados dentro de la celda conservando el orden. Los tokens
+// viven en un buffer reutilizable, sin un std::string por token.
+class CellTokenizer {
+public:
+    CellTokenizer(std::string_view separators, char quote);
+
+    std::size_t split(std::string_view cell);
+
+    std::size_t size() const { return spans_.size(); }
+
+    std::string_view token(std::size_t i) const {
+        return std::string_view(bytes_.data() + spans_[i].first, spans_[i].second);
+    }
+
+private:
+    void finish_token(std::size_t token_start);
+
+    bool is_separator_[256] = {};
+    char quote_;
+    std::string bytes_;
+    std::vector<std::pair<std::size_t, std::size_t>> spans_;
+};
+
+// Resultado plano de mapear una columna: pares (fila, option_id) y los
+// tokens que no corresponden a ninguna opción conocida.
+struct MappedColumn {
+    std::vector<long long> rows;
+    std::vector<long long> option_ids;
+    std::vector<long long> unknown_rows;
+    std::string unknown_bytes;
+    std::vector<std::pair<std::size_t, std::size_t>> unknown_spans;
+};
+
+// Mapea tokens de multi-selección a IDs de opción. Las opciones
+// (texto, id) se reciben una sola vez y se reutilizan en cada chunk.
+class OptionMapper {
+public:
+    OptionMapper(const std::vector<std::pair<std::string, long long>> &options,
+                 std::string separators, char quote);
+
+    OptionMapper(const OptionMapper &) = delete;
+    OptionMapper &operator=(const OptionMapper &) = delete;
+
+    MappedColumn map(const std::vector<std::string_view> &cells) const;
+
+    const std::string &separators() const { return separators_; }
+    char quote() const { return quote_; }
+
+private:
+    std::string separators_;
+    char quote_;
+    std::deque<std::string> keys_;  // direcciones estables para las string_view
+    std::unordered_map<std::string_view, long long> ids_;
+};
+
+}  // namespace multiselect
+
+}  // namespace csvcore
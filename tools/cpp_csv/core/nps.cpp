@@ -0,0 +1,116 @@
+#include "nps.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace csvcore {
+namespace nps {
+
+namespace {
+
+constexpr double kSqrt2Pi = 2.5066282746310002;
+
+// Cuantil de la normal estándar (Acklam), p en (0, 1).
+double inverse_normal(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    constexpr double kLow = 0.02425;
+
+    if (p < kLow) {
+        const double q = std::sqrt(-2.0 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - kLow) {
+        const double q = std::sqrt(-2.0 * std::log(1.0 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    const double q = p - 0.5;
+    const double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+inline void add(Result &r, double value, std::uint64_t count) {
+    r.total += count;
+    if (value >= kPromoterMin) r.promoters += count;
+    else if (value <= kDetractorMax) r.detractors += count;
+    else if (value >= kPassiveMin && value <= kPassiveMax) r.passives += count;
+}
+
+// Cada respuesta aporta +1 (promotor), -1 (detractor) o 0; el NPS es la
+// media por 100 y su varianza es (p + d) - (p - d)^2.
+void finish(Result &r, double z) {
+    if (r.total == 0) {
+        r.score = r.margin = r.low = r.high = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+    const double n = static_cast<double>(r.total);
+    const double p = static_cast<double>(r.promoters) / n;
+    const double d = static_cast<double>(r.detractors) / n;
+    const double variance = std::max(0.0, (p + d) - (p - d) * (p - d));
+    r.score = (p - d) * 100.0;
+    r.margin = z * std::sqrt(variance / n) * 100.0;
+    r.low = std::max(-100.0, r.score - r.margin);
+    r.high = std::min(100.0, r.score + r.margin);
+}
+
+}  // namespace
+
+double z_score(double confidence) {
+    if (!(confidence > 0.0 && confidence < 1.0)) return 0.0;
+    const double p = 1.0 - (1.0 - confidence) / 2.0;
+    // Un paso de Halley con erfc lleva la aproximación a precisión doble
+    double x = inverse_normal(p);
+    const double e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    const double u = e * kSqrt2Pi * std::exp(x * x / 2.0);
+    x -= u / (1.0 + x * u / 2.0);
+    return x;
+}
+
+Breakdown compute(const std::vector<double> &values,
+                  const std::vector<std::int64_t> &counts,
+                  const std::vector<std::int32_t> &segments,
+                  std::size_t num_segments,
+                  double confidence) {
+    const bool weighted = !counts.empty();
+    const bool segmented = !segments.empty();
+    const std::size_t n = std::min({values.size(),
+                                    weighted ? counts.size() : values.size(),
+                                    segmented ? segments.size() : values.size()});
+    if (segmented && num_segments == 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (segments[i] >= 0) num_segments = std::max(num_segments, static_cast<std::size_t>(segments[i]) + 1);
+        }
+    }
+
+    Breakdown out;
+    // Un num_segments explícito siempre reporta esos grupos, aunque queden vacíos
+    out.segments.resize(segmented || num_segments ? num_segments : 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double value = values[i];
+        if (std::isnan(value)) continue;
+        const std::int64_t count = weighted ? counts[i] : 1;
+        if (count <= 0) continue;
+        add(out.overall, value, static_cast<std::uint64_t>(count));
+        if (segmented && segments[i] >= 0 && static_cast<std::size_t>(segments[i]) < num_segments) {
+            add(out.segments[static_cast<std::size_t>(segments[i])], value, static_cast<std::uint64_t>(count));
+        }
+    }
+
+    const double z = z_score(confidence);
+    finish(out.overall, z);
+    for (Result &r : out.segments) finish(r, z);
+    return out;
+}
+
+}  // namespace nps
+}  // namespace csvcore
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace csvcore {
+
+// Net Promoter Score sobre distribuciones (valor, conteo), global y por
+// segmento (p. ej. cada opción de una pregunta demográfica), en una pasada.
+namespace nps {
+
+// Cortes del NPS: promotores >= 9, pasivos 7..8, detractores <= 6. Los
+// valores entre cortes (6.5, 8.5) solo cuentan en el total.
+constexpr double kPromoterMin = 9.0;
+constexpr double kPassiveMin = 7.0;
+constexpr double kPassiveMax = 8.0;
+constexpr double kDetractorMax = 6.0;
+
+struct Result {
+    std::uint64_t total = 0;
+    std::uint64_t promoters = 0;
+    std::uint64_t passives = 0;
+    std::uint64_t detractors = 0;
+    // Con total == 0 no hay NPS: score, margin, low y high quedan en NaN.
+    double score = 0.0;   // %promotores - %detractores, en [-100, 100]
+    double margin = 0.0;  // z * error estándar (Wald), en puntos de NPS
+    double low = 0.0;     // intervalo recortado a [-100, 100]
+    double high = 0.0;
+
+    bool empty() const { return total == 0; }
+};
+
+struct Breakdown {
+    Result overall;
+    std::vector<Result> segments;
+};
+
+// Cuantil de la normal estándar para un intervalo bilateral con esa
+// confianza (0.95 -> 1.959964): aproximación de Acklam refinada con un
+// paso de Halley, igual a statistics.NormalDist().inv_cdf.
+double z_score(double confidence);
+
+// NPS desde arreglos paralelos. Sin `counts` cada valor cuenta 1; se
+// ignoran NaN y conteos <= 0. `segments` (vacío = sin segmentos) da el
+// código de cada entrada; los códigos fuera de [0, num_segments) solo
+// cuentan en el global. num_segments == 0 lo toma del código mayor + 1;
+// si se da, siempre hay esos grupos aunque no les toque ninguna entrada.
+Breakdown compute(const std::vector<double> &values,
+                  const std::vector<std::int64_t> &counts,
+                  const std::vector<std::int32_t> &segments,
+                  std::size_t num_segments,
+                  double confidence);
+
+}  // namespace nps
+
+}  // namespace csvcore
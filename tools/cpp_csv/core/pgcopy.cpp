@@ -0,0 +1,182 @@
+#include "pgcopy.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace csvcore {
+namespace pgcopy {
+
+namespace {
+
+constexpr char kSignature[] = "PGCOPY\n\377\r\n";  // + '\0' final = 11 bytes
+constexpr std::int32_t kNullLength = -1;
+
+std::size_t field_bytes(Type type) {
+    switch (type) {
+        case Type::Int2: return 2;
+        case Type::Int4: return 4;
+        case Type::Int8: return 8;
+        case Type::Text: return 0;
+    }
+    return 0;
+}
+
+const char *type_name(Type type) {
+    switch (type) {
+        case Type::Int2: return "int2";
+        case Type::Int4: return "int4";
+        case Type::Int8: return "int8";
+        case Type::Text: return "text";
+    }
+    return "?";
+}
+
+// Enteros en orden de red (big-endian) sin depender de htonl.
+inline char *put_u16(char *out, std::uint16_t v) {
+    out[0] = static_cast<char>(v >> 8);
+    out[1] = static_cast<char>(v);
+    return out + 2;
+}
+
+inline char *put_u32(char *out, std::uint32_t v) {
+    out[0] = static_cast<char>(v >> 24);
+    out[1] = static_cast<char>(v >> 16);
+    out[2] = static_cast<char>(v >> 8);
+    out[3] = static_cast<char>(v);
+    return out + 4;
+}
+
+inline char *put_u64(char *out, std::uint64_t v) {
+    out = put_u32(out, static_cast<std::uint32_t>(v >> 32));
+    return put_u32(out, static_cast<std::uint32_t>(v));
+}
+
+}  // namespace
+
+Type parse_type(std::string_view name) {
+    if (name == "int2" || name == "smallint") return Type::Int2;
+    if (name == "int4" || name == "integer") return Type::Int4;
+    if (name == "int8" || name == "bigint") return Type::Int8;
+    if (name == "text") return Type::Text;
+    throw std::invalid_argument("Tipo de COPY no soportado: " + std::string(name));
+}
+
+void Column::clear() {
+    ints.clear();
+    texts.clear();
+    nulls.clear();
+}
+
+Encoder::Encoder(std::vector<Type> types) : types_(std::move(types)), columns_(types_.size()) {
+    if (types_.empty()) throw std::invalid_argument("COPY necesita al menos una columna");
+    if (types_.size() > static_cast<std::size_t>(std::numeric_limits<std::int16_t>::max())) {
+        throw std::invalid_argument("Demasiadas columnas para COPY");
+    }
+}
+
+void Encoder::clear() {
+    for (Column &column : columns_) column.clear();
+}
+
+std::size_t Encoder::rows() const {
+    const std::size_t n = columns_[0].nulls.size();
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+        const Column &column = columns_[c];
+        const std::size_t values = types_[c] == Type::Text ? column.texts.size() : column.ints.size();
+        if (column.nulls.size() != n || values != n) {
+            throw std::invalid_argument("Todas las columnas del COPY deben tener el mismo número de filas");
+        }
+    }
+    return n;
+}
+
+std::size_t Encoder::encoded_size(bool header, bool trailer) const {
+    const std::size_t n = rows();
+    std::size_t size = (header ? kHeaderBytes : 0) + (trailer ? kTrailerBytes : 0) + n * 2;
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+        const Column &column = columns_[c];
+        const Type type = types_[c];
+        std::int64_t lo = std::numeric_limits<std::int64_t>::min();
+        std::int64_t hi = std::numeric_limits<std::int64_t>::max();
+        if (type == Type::Int2) {
+            lo = std::numeric_limits<std::int16_t>::min();
+            hi = std::numeric_limits<std::int16_t>::max();
+        } else if (type == Type::Int4) {
+            lo = std::numeric_limits<std::int32_t>::min();
+            hi = std::numeric_limits<std::int32_t>::max();
+        }
+        for (std::size_t r = 0; r < n; ++r) {
+            size += 4;
+            if (column.nulls[r]) continue;
+            if (type == Type::Text) {
+                if (column.texts[r].size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+                    throw std::overflow_error("Texto demasiado largo para COPY");
+                }
+                size += column.texts[r].size();
+            } else {
+                const std::int64_t v = column.ints[r];
+                if (v < lo || v > hi) {
+                    throw std::overflow_error("Valor " + std::to_string(v) + " fuera de rango para " +
+                                             type_name(type) + " (columna " + std::to_string(c) + ")");
+                }
+                size += field_bytes(type);
+            }
+        }
+    }
+    return size;
+}
+
+char *Encoder::write(char *out, bool header, bool trailer) const {
+    const std::size_t n = rows();
+    if (header) {
+        std::memcpy(out, kSignature, sizeof(kSignature));  // incluye el '\0'
+        out += sizeof(kSignature);
+        out = put_u32(out, 0);  // banderas
+        out = put_u32(out, 0);  // extensión del encabezado
+    }
+    const std::uint16_t fields = static_cast<std::uint16_t>(types_.size());
+    for (std::size_t r = 0; r < n; ++r) {
+        out = put_u16(out, fields);
+        for (std::size_t c = 0; c < columns_.size(); ++c) {
+            const Column &column = columns_[c];
+            if (column.nulls[r]) {
+                out = put_u32(out, static_cast<std::uint32_t>(kNullLength));
+                continue;
+            }
+            switch (types_[c]) {
+                case Type::Int2:
+                    out = put_u32(out, 2);
+                    out = put_u16(out, static_cast<std::uint16_t>(column.ints[r]));
+                    break;
+                case Type::Int4:
+                    out = put_u32(out, 4);
+                    out = put_u32(out, static_cast<std::uint32_t>(column.ints[r]));
+                    break;
+                case Type::Int8:
+                    out = put_u32(out, 8);
+                    out = put_u64(out, static_cast<std::uint64_t>(column.ints[r]));
+                    break;
+                case Type::Text: {
+                    const std::string_view text = column.texts[r];
+                    out = put_u32(out, static_cast<std::uint32_t>(text.size()));
+                    if (!text.empty()) std::memcpy(out, text.data(), text.size());
+                    out += text.size();
+                    break;
+                }
+            }
+        }
+    }
+    if (trailer) out = put_u16(out, static_cast<std::uint16_t>(-1));
+    return out;
+}
+
+std::string Encoder::encode(bool header, bool trailer) const {
+    std::string out(encoded_size(header, trailer), '\0');
+    write(out.data(), header, trailer);
+    return out;
+}
+
+}  // namespace pgcopy
+}  // namespace csvcore
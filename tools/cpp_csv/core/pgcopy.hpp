@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace csvcore {
+
+// Formato binario de COPY de PostgreSQL (COPY ... WITH (FORMAT BINARY)):
+// firma + banderas + extensión de encabezado, luego por tupla un int16 con
+// el número de campos y por campo un int32 con su longitud (-1 = NULL) y
+// sus bytes en orden de red; termina con un int16 -1. El servidor no
+// vuelve a parsear enteros ni a desescapar texto.
+namespace pgcopy {
+
+enum class Type : std::uint8_t { Int2, Int4, Int8, Text };
+
+// "int2", "int4", "int8" o "text" (también smallint, integer, bigint).
+Type parse_type(std::string_view name);
+
+constexpr std::size_t kHeaderBytes = 19;
+constexpr std::size_t kTrailerBytes = 2;
+
+// Una columna del lote. Los enteros van en `ints` y los textos en `texts`
+// según el tipo; `nulls[r]` != 0 marca NULL en la fila r. Los textos son
+// vistas: sus datos deben seguir vivos hasta escribir el lote.
+struct Column {
+    std::vector<std::int64_t> ints;
+    std::vector<std::string_view> texts;
+    std::vector<std::uint8_t> nulls;
+
+    void clear();
+};
+
+// Codifica lotes de tuplas con tipos fijos. Las columnas se llenan por
+// fuera y se reutilizan entre lotes (clear() conserva la capacidad), así
+// que importar muchos lotes no vuelve a reservar memoria. No es seguro
+// compartir un Encoder entre hilos.
+class Encoder {
+public:
+    explicit Encoder(std::vector<Type> types);
+
+    const std::vector<Type> &types() const { return types_; }
+    Column &column(std::size_t index) { return columns_.at(index); }
+    void clear();
+
+    // Filas del lote actual; valida que todas las columnas coincidan.
+    std::size_t rows() const;
+
+    // Bytes exactos del lote (con encabezado y/o terminador del COPY).
+    // Valida longitudes y rangos (int2/int4) y lanza si algo no cabe.
+    std::size_t encoded_size(bool header, bool trailer) const;
+
+    // Escribe el lote en `out`, que debe tener encoded_size() bytes.
+    // Regresa el puntero al final de lo escrito.
+    char *write(char *out, bool header, bool trailer) const;
+
+    std::string encode(bool header = true, bool trailer = true) const;
+
+private:
+    std::vector<Type> types_;
+    std::vector<Column> columns_;
+};
+
+}  // namespace pgcopy
+
+}  // namespace csvcore
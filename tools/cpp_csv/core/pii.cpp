@@ -0,0 +1,225 @@
+#include "pii.hpp"
+
+#include <unordered_set>
+
+namespace csvcore {
+namespace pii {
+
+namespace {
+
+enum Class : std::uint8_t {
+    C_DIGIT = 1 << 0,
+    C_ALPHA = 1 << 1,
+    C_WORD = 1 << 2,    // \w: alfanumérico, '_' y bytes no ASCII (letras UTF-8)
+    C_LOCAL = 1 << 3,   // parte local del correo: [A-Za-z0-9._%+-]
+    C_DOMAIN = 1 << 4,  // dominio del correo: [A-Za-z0-9.-]
+    C_PHONE = 1 << 5,   // tramo de teléfono: [0-9 \s - ( ) .]
+    C_SPACE = 1 << 6,   // \s ASCII
+};
+
+struct ClassTable {
+    std::uint8_t bits[256] = {};
+
+    ClassTable() {
+        for (int c = 0; c < 256; ++c) {
+            std::uint8_t b = 0;
+            const bool digit = c >= '0' && c <= '9';
+            const bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            if (digit) b |= C_DIGIT | C_PHONE;
+            if (alpha) b |= C_ALPHA;
+            if (digit || alpha || c == '_' || c >= 0x80) b |= C_WORD;
+            if (digit || alpha || c == '.' || c == '_' || c == '%' || c == '+' || c == '-') b |= C_LOCAL;
+            if (digit || alpha || c == '.' || c == '-') b |= C_DOMAIN;
+            if (c == ' ' || (c >= '\t' && c <= '\r')) b |= C_SPACE | C_PHONE;
+            if (c == '-' || c == '(' || c == ')' || c == '.') b |= C_PHONE;
+            bits[c] = b;
+        }
+    }
+};
+
+const ClassTable kClasses;
+
+inline std::uint8_t cls(std::string_view s, std::size_t i) {
+    return kClasses.bits[static_cast<unsigned char>(s[i])];
+}
+
+inline bool is_word(std::string_view s, std::size_t i) {
+    return i < s.size() && (cls(s, i) & C_WORD);
+}
+
+// ¿Hay un límite de palabra (\b) en alguna posición de [begin, end)?
+bool has_boundary(std::string_view s, std::size_t begin, std::size_t end) {
+    for (std::size_t p = begin; p < end; ++p) {
+        const bool before = p > 0 && is_word(s, p - 1);
+        if (before != is_word(s, p)) return true;
+    }
+    return false;
+}
+
+// Símbolos de un token para los documentos oficiales.
+enum Symbol : char { LETTER = 'L', ENYE = 'N', NUMBER = 'D', AMP = '&' };
+
+constexpr std::size_t kMaxToken = 18;  // CURP
+
+bool valid_date(const char *digits) {
+    const int month = (digits[2] - '0') * 10 + (digits[3] - '0');
+    const int day = (digits[4] - '0') * 10 + (digits[5] - '0');
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+// RFC (3 o 4 letras, fecha AAMMDD, homoclave), CURP (18) o DNI (8 dígitos
+// + letra). `symbols` y `chars` tienen `n` posiciones.
+bool matches_national_id(const char *symbols, const char *chars, std::size_t n) {
+    auto run = [&](std::size_t from, std::size_t count, auto accept) {
+        for (std::size_t i = from; i < from + count; ++i) {
+            if (!accept(symbols[i], chars[i])) return false;
+        }
+        return true;
+    };
+    auto rfc_letter = [](char s, char) { return s == LETTER || s == ENYE || s == AMP; };
+    auto letter = [](char s, char) { return s == LETTER; };
+    auto digit = [](char s, char) { return s == NUMBER; };
+    auto alnum = [](char s, char) { return s == LETTER || s == NUMBER; };
+    auto sex = [](char s, char c) { return s == LETTER && (c == 'H' || c == 'M' || c == 'h' || c == 'm'); };
+
+    if (n == 12 || n == 13) {
+        const std::size_t prefix = n - 9;
+        if (run(0, prefix, rfc_letter) && run(prefix, 6, digit) && run(prefix + 6, 3, alnum)) {
+            return valid_date(chars + prefix);
+        }
+        return false;
+    }
+    if (n == 18) {
+        return run(0, 4, letter) && run(4, 6, digit) && run(10, 1, sex) && run(11, 5, letter) &&
+               run(16, 1, alnum) && run(17, 1, digit) && valid_date(chars + 4);
+    }
+    if (n == 9) {
+        return run(0, 8, digit) && run(8, 1, letter);
+    }
+    return false;
+}
+
+}  // namespace
+
+bool contains_email(std::string_view s) {
+    for (std::size_t at = s.find('@'); at != std::string_view::npos; at = s.find('@', at + 1)) {
+        // Parte local: tramo de [a-z0-9._%+-] pegado a la '@' que empiece en un \b
+        std::size_t begin = at;
+        while (begin > 0 && (cls(s, begin - 1) & C_LOCAL)) --begin;
+        if (begin == at || !has_boundary(s, begin, at)) continue;
+
+        // Dominio: algún '.' (con al menos un carácter antes) seguido de 2+
+        // letras que terminan en \b
+        std::size_t end = at + 1;
+        while (end < s.size() && (cls(s, end) & C_DOMAIN)) ++end;
+        for (std::size_t dot = at + 2; dot < end; ++dot) {
+            if (s[dot] != '.') continue;
+            std::size_t j = dot + 1;
+            while (j < end && (cls(s, j) & C_ALPHA)) ++j;
+            if (j - dot - 1 >= 2 && !is_word(s, j)) return true;
+        }
+    }
+    return false;
+}
+
+bool looks_like_phone(std::string_view s) {
+    bool candidate = false;
+    std::size_t digits = 0;
+    std::size_t first = std::string_view::npos;  // primer dígito del tramo actual
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const std::uint8_t c = cls(s, i);
+        if (!(c & C_PHONE)) {
+            first = std::string_view::npos;
+            continue;
+        }
+        if (c & C_DIGIT) {
+            ++digits;
+            if (first == std::string_view::npos) first = i;
+            else if (i - first >= 7) candidate = true;
+        }
+    }
+    return candidate && digits >= 7 && digits <= 15;
+}
+
+bool looks_like_identifier(std::string_view s) {
+    std::size_t length = 0;
+    bool has_alpha = false;
+    bool has_digit = false;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const std::uint8_t c = cls(s, i);
+        if ((c & C_SPACE) || s[i] == '_' || s[i] == '-') continue;
+        if (c & C_ALPHA) has_alpha = true;
+        else if (c & C_DIGIT) has_digit = true;
+        else return false;
+        if (++length > 64) return false;
+    }
+    if (length < 6) return false;
+    return (has_alpha && has_digit) || (has_digit && !has_alpha && length >= 8);
+}
+
+bool contains_national_id(std::string_view s) {
+    char symbols[kMaxToken];
+    char chars[kMaxToken];
+    std::size_t n = 0;
+    bool overflow = false;  // token más largo que cualquier documento
+    auto close = [&]() {
+        const bool hit = !overflow && matches_national_id(symbols, chars, n);
+        n = 0;
+        overflow = false;
+        return hit;
+    };
+    auto push = [&](char symbol, char c) {
+        if (n == kMaxToken) overflow = true;
+        else {
+            symbols[n] = symbol;
+            chars[n] = c;
+            ++n;
+        }
+    };
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const std::uint8_t c = cls(s, i);
+        if (c & C_ALPHA) push(LETTER, s[i]);
+        else if (c & C_DIGIT) push(NUMBER, s[i]);
+        else if (s[i] == '&') push(AMP, s[i]);
+        else if (static_cast<unsigned char>(s[i]) == 0xC3 && i + 1 < s.size() &&
+                 (static_cast<unsigned char>(s[i + 1]) == 0x91 || static_cast<unsigned char>(s[i + 1]) == 0xB1)) {
+            push(ENYE, 'N');  // Ñ / ñ
+            ++i;
+        } else if ((n || overflow) && close()) {
+            return true;
+        }
+    }
+    return (n || overflow) && close();
+}
+
+std::uint8_t classify(std::string_view value) {
+    std::uint8_t mask = 0;
+    if (value.empty()) return mask;
+    if (value.find('@') != std::string_view::npos && contains_email(value)) mask |= EMAIL;
+    if (looks_like_phone(value)) mask |= PHONE;
+    if (looks_like_identifier(value)) mask |= IDENTIFIER;
+    if (contains_national_id(value)) mask |= NATIONAL_ID;
+    return mask;
+}
+
+ColumnReport scan_column(const std::vector<std::string_view> &values) {
+    ColumnReport report;
+    report.values = values.size();
+    std::unordered_set<std::string_view> distinct;
+    distinct.reserve(values.size());
+    for (std::size_t row = 0; row < values.size(); ++row) {
+        const std::string_view value = values[row];
+        distinct.insert(value);
+        const std::uint8_t mask = classify(value);
+        if (mask & EMAIL) ++report.emails;
+        if (mask & PHONE) ++report.phones;
+        if (mask & IDENTIFIER) ++report.identifiers;
+        if (mask & NATIONAL_ID) ++report.national_ids;
+        if (mask & (EMAIL | PHONE | NATIONAL_ID)) report.flagged_rows.push_back(row);
+    }
+    report.distinct = distinct.size();
+    return report;
+}
+
+}  // namespace pii
+}  // namespace csvcore
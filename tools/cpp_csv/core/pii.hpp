@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace csvcore {
+
+// Detección de datos personales (PII) en valores de texto: correos,
+// teléfonos, identificadores y documentos oficiales (RFC, CURP, DNI).
+// Cada detector es un autómata escrito a mano que recorre el valor una sola
+// vez, sin regex.
+namespace pii {
+
+enum Kind : std::uint8_t {
+    EMAIL = 1 << 0,
+    PHONE = 1 << 1,
+    IDENTIFIER = 1 << 2,   // el valor completo parece un código/folio
+    NATIONAL_ID = 1 << 3,  // RFC, CURP o DNI dentro del texto
+};
+
+// Equivalente a \b[a-z0-9._%+-]+@[a-z0-9.-]+\.[a-z]{2,}\b (sin distinguir
+// mayúsculas) buscado en cualquier parte del valor.
+bool contains_email(std::string_view value);
+
+// Un tramo de [0-9 espacios - ( ) .] con dígitos en los extremos separados
+// por al menos 6 caracteres, y 7 a 15 dígitos en todo el valor.
+bool looks_like_phone(std::string_view value);
+
+// Sin espacios, '_' ni '-': 6 a 64 caracteres alfanuméricos ASCII que
+// mezclan letras y dígitos, o solo dígitos con 8 o más.
+bool looks_like_identifier(std::string_view value);
+
+// Algún token (tramo de [A-Za-z0-9&Ññ]) con forma de RFC (persona física o
+// moral), CURP o DNI, con fecha plausible en RFC/CURP.
+bool contains_national_id(std::string_view value);
+
+// Máscara de Kind para un valor.
+std::uint8_t classify(std::string_view value);
+
+struct ColumnReport {
+    std::uint64_t values = 0;  // valores recibidos (incluye vacíos)
+    std::uint64_t distinct = 0;
+    std::uint64_t emails = 0;
+    std::uint64_t phones = 0;
+    std::uint64_t identifiers = 0;
+    std::uint64_t national_ids = 0;
+    // Filas con correo, teléfono o documento oficial (para no mostrarlas
+    // como ejemplo aunque la columna no se oculte completa).
+    std::vector<std::uint64_t> flagged_rows;
+};
+
+ColumnReport scan_column(const std::vector<std::string_view> &values);
+
+}  // namespace pii
+
+}  // namespace csvcore
@@ -0,0 +1,271 @@
+#include "predicate.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "validation.hpp"
+
+namespace csvcore {
+namespace predicate {
+
+namespace {
+
+using validation::trim;
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Lee hasta `max_digits` dígitos desde `pos`; regresa cuántos leyó.
+std::size_t read_int(std::string_view s, std::size_t &pos, int &out, std::size_t max_digits) {
+    std::size_t n = 0;
+    out = 0;
+    while (pos < s.size() && n < max_digits && is_digit(s[pos])) {
+        out = out * 10 + (s[pos] - '0');
+        ++pos;
+        ++n;
+    }
+    return n;
+}
+
+bool valid_date(int year, int month, int day) {
+    static const int kDays[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (year < 1 || month < 1 || month > 12 || day < 1 || day > kDays[month - 1]) return false;
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month != 2 || day <= 28 || leap;
+}
+
+// Días desde 1970-01-01 (calendario gregoriano proléptico).
+std::int64_t days_from_civil(int year, int month, int day) {
+    year -= month <= 2;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const std::int64_t yoe = year - era * 400;
+    const std::int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+bool parse_number(std::string_view value, double &out) {
+    value = trim(value);
+    char buffer[64];
+    if (value.empty() || value.size() >= sizeof(buffer)) return false;
+    std::memcpy(buffer, value.data(), value.size());
+    buffer[value.size()] = '\0';
+    char *end = nullptr;
+    out = std::strtod(buffer, &end);
+    return end == buffer + value.size();
+}
+
+// Valor de la celda según el tipo de la comparación.
+bool cell_value(const Expr &expr, std::string_view cell, double &out) {
+    if (expr.type == Type::NUMBER) return parse_number(cell, out);
+    std::int64_t seconds = 0;
+    if (!parse_timestamp(cell, seconds)) return false;
+    out = static_cast<double>(seconds);
+    return true;
+}
+
+bool compare(Op op, int c) {
+    switch (op) {
+        case Op::EQ: return c == 0;
+        case Op::NE: return c != 0;
+        case Op::LT: return c < 0;
+        case Op::LE: return c <= 0;
+        case Op::GT: return c > 0;
+        case Op::GE: return c >= 0;
+        default: return false;
+    }
+}
+
+inline int sign(double a, double b) { return a < b ? -1 : (a > b ? 1 : 0); }
+
+}  // namespace
+
+Op parse_op(std::string_view name) {
+    if (name == "==" || name == "eq") return Op::EQ;
+    if (name == "!=" || name == "ne") return Op::NE;
+    if (name == "<" || name == "lt") return Op::LT;
+    if (name == "<=" || name == "le") return Op::LE;
+    if (name == ">" || name == "gt") return Op::GT;
+    if (name == ">=" || name == "ge") return Op::GE;
+    if (name == "between") return Op::BETWEEN;
+    if (name == "in") return Op::IN;
+    if (name == "empty") return Op::EMPTY;
+    if (name == "not_empty") return Op::NOT_EMPTY;
+    if (name == "and") return Op::AND;
+    if (name == "or") return Op::OR;
+    if (name == "not") return Op::NOT;
+    throw std::invalid_argument("Operador de filtro no soportado: " + std::string(name));
+}
+
+Type parse_type(std::string_view name) {
+    if (name == "text") return Type::TEXT;
+    if (name == "number") return Type::NUMBER;
+    if (name == "date") return Type::DATE;
+    throw std::invalid_argument("Tipo de filtro no soportado: " + std::string(name));
+}
+
+bool parse_timestamp(std::string_view value, std::int64_t &seconds) {
+    value = trim(value);
+    std::size_t pos = 0;
+    int a = 0, b = 0, c = 0;
+    const std::size_t na = read_int(value, pos, a, 4);
+    if (na == 0 || pos >= value.size()) return false;
+    const char sep = value[pos];
+    if (sep != '-' && sep != '/' && sep != '.') return false;
+    ++pos;
+    if (read_int(value, pos, b, 2) == 0 || pos >= value.size() || value[pos] != sep) return false;
+    ++pos;
+    const std::size_t nc = read_int(value, pos, c, 4);
+    if (nc == 0) return false;
+
+    int year, month, day;
+    if (na == 4 && nc <= 2) {
+        year = a, month = b, day = c;
+    } else if (na <= 2 && nc == 4) {
+        // Mes primero salvo que no pueda serlo
+        year = c, month = a, day = b;
+        if (a > 12) std::swap(month, day);
+    } else {
+        return false;
+    }
+    if (!valid_date(year, month, day)) return false;
+
+    int hour = 0, minute = 0, second = 0;
+    if (pos < value.size()) {
+        if (value[pos] != 'T' && value[pos] != ' ') return false;
+        ++pos;
+        std::size_t time_pos = pos;
+        int h = 0;
+        if (read_int(value, time_pos, h, 2) > 0 && time_pos < value.size() && value[time_pos] == ':') {
+            hour = h;
+            ++time_pos;
+            if (read_int(value, time_pos, minute, 2) != 2) return false;
+            if (time_pos < value.size() && value[time_pos] == ':') {
+                ++time_pos;
+                if (read_int(value, time_pos, second, 2) != 2) return false;
+                // Fracción de segundo: se ignora
+                if (time_pos < value.size() && value[time_pos] == '.') {
+                    ++time_pos;
+                    while (time_pos < value.size() && is_digit(value[time_pos])) ++time_pos;
+                }
+            }
+            // a. m. / p. m. / AM / PM (lo demás, p. ej. la zona horaria, se ignora)
+            while (time_pos < value.size() && value[time_pos] == ' ') ++time_pos;
+            if (time_pos < value.size()) {
+                const char meridiem = fold(value[time_pos]);
+                std::size_t m = time_pos + 1;
+                if (m < value.size() && value[m] == '.') ++m;
+                while (m < value.size() && value[m] == ' ') ++m;
+                if ((meridiem == 'a' || meridiem == 'p') && m < value.size() && fold(value[m]) == 'm') {
+                    if (hour < 1 || hour > 12) return false;
+                    if (meridiem == 'a' && hour == 12) hour = 0;
+                    if (meridiem == 'p' && hour != 12) hour += 12;
+                }
+            }
+            if (hour > 23 || minute > 59 || second > 60) return false;
+        }
+    }
+
+    seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+void set_bounds(Expr &expr, std::string_view low, std::string_view high) {
+    if (expr.type == Type::TEXT) {
+        expr.text.assign(low.data(), low.size());
+        expr.text_high.assign(high.data(), high.size());
+        return;
+    }
+    const bool range = expr.op == Op::BETWEEN;
+    for (int k = 0; k < (range ? 2 : 1); ++k) {
+        const std::string_view constant = k == 0 ? low : high;
+        double &out = k == 0 ? expr.low : expr.high;
+        if (!cell_value(expr, constant, out)) {
+            throw std::invalid_argument(
+                std::string(expr.type == Type::NUMBER ? "Número" : "Fecha") +
+                " inválido en el filtro de '" + expr.column + "': " + std::string(constant));
+        }
+    }
+}
+
+void set_values(Expr &expr, std::vector<std::string> values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    expr.values = std::move(values);
+}
+
+void bind(Expr &expr, const std::vector<std::string> &header) {
+    if (expr.op == Op::AND || expr.op == Op::OR || expr.op == Op::NOT) {
+        if (expr.op == Op::NOT && expr.children.size() != 1) {
+            throw std::invalid_argument("El filtro 'not' lleva exactamente una condición");
+        }
+        for (Expr &child : expr.children) bind(child, header);
+        return;
+    }
+    auto it = std::find(header.begin(), header.end(), expr.column);
+    if (it == header.end()) {
+        throw std::invalid_argument("Columna del filtro no encontrada en el CSV: " + expr.column);
+    }
+    expr.index = static_cast<std::size_t>(it - header.begin());
+}
+
+void require(const Expr &expr, std::vector<char> &keep) {
+    if (expr.op == Op::AND || expr.op == Op::OR || expr.op == Op::NOT) {
+        for (const Expr &child : expr.children) require(child, keep);
+        return;
+    }
+    if (expr.index >= keep.size()) keep.resize(expr.index + 1, 0);
+    keep[expr.index] = 1;
+}
+
+bool matches(const Expr &expr, const ChunkArena &arena, std::size_t row) {
+    switch (expr.op) {
+        case Op::AND:
+            for (const Expr &child : expr.children) {
+                if (!matches(child, arena, row)) return false;
+            }
+            return true;
+        case Op::OR:
+            for (const Expr &child : expr.children) {
+                if (matches(child, arena, row)) return true;
+            }
+            return false;
+        case Op::NOT:
+            return !matches(expr.children[0], arena, row);
+        default:
+            break;
+    }
+
+    // Columnas que faltan en la fila cuentan como celda vacía
+    const std::string_view cell = expr.index < arena.row_size(row)
+        ? trim(arena.cell(row, expr.index))
+        : std::string_view();
+
+    switch (expr.op) {
+        case Op::EMPTY: return cell.empty();
+        case Op::NOT_EMPTY: return !cell.empty();
+        case Op::IN: return std::binary_search(expr.values.begin(), expr.values.end(), cell);
+        default: break;
+    }
+
+    if (expr.type == Type::TEXT) {
+        if (expr.op == Op::BETWEEN) {
+            return cell.compare(expr.text) >= 0 && cell.compare(expr.text_high) <= 0;
+        }
+        return compare(expr.op, cell.compare(expr.text));
+    }
+
+    double value = 0.0;
+    if (!cell_value(expr, cell, value)) return false;
+    if (expr.op == Op::BETWEEN) return expr.low <= value && value <= expr.high;
+    return compare(expr.op, sign(value, expr.low));
+}
+
+}  // namespace predicate
+}  // namespace csvcore
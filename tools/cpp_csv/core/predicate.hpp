@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.hpp"
+
+namespace csvcore {
+
+// Filtros de filas (predicate pushdown): se evalúan sobre las celdas crudas
+// de cada registro, recién parseado y antes de cualquier conversión, así
+// que las filas descartadas no llegan al arena ni a Python.
+namespace predicate {
+
+enum class Op : std::uint8_t {
+    EQ, NE, LT, LE, GT, GE,  // celda comparada con una constante
+    BETWEEN,                 // low <= celda <= high
+    IN,                      // celda (recortada) en un conjunto de textos
+    EMPTY, NOT_EMPTY,        // celda vacía tras recortar espacios
+    AND, OR, NOT             // combinan `children`
+};
+
+// Cómo se interpreta la celda en las comparaciones. Una celda que no se
+// puede convertir (número o fecha inválidos, o vacía) no cumple ninguna
+// comparación, como NULL en SQL.
+enum class Type : std::uint8_t { TEXT, NUMBER, DATE };
+
+struct Expr {
+    Op op = Op::AND;
+    Type type = Type::TEXT;
+    std::string column;
+    std::size_t index = 0;  // posición en el header, resuelta por bind()
+    std::string text, text_high;            // TEXT
+    double low = 0.0, high = 0.0;           // NUMBER; DATE en segundos
+    std::vector<std::string> values;        // IN, ordenados (set_values)
+    std::vector<Expr> children;             // AND / OR / NOT
+};
+
+// "==", "!=", "<", "<=", ">", ">=", "between", "in", "empty", "not_empty",
+// "and", "or", "not". Lanza invalid_argument si no se reconoce.
+Op parse_op(std::string_view name);
+
+// "text", "number" o "date". Lanza invalid_argument si no se reconoce.
+Type parse_type(std::string_view name);
+
+// Fecha/hora a segundos (reloj de pared, la zona horaria se ignora):
+// YYYY-MM-DD o YYYY/MM/DD, o MM/DD/YYYY con DD/MM/YYYY si el primer número
+// pasa de 12 (como dateutil sin dayfirst); opcionalmente seguida de 'T' o
+// espacio y HH:MM[:SS[.fff]] con a. m./p. m. o AM/PM. false si no es fecha.
+bool parse_timestamp(std::string_view value, std::int64_t &seconds);
+
+// Asigna las constantes de la comparación según `type`; lanza
+// invalid_argument si `low` / `high` no son un número o fecha válidos.
+void set_bounds(Expr &expr, std::string_view low, std::string_view high = {});
+
+// Conjunto de textos para IN.
+void set_values(Expr &expr, std::vector<std::string> values);
+
+// Resuelve los nombres de columna contra el header (invalid_argument si
+// alguna no existe).
+void bind(Expr &expr, const std::vector<std::string> &header);
+
+// Marca en `keep` las columnas que lee el filtro (para que la proyección no
+// las descarte).
+void require(const Expr &expr, std::vector<char> &keep);
+
+bool matches(const Expr &expr, const ChunkArena &arena, std::size_t row);
+
+}  // namespace predicate
+
+}  // namespace csvcore
@@ -0,0 +1,98 @@
+#include "prefetch_reader.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "trace.hpp"
+
+namespace csvcore {
+
+PrefetchReader::PrefetchReader(const std::string &filename, char delimiter,
+                               std::size_t chunk_rows, std::size_t prefetch,
+                               const projection::Spec &columns,
+                               std::shared_ptr<predicate::Expr> filter,
+                               MemoryBudget *budget,
+                               metrics::CallStats *stats,
+                               progress::Tracker *progress)
+    : chunk_rows_(std::max<std::size_t>(chunk_rows, 1)),
+      budget_(budget),
+      ready_(std::max<std::size_t>(prefetch, 1) + 1),
+      free_(std::max<std::size_t>(prefetch, 1) + 1),
+      arenas_lease_(budget, "los arenas del lector") {
+    reader_ = std::make_unique<CsvChunkReader>(filename, delimiter);
+    reader_->set_stats(stats);
+    ChunkArena scratch;
+    header_ = read_header(*reader_, scratch);
+    selection_ = prepare_reader(*reader_, header_, columns, std::move(filter));
+    reader_->set_progress(progress);
+
+    for (std::size_t i = 0; i < std::max<std::size_t>(prefetch, 1) + 1; ++i) {
+        pool_.push_back(std::make_unique<ChunkArena>());
+        free_.try_push(pool_.back().get());
+    }
+    worker_ = std::thread(&PrefetchReader::produce, this);
+}
+
+PrefetchReader::~PrefetchReader() { stop(); }
+
+void PrefetchReader::stop() {
+    stopping_.store(true, std::memory_order_release);
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+ChunkArena *PrefetchReader::next() {
+    ChunkArena *arena = nullptr;
+    unsigned spins = 0;
+    while (!ready_.try_pop(arena)) {
+        if (done_.load(std::memory_order_acquire) || stopping_.load(std::memory_order_acquire)) {
+            // El productor publica antes de marcar done_: revisar una vez más
+            if (ready_.try_pop(arena)) {
+                return arena;
+            }
+            if (done_.load(std::memory_order_acquire) && error_) {
+                std::rethrow_exception(error_);
+            }
+            return nullptr;
+        }
+        backoff(spins);
+    }
+    return arena;
+}
+
+// Hilo productor: solo C++, nunca toca objetos de Python.
+void PrefetchReader::produce() {
+    // Solo con una sesión abierta: cada lector crea un hilo nuevo
+    if (trace::enabled()) trace::name_thread("cpp_csv-prefetch");
+    try {
+        while (!stopping_.load(std::memory_order_acquire)) {
+            ChunkArena *arena = nullptr;
+            unsigned spins = 0;
+            while (!free_.try_pop(arena)) {
+                if (stopping_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                backoff(spins);
+            }
+            const std::size_t max_bytes = budget_ ? budget_->chunk_bytes(pool_.size()) : kChunkMaxBytes;
+            if (!reader_->next_chunk(*arena, chunk_rows_, max_bytes)) {
+                break;
+            }
+            if (budget_) {
+                // Solo este hilo escribe en los arenas, así que su capacidad
+                // se puede leer aunque el consumidor tenga alguno
+                std::size_t footprint = 0;
+                for (const auto &pooled : pool_) footprint += pooled->footprint();
+                arenas_lease_.resize(footprint);
+            }
+            // Siempre hay lugar: ready_ tiene capacidad para todo el pool
+            ready_.try_push(arena);
+        }
+    } catch (...) {
+        error_ = std::current_exception();
+    }
+    done_.store(true, std::memory_order_release);
+}
+
+}  // namespace csvcore
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena.hpp"
+#include "memory_budget.hpp"
+#include "metrics.hpp"
+#include "predicate.hpp"
+#include "progress.hpp"
+#include "projection.hpp"
+#include "reader.hpp"
+#include "spsc_ring.hpp"
+
+namespace csvcore {
+
+// Lector en segundo plano: un hilo nativo parsea los chunks siguientes
+// mientras el consumidor procesa el anterior. Los arenas se reciclan entre
+// dos colas SPSC: `ready_` (hilo -> consumidor) y `free_` (consumidor ->
+// hilo), así que la memoria queda acotada a `prefetch + 1` chunks.
+// `columns` y `filter` se resuelven contra el header antes de arrancar el
+// hilo (ver prepare_reader). Con `budget` (que debe vivir más que el lector)
+// los arenas del pool se cargan a él y el tamaño de cada chunk se ajusta a
+// lo que queda: si aun así no alcanza, next() relanza BudgetExceeded. Con
+// `stats` el hilo registra sus fases (io, tokenize, filter) ahí. Con
+// `progress` el hilo suma su avance y, si se cancela, next() relanza
+// progress::Cancelled.
+class PrefetchReader {
+public:
+    PrefetchReader(const std::string &filename, char delimiter,
+                   std::size_t chunk_rows, std::size_t prefetch,
+                   const projection::Spec &columns = projection::Spec(),
+                   std::shared_ptr<predicate::Expr> filter = nullptr,
+                   MemoryBudget *budget = nullptr,
+                   metrics::CallStats *stats = nullptr,
+                   progress::Tracker *progress = nullptr);
+    ~PrefetchReader();
+
+    PrefetchReader(const PrefetchReader &) = delete;
+    PrefetchReader &operator=(const PrefetchReader &) = delete;
+
+    const std::vector<std::string> &header() const { return header_; }
+    const projection::Selection &selection() const { return selection_; }
+
+    // Pico de memoria de los arenas del pool cargado al presupuesto.
+    std::size_t arena_peak() const { return arenas_lease_.peak(); }
+
+    // Siguiente chunk listo, o nullptr al final (fin de archivo, error o
+    // stop()). Si hubo error en el hilo, se relanza aquí. Bloquea mientras
+    // el hilo parsea: llamar sin el GIL.
+    ChunkArena *next();
+
+    // Versión sin bloqueo: false si todavía no hay un chunk listo.
+    bool try_next(ChunkArena *&arena) { return ready_.try_pop(arena); }
+
+    // Devuelve al pool un arena ya consumido.
+    void release(ChunkArena *arena) { free_.try_push(arena); }
+
+    void stop();
+
+private:
+    void produce();
+
+    std::size_t chunk_rows_;
+    MemoryBudget *budget_;
+    std::unique_ptr<CsvChunkReader> reader_;
+    std::vector<std::string> header_;
+    projection::Selection selection_;
+
+    std::vector<std::unique_ptr<ChunkArena>> pool_;
+    SpscRing<ChunkArena*> ready_;
+    SpscRing<ChunkArena*> free_;
+    BudgetLease arenas_lease_;
+
+    std::thread worker_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> done_{false};
+    std::exception_ptr error_;
+};
+
+}  // namespace csvcore
@@ -0,0 +1,66 @@
+#include "progress.hpp"
+
+#include <limits>
+#include <utility>
+
+namespace csvcore {
+namespace progress {
+
+namespace {
+
+constexpr std::uint64_t kNever = std::numeric_limits<std::uint64_t>::max();
+
+std::uint64_t next_mark(std::uint64_t done, std::uint64_t every) {
+    return every == 0 ? kNever : done + every;
+}
+
+}  // namespace
+
+Tracker::Tracker(const CancelToken *cancel, Callback callback, std::uint64_t every_rows,
+                 std::uint64_t every_bytes)
+    : cancel_(cancel), callback_(std::move(callback)), every_rows_(every_rows), every_bytes_(every_bytes) {
+    next_rows_.store(next_mark(0, every_rows_), std::memory_order_relaxed);
+    next_bytes_.store(next_mark(0, every_bytes_), std::memory_order_relaxed);
+}
+
+bool Tracker::due(std::uint64_t rows, std::uint64_t bytes) const {
+    if (every_rows_ == 0 && every_bytes_ == 0) return rows != reported_rows_ || bytes != reported_bytes_;
+    return rows >= next_rows_.load(std::memory_order_relaxed) || bytes >= next_bytes_.load(std::memory_order_relaxed);
+}
+
+void Tracker::advance(std::uint64_t rows, std::uint64_t bytes) {
+    const std::uint64_t total_rows = rows_.fetch_add(rows, std::memory_order_relaxed) + rows;
+    const std::uint64_t total_bytes = bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    check();
+    if (!callback_) return;
+    if ((every_rows_ != 0 || every_bytes_ != 0) && !due(total_rows, total_bytes)) return;
+
+    // Si otro hilo ya está reportando, este punto de control se salta
+    std::unique_lock<std::mutex> lock(report_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    const std::uint64_t r = rows_.load(std::memory_order_relaxed);
+    const std::uint64_t b = bytes_.load(std::memory_order_relaxed);
+    if (!due(r, b)) return;
+    report(r, b);
+    check();
+}
+
+void Tracker::finish() {
+    if (!callback_) return;
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    const std::uint64_t r = rows_.load(std::memory_order_relaxed);
+    const std::uint64_t b = bytes_.load(std::memory_order_relaxed);
+    if (r != reported_rows_ || b != reported_bytes_) report(r, b);
+}
+
+// Con report_mutex_ tomado.
+void Tracker::report(std::uint64_t rows, std::uint64_t bytes) {
+    next_rows_.store(next_mark(rows, every_rows_), std::memory_order_relaxed);
+    next_bytes_.store(next_mark(bytes, every_bytes_), std::memory_order_relaxed);
+    reported_rows_ = rows;
+    reported_bytes_ = bytes;
+    callback_(rows, bytes);
+}
+
+}  // namespace progress
+}  // namespace csvcore
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+namespace csvcore {
+
+// Avance y cancelación cooperativa de las llamadas largas (lecturas y
+// discover): los lectores revisan el token antes de cada chunk y suman lo
+// leído al Tracker, que llama al callback solo en los puntos de control.
+namespace progress {
+
+constexpr std::uint64_t kDefaultEveryRows = 50000;
+constexpr std::uint64_t kDefaultEveryBytes = std::uint64_t(8) << 20;
+
+// Se canceló la llamada con su CancelToken. La capa de Python la traduce a
+// cpp_csv.OperationCancelled.
+class Cancelled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Bandera compartida entre quien cancela (cualquier hilo) y la llamada.
+class CancelToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_release); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+// Avance de una llamada. advance() se llama por chunk desde cualquier hilo
+// (el de prefetch, los rangos de discover); cada `every_rows` filas o
+// `every_bytes` bytes (0 = no cuenta; ambos 0 = cada chunk) un solo hilo a
+// la vez llama a `callback(filas, bytes)`. Las excepciones del callback se
+// propagan a quien llamó advance().
+class Tracker {
+public:
+    using Callback = std::function<void(std::uint64_t rows, std::uint64_t bytes)>;
+
+    explicit Tracker(const CancelToken *cancel, Callback callback = nullptr,
+                     std::uint64_t every_rows = kDefaultEveryRows,
+                     std::uint64_t every_bytes = kDefaultEveryBytes);
+
+    Tracker(const Tracker &) = delete;
+    Tracker &operator=(const Tracker &) = delete;
+
+    // Lanza Cancelled si el token se canceló.
+    void check() const {
+        if (cancel_ != nullptr && cancel_->cancelled()) throw Cancelled("cpp_csv: operación cancelada");
+    }
+
+    void advance(std::uint64_t rows, std::uint64_t bytes);
+
+    // Último reporte si hubo avance desde el anterior (al terminar la llamada).
+    void finish();
+
+    std::uint64_t rows() const { return rows_.load(std::memory_order_relaxed); }
+    std::uint64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+private:
+    bool due(std::uint64_t rows, std::uint64_t bytes) const;
+    void report(std::uint64_t rows, std::uint64_t bytes);
+
+    const CancelToken *cancel_;
+    Callback callback_;
+    std::uint64_t every_rows_;
+    std::uint64_t every_bytes_;
+    std::atomic<std::uint64_t> rows_{0};
+    std::atomic<std::uint64_t> bytes_{0};
+    // Siguiente punto de control; se leen sin lock y se mueven con report_mutex_
+    std::atomic<std::uint64_t> next_rows_{0};
+    std::atomic<std::uint64_t> next_bytes_{0};
+    std::mutex report_mutex_;
+    std::uint64_t reported_rows_ = 0;
+    std::uint64_t reported_bytes_ = 0;
+};
+
+}  // namespace progress
+
+}  // namespace csvcore
@@ -0,0 +1,102 @@
+#include "projection.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+
+namespace csvcore {
+namespace projection {
+
+namespace {
+
+inline char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && is_space(value.front())) value.remove_prefix(1);
+    while (!value.empty() && is_space(value.back())) value.remove_suffix(1);
+    return value;
+}
+
+}  // namespace
+
+bool matches(std::string_view pattern, std::string_view name) {
+    name = trim(name);
+    // Glob iterativo: al fallar se retrocede al último '*' y se le da un
+    // carácter más; lineal en la práctica, sin recursión
+    std::size_t p = 0, n = 0;
+    std::size_t star = std::string_view::npos, resume = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = n;
+        } else if (p < pattern.size() && (pattern[p] == '?' || fold(pattern[p]) == fold(name[n]))) {
+            ++p;
+            ++n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+Selection resolve(const std::vector<std::string> &header, const Spec &spec) {
+    Selection selection;
+    if (header.empty()) {
+        // Archivo vacío: no hay columnas contra las que validar
+        selection.all = !spec.active();
+        return selection;
+    }
+    if (!spec.active()) {
+        selection.columns.reserve(header.size());
+        for (std::size_t j = 0; j < header.size(); ++j) selection.columns.push_back(j);
+        selection.keep.assign(header.size(), 1);
+        return selection;
+    }
+
+    selection.all = false;
+    selection.keep.assign(header.size(), spec.select ? 0 : 1);
+    if (spec.select) {
+        std::unordered_multimap<std::string_view, std::size_t> positions;
+        positions.reserve(header.size());
+        for (std::size_t j = 0; j < header.size(); ++j) positions.emplace(header[j], j);
+
+        for (const std::string &name : spec.names) {
+            auto range = positions.equal_range(name);
+            if (range.first == range.second) {
+                throw std::invalid_argument("Columna no encontrada en el CSV: " + name);
+            }
+            for (auto it = range.first; it != range.second; ++it) selection.keep[it->second] = 1;
+        }
+        for (std::size_t index : spec.indices) {
+            if (index >= header.size()) {
+                throw std::out_of_range("Índice de columna fuera de rango: " + std::to_string(index) +
+                                        " (el CSV tiene " + std::to_string(header.size()) + " columnas)");
+            }
+            selection.keep[index] = 1;
+        }
+    }
+
+    for (std::size_t j = 0; j < header.size(); ++j) {
+        if (!selection.keep[j]) continue;
+        for (const std::string &pattern : spec.drop_patterns) {
+            if (matches(pattern, header[j])) {
+                selection.keep[j] = 0;
+                break;
+            }
+        }
+        if (selection.keep[j]) selection.columns.push_back(j);
+    }
+    return selection;
+}
+
+}  // namespace projection
+}  // namespace csvcore
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace csvcore {
+
+// Proyección de columnas (usecols): qué columnas del header se construyen.
+// El parser sigue recorriendo las celdas descartadas para encontrar los
+// delimitadores, pero no copia sus bytes al arena y la capa de Python no
+// crea objetos para ellas.
+namespace projection {
+
+struct Spec {
+    // Si es false se parte de todas las columnas; si es true, solo de las
+    // listadas en `names` / `indices` (una lista vacía no selecciona nada).
+    bool select = false;
+    std::vector<std::string> names;
+    std::vector<std::size_t> indices;
+    // Patrones estilo glob ('*' y '?') que descartan columnas por nombre,
+    // sin distinguir mayúsculas ASCII y con el nombre recortado de espacios.
+    std::vector<std::string> drop_patterns;
+
+    bool active() const { return select || !drop_patterns.empty(); }
+};
+
+struct Selection {
+    bool all = true;                   // sin proyección: todas las columnas
+    std::vector<std::size_t> columns;  // columnas elegidas, en orden del header
+    std::vector<char> keep;            // keep[j] != 0 si la columna j se construye
+};
+
+// true si `name` coincide con el patrón glob (ver Spec::drop_patterns).
+bool matches(std::string_view pattern, std::string_view name);
+
+// Resuelve la especificación contra el header. Lanza invalid_argument si un
+// nombre no existe y out_of_range si un índice no está en el header; un
+// nombre repetido en el header selecciona todas sus apariciones.
+Selection resolve(const std::vector<std::string> &header, const Spec &spec);
+
+}  // namespace projection
+
+}  // namespace csvcore
@@ -0,0 +1,248 @@
+#include "reader.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "trace.hpp"
+
+namespace csvcore {
+
+namespace {
+
+enum class FieldState {
+    START,           // inicio de campo
+    UNQUOTED,        // campo sin comillas
+    QUOTED,          // dentro de comillas
+    QUOTE_IN_QUOTED  // vimos una comilla dentro de comillas: cierre o ""
+};
+
+inline bool keep_column(const std::vector<char> *keep, std::size_t col) {
+    return keep == nullptr || (col < keep->size() && (*keep)[col] != 0);
+}
+
+}  // namespace
+
+void parse_csv_line(std::string_view line, char delimiter, ChunkArena &arena,
+                    const std::vector<char> *keep) {
+    FieldState state = FieldState::START;
+    std::size_t run_start = 0;  // inicio del tramo de bytes literales pendiente
+    std::size_t col = 0;
+    bool keeping = keep_column(keep, col);
+
+    arena.begin_cell();
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+
+        switch (state) {
+            case FieldState::START:
+                if (c == '"') {
+                    state = FieldState::QUOTED;
+                    run_start = i + 1;
+                } else if (c == delimiter) {
+                    // Celda vacía
+                    arena.end_cell();
+                    keeping = keep_column(keep, ++col);
+                    arena.begin_cell();
+                    run_start = i + 1;
+                } else {
+                    state = FieldState::UNQUOTED;
+                }
+                break;
+
+            case FieldState::UNQUOTED:
+                if (c == delimiter) {
+                    // Fin de celda
+                    if (keeping) arena.append(line.data() + run_start, i - run_start);
+                    arena.end_cell();
+                    keeping = keep_column(keep, ++col);
+                    arena.begin_cell();
+                    run_start = i + 1;
+                    state = FieldState::START;
+                }
+                break;
+
+            case FieldState::QUOTED:
+                if (c == '"') {
+                    if (keeping) arena.append(line.data() + run_start, i - run_start);
+                    state = FieldState::QUOTE_IN_QUOTED;
+                }
+                break;
+
+            case FieldState::QUOTE_IN_QUOTED:
+                if (c == '"') {
+                    // Comilla escapada dentro de un campo: ""
+                    if (keeping) arena.push('"');
+                    run_start = i + 1;
+                    state = FieldState::QUOTED;
+                } else if (c == delimiter) {
+                    arena.end_cell();
+                    keeping = keep_column(keep, ++col);
+                    arena.begin_cell();
+                    run_start = i + 1;
+                    state = FieldState::START;
+                } else {
+                    // Texto después de la comilla de cierre: se agrega tal cual
+                    run_start = i;
+                    state = FieldState::UNQUOTED;
+                }
+                break;
+        }
+    }
+
+    // Última celda de la fila
+    if (keeping && (state == FieldState::UNQUOTED || state == FieldState::QUOTED)) {
+        arena.append(line.data() + run_start, line.size() - run_start);
+    }
+    arena.end_cell();
+    arena.end_row();
+}
+
+bool record_is_open(std::string_view line, char delimiter) {
+    // Camino rápido: sin comillas no puede haber campo abierto
+    if (line.find('"') == std::string_view::npos) {
+        return false;
+    }
+
+    FieldState state = FieldState::START;
+    for (char c : line) {
+        switch (state) {
+            case FieldState::START:
+                state = c == '"' ? FieldState::QUOTED
+                      : c == delimiter ? FieldState::START
+                      : FieldState::UNQUOTED;
+                break;
+            case FieldState::UNQUOTED:
+                if (c == delimiter) state = FieldState::START;
+                break;
+            case FieldState::QUOTED:
+                if (c == '"') state = FieldState::QUOTE_IN_QUOTED;
+                break;
+            case FieldState::QUOTE_IN_QUOTED:
+                state = c == '"' ? FieldState::QUOTED
+                      : c == delimiter ? FieldState::START
+                      : FieldState::UNQUOTED;
+                break;
+        }
+    }
+    return state == FieldState::QUOTED;
+}
+
+CsvChunkReader::CsvChunkReader(const std::string &filename, char delimiter)
+    : file_(filename, std::ios::binary), delimiter_(delimiter) {
+    if (!file_.is_open()) {
+        throw std::runtime_error("No se pudo abrir el archivo CSV: " + filename);
+    }
+}
+
+CsvChunkReader::CsvChunkReader(const std::string &filename, char delimiter,
+                               std::uint64_t begin, std::uint64_t end, bool at_record)
+    : CsvChunkReader(filename, delimiter) {
+    end_ = end;
+    if (at_record) {
+        file_.seekg(static_cast<std::streamoff>(begin));
+        pos_ = begin;
+    } else if (begin > 0) {
+        // Descartar la línea que empezó antes del rango
+        file_.seekg(static_cast<std::streamoff>(begin - 1));
+        std::getline(file_, line_);
+        pos_ = begin + line_.size();
+    }
+    start_ = pos_;
+}
+
+bool CsvChunkReader::next_chunk(ChunkArena &arena, std::size_t max_rows, std::size_t max_bytes) {
+    max_bytes = std::min(max_bytes, kChunkMaxBytes);
+    if (progress_) progress_->check();
+    trace::Span span("read_chunk");
+    metrics::PhaseClock clock(stats_);
+    const std::uint64_t start = pos_;
+    const std::uint64_t filtered_before = filtered_;
+    const std::size_t footprint = stats_ ? arena.footprint() : 0;
+    arena.reset();
+    while (arena.rows() < max_rows && arena.byte_size() < max_bytes &&
+           pos_ < end_ && std::getline(file_, line_)) {
+        pos_ += line_.size() + 1;
+
+        // Registro con saltos de línea entre comillas: unir las líneas
+        // físicas (el registro pertenece a quien lo empezó, aunque siga
+        // después de `end_`)
+        while (record_is_open(line_, delimiter_) && std::getline(file_, continuation_)) {
+            pos_ += continuation_.size() + 1;
+            line_.push_back('\n');
+            line_ += continuation_;
+        }
+
+        // Manejo de \r\n (Windows): quitar \r del final si existe.
+        if (!line_.empty() && line_.back() == '\r') {
+            line_.pop_back();
+        }
+
+        // Si quieres saltar filas totalmente vacías
+        if (line_.empty()) {
+            continue;
+        }
+        clock.mark(metrics::IO);
+
+        parse_csv_line(line_, delimiter_, arena, keep_.empty() ? nullptr : &keep_);
+        clock.mark(metrics::TOKENIZE);
+        if (filter_) {
+            if (!predicate::matches(*filter_, arena, arena.rows() - 1)) {
+                arena.pop_row();
+                ++filtered_;
+            }
+            clock.mark(metrics::FILTER);
+        }
+    }
+    clock.mark(metrics::IO);
+    span.arg("rows", static_cast<std::int64_t>(arena.rows()));
+    span.arg("bytes", static_cast<std::int64_t>(pos_ - start));
+
+    if (stats_) {
+        metrics::bump(stats_->bytes_read, pos_ - start);
+        metrics::bump(stats_->rows, arena.rows());
+        metrics::bump(stats_->cells, arena.cell_count());
+        metrics::bump(stats_->filtered_rows, filtered_ - filtered_before);
+        metrics::bump(stats_->allocations, arena.footprint() > footprint ? 1 : 0);
+    }
+    if (progress_) progress_->advance(arena.rows() + (filtered_ - filtered_before), pos_ - start);
+    return arena.rows() > 0;
+}
+
+std::uint64_t file_size(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("No se pudo abrir el archivo CSV: " + filename);
+    }
+    return static_cast<std::uint64_t>(file.tellg());
+}
+
+std::vector<std::string> read_header(CsvChunkReader &reader, ChunkArena &arena) {
+    std::vector<std::string> header;
+    if (reader.next_chunk(arena, 1)) {
+        for (std::size_t j = 0; j < arena.row_size(0); ++j) {
+            header.emplace_back(arena.cell(0, j));
+        }
+    }
+    return header;
+}
+
+projection::Selection prepare_reader(CsvChunkReader &reader, const std::vector<std::string> &header,
+                                     const projection::Spec &columns,
+                                     std::shared_ptr<predicate::Expr> filter) {
+    projection::Selection selection = projection::resolve(header, columns);
+    if (filter && !header.empty()) {
+        predicate::bind(*filter, header);
+        if (!selection.all) {
+            std::vector<char> keep = selection.keep;
+            predicate::require(*filter, keep);
+            reader.set_projection(std::move(keep));
+        }
+        reader.set_filter(std::move(filter));
+    } else if (!selection.all) {
+        reader.set_projection(selection.keep);
+    }
+    return selection;
+}
+
+}  // namespace csvcore
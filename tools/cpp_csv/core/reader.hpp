@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"
+#include "metrics.hpp"
+#include "predicate.hpp"
+#include "progress.hpp"
+#include "projection.hpp"
+
+namespace csvcore {
+
+// Parsea un registro CSV (RFC 4180, como el módulo csv de Python) en el arena:
+// - delimitador configurable
+// - comillas dobles al inicio de un campo; "" es una comilla literal
+// - una comilla en medio de un campo sin comillas es literal
+// - saltos de línea dentro de comillas se conservan
+// Con `keep` (máscara por columna, ver projection.hpp) las celdas descartadas
+// y las que pasan del largo de la máscara quedan vacías en el arena: se
+// conserva la posición de cada columna pero no se copian sus bytes.
+void parse_csv_line(std::string_view line, char delimiter, ChunkArena &arena,
+                    const std::vector<char> *keep = nullptr);
+
+// true si la línea termina dentro de un campo entre comillas, es decir, el
+// registro continúa en la siguiente línea física.
+bool record_is_open(std::string_view line, char delimiter);
+
+// Lector por chunks: llena un ChunkArena con hasta `max_rows` filas.
+// Solo C++, sin tipos de pybind11, así que puede correr sin el GIL.
+// El archivo se abre en binario para que las posiciones sean offsets de
+// bytes reales; el \r de \r\n se quita a mano.
+class CsvChunkReader {
+public:
+    CsvChunkReader(const std::string &filename, char delimiter);
+
+    // Lector de un rango de bytes [begin, end): procesa los registros que
+    // empiezan dentro del rango; el último puede terminar después de `end`.
+    // `begin` se alinea a la siguiente línea física, así que si un campo
+    // multilínea cruza `begin` el lector empieza a media celda: quien
+    // reparte rangos lo detecta porque position() al terminar el rango
+    // anterior no coincide con start() de este (ver discovery::discover).
+    // Con `at_record` `begin` ya es el inicio de un registro y se usa tal cual.
+    CsvChunkReader(const std::string &filename, char delimiter,
+                   std::uint64_t begin, std::uint64_t end, bool at_record = false);
+
+    // Resetea el arena y lo llena con el siguiente chunk (hasta `max_rows`
+    // filas o `max_bytes` bytes de celdas). Devuelve false si ya no quedan
+    // filas.
+    bool next_chunk(ChunkArena &arena, std::size_t max_rows = kChunkRows,
+                    std::size_t max_bytes = kChunkMaxBytes);
+
+    // Máscara de columnas para los chunks siguientes (vacía = todas).
+    void set_projection(std::vector<char> keep) { keep_ = std::move(keep); }
+
+    // Filtro de filas ya resuelto contra el header (nullptr = todas): las
+    // filas que no lo cumplen se descartan del arena al parsearlas.
+    void set_filter(std::shared_ptr<const predicate::Expr> filter) { filter_ = std::move(filter); }
+
+    // Contadores por fase para los chunks siguientes (nullptr = no medir);
+    // `stats` debe vivir más que el lector.
+    void set_stats(metrics::CallStats *stats) { stats_ = stats; }
+
+    // Avance y cancelación para los chunks siguientes (nullptr = sin
+    // reportar): next_chunk lanza progress::Cancelled si se canceló y suma
+    // las filas leídas (incluidas las filtradas) y los bytes al `progress`.
+    void set_progress(progress::Tracker *progress) { progress_ = progress; }
+
+    // Filas descartadas por el filtro hasta ahora.
+    std::uint64_t filtered_rows() const { return filtered_; }
+
+    // Offset en bytes del inicio del siguiente registro por leer.
+    std::uint64_t position() const { return pos_; }
+
+    // Offset donde empezó a leer (el inicio del rango ya alineado).
+    std::uint64_t start() const { return start_; }
+
+private:
+    std::ifstream file_;
+    char delimiter_;
+    std::string line_;
+    std::string continuation_;
+    std::vector<char> keep_;
+    std::shared_ptr<const predicate::Expr> filter_;
+    metrics::CallStats *stats_ = nullptr;
+    progress::Tracker *progress_ = nullptr;
+    std::uint64_t filtered_ = 0;
+    std::uint64_t pos_ = 0;
+    std::uint64_t start_ = 0;
+    std::uint64_t end_ = std::numeric_limits<std::uint64_t>::max();
+};
+
+// Tamaño del archivo en bytes.
+std::uint64_t file_size(const std::string &filename);
+
+// Lee la primera fila no vacía del archivo como encabezado.
+std::vector<std::string> read_header(CsvChunkReader &reader, ChunkArena &arena);
+
+// Configura un lector que ya leyó el header: resuelve el filtro contra el
+// header, proyecta las columnas elegidas más las que lee el filtro y
+// devuelve la selección resuelta.
+projection::Selection prepare_reader(CsvChunkReader &reader, const std::vector<std::string> &header,
+                                     const projection::Spec &columns,
+                                     std::shared_ptr<predicate::Expr> filter);
+
+}  // namespace csvcore
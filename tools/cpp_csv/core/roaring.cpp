@@ -0,0 +1,323 @@
+#include "roaring.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace csvcore {
+namespace roaring {
+
+namespace {
+
+constexpr std::uint32_t kBlockSize = 1u << 16;
+
+unsigned highest_bit(std::uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(word));
+#endif
+}
+
+void set_bits(const Container &c, std::uint64_t *words) {
+    if (c.is_bitset()) {
+        for (std::size_t w = 0; w < kBlockWords; ++w) words[w] |= c.words[w];
+        return;
+    }
+    for (std::uint16_t low : c.array) words[low >> 6] |= std::uint64_t{1} << (low & 63);
+}
+
+// Enciende los bits [first, last) de un bloque.
+void set_range(std::uint64_t *words, std::uint32_t first, std::uint32_t last) {
+    for (std::uint32_t bit = first; bit < last;) {
+        const std::uint32_t w = bit >> 6;
+        const std::uint32_t from = bit & 63;
+        const std::uint32_t to = std::min<std::uint32_t>(64, from + (last - bit));
+        const std::uint64_t mask = to - from == 64 ? ~std::uint64_t{0}
+                                                    : ((std::uint64_t{1} << (to - from)) - 1) << from;
+        words[w] |= mask;
+        bit += to - from;
+    }
+}
+
+// Contenedor canónico: arreglo si cabe en kArrayMax, bitset si no.
+Container from_words(std::uint16_t key, std::vector<std::uint64_t> words) {
+    Container c;
+    c.key = key;
+    for (std::uint64_t w : words) c.cardinality += popcount64(w);
+    if (c.cardinality > kArrayMax) {
+        c.words = std::move(words);
+        return c;
+    }
+    c.array.reserve(c.cardinality);
+    for (std::size_t w = 0; w < kBlockWords; ++w) {
+        for (std::uint64_t word = words[w]; word; word &= word - 1) {
+            c.array.push_back(static_cast<std::uint16_t>(w * 64 + lowest_bit(word)));
+        }
+    }
+    return c;
+}
+
+Container from_array(std::uint16_t key, std::vector<std::uint16_t> array) {
+    if (array.size() > kArrayMax) {
+        std::vector<std::uint64_t> words(kBlockWords, 0);
+        for (std::uint16_t low : array) words[low >> 6] |= std::uint64_t{1} << (low & 63);
+        return from_words(key, std::move(words));
+    }
+    Container c;
+    c.key = key;
+    c.cardinality = static_cast<std::uint32_t>(array.size());
+    c.array = std::move(array);
+    return c;
+}
+
+Container intersect(const Container &a, const Container &b) {
+    if (a.is_bitset() && b.is_bitset()) {
+        std::vector<std::uint64_t> words(kBlockWords);
+        for (std::size_t w = 0; w < kBlockWords; ++w) words[w] = a.words[w] & b.words[w];
+        return from_words(a.key, std::move(words));
+    }
+    std::vector<std::uint16_t> out;
+    if (!a.is_bitset() && !b.is_bitset()) {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(out));
+    } else {
+        const Container &array = a.is_bitset() ? b : a;
+        const Container &bits = a.is_bitset() ? a : b;
+        for (std::uint16_t low : array.array) {
+            if (bits.contains(low)) out.push_back(low);
+        }
+    }
+    return from_array(a.key, std::move(out));
+}
+
+Container unite(const Container &a, const Container &b) {
+    if (!a.is_bitset() && !b.is_bitset() && a.array.size() + b.array.size() <= kArrayMax) {
+        std::vector<std::uint16_t> out;
+        out.reserve(a.array.size() + b.array.size());
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out));
+        return from_array(a.key, std::move(out));
+    }
+    std::vector<std::uint64_t> words(kBlockWords, 0);
+    set_bits(a, words.data());
+    set_bits(b, words.data());
+    return from_words(a.key, std::move(words));
+}
+
+Container subtract(const Container &a, const Container &b) {
+    if (!a.is_bitset()) {
+        std::vector<std::uint16_t> out;
+        if (!b.is_bitset()) {
+            std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                std::back_inserter(out));
+        } else {
+            for (std::uint16_t low : a.array) {
+                if (!b.contains(low)) out.push_back(low);
+            }
+        }
+        return from_array(a.key, std::move(out));
+    }
+    std::vector<std::uint64_t> words(a.words);
+    if (b.is_bitset()) {
+        for (std::size_t w = 0; w < kBlockWords; ++w) words[w] &= ~b.words[w];
+    } else {
+        for (std::uint16_t low : b.array) words[low >> 6] &= ~(std::uint64_t{1} << (low & 63));
+    }
+    return from_words(a.key, std::move(words));
+}
+
+}  // namespace
+
+bool Container::contains(std::uint16_t low) const {
+    if (is_bitset()) return (words[low >> 6] >> (low & 63)) & 1u;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+Bitmap Bitmap::from_sorted(const std::uint32_t *values, std::size_t n) {
+    Bitmap out;
+    std::size_t i = 0;
+    while (i < n) {
+        const std::uint16_t key = static_cast<std::uint16_t>(values[i] >> 16);
+        std::vector<std::uint16_t> array;
+        for (; i < n && (values[i] >> 16) == key; ++i) {
+            const std::uint16_t low = static_cast<std::uint16_t>(values[i] & 0xFFFF);
+            if (array.empty() || array.back() != low) array.push_back(low);
+        }
+        out.containers_.push_back(from_array(key, std::move(array)));
+    }
+    return out;
+}
+
+Bitmap Bitmap::range(std::uint32_t first, std::uint32_t last) {
+    Bitmap out;
+    if (first >= last) return out;
+    for (std::uint32_t key = first >> 16; key <= (last - 1) >> 16; ++key) {
+        const std::uint32_t base = key << 16;
+        const std::uint32_t from = std::max(first, base) - base;
+        const std::uint32_t to = std::min<std::uint64_t>(last, std::uint64_t{base} + kBlockSize) - base;
+        std::vector<std::uint64_t> words(kBlockWords, 0);
+        set_range(words.data(), from, to);
+        out.containers_.push_back(from_words(static_cast<std::uint16_t>(key), std::move(words)));
+    }
+    return out;
+}
+
+Bitmap Bitmap::union_of(const std::vector<const Bitmap *> &bitmaps) {
+    std::vector<const Container *> all;
+    for (const Bitmap *b : bitmaps) {
+        if (!b) continue;
+        for (const Container &c : b->containers_) all.push_back(&c);
+    }
+    std::stable_sort(all.begin(), all.end(), [](const Container *a, const Container *b) { return a->key < b->key; });
+
+    Bitmap out;
+    std::vector<std::uint64_t> words;
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t j = i + 1;
+        while (j < all.size() && all[j]->key == all[i]->key) ++j;
+        if (j - i == 1) {
+            out.containers_.push_back(*all[i]);
+        } else {
+            // Un solo bitset por bloque, sin uniones intermedias
+            words.assign(kBlockWords, 0);
+            for (std::size_t k = i; k < j; ++k) set_bits(*all[k], words.data());
+            out.containers_.push_back(from_words(all[i]->key, words));
+        }
+        i = j;
+    }
+    return out;
+}
+
+std::uint64_t Bitmap::cardinality() const {
+    std::uint64_t n = 0;
+    for (const Container &c : containers_) n += c.cardinality;
+    return n;
+}
+
+bool Bitmap::contains(std::uint32_t value) const {
+    const std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container &c, std::uint16_t k) { return c.key < k; });
+    return it != containers_.end() && it->key == key && it->contains(static_cast<std::uint16_t>(value & 0xFFFF));
+}
+
+std::int64_t Bitmap::maximum() const {
+    if (containers_.empty()) return -1;
+    const Container &c = containers_.back();
+    const std::int64_t high = std::int64_t{c.key} << 16;
+    if (!c.is_bitset()) return high | c.array.back();
+    for (std::size_t w = kBlockWords; w-- > 0;) {
+        if (c.words[w]) return high | static_cast<std::int64_t>(w * 64 + highest_bit(c.words[w]));
+    }
+    return -1;
+}
+
+std::size_t Bitmap::bytes() const {
+    std::size_t n = containers_.size() * sizeof(Container);
+    for (const Container &c : containers_) {
+        n += c.array.size() * sizeof(std::uint16_t) + c.words.size() * sizeof(std::uint64_t);
+    }
+    return n;
+}
+
+Bitmap &Bitmap::operator&=(const Bitmap &other) {
+    std::vector<Container> out;
+    std::size_t i = 0, j = 0;
+    while (i < containers_.size() && j < other.containers_.size()) {
+        const Container &a = containers_[i];
+        const Container &b = other.containers_[j];
+        if (a.key < b.key) {
+            ++i;
+        } else if (b.key < a.key) {
+            ++j;
+        } else {
+            Container c = intersect(a, b);
+            if (c.cardinality) out.push_back(std::move(c));
+            ++i;
+            ++j;
+        }
+    }
+    containers_ = std::move(out);
+    return *this;
+}
+
+Bitmap &Bitmap::operator|=(const Bitmap &other) {
+    std::vector<Container> out;
+    out.reserve(containers_.size() + other.containers_.size());
+    std::size_t i = 0, j = 0;
+    while (i < containers_.size() || j < other.containers_.size()) {
+        if (j == other.containers_.size() || (i < containers_.size() && containers_[i].key < other.containers_[j].key)) {
+            out.push_back(std::move(containers_[i++]));
+        } else if (i == containers_.size() || other.containers_[j].key < containers_[i].key) {
+            out.push_back(other.containers_[j++]);
+        } else {
+            out.push_back(unite(containers_[i++], other.containers_[j++]));
+        }
+    }
+    containers_ = std::move(out);
+    return *this;
+}
+
+Bitmap &Bitmap::operator-=(const Bitmap &other) {
+    std::vector<Container> out;
+    std::size_t j = 0;
+    for (Container &a : containers_) {
+        while (j < other.containers_.size() && other.containers_[j].key < a.key) ++j;
+        if (j == other.containers_.size() || other.containers_[j].key != a.key) {
+            out.push_back(std::move(a));
+            continue;
+        }
+        Container c = subtract(a, other.containers_[j]);
+        if (c.cardinality) out.push_back(std::move(c));
+    }
+    containers_ = std::move(out);
+    return *this;
+}
+
+Bitmap Bitmap::flip(std::uint32_t size) const {
+    Bitmap out;
+    if (size == 0) return out;
+    std::size_t i = 0;
+    for (std::uint32_t key = 0; key <= (size - 1) >> 16; ++key) {
+        const std::uint32_t base = key << 16;
+        std::vector<std::uint64_t> words(kBlockWords, 0);
+        set_range(words.data(), 0, std::min<std::uint64_t>(kBlockSize, std::uint64_t{size} - base));
+        while (i < containers_.size() && containers_[i].key < key) ++i;
+        if (i < containers_.size() && containers_[i].key == key) {
+            const Container &c = containers_[i];
+            if (c.is_bitset()) {
+                for (std::size_t w = 0; w < kBlockWords; ++w) words[w] &= ~c.words[w];
+            } else {
+                for (std::uint16_t low : c.array) words[low >> 6] &= ~(std::uint64_t{1} << (low & 63));
+            }
+        }
+        Container c = from_words(static_cast<std::uint16_t>(key), std::move(words));
+        if (c.cardinality) out.containers_.push_back(std::move(c));
+    }
+    return out;
+}
+
+bool Bitmap::operator==(const Bitmap &other) const {
+    if (containers_.size() != other.containers_.size()) return false;
+    for (std::size_t i = 0; i < containers_.size(); ++i) {
+        const Container &a = containers_[i];
+        const Container &b = other.containers_[i];
+        // Los contenedores son canónicos: misma cardinalidad implica mismo tipo
+        if (a.key != b.key || a.cardinality != b.cardinality || a.array != b.array || a.words != b.words) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::uint32_t> Bitmap::to_vector() const {
+    std::vector<std::uint32_t> out;
+    out.reserve(static_cast<std::size_t>(cardinality()));
+    for_each([&](std::uint32_t v) { out.push_back(v); });
+    return out;
+}
+
+}  // namespace roaring
+}  // namespace csvcore
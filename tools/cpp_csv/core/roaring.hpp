@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace csvcore {
+
+// Conjuntos de enteros de 32 bits comprimidos al estilo Roaring: el universo
+// se parte en bloques de 2^16 valores y cada bloque no vacío se guarda como
+// arreglo ordenado de uint16 (hasta kArrayMax elementos) o como bitset de
+// 1024 palabras. Las operaciones trabajan bloque a bloque, así que un
+// segmento chico cuesta lo que mide y no lo que mide la encuesta.
+namespace roaring {
+
+constexpr std::size_t kArrayMax = 4096;
+constexpr std::size_t kBlockWords = 1024;  // 65536 bits
+
+inline unsigned popcount64(std::uint64_t word) {
+#ifdef _MSC_VER
+    return static_cast<unsigned>(__popcnt64(word));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#endif
+}
+
+// Índice del bit encendido más bajo (word != 0).
+inline unsigned lowest_bit(std::uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+struct Container {
+    std::uint16_t key = 0;  // 16 bits altos de los valores del bloque
+    std::uint32_t cardinality = 0;
+    std::vector<std::uint16_t> array;  // contenedor de arreglo (ordenado)
+    std::vector<std::uint64_t> words;  // contenedor bitset (kBlockWords palabras)
+
+    bool is_bitset() const { return !words.empty(); }
+    bool contains(std::uint16_t low) const;
+};
+
+class Bitmap {
+public:
+    Bitmap() = default;
+
+    // Valores ordenados de forma no decreciente (se ignoran los repetidos).
+    static Bitmap from_sorted(const std::uint32_t *values, std::size_t n);
+    // Todos los valores en [first, last).
+    static Bitmap range(std::uint32_t first, std::uint32_t last);
+    // Unión de varios conjuntos en una sola pasada por bloque.
+    static Bitmap union_of(const std::vector<const Bitmap *> &bitmaps);
+
+    bool empty() const { return containers_.empty(); }
+    std::uint64_t cardinality() const;
+    bool contains(std::uint32_t value) const;
+    // Mayor valor del conjunto (-1 si está vacío).
+    std::int64_t maximum() const;
+    // Memoria que ocupan los contenedores.
+    std::size_t bytes() const;
+
+    Bitmap &operator&=(const Bitmap &other);
+    Bitmap &operator|=(const Bitmap &other);
+    Bitmap &operator-=(const Bitmap &other);  // diferencia (AND NOT)
+    // Complemento dentro de [0, size).
+    Bitmap flip(std::uint32_t size) const;
+
+    bool operator==(const Bitmap &other) const;
+    bool operator!=(const Bitmap &other) const { return !(*this == other); }
+
+    const std::vector<Container> &containers() const { return containers_; }
+    std::vector<std::uint32_t> to_vector() const;
+
+    // Llama f(valor) en orden creciente.
+    template <typename F>
+    void for_each(F &&f) const {
+        for (const Container &c : containers_) {
+            const std::uint32_t high = std::uint32_t{c.key} << 16;
+            if (!c.is_bitset()) {
+                for (std::uint16_t low : c.array) f(high | low);
+                continue;
+            }
+            for (std::size_t w = 0; w < kBlockWords; ++w) {
+                for (std::uint64_t word = c.words[w]; word; word &= word - 1) {
+                    f(high | static_cast<std::uint32_t>(w * 64 + lowest_bit(word)));
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<Container> containers_;  // ordenados por key, sin vacíos
+};
+
+}  // namespace roaring
+
+}  // namespace csvcore
@@ -0,0 +1,322 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "trace.hpp"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace csvcore {
+
+namespace {
+
+constexpr std::size_t kMaxThreads = 256;
+
+// Hilo del pool que ejecuta (para encolar en su propio deque).
+thread_local Scheduler *tls_scheduler = nullptr;
+thread_local std::size_t tls_index = 0;
+
+// Instancia del proceso; el mutex también se toma alrededor de fork().
+std::mutex g_instance_mutex;
+Scheduler *g_instance = nullptr;
+std::size_t g_threads = 0;
+std::size_t g_per_call = 0;
+#ifndef _WIN32
+pid_t g_instance_pid = 0;
+bool g_atfork_registered = false;
+
+void before_fork() { g_instance_mutex.lock(); }
+void after_fork() { g_instance_mutex.unlock(); }
+#endif
+
+std::size_t env_size(const char *name) {
+    const char *value = std::getenv(name);
+    if (value == nullptr || *value == '\0') return 0;
+    char *end = nullptr;
+    const long n = std::strtol(value, &end, 10);
+    return (end != value && *end == '\0' && n > 0) ? static_cast<std::size_t>(n) : 0;
+}
+
+}  // namespace
+
+Scheduler::Scheduler(std::size_t threads, std::size_t per_call_limit) {
+    threads = std::min(std::max<std::size_t>(threads, 1), kMaxThreads);
+    per_call_limit_ = per_call_limit == 0 ? threads : std::min(per_call_limit, threads);
+    workers_.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t) workers_.push_back(std::make_unique<Worker>());
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers_[t]->thread = std::thread([this, t] { run(t); });
+    }
+}
+
+Scheduler::~Scheduler() { shutdown(); }
+
+Scheduler &Scheduler::instance() {
+    std::lock_guard<std::mutex> lock(g_instance_mutex);
+#ifndef _WIN32
+    if (!g_atfork_registered) {
+        pthread_atfork(before_fork, after_fork, after_fork);
+        g_atfork_registered = true;
+    }
+    if (g_instance != nullptr && g_instance_pid != getpid()) {
+        // Hijo de un fork: los hilos del padre no existen aquí y sus mutex
+        // pueden haber quedado tomados. Se abandona (no se destruye).
+        g_instance = nullptr;
+    }
+#endif
+    if (g_instance == nullptr) {
+        std::size_t threads = g_threads ? g_threads : env_size("CPP_CSV_THREADS");
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t per_call = g_per_call ? g_per_call : env_size("CPP_CSV_THREADS_PER_CALL");
+        g_instance = new Scheduler(threads, per_call);
+#ifndef _WIN32
+        g_instance_pid = getpid();
+#endif
+    }
+    return *g_instance;
+}
+
+bool Scheduler::configure(std::size_t threads, std::size_t per_call_limit) {
+    std::lock_guard<std::mutex> lock(g_instance_mutex);
+    bool started = g_instance != nullptr;
+#ifndef _WIN32
+    started = started && g_instance_pid == getpid();
+#endif
+    if (started) return false;
+    g_threads = threads;
+    g_per_call = per_call_limit;
+    return true;
+}
+
+void Scheduler::shutdown_instance() {
+    Scheduler *scheduler = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_instance_mutex);
+        scheduler = g_instance;
+#ifndef _WIN32
+        if (g_instance_pid != getpid()) scheduler = nullptr;
+#endif
+    }
+    if (scheduler != nullptr) scheduler->shutdown();
+}
+
+bool Scheduler::submit(std::function<void()> task) {
+    if (closed_.load(std::memory_order_acquire)) return false;
+    // pending_ sube dentro del mismo candado que encola: quien toma la
+    // tarea siempre lo ve antes de bajarlo
+    if (tls_scheduler == this) {
+        Worker &own = *workers_[tls_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(std::move(task));
+        pending_.fetch_add(1, std::memory_order_release);
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        injected_.push_back(std::move(task));
+        pending_.fetch_add(1, std::memory_order_release);
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    // Tomar el mutex evita perder el aviso si un hilo está por dormirse
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_one();
+    return true;
+}
+
+void Scheduler::shutdown() {
+    if (closed_.exchange(true)) {
+        // Otro hilo ya cerró: solo esperar a que terminen
+        for (auto &worker : workers_) {
+            if (worker->thread.joinable() && worker->thread.get_id() != std::this_thread::get_id()) {
+                worker->thread.join();
+            }
+        }
+        return;
+    }
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+    // Un submit() que cruzó el cierre pudo encolar después de que los hilos
+    // salieron: se ejecuta aquí para no perderlo
+    while (true) {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            if (injected_.empty()) break;
+            task = std::move(injected_.front());
+            injected_.pop_front();
+        }
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+        try {
+            task();
+        } catch (...) {
+        }
+        executed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SchedulerStats Scheduler::stats() const {
+    SchedulerStats s;
+    s.threads = workers_.size();
+    s.queued = pending_.load(std::memory_order_relaxed);
+    s.active = active_.load(std::memory_order_relaxed);
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.executed = executed_.load(std::memory_order_relaxed);
+    s.steals = steals_.load(std::memory_order_relaxed);
+    s.per_call_limit = per_call_limit_;
+    return s;
+}
+
+bool Scheduler::take(std::size_t index, std::function<void()> &task) {
+    {
+        Worker &own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (!injected_.empty()) {
+            task = std::move(injected_.front());
+            injected_.pop_front();
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k < workers_.size(); ++k) {
+        Worker &victim = *workers_[(index + k) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::run(std::size_t index) {
+    tls_scheduler = this;
+    tls_index = index;
+    trace::name_thread("cpp_csv-worker-" + std::to_string(index));
+    while (true) {
+        std::function<void()> task;
+        if (take(index, task)) {
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            active_.fetch_add(1, std::memory_order_relaxed);
+            try {
+                task();
+            } catch (...) {
+            }
+            task = nullptr;
+            active_.fetch_sub(1, std::memory_order_relaxed);
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (pending_.load(std::memory_order_acquire) > 0) {
+            // Otra tarea está en tránsito entre colas: reintentar
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        // Al cerrar se vacían las colas antes de salir
+        if (closed_.load(std::memory_order_acquire)) return;
+        wake_.wait(lock, [this] {
+            return pending_.load(std::memory_order_acquire) > 0 || closed_.load(std::memory_order_acquire);
+        });
+    }
+}
+
+struct TaskGroup::State {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::deque<std::function<void()>> tasks;
+    std::size_t in_flight = 0;
+    std::size_t runners = 0;
+    std::exception_ptr error;
+
+    // Ejecuta tareas del grupo hasta que la cola quede vacía.
+    void drain() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                ++in_flight;
+            }
+            std::exception_ptr failure;
+            try {
+                task();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failure && !error) error = failure;
+            if (--in_flight == 0 && tasks.empty()) done.notify_all();
+        }
+    }
+};
+
+TaskGroup::TaskGroup(Scheduler *scheduler, std::size_t max_parallel)
+    : scheduler_(scheduler), state_(std::make_shared<State>()) {
+    const std::size_t limit = scheduler_ ? scheduler_->per_call_limit() : 1;
+    max_parallel_ = max_parallel == 0 ? limit : std::min(max_parallel, limit);
+    max_parallel_ = std::max<std::size_t>(max_parallel_, 1);
+}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    bool spawn = false;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->tasks.push_back(std::move(task));
+        // El hilo que espera cuenta como uno: hasta max_parallel - 1 ayudantes
+        if (scheduler_ && state_->runners + 1 < max_parallel_ && state_->runners < state_->tasks.size()) {
+            ++state_->runners;
+            spawn = true;
+        }
+    }
+    if (!spawn) return;
+    std::shared_ptr<State> state = state_;
+    const bool accepted = scheduler_->submit([state] {
+        state->drain();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        --state->runners;
+    });
+    if (!accepted) {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        --state_->runners;
+    }
+}
+
+void TaskGroup::wait() {
+    state_->drain();
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->done.wait(lock, [this] { return state_->tasks.empty() && state_->in_flight == 0; });
+        std::swap(error, state_->error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+}  // namespace csvcore
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace csvcore {
+
+struct SchedulerStats {
+    std::size_t threads = 0;
+    std::size_t queued = 0;   // tareas esperando (colas locales + inyección)
+    std::size_t active = 0;   // tareas ejecutándose
+    std::uint64_t submitted = 0;
+    std::uint64_t executed = 0;
+    std::uint64_t steals = 0;  // tareas tomadas de la cola de otro hilo
+    std::size_t per_call_limit = 0;
+};
+
+// Planificador de tareas con robo de trabajo, compartido por todo el
+// proceso: todos los kernels paralelos de cpp_csv (y las llamadas
+// awaitable) comparten los mismos hilos en lugar de crear los suyos, así
+// que Celery + gunicorn no sobresuscriben los núcleos.
+//
+// Cada hilo tiene su deque: encola y toma del final (LIFO, caché caliente)
+// y los demás le roban del frente. Las tareas enviadas desde fuera del
+// pool van a una cola de inyección. Las tareas no deben lanzar (se
+// descartan las excepciones; TaskGroup las propaga).
+class Scheduler {
+public:
+    explicit Scheduler(std::size_t threads, std::size_t per_call_limit = 0);
+    ~Scheduler();
+
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    // Instancia del proceso, creada en el primer uso con el tamaño de
+    // configure() o, si no, de CPP_CSV_THREADS / CPP_CSV_THREADS_PER_CALL o
+    // del número de núcleos. Tras un fork (prefork de Celery) el hijo no
+    // hereda los hilos: se abandona la instancia del padre y se crea otra.
+    static Scheduler &instance();
+
+    // Tamaño de la instancia del proceso (0 = automático). Solo aplica si
+    // todavía no se creó; regresa false si ya estaba en uso.
+    static bool configure(std::size_t threads, std::size_t per_call_limit = 0);
+
+    // Cierra la instancia del proceso si existe (no la crea).
+    static void shutdown_instance();
+
+    std::size_t size() const { return workers_.size(); }
+
+    // Máximo de tareas simultáneas por llamada (TaskGroup sin límite propio).
+    std::size_t per_call_limit() const { return per_call_limit_; }
+
+    // false si el planificador ya se cerró (la tarea no se ejecuta).
+    bool submit(std::function<void()> task);
+
+    // Deja de aceptar tareas, termina las pendientes y espera a los hilos.
+    // No llamar desde una tarea.
+    void shutdown();
+
+    SchedulerStats stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+    };
+
+    void run(std::size_t index);
+    bool take(std::size_t index, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::size_t per_call_limit_;
+    std::mutex inject_mutex_;
+    std::deque<std::function<void()>> injected_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<std::size_t> active_{0};
+    std::atomic<std::uint64_t> submitted_{0};
+    std::atomic<std::uint64_t> executed_{0};
+    std::atomic<std::uint64_t> steals_{0};
+    std::atomic<bool> closed_{false};
+};
+
+// Grupo fork-join sobre el planificador con un límite de concurrencia por
+// llamada: como mucho `max_parallel` tareas del grupo corren a la vez (el
+// hilo que llama a wait() cuenta como una). wait() ayuda a vaciar el grupo
+// en el hilo que llama, así que no se bloquea aunque el pool esté lleno o
+// se llame desde dentro de otra tarea. Sin planificador (o cerrado), todo
+// corre en el hilo que llama.
+class TaskGroup {
+public:
+    explicit TaskGroup(Scheduler *scheduler, std::size_t max_parallel = 0);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    std::size_t max_parallel() const { return max_parallel_; }
+
+    void run(std::function<void()> task);
+
+    // Espera a todas las tareas y relanza la primera excepción.
+    void wait();
+
+private:
+    struct State;
+
+    Scheduler *scheduler_;
+    std::size_t max_parallel_;
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace csvcore
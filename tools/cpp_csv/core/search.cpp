@@ -0,0 +1,187 @@
+#include "search.hpp"
+
+#include <algorithm>
+
+#include "text.hpp"
+
+namespace csvcore {
+namespace search {
+
+namespace {
+
+inline bool is_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Recorre los tokens (tramos sin espacios) de un texto normalizado.
+template <typename Fn>
+void for_each_token(std::string_view folded, Fn &&fn) {
+    std::size_t pos = 0;
+    while (pos < folded.size()) {
+        while (pos < folded.size() && folded[pos] == ' ') ++pos;
+        const std::size_t start = pos;
+        while (pos < folded.size() && folded[pos] != ' ') ++pos;
+        if (pos > start) fn(start, pos);
+    }
+}
+
+// (texto, apariciones) ordenado por texto.
+using DocCounts = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+DocCounts count_by_doc(const std::vector<Hit> &hits) {
+    DocCounts counts;
+    for (const Hit &hit : hits) {
+        if (!counts.empty() && counts.back().first == hit.doc) ++counts.back().second;
+        else counts.emplace_back(hit.doc, 1);
+    }
+    return counts;
+}
+
+DocCounts intersect(const DocCounts &a, const DocCounts &b) {
+    DocCounts out;
+    std::size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i].first < b[j].first) ++i;
+        else if (b[j].first < a[i].first) ++j;
+        else {
+            out.emplace_back(a[i].first, a[i].second + b[j].second);
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TextIndex::TextIndex(const std::vector<std::string_view> &texts) {
+    std::size_t total = 0;
+    for (std::string_view t : texts) total += t.size();
+    bytes_.reserve(total);
+    text_offsets_.reserve(texts.size() + 1);
+    char_counts_.reserve(texts.size());
+    token_offsets_.reserve(texts.size() + 1);
+
+    std::string folded;
+    std::vector<std::uint32_t> offsets;
+    std::string term;
+    for (std::size_t d = 0; d < texts.size(); ++d) {
+        const std::string_view t = texts[d];
+        text_offsets_.push_back(static_cast<std::uint32_t>(bytes_.size()));
+        bytes_.append(t);
+        char_counts_.push_back(static_cast<std::uint32_t>(
+            std::count_if(t.begin(), t.end(), [](char c) { return !is_continuation(c); })));
+        token_offsets_.push_back(static_cast<std::uint32_t>(token_terms_.size()));
+
+        text::fold(t, folded, offsets);
+        std::uint32_t position = 0;
+        for_each_token(folded, [&](std::size_t start, std::size_t end) {
+            term.assign(folded, start, end - start);
+            auto inserted = term_ids_.try_emplace(term, static_cast<std::uint32_t>(postings_.size()));
+            if (inserted.second) postings_.emplace_back();
+            const std::uint32_t id = inserted.first->second;
+            postings_[id].push_back({static_cast<std::uint32_t>(d), position++});
+            token_terms_.push_back(id);
+            spans_.emplace_back(offsets[start], std::max(offsets[end], offsets[start]));
+        });
+    }
+    text_offsets_.push_back(static_cast<std::uint32_t>(bytes_.size()));
+    token_offsets_.push_back(static_cast<std::uint32_t>(token_terms_.size()));
+}
+
+const std::vector<Posting> *TextIndex::postings(std::string_view term) const {
+    auto it = term_ids_.find(std::string(term));
+    return it != term_ids_.end() ? &postings_[it->second] : nullptr;
+}
+
+bool TextIndex::phrase_terms(std::string_view phrase, std::vector<std::int64_t> &terms) const {
+    std::string folded;
+    text::fold(phrase, folded);
+    terms.clear();
+    bool complete = true;
+    for_each_token(folded, [&](std::size_t start, std::size_t end) {
+        auto it = term_ids_.find(folded.substr(start, end - start));
+        if (it == term_ids_.end()) complete = false;
+        terms.push_back(it != term_ids_.end() ? static_cast<std::int64_t>(it->second) : -1);
+    });
+    return complete && !terms.empty();
+}
+
+std::vector<Hit> TextIndex::find(std::string_view phrase, std::size_t limit) const {
+    std::vector<Hit> hits;
+    std::vector<std::int64_t> terms;
+    if (!phrase_terms(phrase, terms)) return hits;
+
+    // Se recorre la lista más corta de la frase y el resto se verifica
+    // contra los tokens del texto.
+    std::size_t anchor = 0;
+    for (std::size_t i = 1; i < terms.size(); ++i) {
+        if (postings_[static_cast<std::size_t>(terms[i])].size() <
+            postings_[static_cast<std::size_t>(terms[anchor])].size()) {
+            anchor = i;
+        }
+    }
+    for (const Posting &p : postings_[static_cast<std::size_t>(terms[anchor])]) {
+        if (p.position < anchor) continue;
+        const std::uint32_t first = token_offsets_[p.doc];
+        const std::uint32_t count = token_offsets_[p.doc + 1] - first;
+        const std::size_t start = p.position - anchor;
+        if (start + terms.size() > count) continue;
+
+        bool match = true;
+        for (std::size_t i = 0; i < terms.size() && match; ++i) {
+            match = token_terms_[first + start + i] == static_cast<std::uint32_t>(terms[i]);
+        }
+        if (!match) continue;
+        hits.push_back({p.doc, spans_[first + start].first, spans_[first + start + terms.size() - 1].second});
+        if (limit && hits.size() >= limit) break;
+    }
+    return hits;
+}
+
+std::int64_t TextIndex::best_quote(const std::vector<std::string> &phrases,
+                                   std::size_t min_chars, std::size_t max_chars) const {
+    if (phrases.empty()) return -1;
+    DocCounts candidates;
+    for (std::size_t i = 0; i < phrases.size(); ++i) {
+        DocCounts counts = count_by_doc(find(phrases[i], 0));
+        candidates = i == 0 ? std::move(counts) : intersect(candidates, counts);
+        if (candidates.empty()) return -1;
+    }
+
+    std::int64_t best = -1;
+    std::uint32_t best_count = 0;
+    for (const auto &candidate : candidates) {
+        const std::size_t length = char_counts_[candidate.first];
+        if (length <= min_chars || length >= max_chars) continue;
+        if (candidate.second > best_count) {
+            best = candidate.first;
+            best_count = candidate.second;
+        }
+    }
+    return best;
+}
+
+std::vector<Context> TextIndex::keyword_in_context(std::string_view phrase, std::size_t width,
+                                                   std::size_t limit) const {
+    std::vector<Context> contexts;
+    for (const Hit &hit : find(phrase, limit)) {
+        const std::string_view t = text(hit.doc);
+        std::size_t left = hit.begin;
+        for (std::size_t n = 0; n < width && left > 0; ++n) {
+            --left;
+            while (left > 0 && is_continuation(t[left])) --left;
+        }
+        std::size_t right = hit.end;
+        for (std::size_t n = 0; n < width && right < t.size(); ++n) {
+            ++right;
+            while (right < t.size() && is_continuation(t[right])) ++right;
+        }
+        contexts.push_back({hit.doc, t.substr(left, hit.begin - left), t.substr(hit.begin, hit.end - hit.begin),
+                            t.substr(hit.end, right - hit.end)});
+    }
+    return contexts;
+}
+
+}  // namespace search
+}  // namespace csvcore
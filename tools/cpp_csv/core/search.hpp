@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace csvcore {
+
+// Índice invertido de comentarios abiertos: término normalizado -> lista de
+// (texto, posición). Sirve para buscar citas y mostrar palabras en contexto
+// sin volver a recorrer todos los textos en cada consulta.
+namespace search {
+
+struct Posting {
+    std::uint32_t doc;       // índice del texto
+    std::uint32_t position;  // token dentro del texto
+};
+
+// Aparición de una frase: bytes [begin, end) del texto original.
+struct Hit {
+    std::uint32_t doc;
+    std::uint32_t begin;
+    std::uint32_t end;
+};
+
+// Palabra en contexto: hasta `width` caracteres antes y después.
+struct Context {
+    std::uint32_t doc;
+    std::string_view left;
+    std::string_view match;
+    std::string_view right;
+};
+
+class TextIndex {
+public:
+    // Copia los textos a un solo buffer; los tokens salen de text::fold().
+    explicit TextIndex(const std::vector<std::string_view> &texts);
+
+    TextIndex(const TextIndex &) = delete;
+    TextIndex &operator=(const TextIndex &) = delete;
+
+    std::size_t documents() const { return char_counts_.size(); }
+    std::size_t terms() const { return postings_.size(); }
+    std::size_t tokens() const { return token_terms_.size(); }
+
+    std::string_view text(std::uint32_t doc) const {
+        return std::string_view(bytes_.data() + text_offsets_[doc], text_offsets_[doc + 1] - text_offsets_[doc]);
+    }
+    // Largo en caracteres (code points), como len() en Python.
+    std::size_t chars(std::uint32_t doc) const { return char_counts_[doc]; }
+
+    // Lista de un término ya normalizado (nullptr si no aparece).
+    const std::vector<Posting> *postings(std::string_view term) const;
+
+    // Apariciones de una frase (se normaliza igual que los textos; varias
+    // palabras = tokens consecutivos), en orden de texto. 0 = sin tope.
+    std::vector<Hit> find(std::string_view phrase, std::size_t limit) const;
+
+    // Texto con todas las frases y largo en caracteres dentro de
+    // (min_chars, max_chars): el de más apariciones y, en empate, el primero.
+    // -1 si ninguno cumple.
+    std::int64_t best_quote(const std::vector<std::string> &phrases,
+                            std::size_t min_chars, std::size_t max_chars) const;
+
+    std::vector<Context> keyword_in_context(std::string_view phrase, std::size_t width,
+                                            std::size_t limit) const;
+
+private:
+    // Términos de la frase (-1 si alguno no está en el índice).
+    bool phrase_terms(std::string_view phrase, std::vector<std::int64_t> &terms) const;
+
+    std::string bytes_;
+    std::vector<std::uint32_t> text_offsets_;   // documents() + 1
+    std::vector<std::uint32_t> char_counts_;
+    std::vector<std::uint32_t> token_offsets_;  // primer token de cada texto (documents() + 1)
+    std::vector<std::uint32_t> token_terms_;    // término de cada token
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> spans_;  // bytes de cada token en su texto
+    std::unordered_map<std::string, std::uint32_t> term_ids_;
+    std::vector<std::vector<Posting>> postings_;
+};
+
+}  // namespace search
+
+}  // namespace csvcore
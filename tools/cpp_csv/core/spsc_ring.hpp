@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace csvcore {
+
+// Cola acotada lock-free de un productor y un consumidor. Un slot queda
+// siempre libre para distinguir "llena" de "vacía".
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) : slots_(capacity + 1) {}
+
+    bool try_push(T value) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t next = (tail + 1) % slots_.size();
+        if (next == head_.load(std::memory_order_acquire)) {
+            return false;  // llena
+        }
+        slots_[tail] = value;
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &out) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;  // vacía
+        }
+        out = slots_[head];
+        head_.store((head + 1) % slots_.size(), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+// Espera activa corta y luego dormir: los chunks tardan milisegundos, así
+// que no vale la pena un mutex/condvar por cada intercambio.
+inline void backoff(unsigned &spins) {
+    if (++spins < 64) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+}  // namespace csvcore
@@ -0,0 +1,135 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace csvcore {
+namespace stats {
+
+Distribution build_distribution(const std::vector<double> &values,
+                                const std::vector<std::int64_t> &counts) {
+    if (!counts.empty() && counts.size() != values.size()) {
+        throw std::invalid_argument("values y counts deben tener la misma longitud");
+    }
+
+    std::vector<std::size_t> order;
+    order.reserve(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[i])) continue;
+        if (!counts.empty() && counts[i] <= 0) continue;
+        order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t a, std::size_t b) { return values[a] < values[b]; });
+
+    Distribution dist;
+    for (std::size_t i : order) {
+        const auto count = counts.empty() ? 1u : static_cast<std::uint64_t>(counts[i]);
+        if (!dist.values.empty() && dist.values.back() == values[i]) {
+            dist.counts.back() += count;
+        } else {
+            dist.values.push_back(values[i]);
+            dist.counts.push_back(count);
+        }
+        dist.total += count;
+    }
+
+    dist.cumulative.resize(dist.counts.size());
+    std::partial_sum(dist.counts.begin(), dist.counts.end(), dist.cumulative.begin());
+    return dist;
+}
+
+Summary summarize(const Distribution &dist) {
+    Summary s;
+    if (dist.empty()) return s;
+
+    s.count = dist.total;
+    s.min = dist.values.front();
+    s.max = dist.values.back();
+
+    long double sum = 0.0L;
+    for (std::size_t i = 0; i < dist.values.size(); ++i) {
+        sum += static_cast<long double>(dist.values[i]) * dist.counts[i];
+    }
+    s.sum = static_cast<double>(sum);
+    const long double mean = sum / dist.total;
+    s.mean = static_cast<double>(mean);
+
+    // Segunda pasada (sobre los distintos) para una varianza estable
+    if (dist.total > 1) {
+        long double squares = 0.0L;
+        for (std::size_t i = 0; i < dist.values.size(); ++i) {
+            const long double delta = dist.values[i] - mean;
+            squares += delta * delta * dist.counts[i];
+        }
+        s.variance = static_cast<double>(squares / (dist.total - 1));
+        s.stddev = std::sqrt(s.variance);
+    }
+    return s;
+}
+
+namespace {
+
+// Valor de la observación k (0-based) en el orden expandido.
+double value_at(const Distribution &dist, std::uint64_t k) {
+    auto it = std::upper_bound(dist.cumulative.begin(), dist.cumulative.end(), k);
+    return dist.values[static_cast<std::size_t>(it - dist.cumulative.begin())];
+}
+
+}  // namespace
+
+double quantile(const Distribution &dist, double q) {
+    if (dist.empty()) {
+        throw std::invalid_argument("quantile de una distribución vacía");
+    }
+    if (!(q >= 0.0 && q <= 1.0)) {
+        throw std::invalid_argument("el cuantil debe estar entre 0 y 1");
+    }
+
+    const double h = static_cast<double>(dist.total - 1) * q;
+    const auto lo = static_cast<std::uint64_t>(std::floor(h));
+    const double lo_value = value_at(dist, lo);
+    if (lo + 1 >= dist.total || h == static_cast<double>(lo)) {
+        return lo_value;
+    }
+    const double hi_value = value_at(dist, lo + 1);
+    return lo_value + (h - static_cast<double>(lo)) * (hi_value - lo_value);
+}
+
+Histogram histogram(const Distribution &dist, std::size_t num_bins) {
+    Histogram hist;
+    if (dist.empty() || num_bins == 0) return hist;
+
+    const double min_val = dist.values.front();
+    const double max_val = dist.values.back();
+    double interval = (max_val - min_val) / static_cast<double>(num_bins);
+    if (interval < 1) interval = 1;
+
+    // Mismos límites (acumulados) que el cálculo original en Python
+    double curr = min_val;
+    for (std::size_t i = 0; i < num_bins; ++i) {
+        const double end = curr + interval;
+        hist.starts.push_back(curr);
+        hist.ends.push_back(end);
+        curr = end;
+    }
+    hist.counts.assign(num_bins, 0);
+
+    for (std::size_t i = 0; i < dist.values.size(); ++i) {
+        const double v = dist.values[i];
+        // Primer rango con end > v; su start (= end anterior) ya es <= v
+        auto it = std::upper_bound(hist.ends.begin(), hist.ends.end(), v);
+        std::size_t bin = static_cast<std::size_t>(it - hist.ends.begin());
+        if (bin == num_bins) {
+            if (v > hist.ends.back() + 0.1) continue;
+            bin = num_bins - 1;
+        }
+        hist.counts[bin] += dist.counts[i];
+    }
+    return hist;
+}
+
+}  // namespace stats
+}  // namespace csvcore
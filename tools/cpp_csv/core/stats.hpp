@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace csvcore {
+
+// Estadísticas numéricas sobre distribuciones (valor, conteo): todo es
+// O(valores distintos), nunca se expande una observación por respuesta.
+namespace stats {
+
+// Valores distintos ordenados con sus conteos y el acumulado.
+struct Distribution {
+    std::vector<double> values;
+    std::vector<std::uint64_t> counts;
+    std::vector<std::uint64_t> cumulative;  // cumulative[i] = counts[0..i]
+    std::uint64_t total = 0;
+
+    bool empty() const { return total == 0; }
+};
+
+// Construye la distribución desde arreglos paralelos. Sin `counts` cada
+// valor cuenta 1. Se ignoran NaN y conteos <= 0; los duplicados se suman.
+Distribution build_distribution(const std::vector<double> &values,
+                                const std::vector<std::int64_t> &counts);
+
+struct Summary {
+    std::uint64_t count = 0;
+    double sum = 0.0;
+    double mean = 0.0;
+    double variance = 0.0;  // muestral (n - 1), como statistics.variance
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(const Distribution &dist);
+
+// Cuantil exacto con interpolación lineal entre observaciones (método 7,
+// el de numpy/pandas); quantile(d, 0.5) coincide con statistics.median.
+double quantile(const Distribution &dist, double q);
+
+// Histograma de rangos de _optimize_chart_data: `num_bins` rangos de ancho
+// (max - min) / num_bins (mínimo 1) desde min; el último incluye hasta
+// end + 0.1. Los valores fuera de todo rango no se cuentan.
+struct Histogram {
+    std::vector<double> starts;
+    std::vector<double> ends;
+    std::vector<std::uint64_t> counts;
+};
+
+Histogram histogram(const Distribution &dist, std::size_t num_bins);
+
+}  // namespace stats
+
+}  // namespace csvcore
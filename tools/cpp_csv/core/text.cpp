@@ -0,0 +1,173 @@
+#include "text.hpp"
+
+#include <algorithm>
+
+namespace csvcore {
+namespace text {
+
+namespace {
+
+// Plegado de U+0080..U+017F (Latin-1 Supplement + Latin Extended-A): la
+// forma NFKD en minúsculas, sin marcas combinantes y con lo que no es ASCII
+// alfanumérico como espacio ("¼" -> "1 4"). "" = separador.
+const char *const kFoldTable[256] = {
+    "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "",  // U+0080
+    "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "",  // U+0090
+    "", "", "", "", "", "", "", "", "", "", "a", "", "", "", "", "",  // U+00A0
+    "", "", "2", "3", "", "", "", "", "", "1", "o", "", "1 4", "1 2", "3 4", "",  // U+00B0
+    "a", "a", "a", "a", "a", "a", "", "c", "e", "e", "e", "e", "i", "i", "i", "i",  // U+00C0
+    "", "n", "o", "o", "o", "o", "o", "", "", "u", "u", "u", "u", "y", "", "",  // U+00D0
+    "a", "a", "a", "a", "a", "a", "", "c", "e", "e", "e", "e", "i", "i", "i", "i",  // U+00E0
+    "", "n", "o", "o", "o", "o", "o", "", "", "u", "u", "u", "u", "y", "", "y",  // U+00F0
+    "a", "a", "a", "a", "a", "a", "c", "c", "c", "c", "c", "c", "c", "c", "d", "d",  // U+0100
+    "", "", "e", "e", "e", "e", "e", "e", "e", "e", "e", "e", "g", "g", "g", "g",  // U+0110
+    "g", "g", "g", "g", "h", "h", "", "", "i", "i", "i", "i", "i", "i", "i", "i",  // U+0120
+    "i", "", "ij", "ij", "j", "j", "k", "k", "", "l", "l", "l", "l", "l", "l", "l ",  // U+0130
+    "l ", "", "", "n", "n", "n", "n", "n", "n", " n", "", "", "o", "o", "o", "o",  // U+0140
+    "o", "o", "", "", "r", "r", "r", "r", "r", "r", "s", "s", "s", "s", "s", "s",  // U+0150
+    "s", "s", "t", "t", "t", "t", "", "", "u", "u", "u", "u", "u", "u", "u", "u",  // U+0160
+    "u", "u", "u", "u", "w", "w", "y", "y", "y", "z", "z", "z", "z", "z", "z", "s",  // U+0170
+};
+
+// Decodifica un code point UTF-8 en `s[i]`; avanza `i`. Secuencias
+// inválidas cuentan como un byte (se tratan como separador).
+std::uint32_t next_code_point(std::string_view s, std::size_t &i) {
+    const auto b0 = static_cast<unsigned char>(s[i]);
+    std::size_t len = b0 < 0x80 ? 1 : (b0 >> 5) == 0x6 ? 2 : (b0 >> 4) == 0xE ? 3 : (b0 >> 3) == 0x1E ? 4 : 0;
+    if (len == 0 || i + len > s.size()) {
+        ++i;
+        return 0xFFFD;
+    }
+    std::uint32_t cp = len == 1 ? b0 : len == 2 ? (b0 & 0x1F) : len == 3 ? (b0 & 0x0F) : (b0 & 0x07);
+    for (std::size_t k = 1; k < len; ++k) {
+        const auto b = static_cast<unsigned char>(s[i + k]);
+        if ((b & 0xC0) != 0x80) {
+            ++i;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    i += len;
+    return cp;
+}
+
+bool is_combining_mark(std::uint32_t cp) {
+    return cp >= 0x0300 && cp <= 0x036F;
+}
+
+// Orden de top-k: conteo descendente, empate alfabético.
+std::vector<TermCount> top_k(const std::unordered_map<std::string, std::uint64_t> &counts,
+                             std::size_t k) {
+    using Entry = const std::pair<const std::string, std::uint64_t> *;
+    std::vector<Entry> entries;
+    entries.reserve(counts.size());
+    for (const auto &item : counts) entries.push_back(&item);
+
+    auto before = [](Entry a, Entry b) {
+        if (a->second != b->second) return a->second > b->second;
+        return a->first < b->first;
+    };
+    if (k == 0 || k > entries.size()) k = entries.size();
+    std::partial_sort(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(k),
+                      entries.end(), before);
+
+    std::vector<TermCount> out;
+    out.reserve(k);
+    for (std::size_t i = 0; i < k; ++i) out.push_back({entries[i]->first, entries[i]->second});
+    return out;
+}
+
+}  // namespace
+
+namespace {
+
+template <bool kOffsets>
+void fold_impl(std::string_view utf8, std::string &out, std::vector<std::uint32_t> *offsets) {
+    out.clear();
+    out.reserve(utf8.size());
+    if constexpr (kOffsets) {
+        offsets->clear();
+        offsets->reserve(utf8.size() + 1);
+    }
+    std::size_t i = 0;
+    while (i < utf8.size()) {
+        const auto start = static_cast<std::uint32_t>(i);
+        const auto c = static_cast<unsigned char>(utf8[i]);
+        if (c < 0x80) {
+            // Camino rápido ASCII
+            if (c >= 'A' && c <= 'Z') out.push_back(static_cast<char>(c + ('a' - 'A')));
+            else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) out.push_back(static_cast<char>(c));
+            else out.push_back(' ');
+            if constexpr (kOffsets) offsets->push_back(start);
+            ++i;
+            continue;
+        }
+        const std::uint32_t cp = next_code_point(utf8, i);
+        if (is_combining_mark(cp)) continue;
+        const char *folded = cp < 0x180 ? kFoldTable[cp - 0x80] : "";
+        if (*folded) out.append(folded);
+        else out.push_back(' ');
+        if constexpr (kOffsets) offsets->resize(out.size(), start);
+    }
+    if constexpr (kOffsets) offsets->push_back(static_cast<std::uint32_t>(utf8.size()));
+}
+
+}  // namespace
+
+void fold(std::string_view utf8, std::string &out) {
+    fold_impl<false>(utf8, out, nullptr);
+}
+
+void fold(std::string_view utf8, std::string &out, std::vector<std::uint32_t> &offsets) {
+    fold_impl<true>(utf8, out, &offsets);
+}
+
+Analyzer::Analyzer(Options options) : options_(std::move(options)) {}
+
+void Analyzer::add(std::string_view utf8) {
+    ++documents_;
+    fold(utf8, folded_);
+
+    // Los bigramas unen tokens consecutivos ya filtrados (sin stopwords ni
+    // cortos), dentro del mismo texto.
+    const std::string_view line(folded_);
+    std::string_view previous;
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && line[pos] == ' ') ++pos;
+        const std::size_t start = pos;
+        while (pos < line.size() && line[pos] != ' ') ++pos;
+        if (pos == start) break;
+
+        const std::string_view token = line.substr(start, pos - start);
+        if (token.size() < options_.min_length) continue;
+        term_.assign(token);
+        if (options_.stopwords.count(term_)) continue;
+
+        ++unigrams_[term_];
+        ++tokens_;
+        if (options_.bigrams && !previous.empty()) {
+            bigram_.assign(previous);
+            bigram_.push_back(' ');
+            bigram_.append(token);
+            ++bigrams_[bigram_];
+        }
+        previous = token;
+    }
+}
+
+std::vector<TermCount> Analyzer::top_unigrams(std::size_t k) const {
+    return top_k(unigrams_, k);
+}
+
+std::vector<TermCount> Analyzer::top_bigrams(std::size_t k) const {
+    return top_k(bigrams_, k);
+}
+
+std::uint64_t Analyzer::count(const std::string &term) const {
+    auto it = unigrams_.find(term);
+    return it != unigrams_.end() ? it->second : 0;
+}
+
+}  // namespace text
+}  // namespace csvcore
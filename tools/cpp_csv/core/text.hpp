@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace csvcore {
+
+// Minería de texto para comentarios abiertos: normalización, tokens y
+// conteo de palabras / bigramas.
+namespace text {
+
+// Minúsculas + quitar acentos con una tabla (equivalente a NFKD + ASCII
+// para Latin-1 y Latin Extended-A: "Atención" -> "atencion", "ñ" -> "n").
+// Todo lo que no es letra o dígito queda como un espacio, así el resultado
+// se tokeniza separando por espacios. Las marcas combinantes (texto en NFD)
+// se eliminan sin cortar la palabra.
+void fold(std::string_view utf8, std::string &out);
+
+// Igual que fold(), y además `offsets[i]` es el byte de `utf8` donde empieza
+// el carácter que produjo `out[i]` (con un elemento extra = utf8.size()),
+// para ubicar un token normalizado en el texto original.
+void fold(std::string_view utf8, std::string &out, std::vector<std::uint32_t> &offsets);
+
+struct Options {
+    std::size_t min_length = 3;                 // largo mínimo de token (ya normalizado)
+    std::unordered_set<std::string> stopwords;  // normalizadas con fold()
+    bool bigrams = true;                        // pares de tokens consecutivos del mismo texto
+};
+
+struct TermCount {
+    std::string term;
+    std::uint64_t count;
+};
+
+// Acumula textos y cuenta unigramas/bigramas en tablas hash; los buffers
+// se reutilizan entre textos (sin asignar memoria por token ya visto).
+class Analyzer {
+public:
+    explicit Analyzer(Options options);
+
+    void add(std::string_view utf8);
+
+    // Los k términos más frecuentes (empate por orden alfabético); 0 = todos.
+    std::vector<TermCount> top_unigrams(std::size_t k) const;
+    std::vector<TermCount> top_bigrams(std::size_t k) const;
+
+    std::uint64_t count(const std::string &term) const;
+    std::uint64_t tokens() const { return tokens_; }
+    std::uint64_t documents() const { return documents_; }
+
+private:
+    Options options_;
+    std::unordered_map<std::string, std::uint64_t> unigrams_;
+    std::unordered_map<std::string, std::uint64_t> bigrams_;
+    std::uint64_t tokens_ = 0;
+    std::uint64_t documents_ = 0;
+    std::string folded_;  // buffers reutilizados entre textos
+    std::string term_;
+    std::string bigram_;
+};
+
+}  // namespace text
+
+}  // namespace csvcore
@@ -0,0 +1,259 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace csvcore {
+namespace trace {
+
+namespace detail {
+std::atomic<std::uint32_t> g_sessions{0};
+}
+
+namespace {
+
+// Slot del ring. `seq` vale 2*i+1 mientras se escribe el evento i y 2*i+2
+// cuando ya está completo; quien exporta copia el evento y vuelve a leer
+// `seq` (como un seqlock) para descartar slots a medio escribir o ya
+// reusados por una vuelta posterior.
+struct Slot {
+    std::atomic<std::uint64_t> seq{0};
+    Event event;
+};
+
+struct Ring {
+    explicit Ring(std::size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+    std::size_t capacity() const { return mask + 1; }
+
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+};
+
+// El ring se reserva con la primera sesión y vive lo que el proceso (los
+// escritores lo leen sin lock).
+std::atomic<Ring *> g_ring{nullptr};
+std::atomic<std::uint64_t> g_head{0};
+std::atomic<std::uint32_t> g_next_tid{0};
+
+// start/stop y los nombres de hilos; nunca en el camino de record().
+std::mutex g_mutex;
+std::map<std::uint32_t, std::string> g_thread_names;
+
+std::size_t env_size(const char *name) {
+    const char *value = std::getenv(name);
+    if (value == nullptr || *value == '\0') return 0;
+    char *end = nullptr;
+    const long n = std::strtol(value, &end, 10);
+    return (end != value && *end == '\0' && n > 0) ? static_cast<std::size_t>(n) : 0;
+}
+
+// Copia terminada en '\0' sin partir un carácter UTF-8 al truncar.
+void copy_text(char *dst, std::size_t size, const char *src) {
+    std::size_t n = 0;
+    while (src[n] != '\0' && n + 1 < size) ++n;
+    if (src[n] != '\0') {
+        while (n > 0 && (static_cast<unsigned char>(src[n]) & 0xC0) == 0x80) --n;
+    }
+    std::copy(src, src + n, dst);
+    dst[n] = '\0';
+}
+
+void append_escaped(std::string &out, const char *text) {
+    out.push_back('"');
+    for (const char *p = text; *p != '\0'; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(static_cast<char>(c));
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out.push_back(static_cast<char>(c));
+        }
+    }
+    out.push_back('"');
+}
+
+// Microsegundos con 3 decimales (la unidad de Chrome Trace Event).
+void append_micros(std::string &out, std::uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03u", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned>(ns % 1000));
+    out += buf;
+}
+
+void append_event(std::string &out, const Event &e, long pid) {
+    out += "{\"name\":";
+    append_escaped(out, e.name);
+    out += ",\"cat\":";
+    append_escaped(out, e.category);
+    out += ",\"ph\":\"X\",\"ts\":";
+    append_micros(out, e.start_ns);
+    out += ",\"dur\":";
+    append_micros(out, e.duration_ns);
+    out += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(e.tid);
+    if (e.args > 0) {
+        out += ",\"args\":{";
+        for (std::uint32_t a = 0; a < e.args; ++a) {
+            if (a > 0) out.push_back(',');
+            append_escaped(out, e.keys[a]);
+            out += ":" + std::to_string(e.values[a]);
+        }
+        out.push_back('}');
+    }
+    out.push_back('}');
+}
+
+long process_id() {
+#ifndef _WIN32
+    return static_cast<long>(getpid());
+#else
+    return 0;
+#endif
+}
+
+std::uint32_t next_thread_id() { return g_next_tid.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+}  // namespace
+
+std::uint32_t thread_id() {
+    thread_local const std::uint32_t id = next_thread_id();
+    return id;
+}
+
+void name_thread(const std::string &name) {
+    const std::uint32_t tid = thread_id();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_thread_names[tid] = name;
+}
+
+namespace {
+
+// Copia `event` al ring con el tid del hilo que llama.
+void record(Event event) {
+    if (!enabled()) return;
+    Ring *ring = g_ring.load(std::memory_order_acquire);
+    if (ring == nullptr) return;
+    event.tid = thread_id();
+
+    const std::uint64_t index = g_head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = ring->slots[index & ring->mask];
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+}  // namespace
+
+void complete(const char *name, const char *category, std::uint64_t start_ns, std::uint64_t end_ns,
+              const std::pair<const char *, std::int64_t> *args, std::size_t count) {
+    if (!enabled()) return;
+    Event event;
+    copy_text(event.name, kNameBytes, name);
+    copy_text(event.category, kCategoryBytes, category);
+    event.start_ns = start_ns;
+    event.duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+    event.args = 0;
+    for (std::size_t a = 0; a < count && a < kMaxArgs; ++a) {
+        copy_text(event.keys[a], kKeyBytes, args[a].first);
+        event.values[a] = args[a].second;
+        ++event.args;
+    }
+    record(event);
+}
+
+std::uint64_t start(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_ring.load(std::memory_order_relaxed) == nullptr) {
+        if (capacity == 0) capacity = env_size("CPP_CSV_TRACE_EVENTS");
+        if (capacity == 0) capacity = kDefaultCapacity;
+        std::size_t rounded = 1024;
+        while (rounded < capacity) rounded <<= 1;
+        g_ring.store(new Ring(rounded), std::memory_order_release);
+    }
+    const std::uint64_t cursor = g_head.load(std::memory_order_acquire);
+    detail::g_sessions.fetch_add(1, std::memory_order_release);
+    return cursor;
+}
+
+std::string stop(std::uint64_t cursor, std::uint64_t *dropped) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (detail::g_sessions.load(std::memory_order_relaxed) > 0) {
+        detail::g_sessions.fetch_sub(1, std::memory_order_release);
+    }
+    const Ring *ring = g_ring.load(std::memory_order_acquire);
+    const std::uint64_t head = g_head.load(std::memory_order_acquire);
+    const long pid = process_id();
+
+    std::uint64_t lost = 0;
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    if (ring != nullptr && head > cursor) {
+        const std::uint64_t oldest = head > ring->capacity() ? head - ring->capacity() : 0;
+        const std::uint64_t begin = std::max(cursor, oldest);
+        lost = begin - cursor;
+        for (std::uint64_t index = begin; index < head; ++index) {
+            const Slot &slot = ring->slots[index & ring->mask];
+            const std::uint64_t expected = 2 * index + 2;
+            if (slot.seq.load(std::memory_order_acquire) != expected) {
+                ++lost;
+                continue;
+            }
+            const Event event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != expected) {
+                ++lost;
+                continue;
+            }
+            if (!first) out.push_back(',');
+            first = false;
+            append_event(out, event, pid);
+        }
+    }
+    for (const auto &item : g_thread_names) {
+        if (!first) out.push_back(',');
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) +
+               ",\"tid\":" + std::to_string(item.first) + ",\"args\":{\"name\":";
+        append_escaped(out, item.second.c_str());
+        out += "}}";
+    }
+    out += "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" + std::to_string(lost) + "}}";
+    if (dropped != nullptr) *dropped = lost;
+    return out;
+}
+
+Span::Span(const char *name, const char *category) : active_(enabled()) {
+    if (!active_) return;
+    copy_text(event_.name, kNameBytes, name);
+    copy_text(event_.category, kCategoryBytes, category);
+    event_.args = 0;
+    event_.start_ns = now_ns();
+}
+
+Span::~Span() {
+    if (!active_) return;
+    event_.duration_ns = now_ns() - event_.start_ns;
+    record(event_);
+}
+
+void Span::arg(const char *key, std::int64_t value) {
+    if (!active_ || event_.args >= kMaxArgs) return;
+    copy_text(event_.keys[event_.args], kKeyBytes, key);
+    event_.values[event_.args] = value;
+    ++event_.args;
+}
+
+}  // namespace trace
+}  // namespace csvcore
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "metrics.hpp"
+
+namespace csvcore {
+
+// Línea de tiempo de spans (nombre, hilo, inicio, duración y hasta tres
+// argumentos enteros) exportable como JSON de Chrome Trace Event, que abren
+// chrome://tracing y Perfetto. Se activa por sesión (una petición o una
+// importación): sin sesiones abiertas un Span solo lee un atómico.
+//
+// Los eventos van a un ring buffer de tamaño fijo del proceso: cada
+// escritor reserva un slot con fetch_add y lo publica con un número de
+// secuencia, sin locks. Si el ring da la vuelta se pierden los eventos más
+// viejos (la exportación los cuenta como `dropped`). Las sesiones
+// simultáneas comparten el ring: cada una exporta lo registrado por todo el
+// proceso mientras estuvo abierta.
+namespace trace {
+
+constexpr std::size_t kDefaultCapacity = std::size_t(1) << 15;  // eventos (~5 MB)
+constexpr std::size_t kNameBytes = 48;
+constexpr std::size_t kCategoryBytes = 16;
+constexpr std::size_t kKeyBytes = 16;
+constexpr std::size_t kMaxArgs = 3;
+
+struct Event {
+    char name[kNameBytes];
+    char category[kCategoryBytes];
+    char keys[kMaxArgs][kKeyBytes];
+    std::int64_t values[kMaxArgs];
+    std::uint64_t start_ns;
+    std::uint64_t duration_ns;
+    std::uint32_t tid;
+    std::uint32_t args;
+};
+
+namespace detail {
+extern std::atomic<std::uint32_t> g_sessions;
+}
+
+// true si hay al menos una sesión abierta.
+inline bool enabled() { return detail::g_sessions.load(std::memory_order_relaxed) != 0; }
+
+// Reloj de los eventos (el de metrics), el mismo para C++ y Python.
+inline std::uint64_t now_ns() { return metrics::now_ns(); }
+
+// Id pequeño y estable del hilo que llama (1, 2, ...).
+std::uint32_t thread_id();
+
+// Nombre del hilo que llama en la línea de tiempo (metadato thread_name).
+void name_thread(const std::string &name);
+
+// Evento completo con tiempos explícitos (p. ej. un span de Python medido
+// con now_ns()), en el hilo que llama. Sin sesiones abiertas no hace nada.
+void complete(const char *name, const char *category, std::uint64_t start_ns, std::uint64_t end_ns,
+              const std::pair<const char *, std::int64_t> *args = nullptr, std::size_t count = 0);
+
+// Abre una sesión y regresa su cursor. La primera sesión del proceso
+// reserva el ring con `capacity` eventos (0 = CPP_CSV_TRACE_EVENTS o
+// kDefaultCapacity, redondeado a potencia de 2).
+std::uint64_t start(std::size_t capacity = 0);
+
+// Cierra la sesión de `cursor` y regresa sus eventos como JSON de Chrome
+// Trace Event ({"traceEvents": [...], ...}). `dropped` recibe cuántos
+// eventos se perdieron porque el ring dio la vuelta.
+std::string stop(std::uint64_t cursor, std::uint64_t *dropped = nullptr);
+
+// Span RAII: registra un evento completo ("ph": "X") al destruirse si al
+// construirse había una sesión abierta. `name` y las llaves se copian
+// (truncadas a kNameBytes / kKeyBytes).
+class Span {
+public:
+    explicit Span(const char *name, const char *category = "cpp_csv");
+    ~Span();
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+    bool active() const { return active_; }
+
+    // Argumento entero del evento; los que pasan de kMaxArgs se ignoran.
+    void arg(const char *key, std::int64_t value);
+
+private:
+    bool active_;
+    Event event_;
+};
+
+}  // namespace trace
+
+}  // namespace csvcore
@@ -0,0 +1,99 @@
+#include "validation.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace csvcore {
+namespace validation {
+
+std::string_view trim(std::string_view str) {
+    std::size_t start = 0;
+    while (start < str.size() && std::isspace(static_cast<unsigned char>(str[start]))) {
+        ++start;
+    }
+    std::size_t end = str.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(str[end - 1]))) {
+        --end;
+    }
+    return str.substr(start, end - start);
+}
+
+FieldType parse_field_type(const std::string& type_str) {
+    std::string lower = type_str;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "number") return FieldType::NUMBER;
+    if (lower == "scale") return FieldType::SCALE;
+    if (lower == "single") return FieldType::SINGLE;
+    return FieldType::TEXT;
+}
+
+ValidatedValue validate_value(std::string_view value, const ValidationRule& rule,
+                              size_t row_idx, const std::string& column,
+                              std::vector<ValidationError>& errors) {
+    std::string_view trimmed = trim(value);
+
+    // Valor vacío
+    if (trimmed.empty()) {
+        return {};
+    }
+
+    switch (rule.type) {
+        case FieldType::NUMBER: {
+            try {
+                std::string num_str(trimmed);
+                size_t pos;
+                double num = std::stod(num_str, &pos);
+                // Verificar que se consumió todo el string
+                if (pos != num_str.length()) {
+                    errors.push_back({row_idx, column, std::string(value), "No es un número válido"});
+                    return {};
+                }
+                return {ValueKind::NUMBER, num, {}};
+            } catch (...) {
+                errors.push_back({row_idx, column, std::string(value), "No es un número válido"});
+                return {};
+            }
+        }
+
+        case FieldType::SCALE: {
+            try {
+                std::string num_str(trimmed);
+                size_t pos;
+                double num = std::stod(num_str, &pos);
+                if (pos != num_str.length()) {
+                    errors.push_back({row_idx, column, std::string(value), "No es un número válido para escala"});
+                    return {};
+                }
+                if (num < rule.min_value || num > rule.max_value) {
+                    std::ostringstream oss;
+                    oss << "Valor fuera de rango [" << rule.min_value << ", " << rule.max_value << "]";
+                    errors.push_back({row_idx, column, std::string(value), oss.str()});
+                    return {};
+                }
+                return {ValueKind::NUMBER, num, {}};
+            } catch (...) {
+                errors.push_back({row_idx, column, std::string(value), "No es un número válido para escala"});
+                return {};
+            }
+        }
+
+        case FieldType::SINGLE: {
+            if (!rule.valid_options.empty()) {
+                if (rule.valid_options.find(std::string(trimmed)) == rule.valid_options.end()) {
+                    errors.push_back({row_idx, column, std::string(value), "Opción no válida"});
+                    return {};
+                }
+            }
+            return {ValueKind::TEXT, 0.0, trimmed};
+        }
+
+        case FieldType::TEXT:
+        default:
+            return {ValueKind::TEXT, 0.0, trimmed};
+    }
+}
+
+}  // namespace validation
+}  // namespace csvcore
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace csvcore {
+
+// Estructuras para validación
+namespace validation {
+
+enum class FieldType {
+    TEXT,
+    NUMBER,
+    SCALE,
+    SINGLE
+};
+
+struct ValidationRule {
+    FieldType type;
+    double min_value = 0.0;
+    double max_value = 10.0;
+    std::unordered_set<std::string> valid_options;
+};
+
+struct ValidationError {
+    size_t row_index;
+    std::string column;
+    std::string value;
+    std::string message;
+};
+
+// Resultado de validar una celda: vacío/inválido, número o texto (la vista
+// apunta a la celda original, ya recortada).
+enum class ValueKind {
+    NONE,
+    NUMBER,
+    TEXT
+};
+
+struct ValidatedValue {
+    ValueKind kind = ValueKind::NONE;
+    double number = 0.0;
+    std::string_view text;
+};
+
+// Trim whitespace
+std::string_view trim(std::string_view str);
+
+// Convierte string a FieldType
+FieldType parse_field_type(const std::string& type_str);
+
+// Valida y convierte un valor según la regla
+ValidatedValue validate_value(std::string_view value, const ValidationRule& rule,
+                              size_t row_idx, const std::string& column,
+                              std::vector<ValidationError>& errors);
+
+}  // namespace validation
+
+}  // namespace csvcore
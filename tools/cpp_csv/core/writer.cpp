@@ -0,0 +1,203 @@
+#include "writer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CSVCORE_HAS_SSE2 1
+#endif
+
+namespace csvcore {
+namespace writer {
+
+namespace {
+
+constexpr char kLineEnd[] = "\r\n";
+// Una fila de un solo campo vacío sería una línea en blanco, que los
+// lectores saltan; como csv.writer, se escribe entre comillas.
+constexpr char kEmptyField[] = "\"\"";
+constexpr double kMaxExactInteger = 1e15;
+
+bool is_special(char c, char delimiter) {
+    return c == delimiter || c == '"' || c == '\r' || c == '\n';
+}
+
+}  // namespace
+
+bool needs_quotes(std::string_view field, char delimiter) {
+    const char *p = field.data();
+    const std::size_t n = field.size();
+    std::size_t i = 0;
+#ifdef CSVCORE_HAS_SSE2
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, delim), _mm_cmpeq_epi8(v, quote)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        if (_mm_movemask_epi8(hit)) return true;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (is_special(p[i], delimiter)) return true;
+    }
+    return false;
+}
+
+void append_field(std::string &out, std::string_view field, char delimiter) {
+    if (!needs_quotes(field, delimiter)) {
+        out.append(field);
+        return;
+    }
+    out.push_back('"');
+    std::size_t start = 0;
+    for (std::size_t q = field.find('"'); q != std::string_view::npos; q = field.find('"', start)) {
+        out.append(field.substr(start, q + 1 - start));
+        out.push_back('"');
+        start = q + 1;
+    }
+    out.append(field.substr(start));
+    out.push_back('"');
+}
+
+void append_number(std::string &out, double value) {
+    char buffer[32];
+    if (value == std::floor(value) && std::fabs(value) < kMaxExactInteger) {
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<long long>(value));
+        out.append(buffer, static_cast<std::size_t>(result.ptr - buffer));
+        return;
+    }
+    const int n = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (n > 0) out.append(buffer, static_cast<std::size_t>(n));
+}
+
+TableEncoder::TableEncoder(std::vector<std::string> header, char delimiter, std::string multi_separator,
+                           std::size_t chunk_bytes)
+    : header_(std::move(header)),
+      delimiter_(delimiter),
+      multi_separator_(std::move(multi_separator)),
+      chunk_bytes_(std::max<std::size_t>(chunk_bytes, 1)),
+      labels_(header_.size()),
+      encoded_(header_.size()) {
+    if (header_.empty()) throw std::invalid_argument("El encabezado no puede estar vacío");
+}
+
+void TableEncoder::set_dictionary(std::size_t column, const std::vector<std::string_view> &labels) {
+    if (column >= header_.size()) throw std::out_of_range("Columna fuera del encabezado");
+    labels_[column].assign(labels.begin(), labels.end());
+    encoded_[column].clear();
+    encoded_[column].reserve(labels.size());
+    for (std::string_view label : labels) {
+        std::string field;
+        append_field(field, label, delimiter_);
+        encoded_[column].push_back(std::move(field));
+    }
+}
+
+std::string TableEncoder::header() const {
+    std::string out;
+    for (std::size_t c = 0; c < header_.size(); ++c) {
+        if (c) out.push_back(delimiter_);
+        append_field(out, header_[c], delimiter_);
+    }
+    if (out.empty()) out.append(kEmptyField);
+    out.append(kLineEnd);
+    return out;
+}
+
+void TableEncoder::append_value(std::string &field, const Cell &cell) const {
+    if (!cell.text.empty()) {
+        field.append(cell.text);
+    } else if (!std::isnan(cell.number)) {
+        append_number(field, cell.number);
+    } else if (cell.code >= 0 && static_cast<std::size_t>(cell.code) < labels_[cell.column].size()) {
+        field.append(labels_[cell.column][static_cast<std::size_t>(cell.code)]);
+    }
+}
+
+std::vector<std::string> TableEncoder::encode(std::size_t rows,
+                                              const std::vector<std::vector<std::string_view>> &leading,
+                                              std::vector<Cell> cells) const {
+    if (leading.size() > header_.size()) throw std::invalid_argument("Más columnas fijas que encabezados");
+    for (const auto &column : leading) {
+        if (column.size() != rows) throw std::invalid_argument("Cada columna fija debe tener un valor por fila");
+    }
+    for (const Cell &cell : cells) {
+        if (cell.row >= rows || cell.column < leading.size() || cell.column >= header_.size()) {
+            throw std::out_of_range("Celda fuera de la tabla");
+        }
+    }
+    // Orden (fila, columna) estable: conteo por fila y, dentro de cada
+    // fila (pocas celdas), orden por columna.
+    std::vector<std::size_t> starts(rows + 1, 0);
+    for (const Cell &cell : cells) ++starts[cell.row + 1];
+    for (std::size_t r = 0; r < rows; ++r) starts[r + 1] += starts[r];
+    std::vector<Cell> sorted(cells.size());
+    {
+        std::vector<std::size_t> fill(starts.begin(), starts.end() - 1);
+        for (const Cell &cell : cells) sorted[fill[cell.row]++] = cell;
+    }
+    for (std::size_t r = 0; r < rows; ++r) {
+        auto begin = sorted.begin() + static_cast<std::ptrdiff_t>(starts[r]);
+        auto end = sorted.begin() + static_cast<std::ptrdiff_t>(starts[r + 1]);
+        auto by_column = [](const Cell &a, const Cell &b) { return a.column < b.column; };
+        if (!std::is_sorted(begin, end, by_column)) std::stable_sort(begin, end, by_column);
+    }
+    cells = std::move(sorted);
+
+    std::vector<std::string> chunks;
+    std::string out;
+    out.reserve(chunk_bytes_ + chunk_bytes_ / 4);
+    std::string field;
+    std::size_t next = 0;
+    for (std::size_t r = 0; r < rows; ++r) {
+        const std::size_t line_start = out.size();
+        for (std::size_t c = 0; c < header_.size(); ++c) {
+            if (c) out.push_back(delimiter_);
+            if (c < leading.size()) {
+                append_field(out, leading[c][r], delimiter_);
+                continue;
+            }
+            std::size_t end = next;
+            while (end < cells.size() && cells[end].row == r && cells[end].column == c) ++end;
+            if (end == next) continue;
+            const Cell &first = cells[next];
+            if (end - next == 1 && first.text.empty() && std::isnan(first.number) && first.code >= 0 &&
+                static_cast<std::size_t>(first.code) < encoded_[c].size()) {
+                // Opción sola: la etiqueta ya está escapada
+                out.append(encoded_[c][static_cast<std::size_t>(first.code)]);
+            } else {
+                field.clear();
+                for (std::size_t i = next; i < end; ++i) {
+                    const std::size_t before = field.size();
+                    if (!field.empty()) field.append(multi_separator_);
+                    const std::size_t with_separator = field.size();
+                    append_value(field, cells[i]);
+                    // Una celda sin valor no deja separador colgando
+                    if (field.size() == with_separator) field.resize(before);
+                }
+                append_field(out, field, delimiter_);
+            }
+            next = end;
+        }
+        if (out.size() == line_start) out.append(kEmptyField);
+        out.append(kLineEnd);
+        if (out.size() >= chunk_bytes_) {
+            chunks.push_back(std::move(out));
+            out.clear();
+            out.reserve(chunk_bytes_ + chunk_bytes_ / 4);
+        }
+    }
+    if (!out.empty()) chunks.push_back(std::move(out));
+    return chunks;
+}
+
+}  // namespace writer
+}  // namespace csvcore
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace csvcore {
+
+// Escritura de CSV (RFC 4180, como csv.writer de Python con QUOTE_MINIMAL):
+// un campo va entre comillas si contiene el delimitador, comillas, \r o \n,
+// y las comillas internas se duplican. Las líneas terminan en \r\n y una
+// línea con un único campo vacío se escribe "" para no quedar en blanco.
+namespace writer {
+
+constexpr std::size_t kDefaultChunkBytes = 64 * 1024;
+constexpr std::int64_t kNoCode = -1;
+
+// true si el campo necesita comillas (SSE2 de 16 en 16 bytes cuando está
+// disponible).
+bool needs_quotes(std::string_view field, char delimiter);
+
+// Agrega el campo a `out`, entre comillas y escapado si hace falta.
+void append_field(std::string &out, std::string_view field, char delimiter);
+
+// Una respuesta individual de la tabla: celda (fila del lote, columna) y su
+// valor. Se usa el texto si no está vacío; si no, el número (si no es NaN);
+// si no, la etiqueta del código en el diccionario de la columna.
+struct Cell {
+    std::uint32_t row = 0;
+    std::uint32_t column = 0;
+    std::string_view text;
+    double number = 0.0;
+    std::int64_t code = kNoCode;
+};
+
+// Codifica una tabla de respuestas por lotes en bloques de ~chunk_bytes,
+// con memoria acotada por lote. Las columnas fijas (id, fecha, usuario) van
+// primero; las demás se llenan con celdas. Varias celdas en la misma
+// posición (opción múltiple) se unen con `multi_separator` en su orden.
+class TableEncoder {
+public:
+    TableEncoder(std::vector<std::string> header, char delimiter = ',', std::string multi_separator = ", ",
+                 std::size_t chunk_bytes = kDefaultChunkBytes);
+
+    std::size_t columns() const { return header_.size(); }
+
+    // Diccionario de etiquetas de una columna: se escapan una sola vez.
+    void set_dictionary(std::size_t column, const std::vector<std::string_view> &labels);
+
+    // Línea de encabezado.
+    std::string header() const;
+
+    // Codifica `rows` filas. `leading[c][r]` es el valor de la columna fija
+    // c en la fila r. Regresa los bloques de salida en orden.
+    std::vector<std::string> encode(std::size_t rows, const std::vector<std::vector<std::string_view>> &leading,
+                                    std::vector<Cell> cells) const;
+
+private:
+    // Agrega el valor crudo (sin escapar) de una celda.
+    void append_value(std::string &field, const Cell &cell) const;
+
+    std::vector<std::string> header_;
+    char delimiter_;
+    std::string multi_separator_;
+    std::size_t chunk_bytes_;
+    std::vector<std::vector<std::string>> labels_;   // etiquetas crudas por columna
+    std::vector<std::vector<std::string>> encoded_;  // las mismas, ya escapadas
+};
+
+// Número como lo escribiría str() de Python para enteros y flotantes
+// comunes: "3" para 3.0, "2.5" para 2.5 (hasta 15 dígitos significativos).
+void append_number(std::string &out, double value);
+
+}  // namespace writer
+
+}  // namespace csvcore
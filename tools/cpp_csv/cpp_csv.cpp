@@ -2,138 +2,337 @@
 #include <pybind11/stl.h>
 
 #include <algorithm>
-#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
 #include <stdexcept>
 #include <string>
-#include <vector>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
-#include <sstream>
-#include <cctype>
-#include <limits>
+#include <utility>
+#include <vector>
 
-namespace py = pybind11;
+#include "core/arena.hpp"
+#include "core/correlation.hpp"
+#include "core/crosstab.hpp"
+#include "core/cube.hpp"
+#include "core/discovery.hpp"
+#include "core/lexicon.hpp"
+#include "core/memory_budget.hpp"
+#include "core/metrics.hpp"
+#include "core/multiselect.hpp"
+#include "core/nps.hpp"
+#include "core/pgcopy.hpp"
+#include "core/pii.hpp"
+#include "core/predicate.hpp"
+#include "core/prefetch_reader.hpp"
+#include "core/progress.hpp"
+#include "core/projection.hpp"
+#include "core/reader.hpp"
+#include "core/scheduler.hpp"
+#include "core/search.hpp"
+#include "core/stats.hpp"
+#include "core/text.hpp"
+#include "core/trace.hpp"
+#include "core/validation.hpp"
+#include "core/writer.hpp"
 
-namespace {
+// Capa de pybind11: toda la lógica de parseo vive en core/ (C++ puro, sin
+// Python); aquí solo se convierten argumentos y resultados.
 
-// Parsea una línea CSV en un vector<string>, soportando:
-// - delimitador configurable
-// - comillas dobles
-// - comillas escapadas: ""
-std::vector<std::string> parse_csv_line(const std::string &line, char delimiter) {
-    std::vector<std::string> row;
-    row.reserve(32);  // heurística para reducir realocaciones
+namespace py = pybind11;
 
-    std::string cell;
-    cell.reserve(line.size());
+using csvcore::BudgetLease;
+using csvcore::ChunkArena;
+using csvcore::CsvChunkReader;
+using csvcore::MemoryBudget;
+using csvcore::read_header;
 
-    bool in_quotes = false;
+namespace metrics = csvcore::metrics;
+namespace predicate = csvcore::predicate;
+namespace progress = csvcore::progress;
+namespace projection = csvcore::projection;
+namespace trace = csvcore::trace;
 
-    for (std::size_t i = 0; i < line.size(); ++i) {
-        char c = line[i];
+namespace {
 
-        if (c == '"') {
-            // Comilla escapada dentro de un campo: ""
-            if (in_quotes && i + 1 < line.size() && line[i + 1] == '"') {
-                cell.push_back('"');
-                ++i;  // saltar la segunda comilla
-            } else {
-                // Cambiamos el estado de comillas
-                in_quotes = !in_quotes;
+inline py::str to_py_str(std::string_view value) {
+    return py::str(value.data(), value.size());
+}
+
+// Convierte usecols (None = todas; lista de nombres y/o índices) y los
+// patrones de descarte a una especificación de proyección.
+projection::Spec projection_spec(const py::object &usecols,
+                                 const std::vector<std::string> &drop_patterns) {
+    projection::Spec spec;
+    spec.drop_patterns = drop_patterns;
+    if (usecols.is_none()) {
+        return spec;
+    }
+    spec.select = true;
+    if (py::isinstance<py::str>(usecols)) {
+        spec.names.push_back(usecols.cast<std::string>());
+        return spec;
+    }
+    for (auto item : usecols) {
+        if (py::isinstance<py::int_>(item)) {
+            const long long index = item.cast<long long>();
+            if (index < 0) {
+                throw std::out_of_range("Índice de columna negativo en usecols: " + std::to_string(index));
             }
-        } else if (c == delimiter && !in_quotes) {
-            // Fin de celda
-            row.emplace_back(std::move(cell));
-            cell.clear();
+            spec.indices.push_back(static_cast<std::size_t>(index));
         } else {
-            cell.push_back(c);
+            spec.names.push_back(item.cast<std::string>());
         }
     }
+    return spec;
+}
 
-    // Última celda de la fila
-    row.emplace_back(std::move(cell));
-    return row;
+// Convierte una condición de filtro (dict) a predicate::Expr:
+//   {'column': 'Edad', 'op': '>=', 'value': 18, 'type': 'number'}
+//   {'and': [...]}, {'or': [...]}, {'not': {...}}
+// Sin 'type', un valor int/float compara como número y lo demás como texto.
+predicate::Expr filter_expr(const py::dict &node) {
+    predicate::Expr expr;
+    for (const char *combinator : {"and", "or"}) {
+        if (node.contains(combinator)) {
+            expr.op = predicate::parse_op(combinator);
+            for (auto child : py::cast<py::iterable>(node[combinator])) {
+                expr.children.push_back(filter_expr(py::cast<py::dict>(child)));
+            }
+            return expr;
+        }
+    }
+    if (node.contains("not")) {
+        expr.op = predicate::Op::NOT;
+        expr.children.push_back(filter_expr(py::cast<py::dict>(node["not"])));
+        return expr;
+    }
+    if (!node.contains("column") || !node.contains("op")) {
+        throw std::invalid_argument("Cada condición del filtro necesita 'column' y 'op'");
+    }
+    expr.column = py::str(node["column"]);
+    expr.op = predicate::parse_op(std::string(py::str(node["op"])));
+    if (expr.op == predicate::Op::EMPTY || expr.op == predicate::Op::NOT_EMPTY) {
+        return expr;
+    }
+    if (expr.op == predicate::Op::AND || expr.op == predicate::Op::OR || expr.op == predicate::Op::NOT) {
+        throw std::invalid_argument("Use {'and': [...]}, {'or': [...]} o {'not': {...}} para combinar condiciones");
+    }
+    if (!node.contains("value")) {
+        throw std::invalid_argument("La condición sobre '" + expr.column + "' necesita 'value'");
+    }
+    py::object value = node["value"];
+    if (expr.op == predicate::Op::IN) {
+        std::vector<std::string> values;
+        for (auto item : py::cast<py::iterable>(value)) {
+            values.emplace_back(py::str(item));
+        }
+        predicate::set_values(expr, std::move(values));
+        return expr;
+    }
+
+    py::object low = value, high = py::none();
+    if (expr.op == predicate::Op::BETWEEN) {
+        py::sequence bounds = py::cast<py::sequence>(value);
+        if (bounds.size() != 2) {
+            throw std::invalid_argument("'between' sobre '" + expr.column + "' necesita [desde, hasta]");
+        }
+        low = bounds[0];
+        high = bounds[1];
+    }
+    if (node.contains("type")) {
+        expr.type = predicate::parse_type(std::string(py::str(node["type"])));
+    } else if (!PyBool_Check(low.ptr()) && (PyLong_Check(low.ptr()) || PyFloat_Check(low.ptr()))) {
+        expr.type = predicate::Type::NUMBER;
+    }
+    const std::string low_text = py::str(low);
+    const std::string high_text = high.is_none() ? std::string() : std::string(py::str(high));
+    predicate::set_bounds(expr, low_text, high_text);
+    return expr;
 }
 
-// Implementación base: solo C++, sin tipos de pybind11.
-// Se usa tanto en read_csv como en read_csv_dicts.
-std::vector<std::vector<std::string>>
-read_csv_impl(const std::string &filename, char delimiter) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("No se pudo abrir el archivo CSV: " + filename);
+// None = sin filtro de filas.
+std::shared_ptr<predicate::Expr> row_filter(const py::object &where) {
+    if (where.is_none()) {
+        return nullptr;
     }
+    return std::make_shared<predicate::Expr>(filter_expr(py::cast<py::dict>(where)));
+}
 
-    std::vector<std::vector<std::string>> result;
-    std::string line;
+// Crea una sola vez las llaves de los dicts para las columnas elegidas.
+std::vector<py::str> make_keys(const std::vector<std::string> &header,
+                               const std::vector<std::size_t> &columns) {
+    std::vector<py::str> keys;
+    keys.reserve(columns.size());
+    for (std::size_t j : columns) {
+        keys.emplace_back(header[j]);
+    }
+    return keys;
+}
 
-    while (std::getline(file, line)) {
-        // Manejo de \r\n (Windows): quitar \r del final si existe.
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+// Agrega a `out` un dict por fila del chunk, mapeando header -> valor solo
+// para las columnas elegidas (`keys` va en paralelo a `columns`).
+void append_dict_rows(py::list &out, const ChunkArena &arena,
+                      const std::vector<py::str> &keys,
+                      const std::vector<std::size_t> &columns, const py::str &empty) {
+    for (std::size_t r = 0; r < arena.rows(); ++r) {
+        py::dict d;
+        const std::size_t cols = arena.row_size(r);
+        for (std::size_t k = 0; k < columns.size(); ++k) {
+            // Si la fila tiene menos columnas que el header, rellenar con vacío
+            d[keys[k]] = columns[k] < cols ? to_py_str(arena.cell(r, columns[k])) : empty;
         }
+        out.append(std::move(d));
+    }
+}
+
+// Estimación de lo que ocupan los objetos de Python de un chunk (CPython de
+// 64 bits): str compacto = 49 bytes + contenido (el "" vacío es compartido),
+// lista = 56 + 8 por elemento y dict ~ 64 + 48 por entrada (tabla a 2/3 de
+// carga), más el apuntador en la lista de resultados. Sobrestima un poco
+// los números de read_and_validate_csv, que salen como float.
+constexpr std::size_t kPyStrBytes = 49;
+constexpr std::size_t kPyListBytes = 56;
+constexpr std::size_t kPyDictBytes = 64;
+constexpr std::size_t kPyDictEntryBytes = 48;
+constexpr std::size_t kPyPointerBytes = 8;
 
-        // Si quieres saltar filas totalmente vacías
-        if (line.empty()) {
-            continue;
+// `columns` nullptr = todas las celdas de cada fila; `dicts` = filas como dict.
+std::size_t py_rows_bytes(const ChunkArena &arena, const std::vector<std::size_t> *columns, bool dicts) {
+    std::size_t total = 0;
+    for (std::size_t r = 0; r < arena.rows(); ++r) {
+        const std::size_t cols = arena.row_size(r);
+        const std::size_t width = columns ? columns->size() : cols;
+        total += kPyPointerBytes + (dicts ? kPyDictBytes + kPyDictEntryBytes * width
+                                          : kPyListBytes + kPyPointerBytes * width);
+        for (std::size_t k = 0; k < width; ++k) {
+            const std::size_t j = columns ? (*columns)[k] : k;
+            const std::size_t length = j < cols ? arena.cell(r, j).size() : 0;
+            if (length > 0) total += kPyStrBytes + length;
         }
+    }
+    return total;
+}
 
-        auto row = parse_csv_line(line, delimiter);
-        result.emplace_back(std::move(row));
+// Llena `stats` (dict, o None para no reportar) con lo que midió el
+// presupuesto de memoria de la llamada, en bytes.
+void report_memory(const py::object &stats, const MemoryBudget &budget,
+                   std::size_t arena_bytes, std::size_t python_bytes) {
+    if (stats.is_none()) {
+        return;
     }
+    py::dict out = py::cast<py::dict>(stats);
+    out["memory_limit"] = py::cast(budget.limit());
+    out["peak_bytes"] = py::cast(budget.peak());
+    out["arena_bytes"] = py::cast(arena_bytes);
+    out["python_bytes"] = py::cast(python_bytes);
+}
 
-    return result;
+// Agrega a `stats` los contadores por fase de la llamada (core/metrics.hpp):
+// volumen, '<fase>_ns' por fase, 'gil_ns' (tiempo con el GIL tomado) y
+// 'total_ns'.
+void report_counters(const py::object &stats, const metrics::CallStats &counters,
+                     std::uint64_t total_ns, std::uint64_t gil_ns) {
+    py::dict out = py::cast<py::dict>(stats);
+    out["bytes_read"] = py::cast(metrics::read(counters.bytes_read));
+    out["rows"] = py::cast(metrics::read(counters.rows));
+    out["cells"] = py::cast(metrics::read(counters.cells));
+    out["filtered_rows"] = py::cast(metrics::read(counters.filtered_rows));
+    out["allocations"] = py::cast(metrics::read(counters.allocations));
+    out["errors"] = py::cast(metrics::read(counters.errors));
+    for (std::size_t p = 0; p < metrics::kPhases; ++p) {
+        const std::string key = std::string(metrics::phase_name(static_cast<metrics::Phase>(p))) + "_ns";
+        out[py::str(key)] = py::cast(metrics::read(counters.phase_ns[p]));
+    }
+    out["gil_ns"] = py::cast(gil_ns);
+    out["total_ns"] = py::cast(total_ns);
 }
 
-}  // namespace
+// Callback de avance para progress::Tracker: toma el GIL solo en los puntos
+// de control y llama fn(filas, bytes, bytes_totales). `fn` y `total_bytes`
+// son de la llamada y viven más que su Tracker.
+progress::Tracker::Callback progress_callback(const py::object &fn, const std::uint64_t *total_bytes) {
+    if (fn.is_none()) return nullptr;
+    const py::object *callable = &fn;
+    return [callable, total_bytes](std::uint64_t rows, std::uint64_t bytes) {
+        py::gil_scoped_acquire acquire;
+        (*callable)(rows, bytes, *total_bytes);
+    };
+}
 
-// Estructuras para validación
-namespace validation {
+// Medición de una llamada síncrona, solo si se pidió `stats`: los
+// contadores por fase del núcleo más el tiempo total y el tiempo sin el GIL.
+class CallMeter {
+public:
+    // Suma un bloque al tiempo sin el GIL; se declara antes del
+    // gil_scoped_release para incluir la espera por recuperarlo.
+    class Released {
+    public:
+        explicit Released(std::uint64_t *ns) : ns_(ns), started_(ns ? metrics::now_ns() : 0) {}
+        ~Released() {
+            if (ns_) *ns_ += metrics::now_ns() - started_;
+        }
+        Released(const Released &) = delete;
+        Released &operator=(const Released &) = delete;
 
-enum class FieldType {
-    TEXT,
-    NUMBER,
-    SCALE,
-    SINGLE
-};
+    private:
+        std::uint64_t *ns_;
+        std::uint64_t started_;
+    };
 
-struct ValidationRule {
-    FieldType type;
-    double min_value = 0.0;
-    double max_value = 10.0;
-    std::unordered_set<std::string> valid_options;
-};
+    explicit CallMeter(const py::object &stats)
+        : counters_(stats.is_none() ? nullptr : &storage_),
+          started_(counters_ ? metrics::now_ns() : 0) {}
 
-struct ValidationError {
-    size_t row_index;
-    std::string column;
-    std::string value;
-    std::string message;
+    // nullptr si no se mide.
+    metrics::CallStats *counters() { return counters_; }
+
+    Released released() { return Released(counters_ ? &released_ns_ : nullptr); }
+
+    void report(const py::object &stats) const {
+        if (counters_ == nullptr) {
+            return;
+        }
+        const std::uint64_t total = metrics::now_ns() - started_;
+        report_counters(stats, storage_, total, total > released_ns_ ? total - released_ns_ : 0);
+    }
+
+private:
+    metrics::CallStats storage_;
+    metrics::CallStats *counters_;
+    std::uint64_t started_;
+    std::uint64_t released_ns_ = 0;
 };
 
-// Trim whitespace
-inline std::string trim(const std::string& str) {
-    auto start = str.begin();
-    while (start != str.end() && std::isspace(*start)) {
-        ++start;
+// Obtiene vistas UTF-8 de una lista de str de Python sin copiarlas; None y
+// valores no-str cuentan como celda vacía. Requiere el GIL y que `values`
+// siga vivo mientras se usen las vistas.
+std::vector<std::string_view> utf8_views(const py::list &values) {
+    std::vector<std::string_view> views;
+    views.reserve(values.size());
+    for (auto value : values) {
+        Py_ssize_t size = 0;
+        const char *data = PyUnicode_Check(value.ptr())
+            ? PyUnicode_AsUTF8AndSize(value.ptr(), &size)
+            : nullptr;
+        if (data == nullptr) {
+            PyErr_Clear();
+            views.emplace_back();
+        } else {
+            views.emplace_back(data, static_cast<std::size_t>(size));
+        }
     }
-    auto end = str.end();
-    do {
-        --end;
-    } while (std::distance(start, end) > 0 && std::isspace(*end));
-    return std::string(start, end + 1);
+    return views;
 }
 
-// Convierte string a FieldType
-FieldType parse_field_type(const std::string& type_str) {
-    std::string lower = type_str;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
-    if (lower == "number") return FieldType::NUMBER;
-    if (lower == "scale") return FieldType::SCALE;
-    if (lower == "single") return FieldType::SINGLE;
-    return FieldType::TEXT;
-}
+}  // namespace
+
+namespace validation {
+
+using namespace csvcore::validation;
 
 // Parsea el esquema de validación desde Python dict
 std::unordered_map<std::string, ValidationRule> parse_schema(const py::dict& schema) {
@@ -166,7 +365,7 @@ std::unordered_map<std::string, ValidationRule> parse_schema(const py::dict& sch
             py::list options = py::cast<py::list>(column_rules["options"]);
             for (auto opt : options) {
                 std::string opt_str = py::str(opt);
-                rule.valid_options.insert(trim(opt_str));
+                rule.valid_options.emplace(trim(opt_str));
             }
         }
         
@@ -176,191 +375,328 @@ std::unordered_map<std::string, ValidationRule> parse_schema(const py::dict& sch
     return rules;
 }
 
-// Valida y convierte un valor según la regla
-py::object validate_value(const std::string& value, const ValidationRule& rule, 
-                          size_t row_idx, const std::string& column,
-                          std::vector<ValidationError>& errors) {
-    std::string trimmed = trim(value);
-    
-    // Valor vacío
-    if (trimmed.empty()) {
-        return py::none();
+// Convierte el resultado de validar una celda a un objeto de Python
+py::object to_py(const ValidatedValue& value) {
+    switch (value.kind) {
+        case ValueKind::NUMBER:
+            return py::cast(value.number);
+        case ValueKind::TEXT:
+            return to_py_str(value.text);
+        case ValueKind::NONE:
+        default:
+            return py::none();
     }
-    
-    switch (rule.type) {
-        case FieldType::NUMBER: {
-            try {
-                size_t pos;
-                double num = std::stod(trimmed, &pos);
-                // Verificar que se consumió todo el string
-                if (pos != trimmed.length()) {
-                    errors.push_back({row_idx, column, value, "No es un número válido"});
-                    return py::none();
-                }
-                return py::cast(num);
-            } catch (...) {
-                errors.push_back({row_idx, column, value, "No es un número válido"});
-                return py::none();
-            }
+}
+
+}  // namespace validation
+
+namespace multiselect = csvcore::multiselect;
+namespace discovery = csvcore::discovery;
+namespace stats = csvcore::stats;
+namespace crosstab = csvcore::crosstab;
+namespace correlation = csvcore::correlation;
+namespace text = csvcore::text;
+namespace lexicon = csvcore::lexicon;
+namespace pii = csvcore::pii;
+namespace search = csvcore::search;
+namespace nps = csvcore::nps;
+namespace cube = csvcore::cube;
+namespace writer = csvcore::writer;
+namespace pgcopy = csvcore::pgcopy;
+
+// Función original: devuelve list[list[str]]. Con proyección o filtro, la
+// primera fila hace de header para resolver nombres y todas las filas traen
+// solo las columnas elegidas (vacío si a la fila le faltan).
+// Con `memory_limit` (bytes, 0 = sin límite) el arena y los objetos creados
+// se cargan a un presupuesto: los chunks se achican al acercarse al límite y
+// se lanza MemoryError antes de pasarlo. `stats` (dict) recibe el pico de
+// memoria y los contadores por fase de la llamada.
+py::list read_csv(const std::string &filename, char delimiter = ',',
+                  const py::object &usecols = py::none(),
+                  const std::vector<std::string> &drop_patterns = std::vector<std::string>(),
+                  const py::object &where = py::none(),
+                  std::size_t memory_limit = 0,
+                  const py::object &stats = py::none(),
+                  const py::object &on_progress = py::none(),
+                  std::uint64_t progress_rows = progress::kDefaultEveryRows,
+                  std::uint64_t progress_bytes = progress::kDefaultEveryBytes,
+                  const progress::CancelToken *cancel = nullptr) {
+    trace::Span span("read_csv");
+    const projection::Spec spec = projection_spec(usecols, drop_patterns);
+    std::shared_ptr<predicate::Expr> filter = row_filter(where);
+    MemoryBudget budget(memory_limit);
+    BudgetLease arena_lease(&budget, "el arena");
+    BudgetLease objects(&budget, "los objetos de Python");
+    CallMeter meter(stats);
+    std::uint64_t total_bytes = 0;
+    progress::Tracker tracker(cancel, progress_callback(on_progress, &total_bytes), progress_rows, progress_bytes);
+    metrics::PhaseClock clock(meter.counters());
+    py::list py_rows;
+    ChunkArena arena;
+    std::unique_ptr<CsvChunkReader> reader;
+    projection::Selection selection;
+
+    if (spec.active() || filter) {
+        std::vector<std::string> header;
+        {
+            const auto unlocked = meter.released();
+            py::gil_scoped_release release;
+            reader = std::make_unique<CsvChunkReader>(filename, delimiter);
+            reader->set_stats(meter.counters());
+            header = read_header(*reader, arena);
+            selection = csvcore::prepare_reader(*reader, header, spec, std::move(filter));
+            reader->set_progress(&tracker);
+            total_bytes = csvcore::file_size(filename) - reader->position();
         }
-        
-        case FieldType::SCALE: {
-            try {
-                size_t pos;
-                double num = std::stod(trimmed, &pos);
-                if (pos != trimmed.length()) {
-                    errors.push_back({row_idx, column, value, "No es un número válido para escala"});
-                    return py::none();
-                }
-                if (num < rule.min_value || num > rule.max_value) {
-                    std::ostringstream oss;
-                    oss << "Valor fuera de rango [" << rule.min_value << ", " << rule.max_value << "]";
-                    errors.push_back({row_idx, column, value, oss.str()});
-                    return py::none();
-                }
-                return py::cast(num);
-            } catch (...) {
-                errors.push_back({row_idx, column, value, "No es un número válido para escala"});
-                return py::none();
+        if (header.empty()) {
+            return py_rows;
+        }
+        py::list row(selection.columns.size());
+        for (std::size_t k = 0; k < selection.columns.size(); ++k) {
+            row[k] = to_py_str(header[selection.columns[k]]);
+        }
+        py_rows.append(std::move(row));
+    }
+    const py::str empty("");
+
+    while (true) {
+        bool has_rows;
+        {
+            // Liberamos el GIL mientras hacemos I/O y parsing en C++
+            const auto unlocked = meter.released();
+            py::gil_scoped_release release;
+            if (!reader) {
+                reader = std::make_unique<CsvChunkReader>(filename, delimiter);
+                reader->set_stats(meter.counters());
+                reader->set_progress(&tracker);
+                total_bytes = csvcore::file_size(filename);
             }
+            has_rows = reader->next_chunk(arena, csvcore::kChunkRows, budget.chunk_bytes());
+            arena_lease.resize(arena.footprint());
         }
-        
-        case FieldType::SINGLE: {
-            if (!rule.valid_options.empty()) {
-                if (rule.valid_options.find(trimmed) == rule.valid_options.end()) {
-                    errors.push_back({row_idx, column, value, "Opción no válida"});
-                    return py::none();
+        if (!has_rows) {
+            break;
+        }
+        clock.restart();
+        objects.add(py_rows_bytes(arena, selection.all ? nullptr : &selection.columns, false));
+
+        for (std::size_t r = 0; r < arena.rows(); ++r) {
+            const std::size_t cols = arena.row_size(r);
+            if (selection.all) {
+                py::list row(cols);
+                for (std::size_t j = 0; j < cols; ++j) {
+                    row[j] = to_py_str(arena.cell(r, j));
                 }
+                py_rows.append(std::move(row));
+                continue;
+            }
+            py::list row(selection.columns.size());
+            for (std::size_t k = 0; k < selection.columns.size(); ++k) {
+                const std::size_t j = selection.columns[k];
+                row[k] = j < cols ? to_py_str(arena.cell(r, j)) : empty;
             }
-            return py::str(trimmed);
+            py_rows.append(std::move(row));
         }
-        
-        case FieldType::TEXT:
-        default:
-            return py::str(trimmed);
+        clock.mark(metrics::CONVERT);
     }
-}
 
-}  // namespace validation
-
-// Función original: devuelve list[list[str]] (vector<vector<string>>)
-std::vector<std::vector<std::string>>
-read_csv(const std::string &filename, char delimiter = ',') {
-    // Liberamos el GIL mientras hacemos I/O y parsing en C++
-    py::gil_scoped_release release;
-    auto result = read_csv_impl(filename, delimiter);
-    return result;
+    tracker.finish();
+    span.arg("rows", static_cast<std::int64_t>(py_rows.size()));
+    clock.flush();
+    report_memory(stats, budget, arena_lease.peak(), objects.peak());
+    meter.report(stats);
+    return py_rows;
 }
 
 // Nueva función: devuelve list[dict], mapeando header -> valor
-py::list read_csv_dicts(const std::string &filename, char delimiter = ',') {
-    std::vector<std::vector<std::string>> rows;
+py::list read_csv_dicts(const std::string &filename, char delimiter = ',',
+                        const py::object &usecols = py::none(),
+                        const std::vector<std::string> &drop_patterns = std::vector<std::string>(),
+                        const py::object &where = py::none(),
+                        std::size_t memory_limit = 0,
+                        const py::object &stats = py::none(),
+                        const py::object &on_progress = py::none(),
+                        std::uint64_t progress_rows = progress::kDefaultEveryRows,
+                        std::uint64_t progress_bytes = progress::kDefaultEveryBytes,
+                        const progress::CancelToken *cancel = nullptr) {
+    trace::Span span("read_csv_dicts");
+    const projection::Spec spec = projection_spec(usecols, drop_patterns);
+    std::shared_ptr<predicate::Expr> filter = row_filter(where);
+    MemoryBudget budget(memory_limit);
+    BudgetLease arena_lease(&budget, "el arena");
+    BudgetLease objects(&budget, "los objetos de Python");
+    CallMeter meter(stats);
+    std::uint64_t total_bytes = 0;
+    progress::Tracker tracker(cancel, progress_callback(on_progress, &total_bytes), progress_rows, progress_bytes);
+    metrics::PhaseClock clock(meter.counters());
+    py::list py_rows;
+    ChunkArena arena;
+    std::unique_ptr<CsvChunkReader> reader;
+    std::vector<std::string> header;
+    projection::Selection selection;
 
     {
-        // Leer y parsear CSV sin GIL (solo C++)
+        // Leer y parsear el encabezado sin GIL (solo C++)
+        const auto unlocked = meter.released();
         py::gil_scoped_release release;
-        rows = read_csv_impl(filename, delimiter);
+        reader = std::make_unique<CsvChunkReader>(filename, delimiter);
+        reader->set_stats(meter.counters());
+        header = read_header(*reader, arena);
+        selection = csvcore::prepare_reader(*reader, header, spec, std::move(filter));
+        reader->set_progress(&tracker);
+        total_bytes = csvcore::file_size(filename) - reader->position();
     }  // Aquí se recupera el GIL automáticamente
 
-    py::list py_rows;
-
-    if (rows.empty()) {
+    if (header.empty()) {
         return py_rows;
     }
 
-    const auto &header = rows.front();
+    // Las llaves se crean una sola vez y se reutilizan en todas las filas
+    const std::vector<py::str> keys = make_keys(header, selection.columns);
+    const py::str empty("");
 
-    for (std::size_t i = 1; i < rows.size(); ++i) {
-        const auto &row = rows[i];
-        py::dict d;
-
-        // Emparejar columnas que existan en ambas
-        std::size_t cols = std::min(header.size(), row.size());
-        for (std::size_t j = 0; j < cols; ++j) {
-            d[py::str(header[j])] = py::str(row[j]);
+    while (true) {
+        bool has_rows;
+        {
+            const auto unlocked = meter.released();
+            py::gil_scoped_release release;
+            has_rows = reader->next_chunk(arena, csvcore::kChunkRows, budget.chunk_bytes());
+            arena_lease.resize(arena.footprint());
         }
-
-        // Si la fila tiene menos columnas que el header, rellenar con vacío
-        if (row.size() < header.size()) {
-            for (std::size_t j = row.size(); j < header.size(); ++j) {
-                d[py::str(header[j])] = py::str("");
-            }
+        if (!has_rows) {
+            break;
         }
-
-        py_rows.append(std::move(d));
+        clock.restart();
+        objects.add(py_rows_bytes(arena, &selection.columns, true));
+        append_dict_rows(py_rows, arena, keys, selection.columns, empty);
+        clock.mark(metrics::CONVERT);
     }
 
+    tracker.finish();
+    span.arg("rows", static_cast<std::int64_t>(py_rows.size()));
+    clock.flush();
+    report_memory(stats, budget, arena_lease.peak(), objects.peak());
+    meter.report(stats);
     return py_rows;
 }
 
 // Nueva función: leer, validar y convertir datos según esquema
-py::dict read_and_validate_csv(const std::string& filename, 
+py::dict read_and_validate_csv(const std::string& filename,
                                 const py::dict& schema,
-                                char delimiter = ',') {
-    std::vector<std::vector<std::string>> rows;
-    
+                                char delimiter = ',',
+                                const py::object &usecols = py::none(),
+                                const std::vector<std::string> &drop_patterns = std::vector<std::string>(),
+                                const py::object &where = py::none(),
+                                std::size_t memory_limit = 0,
+                                const py::object &stats = py::none(),
+                                const py::object &on_progress = py::none(),
+                                std::uint64_t progress_rows = progress::kDefaultEveryRows,
+                                std::uint64_t progress_bytes = progress::kDefaultEveryBytes,
+                                const progress::CancelToken *cancel = nullptr) {
+    trace::Span span("read_and_validate_csv");
+    const projection::Spec spec = projection_spec(usecols, drop_patterns);
+    std::shared_ptr<predicate::Expr> filter = row_filter(where);
+    MemoryBudget budget(memory_limit);
+    BudgetLease arena_lease(&budget, "el arena");
+    BudgetLease objects(&budget, "los objetos de Python");
+    CallMeter meter(stats);
+    std::uint64_t total_bytes = 0;
+    progress::Tracker tracker(cancel, progress_callback(on_progress, &total_bytes), progress_rows, progress_bytes);
+    metrics::PhaseClock clock(meter.counters());
+    ChunkArena arena;
+    std::unique_ptr<CsvChunkReader> reader;
+    std::vector<std::string> header;
+    projection::Selection selection;
+
     {
-        // Leer y parsear CSV sin GIL (solo C++)
+        // Leer y parsear el encabezado sin GIL (solo C++)
+        const auto unlocked = meter.released();
         py::gil_scoped_release release;
-        rows = read_csv_impl(filename, delimiter);
+        reader = std::make_unique<CsvChunkReader>(filename, delimiter);
+        reader->set_stats(meter.counters());
+        header = read_header(*reader, arena);
+        selection = csvcore::prepare_reader(*reader, header, spec, std::move(filter));
+        reader->set_progress(&tracker);
+        total_bytes = csvcore::file_size(filename) - reader->position();
     }
-    
+
     // Parsear esquema de validación
     auto rules = validation::parse_schema(schema);
-    
+
     py::list validated_data;
     std::vector<validation::ValidationError> errors;
-    
-    if (rows.empty()) {
+
+    if (header.empty()) {
         py::dict result;
         result["data"] = validated_data;
         result["errors"] = py::list();
         return result;
     }
-    
-    const auto& header = rows.front();
-    
-    // Crear mapa de índice de columnas
-    std::unordered_map<std::string, size_t> column_indices;
-    for (size_t j = 0; j < header.size(); ++j) {
-        column_indices[header[j]] = j;
+
+    // Resolver la regla de cada columna elegida una sola vez (nullptr = sin regla)
+    const std::vector<std::size_t> &columns = selection.columns;
+    const std::vector<py::str> keys = make_keys(header, columns);
+    std::vector<const validation::ValidationRule*> column_rules;
+    column_rules.reserve(columns.size());
+    for (std::size_t j : columns) {
+        auto rule_it = rules.find(header[j]);
+        column_rules.push_back(rule_it != rules.end() ? &rule_it->second : nullptr);
     }
-    
+
+    // Índice de fila como antes: 1 = primera fila de datos
+    size_t row_index = 0;
+
     // Validar y convertir cada fila
-    for (size_t i = 1; i < rows.size(); ++i) {
-        const auto& row = rows[i];
-        py::dict row_dict;
-        bool row_has_critical_error = false;
-        
-        // Procesar cada columna según el header
-        size_t cols = std::min(header.size(), row.size());
-        for (size_t j = 0; j < cols; ++j) {
-            const std::string& col_name = header[j];
-            const std::string& cell_value = row[j];
-            
-            // Si existe regla de validación para esta columna
-            auto rule_it = rules.find(col_name);
-            if (rule_it != rules.end()) {
-                py::object validated = validation::validate_value(
-                    cell_value, rule_it->second, i, col_name, errors
-                );
-                row_dict[py::str(col_name)] = validated;
-            } else {
-                // Sin regla, pasar como string
-                row_dict[py::str(col_name)] = py::str(validation::trim(cell_value));
-            }
+    while (true) {
+        bool has_rows;
+        {
+            const auto unlocked = meter.released();
+            py::gil_scoped_release release;
+            has_rows = reader->next_chunk(arena, csvcore::kChunkRows, budget.chunk_bytes());
+            arena_lease.resize(arena.footprint());
         }
-        
-        // Rellenar columnas faltantes con None
-        if (row.size() < header.size()) {
-            for (size_t j = row.size(); j < header.size(); ++j) {
-                row_dict[py::str(header[j])] = py::none();
+        if (!has_rows) {
+            break;
+        }
+        clock.restart();
+        objects.add(py_rows_bytes(arena, &columns, true));
+
+        for (std::size_t r = 0; r < arena.rows(); ++r) {
+            ++row_index;
+            py::dict row_dict;
+
+            // Procesar cada columna elegida según el header
+            const size_t cols = arena.row_size(r);
+            for (size_t k = 0; k < columns.size(); ++k) {
+                const size_t j = columns[k];
+
+                // Rellenar columnas faltantes con None
+                if (j >= cols) {
+                    row_dict[keys[k]] = py::none();
+                    continue;
+                }
+
+                std::string_view cell_value = arena.cell(r, j);
+
+                // Si existe regla de validación para esta columna
+                if (column_rules[k] != nullptr) {
+                    clock.mark(metrics::CONVERT);
+                    const validation::ValidatedValue value = validation::validate_value(
+                        cell_value, *column_rules[k], row_index, header[j], errors
+                    );
+                    clock.mark(metrics::VALIDATE);
+                    row_dict[keys[k]] = validation::to_py(value);
+                } else {
+                    // Sin regla, pasar como string
+                    row_dict[keys[k]] = to_py_str(validation::trim(cell_value));
+                }
             }
+
+            validated_data.append(std::move(row_dict));
         }
-        
-        validated_data.append(std::move(row_dict));
+        clock.mark(metrics::CONVERT);
     }
-    
+
     // Convertir errores a lista de dicts Python
     py::list error_list;
     for (const auto& err : errors) {
@@ -371,23 +707,1035 @@ py::dict read_and_validate_csv(const std::string& filename,
         err_dict["message"] = py::str(err.message);
         error_list.append(std::move(err_dict));
     }
-    
+
+    tracker.finish();
+    span.arg("rows", static_cast<std::int64_t>(validated_data.size()));
+    span.arg("errors", static_cast<std::int64_t>(errors.size()));
+    clock.flush();
+    if (meter.counters()) metrics::bump(meter.counters()->errors, errors.size());
+    report_memory(stats, budget, arena_lease.peak(), objects.peak());
+    meter.report(stats);
     py::dict result;
     result["data"] = validated_data;
     result["errors"] = error_list;
     return result;
 }
 
+// Divide una celda multi-selección en opciones limpias y sin duplicados.
+py::list split_multi_select(const std::string &value,
+                            const std::string &separators = ",;",
+                            char quote = '"') {
+    multiselect::CellTokenizer tokenizer(separators, quote);
+    tokenizer.split(value);
+    py::list tokens;
+    for (std::size_t i = 0; i < tokenizer.size(); ++i) {
+        tokens.append(to_py_str(tokenizer.token(i)));
+    }
+    return tokens;
+}
+
+// Mapea una columna completa de celdas multi-selección a pares
+// (fila, option_id); los tokens sin opción se devuelven aparte.
+py::dict map_multi_select(const multiselect::OptionMapper &mapper, const py::list &cells) {
+    std::vector<std::string_view> views = utf8_views(cells);
+    multiselect::MappedColumn mapped;
+    {
+        py::gil_scoped_release release;
+        mapped = mapper.map(views);
+    }
+
+    py::list unknown_tokens;
+    for (const auto &span : mapped.unknown_spans) {
+        unknown_tokens.append(to_py_str(
+            std::string_view(mapped.unknown_bytes.data() + span.first, span.second)));
+    }
+
+    py::dict result;
+    result["rows"] = py::cast(mapped.rows);
+    result["option_ids"] = py::cast(mapped.option_ids);
+    result["unknown_rows"] = py::cast(mapped.unknown_rows);
+    result["unknown_tokens"] = unknown_tokens;
+    return result;
+}
+
+// Estadísticas de una pregunta numérica desde arreglos (valor, conteo):
+// resumen, cuantiles exactos e histograma de rangos, sin expandir conteos.
+py::dict numeric_stats(const std::vector<double> &values,
+                       const std::vector<std::int64_t> &counts,
+                       const std::vector<double> &quantiles,
+                       std::size_t bins = 10) {
+    trace::Span span("numeric_stats");
+    span.arg("values", static_cast<std::int64_t>(values.size()));
+    stats::Summary summary;
+    double median = 0.0;
+    std::vector<double> quantile_values;
+    stats::Histogram hist;
+    {
+        py::gil_scoped_release release;
+        stats::Distribution dist = stats::build_distribution(values, counts);
+        summary = stats::summarize(dist);
+        if (!dist.empty()) {
+            median = stats::quantile(dist, 0.5);
+            for (double q : quantiles) {
+                quantile_values.push_back(stats::quantile(dist, q));
+            }
+            hist = stats::histogram(dist, bins);
+        }
+    }
+
+    py::dict result;
+    result["count"] = py::cast(summary.count);
+    if (summary.count == 0) {
+        // Sin observaciones no hay estadísticas (como en el código Python)
+        for (const char *key : {"sum", "mean", "variance", "stddev", "min", "max", "median"}) {
+            result[key] = py::none();
+        }
+        result["quantiles"] = py::dict();
+        result["histogram"] = py::list();
+        return result;
+    }
+
+    result["sum"] = py::cast(summary.sum);
+    result["mean"] = py::cast(summary.mean);
+    result["variance"] = py::cast(summary.variance);
+    result["stddev"] = py::cast(summary.stddev);
+    result["min"] = py::cast(summary.min);
+    result["max"] = py::cast(summary.max);
+    result["median"] = py::cast(median);
+
+    py::dict quantile_dict;
+    for (std::size_t i = 0; i < quantiles.size(); ++i) {
+        quantile_dict[py::cast(quantiles[i])] = py::cast(quantile_values[i]);
+    }
+    result["quantiles"] = quantile_dict;
+
+    py::list histogram;
+    for (std::size_t i = 0; i < hist.counts.size(); ++i) {
+        histogram.append(py::make_tuple(hist.starts[i], hist.ends[i], hist.counts[i]));
+    }
+    result["histogram"] = histogram;
+    return result;
+}
+
+// Resultado de un grupo (global o segmento); sin respuestas, NPS e
+// intervalo son None.
+py::dict nps_result_to_dict(const nps::Result &r) {
+    py::dict out;
+    out["total"] = py::cast(r.total);
+    out["promoters"] = py::cast(r.promoters);
+    out["passives"] = py::cast(r.passives);
+    out["detractors"] = py::cast(r.detractors);
+    if (r.empty()) {
+        for (const char *key : {"score", "margin", "ci_low", "ci_high"}) out[key] = py::none();
+        return out;
+    }
+    out["score"] = py::cast(r.score);
+    out["margin"] = py::cast(r.margin);
+    out["ci_low"] = py::cast(r.low);
+    out["ci_high"] = py::cast(r.high);
+    return out;
+}
+
+// NPS global y por segmento desde arreglos (valor, conteo, segmento), con
+// intervalo de confianza analítico, en una sola pasada.
+py::dict nps_breakdown(const std::vector<double> &values,
+                       const std::vector<std::int64_t> &counts,
+                       const std::vector<std::int32_t> &segments,
+                       std::size_t num_segments = 0,
+                       double confidence = 0.95) {
+    trace::Span span("nps_breakdown");
+    span.arg("values", static_cast<std::int64_t>(values.size()));
+    nps::Breakdown breakdown;
+    {
+        py::gil_scoped_release release;
+        breakdown = nps::compute(values, counts, segments, num_segments, confidence);
+    }
+
+    py::list segment_list;
+    for (const nps::Result &r : breakdown.segments) segment_list.append(nps_result_to_dict(r));
+    py::dict result;
+    result["overall"] = nps_result_to_dict(breakdown.overall);
+    result["segments"] = segment_list;
+    return result;
+}
+
+// Tabla cruzada de dos preguntas desde pares (response_id, categoría);
+// regresa la estructura 'split' de pandas (index, columns, data).
+py::dict build_crosstab(const std::vector<std::int64_t> &universe,
+                        const std::vector<std::int64_t> &row_ids,
+                        const py::list &row_labels,
+                        const std::vector<std::int64_t> &col_ids,
+                        const py::list &col_labels,
+                        std::size_t top_k = 10,
+                        const std::string &missing_label = "Sin respuesta",
+                        const std::string &other_label = "Otros",
+                        const std::string &total_label = "Total") {
+    trace::Span span("build_crosstab");
+    span.arg("rows", static_cast<std::int64_t>(row_ids.size()));
+    // Las vistas apuntan al buffer UTF-8 de cada str (las listas siguen vivas)
+    std::vector<std::string_view> row_views = utf8_views(row_labels);
+    std::vector<std::string_view> col_views = utf8_views(col_labels);
+
+    crosstab::Options options;
+    options.top_k = top_k;
+    options.missing_label = missing_label;
+    options.other_label = other_label;
+    options.total_label = total_label;
+
+    crosstab::Table table;
+    {
+        py::gil_scoped_release release;
+        table = crosstab::build(universe, row_ids, row_views, col_ids, col_views, options);
+    }
+
+    py::list index;
+    for (const auto &label : table.rows) index.append(to_py_str(label));
+    py::list columns;
+    for (const auto &label : table.cols) columns.append(to_py_str(label));
+    py::list data;
+    const std::size_t width = table.cols.size();
+    for (std::size_t r = 0; r < table.rows.size(); ++r) {
+        py::list row;
+        for (std::size_t c = 0; c < width; ++c) {
+            row.append(py::cast(table.counts[r * width + c]));
+        }
+        data.append(std::move(row));
+    }
+
+    py::dict split;
+    split["index"] = index;
+    split["columns"] = columns;
+    split["data"] = data;
+
+    py::dict result;
+    result["data"] = split;
+    result["total_responses"] = py::cast(table.total);
+    result["row_categories"] = py::cast(table.row_categories);
+    result["col_categories"] = py::cast(table.col_categories);
+    return result;
+}
+
+// Matriz de correlación (pairwise-complete) entre preguntas numéricas desde
+// tripletas (response_id, question_id, valor).
+py::dict correlation_matrix(const std::vector<std::int64_t> &response_ids,
+                            const std::vector<std::int64_t> &question_ids,
+                            const std::vector<double> &values,
+                            const std::vector<std::int64_t> &columns,
+                            const std::string &method = "pearson",
+                            std::size_t max_columns = 20) {
+    trace::Span span("correlation_matrix");
+    span.arg("values", static_cast<std::int64_t>(values.size()));
+    correlation::Method kind;
+    if (method == "pearson") {
+        kind = correlation::Method::PEARSON;
+    } else if (method == "spearman") {
+        kind = correlation::Method::SPEARMAN;
+    } else {
+        throw std::invalid_argument("method debe ser 'pearson' o 'spearman'");
+    }
+
+    correlation::Result corr;
+    {
+        py::gil_scoped_release release;
+        corr = correlation::compute(response_ids, question_ids, values, columns, kind, max_columns);
+    }
+
+    const std::size_t n = corr.columns.size();
+    py::list matrix;
+    py::list pairs;
+    for (std::size_t a = 0; a < n; ++a) {
+        py::list row;
+        py::list row_pairs;
+        for (std::size_t b = 0; b < n; ++b) {
+            const double r = corr.matrix[a * n + b];
+            row.append(std::isnan(r) ? py::object(py::none()) : py::object(py::float_(r)));
+            row_pairs.append(py::cast(corr.pairs[a * n + b]));
+        }
+        matrix.append(std::move(row));
+        pairs.append(std::move(row_pairs));
+    }
+
+    py::dict result;
+    result["columns"] = py::cast(corr.columns);
+    result["matrix"] = matrix;
+    result["pairs"] = pairs;
+    return result;
+}
+
+// Minúsculas + acentos fuera; lo que no es alfanumérico queda como espacio.
+py::str fold_text(const std::string &value) {
+    std::string folded;
+    text::fold(value, folded);
+    return to_py_str(folded);
+}
+
+py::list term_counts_to_py(const std::vector<text::TermCount> &terms) {
+    py::list out;
+    for (const auto &t : terms) {
+        out.append(py::make_tuple(to_py_str(t.term), t.count));
+    }
+    return out;
+}
+
+// Palabras y bigramas más frecuentes de una lista de comentarios. `track`
+// son términos cuyo conteo se quiere aunque no entren al top (léxicos).
+py::dict analyze_texts(const py::list &texts,
+                       std::size_t min_length,
+                       const std::vector<std::string> &stopwords,
+                       std::size_t top_k,
+                       bool bigrams,
+                       const std::vector<std::string> &track) {
+    trace::Span span("analyze_texts");
+    span.arg("texts", static_cast<std::int64_t>(texts.size()));
+    std::vector<std::string_view> views = utf8_views(texts);
+
+    text::Options options;
+    options.min_length = min_length;
+    options.bigrams = bigrams;
+    // Stopwords y términos se normalizan como los tokens (sin los espacios
+    // que deja la puntuación en los extremos)
+    std::string folded;
+    for (const auto &word : stopwords) {
+        text::fold(word, folded);
+        options.stopwords.emplace(validation::trim(folded));
+    }
+
+    std::vector<text::TermCount> top_words;
+    std::vector<text::TermCount> top_bigrams;
+    std::vector<std::uint64_t> tracked;
+    std::uint64_t tokens = 0;
+    std::uint64_t documents = 0;
+    {
+        py::gil_scoped_release release;
+        text::Analyzer analyzer(std::move(options));
+        for (const auto &view : views) {
+            if (!view.empty()) analyzer.add(view);
+        }
+        top_words = analyzer.top_unigrams(top_k);
+        if (bigrams) top_bigrams = analyzer.top_bigrams(top_k);
+        for (const auto &term : track) {
+            text::fold(term, folded);
+            tracked.push_back(analyzer.count(std::string(validation::trim(folded))));
+        }
+        tokens = analyzer.tokens();
+        documents = analyzer.documents();
+    }
+
+    py::dict tracked_counts;
+    for (std::size_t i = 0; i < track.size(); ++i) {
+        tracked_counts[py::str(track[i])] = py::cast(tracked[i]);
+    }
+
+    py::dict result;
+    result["words"] = term_counts_to_py(top_words);
+    result["bigrams"] = term_counts_to_py(top_bigrams);
+    result["tracked"] = tracked_counts;
+    result["tokens"] = py::cast(tokens);
+    result["documents"] = py::cast(documents);
+    return result;
+}
+
+// Puntúa cada comentario con el léxico (una pasada por texto, sin el GIL).
+py::dict score_sentiment(const lexicon::Matcher &matcher, const py::list &texts) {
+    trace::Span span("score_sentiment");
+    span.arg("texts", static_cast<std::int64_t>(texts.size()));
+    std::vector<std::string_view> views = utf8_views(texts);
+    lexicon::Summary summary;
+    {
+        py::gil_scoped_release release;
+        summary = lexicon::score_all(matcher, views);
+    }
+
+    py::list scores;
+    for (const auto &s : summary.per_text) scores.append(py::float_(s.score));
+
+    py::dict result;
+    result["scores"] = scores;
+    result["positive"] = py::float_(summary.positive);
+    result["negative"] = py::float_(summary.negative);
+    result["matches"] = py::cast(summary.matches);
+    result["positive_texts"] = py::cast(summary.positive_texts);
+    result["negative_texts"] = py::cast(summary.negative_texts);
+    result["neutral_texts"] = py::cast(summary.neutral_texts);
+    return result;
+}
+
+// Cuenta correos, teléfonos, identificadores y documentos oficiales en
+// columnas completas de texto (una lista de valores por columna).
+py::list scan_pii(const py::list &columns) {
+    trace::Span span("scan_pii");
+    span.arg("columns", static_cast<std::int64_t>(columns.size()));
+    std::vector<py::list> lists;
+    std::vector<std::vector<std::string_view>> views;
+    lists.reserve(columns.size());
+    views.reserve(columns.size());
+    for (auto column : columns) {
+        lists.push_back(py::cast<py::list>(column));
+        views.push_back(utf8_views(lists.back()));
+    }
+
+    std::vector<pii::ColumnReport> reports(views.size());
+    {
+        py::gil_scoped_release release;
+        for (std::size_t i = 0; i < views.size(); ++i) reports[i] = pii::scan_column(views[i]);
+    }
+
+    py::list out;
+    for (const auto &report : reports) {
+        py::dict d;
+        d["values"] = py::cast(report.values);
+        d["distinct"] = py::cast(report.distinct);
+        d["emails"] = py::cast(report.emails);
+        d["phones"] = py::cast(report.phones);
+        d["identifiers"] = py::cast(report.identifiers);
+        d["national_ids"] = py::cast(report.national_ids);
+        d["flagged_rows"] = py::cast(report.flagged_rows);
+        out.append(std::move(d));
+    }
+    return out;
+}
+
+// Cita representativa: índice del texto o None.
+py::object index_best_quote(const search::TextIndex &index, const std::vector<std::string> &terms,
+                            std::size_t min_length, std::size_t max_length) {
+    std::int64_t doc;
+    {
+        py::gil_scoped_release release;
+        doc = index.best_quote(terms, min_length, max_length);
+    }
+    if (doc < 0) return py::none();
+    return py::cast(doc);
+}
+
+py::list index_keyword_in_context(const search::TextIndex &index, const std::string &term,
+                                  std::size_t width, std::size_t limit) {
+    std::vector<search::Context> contexts;
+    {
+        py::gil_scoped_release release;
+        contexts = index.keyword_in_context(term, width, limit);
+    }
+    py::list out;
+    for (const auto &c : contexts) {
+        py::dict d;
+        d["row"] = py::cast(c.doc);
+        d["left"] = to_py_str(c.left);
+        d["match"] = to_py_str(c.match);
+        d["right"] = to_py_str(c.right);
+        out.append(std::move(d));
+    }
+    return out;
+}
+
+py::list index_postings(const search::TextIndex &index, const std::string &term) {
+    std::string folded;
+    text::fold(term, folded);
+    const auto first = folded.find_first_not_of(' ');
+    const auto last = folded.find_last_not_of(' ');
+    py::list out;
+    if (first == std::string::npos) return out;
+    const auto *postings = index.postings(std::string_view(folded).substr(first, last - first + 1));
+    if (postings == nullptr) return out;
+    for (const auto &p : *postings) out.append(py::make_tuple(p.doc, p.position));
+    return out;
+}
+
+// Columna del cubo o KeyError si la pregunta no está en él.
+const cube::Column &cube_column(const cube::Cube &c, std::int64_t question_id) {
+    const cube::Column *column = c.column(question_id);
+    if (column == nullptr) throw py::key_error("La pregunta " + std::to_string(question_id) + " no está en el cubo");
+    return *column;
+}
+
+// Etiquetas [(texto, de_opción)] de una columna CHOICE o valores de una NUMERIC.
+py::list cube_dictionary(const cube::Cube &c, std::int64_t question_id) {
+    const cube::Column &column = cube_column(c, question_id);
+    py::list out;
+    for (std::size_t code = 0; code < column.dictionary; ++code) {
+        if (column.kind == cube::Kind::NUMERIC) out.append(column.values[code]);
+        else out.append(py::make_tuple(to_py_str(column.label(code)), column.label_flags[code] != 0));
+    }
+    return out;
+}
+
+const char *cube_kind(const cube::Cube &c, std::int64_t question_id) {
+    return cube_column(c, question_id).kind == cube::Kind::NUMERIC ? "numeric" : "choice";
+}
+
+py::list cube_question_ids(const cube::Cube &c) {
+    py::list out;
+    for (const cube::Column &column : c.columns()) out.append(column.question_id);
+    return out;
+}
+
+cube::RowSet cube_with_codes(const cube::Cube &c, std::int64_t question_id, const std::vector<std::uint32_t> &codes) {
+    const cube::Column &column = cube_column(c, question_id);
+    py::gil_scoped_release release;
+    return c.with_codes(column, codes);
+}
+
+cube::RowSet cube_with_values(const cube::Cube &c, std::int64_t question_id, double low, double high) {
+    const cube::Column &column = cube_column(c, question_id);
+    py::gil_scoped_release release;
+    return c.with_values(column, low, high);
+}
+
+cube::RowSet cube_days_between(const cube::Cube &c, std::int32_t first, std::int32_t last) {
+    py::gil_scoped_release release;
+    return c.days_between(first, last);
+}
+
+// Los conjuntos de filas deben venir del mismo cubo.
+const cube::RowSet *checked_rows(const cube::Cube &c, const cube::RowSet *rows) {
+    if (rows && rows->size() != c.rows()) throw py::value_error("El conjunto de filas es de otro cubo");
+    return rows;
+}
+
+std::vector<std::uint64_t> cube_code_counts(const cube::Cube &c, std::int64_t question_id, const cube::RowSet *rows) {
+    const cube::Column &column = cube_column(c, question_id);
+    checked_rows(c, rows);
+    py::gil_scoped_release release;
+    return c.code_counts(column, rows);
+}
+
+std::vector<std::pair<std::int32_t, std::uint64_t>> cube_day_counts(const cube::Cube &c, const cube::RowSet *rows) {
+    checked_rows(c, rows);
+    py::gil_scoped_release release;
+    return c.day_counts(rows);
+}
+
+std::int64_t cube_last_response_id(const cube::Cube &c, const cube::RowSet *rows) {
+    checked_rows(c, rows);
+    return c.last_response_id(rows);
+}
+
+py::list cube_response_ids(const cube::Cube &c, const cube::RowSet *rows) {
+    checked_rows(c, rows);
+    py::list out;
+    if (!rows) {
+        for (std::size_t r = 0; r < c.rows(); ++r) out.append(c.response_id(r));
+        return out;
+    }
+    rows->bits().for_each([&](std::uint32_t r) { out.append(c.response_id(r)); });
+    return out;
+}
+
+// Codifica un lote de la tabla. Las celdas llegan como listas paralelas
+// (fila, columna, texto, número, código); se arman con el GIL y se escriben
+// sin él.
+py::list encode_csv_rows(const writer::TableEncoder &encoder,
+                         std::size_t rows,
+                         const py::list &leading,
+                         const std::vector<std::uint32_t> &cell_rows,
+                         const std::vector<std::uint32_t> &cell_columns,
+                         const py::list &texts,
+                         const std::vector<double> &numbers,
+                         const std::vector<std::int64_t> &codes) {
+    const std::size_t n = cell_rows.size();
+    if (cell_columns.size() != n || static_cast<std::size_t>(texts.size()) != n || numbers.size() != n ||
+        codes.size() != n) {
+        throw py::value_error("cell_rows, cell_columns, texts, numbers y codes deben tener la misma longitud");
+    }
+    std::vector<py::list> leading_lists;
+    std::vector<std::vector<std::string_view>> leading_views;
+    for (auto column : leading) {
+        leading_lists.push_back(py::cast<py::list>(column));
+        leading_views.push_back(utf8_views(leading_lists.back()));
+    }
+    const std::vector<std::string_view> text_views = utf8_views(texts);
+    std::vector<writer::Cell> cells(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        cells[i] = writer::Cell{cell_rows[i], cell_columns[i], text_views[i], numbers[i], codes[i]};
+    }
+
+    std::vector<std::string> chunks;
+    {
+        py::gil_scoped_release release;
+        chunks = encoder.encode(rows, leading_views, std::move(cells));
+    }
+    py::list out;
+    for (const std::string &chunk : chunks) out.append(py::bytes(chunk));
+    return out;
+}
+
+// Codifica un lote de COPY binario: `columns` = [[valor o None] por fila]
+// en el orden de los tipos del codificador. Los buffers de columna del
+// codificador se reutilizan y el resultado se escribe directo en el bytes
+// de salida, con el GIL liberado.
+py::bytes encode_pgcopy(pgcopy::Encoder &encoder, const py::list &columns, bool header, bool trailer) {
+    const std::vector<pgcopy::Type> &types = encoder.types();
+    if (static_cast<std::size_t>(columns.size()) != types.size()) {
+        throw py::value_error("Se esperaban " + std::to_string(types.size()) + " columnas");
+    }
+    encoder.clear();
+    std::vector<py::list> lists;
+    lists.reserve(types.size());
+    for (std::size_t c = 0; c < types.size(); ++c) {
+        lists.push_back(py::cast<py::list>(columns[c]));
+        pgcopy::Column &column = encoder.column(c);
+        const py::list &values = lists.back();
+        column.nulls.reserve(values.size());
+        for (auto value : values) {
+            const bool null = value.is_none();
+            column.nulls.push_back(null ? 1 : 0);
+            if (types[c] == pgcopy::Type::Text) {
+                Py_ssize_t size = 0;
+                const char *data = nullptr;
+                if (!null) {
+                    if (!PyUnicode_Check(value.ptr())) throw py::type_error("Las columnas de texto aceptan str o None");
+                    data = PyUnicode_AsUTF8AndSize(value.ptr(), &size);
+                    if (data == nullptr) throw py::error_already_set();
+                }
+                column.texts.emplace_back(data, static_cast<std::size_t>(size));
+            } else {
+                long long v = 0;
+                if (!null) {
+                    v = PyLong_AsLongLong(value.ptr());
+                    if (v == -1 && PyErr_Occurred()) throw py::error_already_set();
+                }
+                column.ints.push_back(v);
+            }
+        }
+    }
+
+    const std::size_t size = encoder.encoded_size(header, trailer);
+    PyObject *raw = PyBytes_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(size));
+    if (raw == nullptr) throw py::error_already_set();
+    py::bytes out = py::reinterpret_steal<py::bytes>(raw);
+    {
+        py::gil_scoped_release release;
+        encoder.write(PyBytes_AS_STRING(raw), header, trailer);
+    }
+    encoder.clear();
+    return out;
+}
+
+// Las variantes awaitable corren en el planificador compartido. Se cierra
+// en atexit, antes de que el intérprete finalice: las tareas pendientes
+// necesitan el GIL para entregar su resultado.
+void shutdown_scheduler() {
+    py::gil_scoped_release release;
+    csvcore::Scheduler::shutdown_instance();
+}
+
+py::dict scheduler_stats() {
+    const csvcore::SchedulerStats s = csvcore::Scheduler::instance().stats();
+    py::dict d;
+    d["threads"] = s.threads;
+    d["per_call_limit"] = s.per_call_limit;
+    d["queued"] = s.queued;
+    d["active"] = s.active;
+    d["submitted"] = s.submitted;
+    d["executed"] = s.executed;
+    d["steals"] = s.steals;
+    return d;
+}
+
+// Cierra la sesión de tracing `cursor`; regresa (JSON de Chrome Trace Event,
+// eventos perdidos).
+py::tuple trace_stop(std::uint64_t cursor) {
+    std::uint64_t dropped = 0;
+    std::string json;
+    {
+        py::gil_scoped_release release;
+        json = trace::stop(cursor, &dropped);
+    }
+    return py::make_tuple(py::str(json), dropped);
+}
+
+// Span medido en Python (con trace_now_ns) en la línea de tiempo nativa;
+// de `args` solo se guardan los valores enteros.
+void trace_record(const std::string &name, const std::string &category,
+                  std::uint64_t start_ns, std::uint64_t end_ns, const py::dict &args) {
+    if (!trace::enabled()) return;
+    std::vector<std::string> keys;
+    std::vector<std::pair<const char *, std::int64_t>> values;
+    keys.reserve(trace::kMaxArgs);
+    for (auto item : args) {
+        if (keys.size() == trace::kMaxArgs) break;
+        if (!py::isinstance<py::int_>(item.second)) continue;
+        keys.push_back(py::str(item.first));
+        values.emplace_back(nullptr, py::cast<std::int64_t>(item.second));
+    }
+    for (std::size_t a = 0; a < values.size(); ++a) values[a].first = keys[a].c_str();
+    trace::complete(name.c_str(), category.c_str(), start_ns, end_ns, values.data(), values.size());
+}
+
+struct AsyncCall {
+    py::object fn, args, kwargs, loop, future, complete;
+};
+
+// Ejecuta fn(*args, **kwargs) en el planificador nativo y entrega el resultado al
+// event loop con loop.call_soon_threadsafe(complete, future, result, error):
+// el hilo que llama (y el hilo sync de Django) no se bloquea. fn toma el
+// GIL en el hilo del pool; las funciones de cpp_csv lo sueltan mientras
+// parsean o agregan, así que varias llamadas avanzan en paralelo.
+void submit_async(const py::object &fn, const py::tuple &args, const py::dict &kwargs, const py::object &loop,
+                  const py::object &future, const py::object &complete) {
+    auto call = std::make_shared<AsyncCall>(AsyncCall{fn, args, kwargs, loop, future, complete});
+    const bool accepted = csvcore::Scheduler::instance().submit([call] {
+        py::gil_scoped_acquire acquire;
+        py::object result = py::none();
+        py::object error = py::none();
+        try {
+            result = call->fn(*call->args, **call->kwargs);
+        } catch (py::error_already_set &e) {
+            error = e.value();
+        } catch (const std::exception &e) {
+            error = py::module_::import("builtins").attr("RuntimeError")(e.what());
+        }
+        try {
+            call->loop.attr("call_soon_threadsafe")(call->complete, call->future, result, error);
+        } catch (py::error_already_set &) {
+            // El loop ya se cerró: nadie espera el resultado
+        }
+        // Las referencias se sueltan aquí, con el GIL
+        *call = AsyncCall{};
+    });
+    if (!accepted) throw std::runtime_error("cpp_csv: el planificador ya se cerró");
+}
+
+// Valores distintos (con conteos) por columna en todo el archivo. Las
+// columnas en `multi_columns` se dividen como multi-selección. `stats`
+// (dict) recibe los contadores por fase, sumados entre los rangos.
+py::dict discover_column_values(const std::string &filename,
+                                const std::vector<std::string> &columns,
+                                const std::vector<std::string> &multi_columns,
+                                std::size_t max_distinct = 200,
+                                char delimiter = ',',
+                                const std::string &separators = ",;",
+                                std::size_t threads = 0,
+                                const py::object &stats = py::none(),
+                                const py::object &on_progress = py::none(),
+                                std::uint64_t progress_rows = progress::kDefaultEveryRows,
+                                std::uint64_t progress_bytes = progress::kDefaultEveryBytes,
+                                const progress::CancelToken *cancel = nullptr,
+                                const py::object &where = py::none()) {
+    trace::Span span("discover_column_values");
+    std::shared_ptr<predicate::Expr> filter = row_filter(where);
+    std::vector<std::string> header;
+    std::vector<discovery::ColumnSpec> specs;
+    std::vector<std::string> names;
+    std::vector<discovery::ColumnCounts> counts;
+    CallMeter meter(stats);
+    std::uint64_t total_bytes = 0;
+    progress::Tracker tracker(cancel, progress_callback(on_progress, &total_bytes), progress_rows, progress_bytes);
+
+    {
+        const auto unlocked = meter.released();
+        py::gil_scoped_release release;
+
+        std::uint64_t body_begin = 0;
+        {
+            CsvChunkReader reader(filename, delimiter);
+            reader.set_stats(meter.counters());
+            ChunkArena arena;
+            header = read_header(reader, arena);
+            body_begin = reader.position();
+        }
+        if (filter && !header.empty()) predicate::bind(*filter, header);
+
+        std::unordered_set<std::string> multi(multi_columns.begin(), multi_columns.end());
+        std::unordered_set<std::string> wanted(columns.begin(), columns.end());
+        for (std::size_t j = 0; j < header.size(); ++j) {
+            if (columns.empty() || wanted.count(header[j])) {
+                specs.push_back({j, multi.count(header[j]) > 0});
+                names.push_back(header[j]);
+            }
+        }
+
+        if (!specs.empty()) {
+            tracker.check();
+            total_bytes = csvcore::file_size(filename) - body_begin;
+            counts = discovery::discover(filename, delimiter, body_begin, specs, max_distinct,
+                                         separators, threads, meter.counters(), &tracker, filter);
+        }
+    }
+
+    tracker.finish();
+    metrics::PhaseClock clock(meter.counters());
+    py::dict result;
+    for (std::size_t c = 0; c < counts.size(); ++c) {
+        auto &column = counts[c];
+
+        // Orden estable: más frecuentes primero, luego alfabético
+        std::vector<std::pair<std::string, std::uint64_t>> sorted(
+            column.counts.begin(), column.counts.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+
+        py::dict values;
+        for (const auto &item : sorted) {
+            values[py::str(item.first)] = py::cast(item.second);
+        }
+
+        py::dict info;
+        info["values"] = values;
+        info["distinct"] = py::cast(sorted.size());
+        info["non_empty"] = py::cast(column.non_empty);
+        info["free_text"] = py::cast(column.free_text);
+        result[py::str(names[c])] = info;
+    }
+    clock.mark(metrics::CONVERT);
+    clock.flush();
+    meter.report(stats);
+    return result;
+}
+
+// Iterador de Python sobre csvcore::PrefetchReader: el hilo nativo parsea
+// por adelantado y aquí solo se convierten los chunks listos a list[dict].
+// Con `memory_limit` se cargan al presupuesto los arenas del pool y los
+// objetos del chunk actual (se asume que el anterior ya se soltó). Con
+// `stats` (dict) se miden las fases: el hilo de prefetch registra io /
+// tokenize / filter y next() la espera y la conversión; el dict se
+// actualiza en cada chunk y al cerrar. Con `cancel` el hilo de prefetch deja
+// de leer al cancelarse y next() lanza OperationCancelled (el avance lo
+// lleva quien itera, chunk a chunk).
+class CsvChunkIterator {
+public:
+    CsvChunkIterator(const std::string &filename, char delimiter,
+                     std::size_t chunk_rows, std::size_t prefetch,
+                     const py::object &usecols, const std::vector<std::string> &drop_patterns,
+                     const py::object &where, std::size_t memory_limit, const py::object &stats,
+                     std::shared_ptr<progress::CancelToken> cancel)
+        : budget_(memory_limit), objects_(&budget_, "los objetos del chunk"),
+          counters_(stats.is_none() ? nullptr : &storage_), stats_(stats),
+          cancel_(std::move(cancel)), tracker_(cancel_.get(), nullptr) {
+        const projection::Spec spec = projection_spec(usecols, drop_patterns);
+        std::shared_ptr<predicate::Expr> filter = row_filter(where);
+        {
+            py::gil_scoped_release release;
+            reader_ = std::make_unique<csvcore::PrefetchReader>(
+                filename, delimiter, chunk_rows, prefetch, spec, std::move(filter), &budget_, counters_,
+                &tracker_);
+        }
+        keys_ = make_keys(reader_->header(), reader_->selection().columns);
+    }
+
+    ~CsvChunkIterator() {
+        if (reader_) {
+            py::gil_scoped_release release;
+            reader_.reset();
+        }
+    }
+
+    const std::vector<std::string> &header() const { return reader_->header(); }
+
+    // Nombres de las columnas que traen los dicts (header tras la proyección).
+    std::vector<std::string> columns() const {
+        std::vector<std::string> names;
+        for (std::size_t j : reader_->selection().columns) names.push_back(reader_->header()[j]);
+        return names;
+    }
+
+    // Memoria, bytes leídos y contadores medidos hasta ahora (mismas llaves
+    // que `stats` en read_csv_dicts; los contadores solo si se pidió
+    // `stats`). Aquí 'total_ns' es el tiempo dentro de next() y 'gil_ns' su
+    // conversión.
+    py::dict stats() const {
+        py::dict out;
+        fill_stats(out);
+        return out;
+    }
+
+    // Devuelve el siguiente chunk como list[dict]; StopIteration al final.
+    py::list next() {
+        tracker_.check();
+        trace::Span span("iter_chunk");
+        metrics::PhaseClock clock(counters_);
+        ChunkArena *arena = nullptr;
+        if (!reader_->try_next(arena)) {
+            py::gil_scoped_release release;
+            arena = reader_->next();
+        }
+        clock.mark(metrics::WAIT);
+        if (arena == nullptr) {
+            clock.flush();
+            refresh_stats();
+            throw py::stop_iteration();
+        }
+
+        try {
+            objects_.resize(py_rows_bytes(*arena, &reader_->selection().columns, true));
+        } catch (...) {
+            reader_->release(arena);
+            throw;
+        }
+        py::list rows;
+        append_dict_rows(rows, *arena, keys_, reader_->selection().columns, empty_);
+        reader_->release(arena);
+        span.arg("rows", static_cast<std::int64_t>(rows.size()));
+        clock.mark(metrics::CONVERT);
+        clock.flush();
+        refresh_stats();
+        return rows;
+    }
+
+    void close() {
+        {
+            py::gil_scoped_release release;
+            reader_->stop();
+        }
+        refresh_stats();
+    }
+
+private:
+    void fill_stats(const py::object &out) const {
+        report_memory(out, budget_, reader_->arena_peak(), objects_.peak());
+        if (counters_) {
+            const std::uint64_t convert = metrics::read(storage_.phase_ns[metrics::CONVERT]);
+            report_counters(out, storage_, metrics::read(storage_.phase_ns[metrics::WAIT]) + convert, convert);
+        } else {
+            // Sin contadores el avance sale del Tracker (para la barra de progreso)
+            py::cast<py::dict>(out)["bytes_read"] = py::cast(tracker_.bytes());
+        }
+    }
+
+    void refresh_stats() {
+        if (!stats_.is_none()) fill_stats(stats_);
+    }
+
+    MemoryBudget budget_;  // antes que reader_: el lector le carga sus arenas
+    BudgetLease objects_;
+    metrics::CallStats storage_;  // también antes que reader_ (el hilo escribe aquí)
+    metrics::CallStats *counters_;
+    py::object stats_;
+    std::shared_ptr<progress::CancelToken> cancel_;
+    progress::Tracker tracker_;  // antes que reader_ (el hilo de prefetch avanza aquí)
+    std::unique_ptr<csvcore::PrefetchReader> reader_;
+    std::vector<py::str> keys_;
+    py::str empty_{""};
+};
+
+// Construye el mapeador a partir de {texto_opción: option_id}.
+std::unique_ptr<multiselect::OptionMapper> make_option_mapper(const py::dict &options,
+                                                              std::string separators,
+                                                              char quote) {
+    std::vector<std::pair<std::string, long long>> pairs;
+    pairs.reserve(options.size());
+    for (auto item : options) {
+        pairs.emplace_back(py::str(item.first), py::cast<long long>(item.second));
+    }
+    return std::make_unique<multiselect::OptionMapper>(pairs, std::move(separators), quote);
+}
+
+std::unique_ptr<lexicon::Matcher> make_sentiment_lexicon(const py::dict &terms,
+                                                         const std::vector<std::string> &negators,
+                                                         std::size_t window) {
+    lexicon::Lexicon lex;
+    lex.terms.reserve(terms.size());
+    for (auto item : terms) {
+        lex.terms.emplace_back(py::str(item.first), py::cast<double>(item.second));
+    }
+    lex.negators = negators;
+    lex.window = window;
+    return std::make_unique<lexicon::Matcher>(lex);
+}
+
+std::unique_ptr<search::TextIndex> make_text_index(const py::list &texts) {
+    trace::Span span("build_text_index");
+    span.arg("texts", static_cast<std::int64_t>(texts.size()));
+    std::vector<std::string_view> views = utf8_views(texts);
+    py::gil_scoped_release release;
+    return std::make_unique<search::TextIndex>(views);
+}
+
+// Cubo en memoria desde columnas [(question_id, response_ids, labels,
+// from_option)] y [(question_id, response_ids, values)].
+std::shared_ptr<cube::Cube> build_survey_cube(const std::vector<std::int64_t> &response_ids,
+                                              const std::vector<std::int32_t> &days,
+                                              const py::list &choice_columns,
+                                              const py::list &numeric_columns) {
+    trace::Span span("build_survey_cube");
+    span.arg("responses", static_cast<std::int64_t>(response_ids.size()));
+    cube::Builder builder(response_ids, days);
+    for (auto item : choice_columns) {
+        py::tuple column = py::cast<py::tuple>(item);
+        const auto ids = py::cast<std::vector<std::int64_t>>(column[1]);
+        const std::vector<std::string_view> labels = utf8_views(py::cast<py::list>(column[2]));
+        const auto from_option = py::cast<std::vector<std::uint8_t>>(column[3]);
+        builder.add_choice(py::cast<std::int64_t>(column[0]), ids, labels, from_option);
+    }
+    for (auto item : numeric_columns) {
+        py::tuple column = py::cast<py::tuple>(item);
+        builder.add_numeric(py::cast<std::int64_t>(column[0]), py::cast<std::vector<std::int64_t>>(column[1]),
+                            py::cast<std::vector<double>>(column[2]));
+    }
+    py::gil_scoped_release release;
+    return cube::Cube::from_bytes(builder.serialize());
+}
+
+std::shared_ptr<cube::Cube> open_survey_cube(const std::string &path) {
+    py::gil_scoped_release release;
+    return cube::Cube::open(path);
+}
+
+// Codificador de tablas CSV; `dictionaries` = {índice de columna: [etiquetas]}.
+std::unique_ptr<writer::TableEncoder> build_csv_encoder(const std::vector<std::string> &header,
+                                                        const py::dict &dictionaries,
+                                                        char delimiter,
+                                                        const std::string &multi_separator,
+                                                        std::size_t chunk_size) {
+    auto encoder = std::make_unique<writer::TableEncoder>(header, delimiter, multi_separator, chunk_size);
+    for (auto item : dictionaries) {
+        const py::list labels = py::cast<py::list>(item.second);
+        encoder->set_dictionary(py::cast<std::size_t>(item.first), utf8_views(labels));
+    }
+    return encoder;
+}
+
+std::unique_ptr<pgcopy::Encoder> build_copy_encoder(const std::vector<std::string> &types) {
+    std::vector<pgcopy::Type> parsed;
+    parsed.reserve(types.size());
+    for (const std::string &type : types) parsed.push_back(pgcopy::parse_type(type));
+    return std::make_unique<pgcopy::Encoder>(std::move(parsed));
+}
+
 PYBIND11_MODULE(cpp_csv, m) {
     m.doc() = "CSV reader acelerado en C++ para Byteneko";
 
+    // Presupuesto de memoria excedido -> MemoryError (no RuntimeError)
+    py::register_exception_translator([](std::exception_ptr error) {
+        try {
+            if (error) std::rethrow_exception(error);
+        } catch (const csvcore::BudgetExceeded &e) {
+            PyErr_SetString(PyExc_MemoryError, e.what());
+        }
+    });
+
+    // Cancelación cooperativa de lecturas y discover
+    py::class_<progress::CancelToken, std::shared_ptr<progress::CancelToken>>(m, "CancelToken")
+        .def(py::init<>())
+        .def("cancel", &progress::CancelToken::cancel,
+             "Pide cancelar; las llamadas que usan el token lanzan OperationCancelled "
+             "en el siguiente chunk.")
+        .def_property_readonly("cancelled", &progress::CancelToken::cancelled);
+    py::register_exception<progress::Cancelled>(m, "OperationCancelled");
+
     // Mantiene la API original
     m.def(
         "read_csv",
         &read_csv,
         py::arg("filename"),
         py::arg("delimiter") = ',',
-        "Lee un archivo CSV y regresa una lista de filas (list[list[str]])."
+        py::arg("usecols") = py::none(),
+        py::arg("drop_patterns") = std::vector<std::string>(),
+        py::arg("where") = py::none(),
+        py::arg("memory_limit") = 0,
+        py::arg("stats") = py::none(),
+        py::arg("progress") = py::none(),
+        py::arg("progress_rows") = progress::kDefaultEveryRows,
+        py::arg("progress_bytes") = progress::kDefaultEveryBytes,
+        py::arg("cancel") = nullptr,
+        "Lee un archivo CSV y regresa una lista de filas (list[list[str]]).\n"
+        "usecols (nombres o índices) y drop_patterns (glob) limitan las columnas;\n"
+        "where filtra filas sobre las celdas crudas. memory_limit (bytes) acota\n"
+        "la memoria de la llamada (MemoryError si no alcanza) y stats (dict)\n"
+        "recibe peak_bytes / arena_bytes / python_bytes y los contadores por fase\n"
+        "(bytes_read, rows, cells, <fase>_ns, gil_ns, total_ns, ...).\n"
+        "progress(filas, bytes, bytes_totales) se llama cada progress_rows filas o\n"
+        "progress_bytes bytes (0 = no cuenta) y al terminar; con cancel (CancelToken)\n"
+        "la lectura se corta en el siguiente chunk con OperationCancelled."
     );
 
     // Nueva API: más directa para tu flujo en Django
@@ -396,8 +1744,19 @@ PYBIND11_MODULE(cpp_csv, m) {
         &read_csv_dicts,
         py::arg("filename"),
         py::arg("delimiter") = ',',
+        py::arg("usecols") = py::none(),
+        py::arg("drop_patterns") = std::vector<std::string>(),
+        py::arg("where") = py::none(),
+        py::arg("memory_limit") = 0,
+        py::arg("stats") = py::none(),
+        py::arg("progress") = py::none(),
+        py::arg("progress_rows") = progress::kDefaultEveryRows,
+        py::arg("progress_bytes") = progress::kDefaultEveryBytes,
+        py::arg("cancel") = nullptr,
         "Lee un CSV y regresa una lista de diccionarios usando la primera fila "
-        "como encabezado."
+        "como encabezado; solo con las columnas de usecols / sin drop_patterns "
+        "y las filas que cumplen where. memory_limit, stats, progress y cancel "
+        "como en read_csv."
     );
     
     // API con validación integrada
@@ -407,7 +1766,368 @@ PYBIND11_MODULE(cpp_csv, m) {
         py::arg("filename"),
         py::arg("schema"),
         py::arg("delimiter") = ',',
+        py::arg("usecols") = py::none(),
+        py::arg("drop_patterns") = std::vector<std::string>(),
+        py::arg("where") = py::none(),
+        py::arg("memory_limit") = 0,
+        py::arg("stats") = py::none(),
+        py::arg("progress") = py::none(),
+        py::arg("progress_rows") = progress::kDefaultEveryRows,
+        py::arg("progress_bytes") = progress::kDefaultEveryBytes,
+        py::arg("cancel") = nullptr,
         "Lee un CSV, valida según el esquema y retorna {data: [...], errors: [...]}.\n"
         "Esquema ejemplo: {'Edad': {'type': 'number'}, 'Satisfacción': {'type': 'scale', 'min': 0, 'max': 10}}"
     );
+
+    // Lectura en segundo plano por chunks (pipeline parseo / COPY)
+    py::class_<CsvChunkIterator>(m, "CsvChunkIterator")
+        .def(py::init<const std::string&, char, std::size_t, std::size_t,
+                      const py::object&, const std::vector<std::string>&, const py::object&,
+                      std::size_t, const py::object&, std::shared_ptr<progress::CancelToken>>(),
+             py::arg("filename"),
+             py::arg("delimiter") = ',',
+             py::arg("chunk_rows") = 2500,
+             py::arg("prefetch") = 2,
+             py::arg("usecols") = py::none(),
+             py::arg("drop_patterns") = std::vector<std::string>(),
+             py::arg("where") = py::none(),
+             py::arg("memory_limit") = 0,
+             py::arg("stats") = py::none(),
+             py::arg("cancel") = nullptr)
+        .def_property_readonly("header", &CsvChunkIterator::header)
+        .def_property_readonly("columns", &CsvChunkIterator::columns)
+        .def_property_readonly("stats", &CsvChunkIterator::stats)
+        .def("__iter__", [](CsvChunkIterator &self) -> CsvChunkIterator& { return self; },
+             py::return_value_policy::reference_internal)
+        .def("__next__", &CsvChunkIterator::next)
+        .def("close", &CsvChunkIterator::close)
+        .def("__enter__", [](CsvChunkIterator &self) -> CsvChunkIterator& { return self; },
+             py::return_value_policy::reference_internal)
+        .def("__exit__", [](CsvChunkIterator &self, py::args) { self.close(); });
+
+    // Multi-selección: división de celdas y mapeo a IDs de opción
+    m.def(
+        "split_multi_select",
+        &split_multi_select,
+        py::arg("value"),
+        py::arg("separators") = ",;",
+        py::arg("quote") = '"',
+        "Divide una celda multi-selección respetando comillas; regresa las "
+        "opciones recortadas y sin duplicados."
+    );
+
+    // Descubrimiento de opciones sobre todo el archivo
+    m.def(
+        "discover_column_values",
+        &discover_column_values,
+        py::arg("filename"),
+        py::arg("columns") = std::vector<std::string>(),
+        py::arg("multi_columns") = std::vector<std::string>(),
+        py::arg("max_distinct") = 200,
+        py::arg("delimiter") = ',',
+        py::arg("separators") = ",;",
+        py::arg("threads") = 0,
+        py::arg("stats") = py::none(),
+        py::arg("progress") = py::none(),
+        py::arg("progress_rows") = progress::kDefaultEveryRows,
+        py::arg("progress_bytes") = progress::kDefaultEveryBytes,
+        py::arg("cancel") = nullptr,
+        py::arg("where") = py::none(),
+        "Cuenta los valores distintos de cada columna en todo el archivo (en paralelo). "
+        "Regresa {columna: {values, distinct, non_empty, free_text}}; las columnas que "
+        "pasan de max_distinct se marcan como texto libre. stats (dict) recibe los "
+        "contadores por fase; progress y cancel como en read_csv (el avance suma "
+        "todos los rangos). where (como en read_csv) limita el conteo a las filas "
+        "que lo cumplen."
+    );
+
+    // Estadísticas numéricas sobre distribuciones (valor, conteo)
+    m.def(
+        "numeric_stats",
+        &numeric_stats,
+        py::arg("values"),
+        py::arg("counts") = std::vector<std::int64_t>(),
+        py::arg("quantiles") = std::vector<double>(),
+        py::arg("bins") = 10,
+        "Resumen de una distribución numérica en O(valores distintos). Regresa "
+        "{count, sum, mean, variance, stddev, min, max, median, quantiles, histogram}; "
+        "histogram es una lista de (inicio, fin, conteo) con los rangos de las gráficas."
+    );
+
+    // NPS por segmento
+    m.def(
+        "nps_breakdown",
+        &nps_breakdown,
+        py::arg("values"),
+        py::arg("counts") = std::vector<std::int64_t>(),
+        py::arg("segments") = std::vector<std::int32_t>(),
+        py::arg("num_segments") = 0,
+        py::arg("confidence") = 0.95,
+        "NPS global y por segmento en una pasada. Regresa {overall, segments}; cada "
+        "grupo trae {total, promoters, passives, detractors, score, margin, ci_low, ci_high}."
+    );
+
+    // Tablas cruzadas sin pandas
+    m.def(
+        "build_crosstab",
+        &build_crosstab,
+        py::arg("universe"),
+        py::arg("row_ids"),
+        py::arg("row_labels"),
+        py::arg("col_ids"),
+        py::arg("col_labels"),
+        py::arg("top_k") = 10,
+        py::arg("missing_label") = "Sin respuesta",
+        py::arg("other_label") = "Otros",
+        py::arg("total_label") = "Total",
+        "Cruza dos preguntas por response_id con márgenes, orden por totales y "
+        "top-K + 'Otros'. Regresa {data: {index, columns, data}, total_responses, "
+        "row_categories, col_categories}."
+    );
+
+    // Correlaciones para el mapa de calor
+    m.def(
+        "correlation_matrix",
+        &correlation_matrix,
+        py::arg("response_ids"),
+        py::arg("question_ids"),
+        py::arg("values"),
+        py::arg("columns") = std::vector<std::int64_t>(),
+        py::arg("method") = "pearson",
+        py::arg("max_columns") = 20,
+        "Correlación pairwise-complete (pearson o spearman) entre preguntas. Regresa "
+        "{columns, matrix, pairs}; las celdas sin datos suficientes son None."
+    );
+
+    // Minería de texto de comentarios abiertos
+    m.def(
+        "fold_text",
+        &fold_text,
+        py::arg("text"),
+        "Minúsculas sin acentos (tabla tipo NFKD); lo que no es alfanumérico queda como espacio."
+    );
+    m.def(
+        "analyze_texts",
+        &analyze_texts,
+        py::arg("texts"),
+        py::arg("min_length") = 3,
+        py::arg("stopwords") = std::vector<std::string>(),
+        py::arg("top_k") = 20,
+        py::arg("bigrams") = true,
+        py::arg("track") = std::vector<std::string>(),
+        "Tokeniza y cuenta palabras/bigramas sin el GIL. Regresa {words, bigrams, "
+        "tracked, tokens, documents}; words/bigrams son [(término, conteo)] (top_k=0 = todos)."
+    );
+
+    m.def(
+        "scan_pii",
+        &scan_pii,
+        py::arg("columns"),
+        "Busca PII en columnas completas (list[list[str]]) sin el GIL. Regresa por columna "
+        "{values, distinct, emails, phones, identifiers, national_ids, flagged_rows}."
+    );
+
+    m.def(
+        "build_survey_cube",
+        &build_survey_cube,
+        py::arg("response_ids"),
+        py::arg("days"),
+        py::arg("choice_columns"),
+        py::arg("numeric_columns"),
+        "Cubo columnar en memoria de una encuesta. choice_columns: [(question_id, "
+        "response_ids, labels, from_option)]; numeric_columns: [(question_id, response_ids, values)]."
+    );
+
+    m.def(
+        "open_survey_cube",
+        &open_survey_cube,
+        py::arg("path"),
+        "Abre (mmap) un cubo guardado con SurveyCube.save(path)."
+    );
+
+    m.def(
+        "build_csv_encoder",
+        &build_csv_encoder,
+        py::arg("header"),
+        py::arg("dictionaries") = py::dict(),
+        py::arg("delimiter") = ',',
+        py::arg("multi_separator") = ", ",
+        py::arg("chunk_size") = writer::kDefaultChunkBytes,
+        "Codificador CSV (RFC 4180) de tablas de respuestas por lotes; dictionaries = "
+        "{columna: [etiquetas]} para celdas con código de opción."
+    );
+
+    m.def(
+        "build_copy_encoder",
+        &build_copy_encoder,
+        py::arg("types"),
+        "Codificador de COPY binario de PostgreSQL (FORMAT BINARY); types = ['int2'|'int4'|'int8'|'text'] "
+        "en el orden de las columnas del COPY."
+    );
+
+    m.def(
+        "submit_async",
+        &submit_async,
+        py::arg("fn"),
+        py::arg("args"),
+        py::arg("kwargs"),
+        py::arg("loop"),
+        py::arg("future"),
+        py::arg("complete"),
+        "Ejecuta fn(*args, **kwargs) en el planificador nativo y llama "
+        "loop.call_soon_threadsafe(complete, future, resultado, error) al terminar."
+    );
+    py::module_::import("atexit").attr("register")(py::cpp_function(&shutdown_scheduler));
+
+    m.def(
+        "configure_scheduler",
+        &csvcore::Scheduler::configure,
+        py::arg("threads") = 0,
+        py::arg("per_call_limit") = 0,
+        "Hilos del planificador compartido y máximo de tareas simultáneas por llamada (0 = "
+        "CPP_CSV_THREADS / CPP_CSV_THREADS_PER_CALL o núcleos). False si ya estaba en uso."
+    );
+
+    m.def(
+        "trace_start",
+        &trace::start,
+        py::arg("capacity") = 0,
+        "Abre una sesión de tracing y regresa su cursor. El ring de eventos del proceso se "
+        "reserva en la primera sesión (capacity eventos; 0 = CPP_CSV_TRACE_EVENTS o 32768)."
+    );
+    m.def(
+        "trace_stop",
+        &trace_stop,
+        py::arg("cursor"),
+        "Cierra la sesión y regresa (json, dropped): los spans de todo el proceso registrados "
+        "mientras estuvo abierta, como JSON de Chrome Trace Event (chrome://tracing, Perfetto)."
+    );
+    m.def("trace_enabled", &trace::enabled, "True si hay alguna sesión de tracing abierta.");
+    m.def("trace_now_ns", &trace::now_ns, "Reloj de los spans (ns, monotónico).");
+    m.def(
+        "trace_record",
+        &trace_record,
+        py::arg("name"),
+        py::arg("category"),
+        py::arg("start_ns"),
+        py::arg("end_ns"),
+        py::arg("args") = py::dict(),
+        "Registra un span medido con trace_now_ns() en el hilo que llama (args: hasta 3 enteros)."
+    );
+    m.def(
+        "trace_name_thread",
+        &trace::name_thread,
+        py::arg("name"),
+        "Nombre del hilo que llama en la línea de tiempo."
+    );
+
+    m.def(
+        "scheduler_stats",
+        &scheduler_stats,
+        "Estado del planificador: threads, per_call_limit, queued, active, submitted, executed, steals."
+    );
+
+    py::class_<multiselect::OptionMapper>(m, "MultiSelectMapper")
+        .def(py::init(&make_option_mapper),
+             py::arg("options"),
+             py::arg("separators") = ",;",
+             py::arg("quote") = '"')
+        .def_property_readonly("separators", &multiselect::OptionMapper::separators)
+        .def("map", &map_multi_select,
+             py::arg("cells"),
+             "Mapea una columna de celdas a {rows, option_ids, unknown_rows, unknown_tokens}.");
+
+    py::class_<lexicon::Matcher>(m, "SentimentLexicon")
+        .def(py::init(&make_sentiment_lexicon),
+             py::arg("terms"),
+             py::arg("negators") = std::vector<std::string>(),
+             py::arg("window") = 3)
+        .def_property_readonly("patterns", &lexicon::Matcher::patterns)
+        .def_property_readonly("window", &lexicon::Matcher::window)
+        .def("score", &score_sentiment,
+             py::arg("texts"),
+             "Puntúa una lista de textos: {scores, positive, negative, matches, "
+             "positive_texts, negative_texts, neutral_texts}.");
+
+    py::class_<search::TextIndex>(m, "TextIndex")
+        .def(py::init(&make_text_index), py::arg("texts"))
+        .def_property_readonly("documents", &search::TextIndex::documents)
+        .def_property_readonly("terms", &search::TextIndex::terms)
+        .def("postings", &index_postings,
+             py::arg("term"),
+             "[(fila, posición)] de un término (se normaliza igual que los textos).")
+        .def("best_quote", &index_best_quote,
+             py::arg("terms"),
+             py::arg("min_length") = 20,
+             py::arg("max_length") = 110,
+             "Fila del texto con todos los términos/frases y largo dentro de (min, max), "
+             "con más apariciones; None si no hay.")
+        .def("keyword_in_context", &index_keyword_in_context,
+             py::arg("term"),
+             py::arg("width") = 40,
+             py::arg("limit") = 20,
+             "Apariciones de una palabra o frase con `width` caracteres de contexto: "
+             "[{row, left, match, right}].");
+
+    py::class_<cube::RowSet>(m, "CubeRows")
+        .def_property_readonly("size", &cube::RowSet::size)
+        .def("count", &cube::RowSet::count)
+        .def("__len__", &cube::RowSet::count)
+        .def_property_readonly("bytes", [](const cube::RowSet &a) { return a.bits().bytes(); },
+                               "Memoria del bitmap comprimido.")
+        .def("__and__", [](const cube::RowSet &a, const cube::RowSet &b) { cube::RowSet out(a); out &= b; return out; })
+        .def("__or__", [](const cube::RowSet &a, const cube::RowSet &b) { cube::RowSet out(a); out |= b; return out; })
+        .def("__sub__", [](const cube::RowSet &a, const cube::RowSet &b) { cube::RowSet out(a); out -= b; return out; })
+        .def("__invert__", [](const cube::RowSet &a) { return ~a; })
+        .def("__eq__", [](const cube::RowSet &a, const cube::RowSet &b) { return a.size() == b.size() && a.bits() == b.bits(); })
+        .def("__contains__", [](const cube::RowSet &a, std::size_t row) { return row < a.size() && a.test(row); })
+        .def("rows", [](const cube::RowSet &a) { return a.bits().to_vector(); }, "Filas seleccionadas, en orden.");
+
+    py::class_<cube::Cube, std::shared_ptr<cube::Cube>>(m, "SurveyCube")
+        .def_property_readonly("rows", &cube::Cube::rows)
+        .def_property_readonly("bytes", &cube::Cube::bytes)
+        .def_property_readonly("mapped", &cube::Cube::mapped)
+        .def("question_ids", &cube_question_ids)
+        .def("kind", &cube_kind, py::arg("question_id"), "'choice' o 'numeric'.")
+        .def("dictionary", &cube_dictionary,
+             py::arg("question_id"),
+             "Diccionario de la columna: [(etiqueta, de_opción)] o valores ordenados.")
+        .def("all", &cube::Cube::all)
+        .def("days_between", &cube_days_between, py::arg("first"), py::arg("last"),
+             "Filas con día ordinal (date.toordinal()) en [first, last].")
+        .def("with_codes", &cube_with_codes, py::arg("question_id"), py::arg("codes"),
+             "Filas con alguna respuesta cuyo código de diccionario está en `codes`.")
+        .def("with_values", &cube_with_values, py::arg("question_id"), py::arg("low"), py::arg("high"),
+             "Filas con algún valor numérico en [low, high].")
+        .def("code_counts", &cube_code_counts, py::arg("question_id"), py::arg("rows") = nullptr,
+             "Respuestas por código de diccionario dentro de `rows` (None = todas).")
+        .def("day_counts", &cube_day_counts, py::arg("rows") = nullptr,
+             "[(día ordinal, respuestas)] ordenado.")
+        .def("last_response_id", &cube_last_response_id, py::arg("rows") = nullptr)
+        .def("response_ids", &cube_response_ids, py::arg("rows") = nullptr)
+        .def("save", &cube::Cube::save, py::arg("path"), py::call_guard<py::gil_scoped_release>());
+
+    py::class_<writer::TableEncoder>(m, "CsvTableEncoder")
+        .def_property_readonly("columns", &writer::TableEncoder::columns)
+        .def("header", [](const writer::TableEncoder &e) { return py::bytes(e.header()); },
+             "Línea de encabezado (bytes UTF-8).")
+        .def("encode", &encode_csv_rows,
+             py::arg("rows"),
+             py::arg("leading"),
+             py::arg("cell_rows"),
+             py::arg("cell_columns"),
+             py::arg("texts"),
+             py::arg("numbers"),
+             py::arg("codes"),
+             "Codifica `rows` filas: `leading` = columnas fijas [[str] por fila]; cada celda es "
+             "(fila, columna, texto, número o NaN, código o -1). Regresa bloques de bytes.");
+
+    py::class_<pgcopy::Encoder>(m, "PgCopyEncoder")
+        .def_property_readonly("columns", [](const pgcopy::Encoder &e) { return e.types().size(); })
+        .def("encode", &encode_pgcopy,
+             py::arg("columns"),
+             py::arg("header") = true,
+             py::arg("trailer") = true,
+             "Codifica un lote: columns = [[int|str|None] por fila] por columna. header/trailer "
+             "agregan la firma y el terminador del COPY (un COPY = header + lotes + trailer).");
 }
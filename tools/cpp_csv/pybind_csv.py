@@ -1,41 +1,255 @@
+import asyncio
+import contextlib
+import contextvars
 import cpp_csv
+import datetime
 import logging
+import threading
 
 logger = logging.getLogger(__name__)
 
+# Lista de (llamada, stats) del collect_stats() activo
+_collector = contextvars.ContextVar('cpp_csv_stats', default=None)
 
-def read_csv(filename, delimiter=','):
+# Hilos de Python que ya tienen nombre en la línea de tiempo nativa
+_trace_threads = threading.local()
+
+# Cancelación cooperativa: token.cancel() desde cualquier hilo corta la
+# llamada que lo recibió en el siguiente chunk con OperationCancelled
+CancelToken = cpp_csv.CancelToken
+OperationCancelled = cpp_csv.OperationCancelled
+
+
+def _drop_list(drop_patterns):
+    return [str(p) for p in (drop_patterns or ())]
+
+
+def _stats(call, stats):
+    # dict que llena cpp_csv: el del llamador o, si hay un collect_stats()
+    # activo, uno nuevo; en ese caso también queda registrado ahí
+    calls = _collector.get()
+    if calls is None:
+        return stats
+    if stats is None:
+        stats = {}
+    calls.append((call, stats))
+    return stats
+
+
+@contextlib.contextmanager
+def collect_stats():
+    """
+    Registra los contadores de todas las llamadas de lectura de cpp_csv del
+    bloque (en este hilo / contexto), aunque no pasen `stats`:
+
+        with collect_stats() as calls:
+            rows = read_csv_dicts(path)
+        for call, stats in calls:
+            log_cpp_csv_stats(call, stats)
+
+    Cada `stats` tiene las mismas llaves que en read_csv_dicts. Las
+    llamadas de run_async corren en otro hilo y no se registran.
+    """
+    calls = []
+    token = _collector.set(calls)
+    try:
+        yield calls
+    finally:
+        _collector.reset(token)
+
+
+class TraceSession:
+    """Resultado de trace_session(): al salir del bloque, `json` y `dropped`."""
+
+    def __init__(self):
+        self.json = None
+        self.dropped = 0
+
+    def save(self, path):
+        with open(path, 'w', encoding='utf-8') as f:
+            f.write(self.json or '{"traceEvents": []}')
+        return path
+
+
+@contextlib.contextmanager
+def trace_session(capacity=0):
+    """
+    Registra la línea de tiempo del proceso durante el bloque: los spans
+    nativos (read_chunk, discover_range, kernels de análisis) y los de span()
+    / trace_mark(). Al salir, session.json trae el JSON de Chrome Trace Event
+    (se abre en chrome://tracing o https://ui.perfetto.dev):
+
+        with trace_session() as session:
+            rows = read_csv_dicts(path)
+        session.save('/tmp/import.json')
+
+    Las sesiones simultáneas (otras peticiones) comparten el ring de eventos:
+    cada una ve todo lo que corrió en el proceso mientras estuvo abierta.
+    `dropped` cuenta los eventos perdidos porque el ring dio la vuelta
+    (`capacity` solo aplica a la primera sesión del proceso).
+    """
+    session = TraceSession()
+    cursor = cpp_csv.trace_start(int(capacity or 0))
+    try:
+        yield session
+    finally:
+        session.json, session.dropped = cpp_csv.trace_stop(cursor)
+
+
+def trace_now_ns():
+    """Reloj de los spans (ns), para medir una etapa con trace_mark()."""
+    return cpp_csv.trace_now_ns()
+
+
+def trace_mark(name, start_ns, category='python', **args):
+    """Span de `start_ns` (trace_now_ns()) a ahora; sin sesión abierta no hace nada."""
+    if cpp_csv.trace_enabled():
+        if not getattr(_trace_threads, 'named', False):
+            cpp_csv.trace_name_thread(threading.current_thread().name)
+            _trace_threads.named = True
+        cpp_csv.trace_record(name, category, start_ns, cpp_csv.trace_now_ns(), args)
+
+
+@contextlib.contextmanager
+def span(name, category='python', **args):
+    """
+    Etapa de Python en la línea de tiempo de trace_session(), en el hilo que
+    la ejecuta; `args` admite hasta 3 valores enteros. Sin sesión abierta no
+    lee el reloj.
+    """
+    if not cpp_csv.trace_enabled():
+        yield
+        return
+    start = cpp_csv.trace_now_ns()
+    try:
+        yield
+    finally:
+        trace_mark(name, start, category, **args)
+
+
+def _where(node):
+    # date/datetime -> texto ISO (con type='date' si no se indicó) y tuplas -> listas
+    if isinstance(node, dict):
+        out = {key: _where(value) for key, value in node.items()}
+        value = node.get('value')
+        bound = value[0] if isinstance(value, (list, tuple)) and value else value
+        if 'type' not in out and isinstance(bound, datetime.date):
+            out['type'] = 'date'
+        return out
+    if isinstance(node, (list, tuple)):
+        return [_where(item) for item in node]
+    if isinstance(node, datetime.datetime):
+        return node.replace(tzinfo=None).isoformat(sep=' ')
+    if isinstance(node, datetime.date):
+        return node.isoformat()
+    return node
+
+
+def read_csv(filename, delimiter=',', usecols=None, drop_patterns=None, where=None,
+             memory_limit=0, stats=None, progress=None, progress_rows=50000,
+             progress_bytes=8 << 20, cancel=None):
     """
     Lee un archivo CSV y regresa una lista de filas (list[list[str]]).
+
+    Con `usecols` / `drop_patterns` / `where` (ver read_csv_dicts) la primera
+    fila se usa como encabezado y cada fila trae solo las columnas elegidas.
+    `memory_limit` / `stats` / `progress` / `cancel` como en read_csv_dicts.
     """
     try:
-        return cpp_csv.read_csv(filename, delimiter)
+        return cpp_csv.read_csv(
+            filename, delimiter, usecols, _drop_list(drop_patterns), _where(where),
+            int(memory_limit or 0), _stats('read_csv', stats),
+            progress, int(progress_rows or 0), int(progress_bytes or 0), cancel,
+        )
+    except OperationCancelled:
+        raise
     except Exception:
         logger.exception("Error leyendo CSV con cpp_csv")
         raise
 
 
-def read_csv_dicts(filename, delimiter=','):
+def read_csv_dicts(filename, delimiter=',', usecols=None, drop_patterns=None, where=None,
+                   memory_limit=0, stats=None, progress=None, progress_rows=50000,
+                   progress_bytes=8 << 20, cancel=None):
     """
     Lee un CSV y regresa una lista de diccionarios usando la primera fila 
     como encabezado.
+
+    Proyección de columnas (las descartadas no se copian ni se convierten a str):
+        usecols: nombres y/o índices de columna a conservar (None = todas).
+            Un nombre inexistente lanza ValueError; un índice fuera de rango,
+            IndexError.
+        drop_patterns: patrones glob ('*', '?') que descartan columnas por
+            nombre, sin distinguir mayúsculas, p. ej. ['id', 'pk', 'unnamed*'].
+
+    Filtro de filas (se evalúa en C++ sobre las celdas crudas; las filas que
+    no cumplen no se convierten):
+        where: condición o combinación de condiciones, p. ej.
+            {'and': [
+                {'column': 'Fecha', 'op': '>=', 'value': date(2024, 1, 1)},
+                {'column': 'Edad', 'op': 'between', 'value': [18, 65]},
+                {'or': [{'column': 'Pais', 'op': 'in', 'value': ['MX', 'CO']},
+                        {'column': 'Comentario', 'op': 'not_empty'}]},
+            ]}
+            Operadores: == != < <= > >= between in empty not_empty, y 'and',
+            'or', 'not' para combinar. 'type' ('text', 'number', 'date') se
+            infiere del valor; una celda que no es número/fecha válida no
+            cumple la comparación. Las fechas ignoran la zona horaria.
+
+    Memoria (la cuenta la lleva C++: arena de parseo + estimación de los
+    objetos de Python creados, no el RSS del proceso):
+        memory_limit: Presupuesto en bytes (0 = sin límite). Al acercarse
+            los chunks se achican; si aun así no alcanza, MemoryError antes
+            de pasarlo.
+        stats: dict que se llena con 'memory_limit', 'peak_bytes',
+            'arena_bytes' y 'python_bytes' (ver memory_monitor.log_native_memory).
+
+    Contadores por fase (solo si se pasa `stats` o hay un collect_stats()
+    activo; medir cuesta ~15-20% del parseo), en el mismo dict:
+        'bytes_read', 'rows', 'cells', 'filtered_rows', 'errors',
+        'allocations' (chunks en los que el arena tuvo que crecer),
+        '<fase>_ns' para io, tokenize, filter, validate, aggregate, convert
+        (objetos de Python) y wait, 'gil_ns' (con el GIL tomado) y
+        'total_ns'. Ver logging_utils.log_cpp_csv_stats.
+
+    Avance y cancelación (el parseo sigue sin el GIL; solo se toma para
+    llamar al callback):
+        progress: callable(filas, bytes, bytes_totales), llamado cada
+            `progress_rows` filas o `progress_bytes` bytes leídos (0 = no
+            cuenta por esa medida) y una vez al terminar. Las filas incluyen
+            las que descarta `where`; los bytes son del cuerpo (sin el
+            header). Si el callback lanza, la lectura se corta con su error.
+        cancel: CancelToken; al cancelarlo (desde otro hilo o desde el
+            propio callback) la llamada lanza OperationCancelled en el
+            siguiente chunk y suelta lo leído.
     """
     try:
-        return cpp_csv.read_csv_dicts(filename, delimiter)
+        return cpp_csv.read_csv_dicts(
+            filename, delimiter, usecols, _drop_list(drop_patterns), _where(where),
+            int(memory_limit or 0), _stats('read_csv_dicts', stats),
+            progress, int(progress_rows or 0), int(progress_bytes or 0), cancel,
+        )
+    except OperationCancelled:
+        raise
     except Exception:
         logger.exception("Error leyendo CSV con cpp_csv (dicts)")
         raise
 
 
-def read_csv_as_dicts(filename, delimiter=','):
+def read_csv_as_dicts(filename, delimiter=',', usecols=None, drop_patterns=None, where=None,
+                      memory_limit=0, stats=None, progress=None, progress_rows=50000,
+                      progress_bytes=8 << 20, cancel=None):
     """
     Alias para read_csv_dicts por compatibilidad.
     Lee un CSV usando el módulo C++ y regresa una lista de diccionarios.
     """
-    return read_csv_dicts(filename, delimiter)
+    return read_csv_dicts(filename, delimiter, usecols, drop_patterns, where, memory_limit, stats,
+                          progress, progress_rows, progress_bytes, cancel)
 
 
-def read_and_validate_csv(filename, schema, delimiter=','):
+def read_and_validate_csv(filename, schema, delimiter=',', usecols=None, drop_patterns=None, where=None,
+                          memory_limit=0, stats=None, progress=None, progress_rows=50000,
+                          progress_bytes=8 << 20, cancel=None):
     """
     Lee y valida un CSV usando el módulo C++ optimizado.
     
@@ -49,6 +263,12 @@ def read_and_validate_csv(filename, schema, delimiter=','):
                 'Comentarios': {'type': 'text'}
             }
         delimiter: Delimitador del CSV (por defecto ',')
+        usecols / drop_patterns: Proyección de columnas (ver read_csv_dicts)
+        where: Filtro de filas (ver read_csv_dicts); 'row' en los errores
+            cuenta solo las filas que pasan el filtro
+        memory_limit / stats: Presupuesto de memoria (ver read_csv_dicts)
+        progress / progress_rows / progress_bytes / cancel: Avance y
+            cancelación (ver read_csv_dicts)
     
     Returns:
         Dict con dos claves:
@@ -62,7 +282,472 @@ def read_and_validate_csv(filename, schema, delimiter=','):
         - 'single': Valor que debe estar en una lista de opciones válidas
     """
     try:
-        return cpp_csv.read_and_validate_csv(filename, schema, delimiter)
+        return cpp_csv.read_and_validate_csv(
+            filename, schema, delimiter, usecols, _drop_list(drop_patterns), _where(where),
+            int(memory_limit or 0), _stats('read_and_validate_csv', stats),
+            progress, int(progress_rows or 0), int(progress_bytes or 0), cancel,
+        )
+    except OperationCancelled:
+        raise
     except Exception:
         logger.exception("Error validando CSV con cpp_csv")
         raise
+
+
+def iter_csv_dict_chunks(filename, chunk_size=2500, delimiter=',', prefetch=2,
+                         usecols=None, drop_patterns=None, where=None, memory_limit=0, stats=None,
+                         cancel=None):
+    """
+    Itera un CSV por chunks (list[dict]) mientras un hilo nativo parsea los
+    siguientes en segundo plano, sin el GIL.
+
+    Pensado para el pipeline de importación: mientras Python mapea un chunk
+    y lo manda con COPY a Postgres, C++ ya está parseando el siguiente.
+    A lo más `prefetch` chunks quedan listos en memoria. `usecols` /
+    `drop_patterns` proyectan columnas y `where` filtra filas igual que
+    read_csv_dicts (los chunks traen solo filas que cumplen); el iterador
+    expone `header` (todas) y `columns` (las que traen los dicts).
+
+    Con `memory_limit` (bytes) se cargan al presupuesto los arenas del
+    prefetch y los objetos del chunk actual: se asume que el chunk anterior
+    ya se soltó al pedir el siguiente. `chunks.stats` da la memoria medida y
+    'bytes_read' (mismas llaves que `stats` en read_csv_dicts). Con `stats`
+    (dict) también se miden las fases y el dict se actualiza en cada chunk y
+    al cerrar; ahí
+    'total_ns' es el tiempo dentro del iterador, 'wait_ns' lo que esperó al
+    hilo de parseo y 'gil_ns' la conversión.
+
+    Con `cancel` (CancelToken) el hilo de parseo se detiene al cancelarse y
+    el siguiente chunk lanza OperationCancelled. El avance lo lleva quien
+    itera (p. ej. con `chunks.stats['bytes_read']`, aun sin `stats`).
+
+    Uso:
+        with iter_csv_dict_chunks(path, chunk_size=2500) as chunks:
+            for rows in chunks:
+                ...
+    """
+    try:
+        return cpp_csv.CsvChunkIterator(
+            filename, delimiter, chunk_size, prefetch, usecols, _drop_list(drop_patterns), _where(where),
+            int(memory_limit or 0), _stats('iter_csv_dict_chunks', stats), cancel,
+        )
+    except Exception:
+        logger.exception("Error abriendo CSV con cpp_csv (chunks)")
+        raise
+
+
+def split_multi_select(value, separators=',;'):
+    """
+    Divide una celda multi-selección ("Ventas; IT, RRHH") en opciones.
+
+    Respeta comillas ("a, b" es una sola opción), recorta espacios y
+    elimina duplicados dentro de la celda conservando el orden.
+    """
+    return cpp_csv.split_multi_select(value, separators)
+
+
+def build_multi_select_mapper(options, separators=',;'):
+    """
+    Construye un mapeador nativo {texto_opción: option_id} reutilizable.
+
+    `mapper.map(cells)` recibe una columna (list[str]) y regresa:
+        'rows': índice de fila de cada par encontrado
+        'option_ids': option_id de cada par encontrado
+        'unknown_rows' / 'unknown_tokens': tokens sin opción conocida
+    """
+    return cpp_csv.MultiSelectMapper(options, separators)
+
+
+def discover_column_values(filename, columns=None, multi_columns=None,
+                           max_distinct=200, delimiter=',', stats=None, progress=None,
+                           progress_rows=50000, progress_bytes=8 << 20, cancel=None, where=None):
+    """
+    Cuenta los valores distintos por columna en TODO el archivo, en una
+    pasada paralela en C++ (sin el GIL).
+
+    Args:
+        columns: Columnas a analizar (None = todas)
+        multi_columns: Columnas multi-selección; sus celdas se dividen en
+            opciones igual que `split_multi_select`
+        max_distinct: Tope de valores distintos; al pasarlo la columna se
+            marca como texto libre y no se devuelven sus valores
+        stats: dict para los contadores por fase (ver read_csv_dicts),
+            sumados entre los rangos paralelos
+        progress / progress_rows / progress_bytes / cancel: Avance y
+            cancelación (ver read_csv_dicts); el avance suma los rangos y el
+            callback puede llamarse desde un hilo nativo
+        where: Filtro de filas (ver read_csv_dicts); solo se cuentan las
+            filas que lo cumplen
+
+    Returns:
+        {columna: {'values': {valor: conteo}, 'distinct': int,
+                   'non_empty': int, 'free_text': bool}}
+    """
+    try:
+        return cpp_csv.discover_column_values(
+            filename, list(columns or []), list(multi_columns or []),
+            max_distinct, delimiter, ',;', 0, _stats('discover_column_values', stats),
+            progress, int(progress_rows or 0), int(progress_bytes or 0), cancel, _where(where),
+        )
+    except OperationCancelled:
+        raise
+    except Exception:
+        logger.exception("Error descubriendo opciones con cpp_csv")
+        raise
+
+
+def numeric_stats(values, counts=None, quantiles=(), bins=10):
+    """
+    Estadísticas de una pregunta numérica desde arreglos paralelos
+    (valor, conteo), en O(valores distintos): no expande las observaciones.
+
+    Args:
+        values: Valores (float/int); se ignoran NaN
+        counts: Conteo de cada valor (None = 1 por valor)
+        quantiles: Cuantiles extra a calcular, p. ej. (0.25, 0.75)
+        bins: Número de rangos del histograma
+
+    Returns:
+        {'count', 'sum', 'mean', 'variance', 'stddev', 'min', 'max',
+         'median', 'quantiles': {q: valor},
+         'histogram': [(inicio, fin, conteo), ...]}
+        Sin observaciones, las estadísticas son None.
+    """
+    return cpp_csv.numeric_stats(
+        [float(v) for v in values],
+        [int(c) for c in counts] if counts is not None else [],
+        [float(q) for q in quantiles],
+        bins,
+    )
+
+
+
+def nps_breakdown(values, counts=None, segments=None, num_segments=0, confidence=0.95):
+    """
+    NPS global y por segmento en C++, en una sola pasada sobre arreglos
+    paralelos (valor, conteo, segmento).
+
+    Args:
+        values: Valores de la escala 0-10; se ignoran NaN
+        counts: Conteo de cada valor (None = 1 por valor)
+        segments: Código de segmento de cada valor (None = sin segmentos);
+            los negativos solo cuentan en el global
+        num_segments: Segmentos a reportar (0 = código mayor + 1)
+        confidence: Confianza del intervalo analítico (Wald)
+
+    Returns:
+        {'overall': grupo, 'segments': [grupo, ...]} donde cada grupo es
+        {'total', 'promoters', 'passives', 'detractors', 'score', 'margin',
+         'ci_low', 'ci_high'}; sin respuestas, score e intervalo son None.
+    """
+    return cpp_csv.nps_breakdown(
+        [float(v) for v in values],
+        [int(c) for c in counts] if counts is not None else [],
+        [int(s) for s in segments] if segments is not None else [],
+        num_segments,
+        confidence,
+    )
+
+
+def build_crosstab(universe, row_ids, row_labels, col_ids, col_labels, top_k=10,
+                   missing_label='Sin respuesta', other_label='Otros', total_label='Total'):
+    """
+    Tabla cruzada de dos preguntas en C++ (sin pandas ni el GIL).
+
+    Args:
+        universe: Todos los response_id a cruzar; los que no respondieron
+            una pregunta cuentan como `missing_label`
+        row_ids/row_labels: Pares (response_id, categoría) de la pregunta de filas
+        col_ids/col_labels: Pares de la pregunta de columnas
+        top_k: Categorías visibles por eje; el resto se agrupa en `other_label`
+
+    Returns:
+        {'data': {'index', 'columns', 'data'} (formato 'split' de pandas, con
+         márgenes Total), 'total_responses', 'row_categories', 'col_categories'}
+    """
+    return cpp_csv.build_crosstab(
+        list(universe), list(row_ids), list(row_labels), list(col_ids), list(col_labels),
+        top_k, missing_label, other_label, total_label,
+    )
+
+
+def correlation_matrix(response_ids, question_ids, values, columns=None,
+                       method='pearson', max_columns=20):
+    """
+    Matriz de correlación entre preguntas numéricas desde tripletas
+    (response_id, question_id, valor), en C++ y sin el GIL.
+
+    Cada par de preguntas usa solo las respuestas que contestaron ambas
+    (pairwise-complete, como DataFrame.corr).
+
+    Args:
+        columns: question_id a incluir y su orden (None = todos, ascendente)
+        method: 'pearson' o 'spearman'
+        max_columns: Tope de columnas (el mapa de calor muestra 20)
+
+    Returns:
+        {'columns': [question_id], 'matrix': [[r | None]], 'pairs': [[n]]}
+    """
+    return cpp_csv.correlation_matrix(
+        list(response_ids), list(question_ids), [float(v) for v in values],
+        list(columns or []), method, max_columns,
+    )
+
+
+def fold_text(text):
+    """Minúsculas sin acentos ("Atención" -> "atencion"); lo no alfanumérico queda como espacio."""
+    return cpp_csv.fold_text(text)
+
+
+def analyze_texts(texts, min_length=3, stopwords=(), top_k=20, bigrams=True, track=()):
+    """
+    Palabras y bigramas más frecuentes de una lista de comentarios, en C++
+    y sin el GIL (pensado para analizar todos los comentarios, no una muestra).
+
+    Args:
+        min_length: Largo mínimo de token (después de quitar acentos)
+        stopwords: Palabras a ignorar (se normalizan igual que el texto)
+        top_k: Términos a devolver (0 = todos)
+        bigrams: Contar también pares de palabras consecutivas
+        track: Términos cuyo conteo se quiere siempre (p. ej. léxicos)
+
+    Returns:
+        {'words': [(palabra, conteo)], 'bigrams': [(bigrama, conteo)],
+         'tracked': {término: conteo}, 'tokens': int, 'documents': int}
+    """
+    return cpp_csv.analyze_texts(
+        [t if isinstance(t, str) else str(t or '') for t in texts],
+        min_length, list(stopwords), top_k, bigrams, list(track),
+    )
+
+
+def build_sentiment_lexicon(terms, negators=(), window=3):
+    """
+    Construye una sola vez el autómata (Aho–Corasick) de un léxico de
+    sentimiento; `lexicon.score(texts)` puntúa todos los textos en una
+    pasada lineal por texto, sin el GIL.
+
+    Args:
+        terms: {palabra o frase: peso} (> 0 positivo, < 0 negativo)
+        negators: Palabras o frases que invierten el signo de los términos
+            que empiezan a menos de `window` tokens después
+        window: Tokens de alcance de un negador
+
+    `lexicon.score(texts)` regresa:
+        'scores': puntaje de cada texto (suma de pesos con signo)
+        'positive' / 'negative': aportes totales (negative en valor absoluto)
+        'matches': términos encontrados
+        'positive_texts' / 'negative_texts' / 'neutral_texts': textos por signo
+    """
+    return cpp_csv.SentimentLexicon(
+        {str(k): float(v) for k, v in dict(terms).items()}, list(negators), window,
+    )
+
+
+def scan_pii(columns):
+    """
+    Busca PII en columnas completas de texto con autómatas en C++ (sin regex
+    y sin el GIL): correos, teléfonos, identificadores tipo folio y
+    documentos oficiales (RFC, CURP, DNI).
+
+    Args:
+        columns: list[list[str]], una lista de valores por columna
+
+    Returns:
+        Por columna: {'values', 'distinct', 'emails', 'phones', 'identifiers',
+        'national_ids', 'flagged_rows'} (filas con correo, teléfono o documento)
+    """
+    return cpp_csv.scan_pii([list(column) for column in columns])
+
+
+def build_text_index(texts):
+    """
+    Índice invertido en C++ de una lista de comentarios (término normalizado
+    -> [(fila, posición)]), para consultar citas y contexto sin volver a
+    recorrer los textos.
+
+    El índice expone:
+        index.best_quote(terms, min_length=20, max_length=110): fila del texto
+            con todos los términos/frases y largo dentro del rango, o None
+        index.keyword_in_context(term, width=40, limit=20):
+            [{'row', 'left', 'match', 'right'}]
+        index.postings(term): [(fila, posición)]
+        index.documents / index.terms
+    """
+    return cpp_csv.TextIndex([t if isinstance(t, str) else str(t or '') for t in texts])
+
+
+def build_survey_cube(response_ids, days, choice_columns=(), numeric_columns=()):
+    """
+    Cubo columnar en C++ de una encuesta: por pregunta, fila y código de
+    diccionario de cada respuesta, para contestar distribuciones y conteos
+    filtrados sin la BD.
+
+    Args:
+        response_ids: Universo de respuestas (SurveyResponse.id)
+        days: Día (date.toordinal()) de cada respuesta
+        choice_columns: [(question_id, response_ids, labels, from_option)]
+        numeric_columns: [(question_id, response_ids, values)]
+
+    El cubo expone:
+        cube.rows / cube.bytes / cube.mapped / cube.question_ids()
+        cube.dictionary(qid): [(etiqueta, de_opción)] o valores ordenados
+        cube.all(), cube.days_between(a, b), cube.with_codes(qid, codes),
+            cube.with_values(qid, low, high): CubeRows (bitmaps; admiten &, |, -, ~, len)
+        cube.code_counts(qid, rows=None), cube.day_counts(rows=None),
+            cube.last_response_id(rows=None), cube.response_ids(rows=None)
+        cube.save(path): archivo que se vuelve a abrir con open_survey_cube
+    """
+    return cpp_csv.build_survey_cube(
+        [int(r) for r in response_ids],
+        [int(d) for d in days],
+        [
+            (int(qid), [int(r) for r in ids], [str(label) for label in labels], [1 if f else 0 for f in flags])
+            for qid, ids, labels, flags in choice_columns
+        ],
+        [
+            (int(qid), [int(r) for r in ids], [float(v) for v in values])
+            for qid, ids, values in numeric_columns
+        ],
+    )
+
+
+def open_survey_cube(path):
+    """Abre con mmap un cubo guardado con `cube.save(path)`."""
+    return cpp_csv.open_survey_cube(str(path))
+
+
+def build_csv_encoder(header, dictionaries=None, delimiter=',', multi_separator=', ', chunk_size=64 * 1024):
+    """
+    Codificador CSV en C++ (RFC 4180, como csv.writer) para exportar tablas
+    de respuestas por lotes con memoria constante.
+
+    Args:
+        header: Nombres de columna
+        dictionaries: {índice de columna: [etiquetas]} para celdas que llegan
+            como código de opción (las etiquetas se escapan una sola vez)
+        multi_separator: Unión de varias respuestas en la misma celda
+        chunk_size: Tamaño aproximado de cada bloque de salida
+
+    El codificador expone:
+        encoder.header() -> bytes
+        encoder.encode(rows, leading, cell_rows, cell_columns, texts, numbers, codes)
+            -> [bytes]; leading = columnas fijas ([str] por fila); por celda se usa
+            el texto, si no el número (NaN = sin número), si no la etiqueta del código (-1 = sin código)
+    """
+    return cpp_csv.build_csv_encoder(
+        [str(h) for h in header],
+        {int(c): [str(label) for label in labels] for c, labels in (dictionaries or {}).items()},
+        delimiter,
+        multi_separator,
+        int(chunk_size),
+    )
+
+
+def build_copy_encoder(types):
+    """
+    Codificador en C++ del formato binario de COPY de PostgreSQL
+    (COPY ... FROM STDIN WITH (FORMAT BINARY)).
+
+    Args:
+        types: Tipo de cada columna del COPY, en orden: 'int2', 'int4',
+            'int8' o 'text' (deben coincidir con los de la tabla)
+
+    El codificador expone:
+        encoder.encode(columns, header=True, trailer=True) -> bytes
+            columns = [[int|str|None] por fila] por columna; None es NULL.
+            Un COPY es header + uno o más lotes + trailer.
+    """
+    return cpp_csv.build_copy_encoder([str(t) for t in types])
+
+
+def _complete_future(future, result, error):
+    # Corre en el event loop (call_soon_threadsafe); el await pudo haberse cancelado
+    if future.cancelled():
+        return
+    if error is not None:
+        future.set_exception(error)
+    else:
+        future.set_result(result)
+
+
+async def run_async(fn, *args, **kwargs):
+    """
+    Ejecuta fn(*args, **kwargs) en el planificador nativo de cpp_csv y espera el
+    resultado sin bloquear el event loop ni el hilo sync de Django
+    (sync_to_async con thread_sensitive=True serializa las llamadas en un
+    solo hilo). El planificador completa el future con loop.call_soon_threadsafe.
+
+    `fn` corre fuera del hilo sync: úsese para funciones de cpp_csv
+    (parseo, validación, agregación), no para el ORM. Cancelar el await no
+    detiene el trabajo nativo, solo descarta su resultado (las versiones
+    *_async de lectura y discover sí lo cortan con su CancelToken).
+    """
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+    cpp_csv.submit_async(fn, args, kwargs, loop, future, _complete_future)
+    return await future
+
+
+async def _run_cancellable(fn, *args, cancel=None, **kwargs):
+    # Si se cancela el await también se cancela el token: el trabajo nativo
+    # se corta en el siguiente chunk y el hilo del planificador queda libre
+    token = cancel if cancel is not None else CancelToken()
+    try:
+        return await run_async(fn, *args, cancel=token, **kwargs)
+    except asyncio.CancelledError:
+        token.cancel()
+        raise
+
+
+async def read_csv_dicts_async(filename, delimiter=',', usecols=None, drop_patterns=None, where=None,
+                               memory_limit=0, stats=None, progress=None, cancel=None):
+    """Versión awaitable de read_csv_dicts; cancelar el await corta la lectura."""
+    return await _run_cancellable(
+        read_csv_dicts, filename, delimiter, usecols, drop_patterns, where, memory_limit, stats,
+        progress=progress, cancel=cancel,
+    )
+
+
+async def read_and_validate_csv_async(filename, schema, delimiter=',', usecols=None, drop_patterns=None,
+                                      where=None, memory_limit=0, stats=None, progress=None, cancel=None):
+    """Versión awaitable de read_and_validate_csv; cancelar el await corta la lectura."""
+    return await _run_cancellable(
+        read_and_validate_csv, filename, schema, delimiter, usecols, drop_patterns, where, memory_limit, stats,
+        progress=progress, cancel=cancel,
+    )
+
+
+async def discover_column_values_async(filename, columns=None, multi_columns=None,
+                                       max_distinct=200, delimiter=',', stats=None, progress=None, cancel=None,
+                                       where=None):
+    """Versión awaitable de discover_column_values; cancelar el await corta el conteo."""
+    return await _run_cancellable(
+        discover_column_values, filename, columns, multi_columns, max_distinct, delimiter, stats,
+        progress=progress, cancel=cancel, where=where,
+    )
+
+
+def configure_threads(threads=0, per_call_limit=0):
+    """
+    Tamaño del planificador nativo compartido por todo el proceso (kernels
+    paralelos y llamadas awaitable).
+
+    Args:
+        threads: Hilos del planificador (0 = CPP_CSV_THREADS o núcleos)
+        per_call_limit: Máximo de tareas simultáneas por llamada
+            (0 = CPP_CSV_THREADS_PER_CALL o `threads`)
+
+    Solo aplica antes del primer uso; regresa False si el planificador ya
+    estaba corriendo. Tras un fork (prefork de Celery) el hijo crea el suyo
+    con esta misma configuración.
+    """
+    return cpp_csv.configure_scheduler(int(threads or 0), int(per_call_limit or 0))
+
+
+def scheduler_stats():
+    """
+    Estado del planificador: {'threads', 'per_call_limit', 'queued',
+    'active', 'submitted', 'executed', 'steals'}.
+    """
+    return cpp_csv.scheduler_stats()